@@ -2,6 +2,9 @@
 #	include "MEM_guardedalloc.h"
 #endif
 
+#include "LIB_task.h"
+#include "LIB_thread.h"
+
 #include "KER_context.h"
 #include "KER_modifier.h"
 
@@ -16,6 +19,9 @@ int main(void) {
 	MEM_use_guarded_allocator();
 #endif
 
+	LIB_threadapi_init();
+	LIB_task_scheduler_init();
+
 	rContext *C = CTX_new();
 
 	KER_modifier_init();
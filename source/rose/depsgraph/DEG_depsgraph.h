@@ -75,6 +75,13 @@ bool DEG_is_active(const struct Depsgraph *depsgraph);
 void DEG_make_active(struct Depsgraph *depsgraph);
 void DEG_make_inactive(struct Depsgraph *depsgraph);
 
+/**
+ * Collect timing of the evaluated operations, see the evaluation statistics in
+ * `DEG_depsgraph_query.h`. Enabling the statistics resets the previously accumulated ones.
+ */
+void DEG_graph_stats_enable(struct Depsgraph *depsgraph, bool enable);
+bool DEG_graph_stats_enabled(const struct Depsgraph *depsgraph);
+
 /** \} */
 
 /* -------------------------------------------------------------------- */
@@ -3,6 +3,7 @@
 
 #include "DEG_depsgraph.h"
 
+struct AnimationEvalCache;
 struct CustomData_MeshMasks;
 struct Depsgraph;
 struct Main;
@@ -23,6 +24,9 @@ struct Main *DEG_get_main(const struct Depsgraph *graph);
 
 float DEG_get_ctime(const struct Depsgraph *graph);
 
+/** The cache shared by the animation evaluations of the current evaluation of the graph. */
+struct AnimationEvalCache *DEG_get_anim_eval_cache(const struct Depsgraph *graph);
+
 /** \} */
 
 /* -------------------------------------------------------------------- */
@@ -51,6 +55,54 @@ struct ID *DEG_get_evaluated_id(const struct Depsgraph *depsgraph, struct ID *id
 
 /** \} */
 
+/* -------------------------------------------------------------------- */
+/** \name DEG evaluation statistics
+ *
+ * Only collected while enabled with #DEG_graph_stats_enable. Times are in seconds, timestamps are
+ * relative to the start of the last evaluation.
+ * \{ */
+
+typedef struct DEGOperationStats {
+	/** Original data-block the operation belongs to. */
+	struct ID *id;
+	/** Type and name of the component the operation belongs to. */
+	const char *component_type;
+	const char *component_name;
+	/** Operation code and name, only valid until the relations of the graph are updated. */
+	const char *operation_code;
+	const char *operation_name;
+
+	/** Index of the thread which evaluated the operation. */
+	int thread_id;
+	/** When all the dependencies of the operation were evaluated. */
+	double ready_time;
+	double start_time;
+	double end_time;
+} DEGOperationStats;
+
+/** Wall time of the last evaluation. */
+double DEG_stats_evaluation_time(const struct Depsgraph *graph);
+
+/** Operations evaluated during the last evaluation, ordered by their start time. */
+int DEG_stats_operations_num(const struct Depsgraph *graph);
+void DEG_stats_operation_get(const struct Depsgraph *graph, int index, DEGOperationStats *r_stats);
+
+/**
+ * Time spent on evaluating the given original ID, during the last evaluation or accumulated
+ * over all the evaluations since the statistics were enabled when \a total is set.
+ */
+double DEG_stats_id_time(const struct Depsgraph *graph, const struct ID *id, bool total);
+/**
+ * Same as #DEG_stats_id_time for a single component of the ID, the type is the one given in
+ * #DEGOperationStats.component_type (e.g. "GEOMETRY").
+ */
+double DEG_stats_component_time(const struct Depsgraph *graph, const struct ID *id, const char *component_type, const char *component_name, bool total);
+
+/** Write the last evaluation as Chrome trace event JSON, for `chrome://tracing` or Perfetto. */
+bool DEG_stats_write_chrome_trace(const struct Depsgraph *graph, const char *filepath);
+
+/** \} */
+
 #ifdef __cplusplus
 }
 #endif
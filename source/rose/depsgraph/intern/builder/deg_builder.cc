@@ -10,6 +10,7 @@
 #include "LIB_utildefines.h"
 
 #include "KER_action.h"
+#include "KER_anim_data.h"
 
 #include "RNA_prototypes.h"
 
@@ -171,7 +172,11 @@ void deg_graph_build_finalize(Main *main, Depsgraph *graph) {
 		if (id_node->customdata_masks != id_node->previous_customdata_masks) {
 			flag |= ID_RECALC_GEOMETRY;
 		}
-		if (!deg_copy_on_write_is_expanded(id_node->id_cow)) {
+		if (deg_copy_on_write_is_expanded(id_node->id_cow)) {
+			/* The relations changed, the data the animation paths resolved to might have changed too. */
+			KER_animdata_runtime_tag_dirty(KER_animdata_from_id(id_node->id_cow));
+		}
+		else {
 			flag |= ID_RECALC_COPY_ON_WRITE;
 			/**
 			 * This means ID is being added to the dependency graph first
@@ -449,7 +449,11 @@ void DepsgraphNodeBuilder::build_action(Action *action) {
 		return;
 	}
 	build_idproperties(action->id.properties);
-	add_operation_node(&action->id, NodeType::ANIMATION, OperationCode::ANIMATION_EVAL);
+	(void)add_id_node(&action->id);
+	Action *action_cow = get_cow_datablock(action);
+	add_operation_node(&action->id, NodeType::ANIMATION, OperationCode::ANIMATION_EVAL, [action_cow](::Depsgraph * /*depsgraph*/) {
+		KER_action_bake_samples_ensure(action_cow);
+	});
 }
 
 void DepsgraphNodeBuilder::build_armature(Armature *armature) {
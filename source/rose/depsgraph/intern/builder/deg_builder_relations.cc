@@ -120,6 +120,11 @@ void DepsgraphRelationBuilder::build_copy_on_write_relations(IDNode *id_node) {
 		if (ELEM(comp_node->type, NodeType::PARAMETERS, NodeType::LAYER_COLLECTIONS)) {
 			rel_flag &= ~RELATION_FLAG_NO_FLUSH;
 		}
+		/* A fresh copy of an action has none of its curves baked, the animation component is where
+		 * they are baked again. */
+		if (ELEM(id_type, ID_AC) && comp_node->type == NodeType::ANIMATION) {
+			rel_flag &= ~RELATION_FLAG_NO_FLUSH;
+		}
 		/* All entry operations of each component should wait for a proper
 		 * copy of ID. */
 		OperationNode *op_entry = comp_node->get_entry_operation();
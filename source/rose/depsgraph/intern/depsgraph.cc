@@ -1,5 +1,6 @@
 #include "DEG_depsgraph.h"
 
+#include "KER_anim_sys.h"
 #include "KER_idtype.h"
 #include "KER_lib_id.h"
 #include "KER_scene.h"
@@ -12,18 +13,21 @@
 #include "intern/node/deg_node_operation.hh"
 #include "intern/node/deg_node_time.hh"
 
+#include "intern/eval/deg_eval_stats.hh"
+
 #include "intern/depsgraph_registry.hh"
 
 #include "depsgraph.hh"
 
 namespace rose::depsgraph {
 
-Depsgraph::Depsgraph(Main *main, Scene *scene, ViewLayer *view_layer) : time_source(nullptr), need_update(true), need_visibility_update(true), need_visibility_time_update(false), main(main), scene(scene), view_layer(view_layer), ctime(0.0), scene_cow(nullptr), is_active(false), is_evaluating(false) {
+Depsgraph::Depsgraph(Main *main, Scene *scene, ViewLayer *view_layer) : time_source(nullptr), need_update(true), need_visibility_update(true), need_visibility_time_update(false), main(main), scene(scene), view_layer(view_layer), ctime(0.0), scene_cow(nullptr), is_active(false), is_evaluating(false), use_stats(false), stats_eval_start(0.0), stats_eval_time(0.0) {
 	LIB_spin_init(&lock);
 	memset(id_type_updated, 0, sizeof(id_type_updated));
 	memset(id_type_exist, 0, sizeof(id_type_exist));
 
 	this->ctime = KER_scene_frame_get(scene);
+	this->anim_eval_cache = KER_animsys_eval_cache_new();
 
 	add_time_source();
 }
@@ -31,6 +35,7 @@ Depsgraph::Depsgraph(Main *main, Scene *scene, ViewLayer *view_layer) : time_sou
 Depsgraph::~Depsgraph() {
 	clear_id_nodes();
 	delete time_source;
+	KER_animsys_eval_cache_free(anim_eval_cache);
 	LIB_spin_end(&lock);
 }
 
@@ -171,6 +176,7 @@ void Depsgraph::add_entry_tag(OperationNode *node) {
 }
 
 void Depsgraph::clear_all_nodes() {
+	stats_operations.clear();
 	clear_id_nodes();
 	delete time_source;
 	time_source = nullptr;
@@ -272,4 +278,18 @@ void DEG_make_inactive(Depsgraph *depsgraph) {
 	deg_graph->is_active = false;
 }
 
+void DEG_graph_stats_enable(Depsgraph *depsgraph, bool enable) {
+	deg::Depsgraph *deg_graph = reinterpret_cast<deg::Depsgraph *>(depsgraph);
+	if (enable && !deg_graph->use_stats) {
+		/* Start accumulating from scratch, previous statistics might be from a different scene state. */
+		deg::deg_eval_stats_reset(deg_graph);
+	}
+	deg_graph->use_stats = enable;
+}
+
+bool DEG_graph_stats_enabled(const Depsgraph *depsgraph) {
+	const deg::Depsgraph *deg_graph = reinterpret_cast<const deg::Depsgraph *>(depsgraph);
+	return deg_graph->use_stats;
+}
+
 /** \} */
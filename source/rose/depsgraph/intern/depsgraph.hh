@@ -109,6 +109,9 @@ struct Depsgraph {
 	 */
 	Scene *scene_cow;
 
+	/** Shares the evaluation of the actions between the IDs of the graph, cleared on every evaluation. */
+	AnimationEvalCache *anim_eval_cache;
+
 	/**
 	 * Active dependency graph is a dependency graph which is used by the
 	 * currently active window. When dependency graph is active, it is allowed
@@ -121,6 +124,16 @@ struct Depsgraph {
 	bool is_active;
 
 	bool is_evaluating;
+
+	/* Evaluation Statistics .............. */
+
+	/* Collect timing of the evaluated operations, see #DEG_graph_stats_enable. */
+	bool use_stats;
+	/* Absolute time at which the last evaluation started and its wall time, in seconds. */
+	double stats_eval_start;
+	double stats_eval_time;
+	/* Operations evaluated during the last evaluation, ordered by their start time. */
+	OperationNodes stats_operations;
 };
 
 }  // namespace rose::depsgraph
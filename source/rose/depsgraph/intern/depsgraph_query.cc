@@ -13,6 +13,8 @@
 #include "intern/node/deg_node_operation.hh"
 #include "intern/node/deg_node_time.hh"
 
+#include "intern/eval/deg_eval_stats.hh"
+
 #include "intern/depsgraph_registry.hh"
 
 #include "depsgraph.hh"
@@ -43,6 +45,11 @@ float DEG_get_ctime(const Depsgraph *graph) {
 	return deg_graph->ctime;
 }
 
+AnimationEvalCache *DEG_get_anim_eval_cache(const Depsgraph *graph) {
+	const deg::Depsgraph *deg_graph = reinterpret_cast<const deg::Depsgraph *>(graph);
+	return deg_graph->anim_eval_cache;
+}
+
 /** \} */
 
 /* -------------------------------------------------------------------- */
@@ -162,3 +169,62 @@ ID *DEG_get_evaluated_id(const Depsgraph *depsgraph, ID *id) {
 }
 
 /** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name DEG evaluation statistics
+ * \{ */
+
+double DEG_stats_evaluation_time(const Depsgraph *graph) {
+	const deg::Depsgraph *deg_graph = reinterpret_cast<const deg::Depsgraph *>(graph);
+	return deg_graph->stats_eval_time;
+}
+
+int DEG_stats_operations_num(const Depsgraph *graph) {
+	const deg::Depsgraph *deg_graph = reinterpret_cast<const deg::Depsgraph *>(graph);
+	return int(deg_graph->stats_operations.size());
+}
+
+void DEG_stats_operation_get(const Depsgraph *graph, int index, DEGOperationStats *r_stats) {
+	const deg::Depsgraph *deg_graph = reinterpret_cast<const deg::Depsgraph *>(graph);
+	const deg::OperationNode *op_node = deg_graph->stats_operations[index];
+	const deg::ComponentNode *comp_node = op_node->owner;
+	r_stats->id = comp_node->owner->id_orig;
+	r_stats->component_type = deg::DEG_node_type_as_string(comp_node->type);
+	r_stats->component_name = comp_node->name.c_str();
+	r_stats->operation_code = deg::DEG_operation_code_as_string(op_node->opcode);
+	r_stats->operation_name = op_node->name.c_str();
+	r_stats->thread_id = op_node->thread_id;
+	r_stats->ready_time = op_node->ready_time;
+	r_stats->start_time = op_node->start_time;
+	r_stats->end_time = op_node->end_time;
+}
+
+double DEG_stats_id_time(const Depsgraph *graph, const ID *id, bool total) {
+	const deg::Depsgraph *deg_graph = reinterpret_cast<const deg::Depsgraph *>(graph);
+	const deg::IDNode *id_node = deg_graph->find_id_node(id);
+	if (id_node == nullptr) {
+		return 0.0;
+	}
+	return total ? id_node->stats.total_time : id_node->stats.current_time;
+}
+
+double DEG_stats_component_time(const Depsgraph *graph, const ID *id, const char *component_type, const char *component_name, bool total) {
+	const deg::Depsgraph *deg_graph = reinterpret_cast<const deg::Depsgraph *>(graph);
+	const deg::IDNode *id_node = deg_graph->find_id_node(id);
+	if (id_node == nullptr) {
+		return 0.0;
+	}
+	for (const deg::ComponentNode *comp_node : id_node->components.values()) {
+		if (STREQ(deg::DEG_node_type_as_string(comp_node->type), component_type) && comp_node->name == component_name) {
+			return total ? comp_node->stats.total_time : comp_node->stats.current_time;
+		}
+	}
+	return 0.0;
+}
+
+bool DEG_stats_write_chrome_trace(const Depsgraph *graph, const char *filepath) {
+	const deg::Depsgraph *deg_graph = reinterpret_cast<const deg::Depsgraph *>(graph);
+	return deg::deg_eval_stats_write_chrome_trace(deg_graph, filepath);
+}
+
+/** \} */
@@ -2,6 +2,7 @@
 #include "LIB_task.h"
 #include "LIB_utildefines.h"
 
+#include "KER_anim_sys.h"
 #include "KER_global.h"
 
 #include "intern/depsgraph.hh"
@@ -10,6 +11,7 @@
 #include "intern/eval/deg_eval_copy_on_write.hh"
 #include "intern/eval/deg_eval_flush.hh"
 #include "intern/eval/deg_eval_runtime_backup.hh"
+#include "intern/eval/deg_eval_stats.hh"
 #include "intern/node/deg_node.hh"
 #include "intern/node/deg_node_component.hh"
 #include "intern/node/deg_node_id.hh"
@@ -63,7 +65,17 @@ void evaluate_node(const DepsgraphEvalState *state, OperationNode *operation_nod
 	/* Sanity checks. */
 	ROSE_assert_msg(!operation_node->is_noop(), "NOOP nodes should not actually be scheduled");
 	/* Perform operation. */
-	operation_node->evaluate(depsgraph);
+	if (state->do_stats) {
+		const double eval_start = state->graph->stats_eval_start;
+		operation_node->thread_id = LIB_task_parallel_thread_id(nullptr);
+		operation_node->start_time = deg_eval_stats_time_now() - eval_start;
+		operation_node->evaluate(depsgraph);
+		operation_node->end_time = deg_eval_stats_time_now() - eval_start;
+		operation_node->stats.current_time += operation_node->end_time - operation_node->start_time;
+	}
+	else {
+		operation_node->evaluate(depsgraph);
+	}
 }
 
 void deg_task_run_func(TaskPool *pool, void *taskdata) {
@@ -128,6 +140,10 @@ void calculate_pending_parents(Depsgraph *graph) {
 void initialize_execution(DepsgraphEvalState *state, Depsgraph *graph) {
 	const bool do_stats = state->do_stats;
 	calculate_pending_parents(graph);
+	/* Clear the timing of the previous evaluation. */
+	if (do_stats) {
+		deg_eval_stats_begin(graph);
+	}
 }
 
 bool need_evaluate_operation_at_stage(DepsgraphEvalState *state, const OperationNode *operation_node) {
@@ -185,6 +201,10 @@ template<typename ScheduleFunction, typename... ScheduleFunctionArgs> void sched
 			schedule_children(state, node, schedule_function, schedule_function_args...);
 		}
 		else {
+			if (state->do_stats) {
+				/* The time until evaluation starts is spent waiting for a thread to pick it up. */
+				node->ready_time = deg_eval_stats_time_now() - state->graph->stats_eval_start;
+			}
 			/* children are scheduled once this task is completed */
 			schedule_function(node, 0, schedule_function_args...);
 		}
@@ -256,9 +276,12 @@ void deg_evaluate_on_refresh(Depsgraph *graph) {
 
 	graph->is_evaluating = true;
 	depsgraph_ensure_view_layer(graph);
+	/* The actions and the time may have changed since the last evaluation. */
+	KER_animsys_eval_cache_clear(graph->anim_eval_cache);
 	/* Set up evaluation state. */
 	DepsgraphEvalState state;
 	state.graph = graph;
+	state.do_stats = graph->use_stats;
 	state.need_single_thread_pass = false;
 	/* Prepare all nodes for evaluation. */
 	initialize_execution(&state, graph);
@@ -283,6 +306,10 @@ void deg_evaluate_on_refresh(Depsgraph *graph) {
 		evaluate_graph_single_threaded(&state);
 	}
 
+	if (state.do_stats) {
+		deg_eval_stats_aggregate(graph);
+	}
+
 	/* Clear any uncleared tags - just in case. */
 	deg_graph_clear_tags(graph);
 	graph->is_evaluating = false;
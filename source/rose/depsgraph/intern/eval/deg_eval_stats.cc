@@ -0,0 +1,169 @@
+#include "intern/eval/deg_eval_stats.hh"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <string>
+
+#include "LIB_utildefines.h"
+
+#include "intern/depsgraph.hh"
+#include "intern/node/deg_node.hh"
+#include "intern/node/deg_node_component.hh"
+#include "intern/node/deg_node_id.hh"
+#include "intern/node/deg_node_operation.hh"
+
+namespace rose::depsgraph {
+
+namespace {
+
+/* Timestamps in the trace file are in microseconds. */
+double seconds_to_trace_time(const double seconds) {
+	return seconds * 1e6;
+}
+
+void append_json_string(std::string &r_json, const char *str) {
+	r_json += '"';
+	for (const char *c = str; *c != '\0'; c++) {
+		switch (*c) {
+			case '"':
+				r_json += "\\\"";
+				break;
+			case '\\':
+				r_json += "\\\\";
+				break;
+			case '\n':
+				r_json += "\\n";
+				break;
+			case '\t':
+				r_json += "\\t";
+				break;
+			default:
+				if ((unsigned char)*c < 0x20) {
+					char buffer[8];
+					snprintf(buffer, sizeof(buffer), "\\u%04x", (unsigned int)*c);
+					r_json += buffer;
+				}
+				else {
+					r_json += *c;
+				}
+				break;
+		}
+	}
+	r_json += '"';
+}
+
+void append_json_number(std::string &r_json, const double value) {
+	char buffer[64];
+	snprintf(buffer, sizeof(buffer), "%.3f", value);
+	r_json += buffer;
+}
+
+}  // namespace
+
+double deg_eval_stats_time_now() {
+	using Clock = std::chrono::steady_clock;
+	return std::chrono::duration<double>(Clock::now().time_since_epoch()).count();
+}
+
+void deg_eval_stats_reset(Depsgraph *graph) {
+	for (IDNode *id_node : graph->id_nodes) {
+		id_node->stats.reset();
+		for (ComponentNode *comp_node : id_node->components.values()) {
+			comp_node->stats.reset();
+			for (OperationNode *op_node : comp_node->operations) {
+				op_node->stats.reset();
+			}
+		}
+	}
+	graph->stats_eval_time = 0.0;
+	graph->stats_operations.clear();
+}
+
+void deg_eval_stats_begin(Depsgraph *graph) {
+	for (IDNode *id_node : graph->id_nodes) {
+		id_node->stats.reset_current();
+		for (ComponentNode *comp_node : id_node->components.values()) {
+			comp_node->stats.reset_current();
+			for (OperationNode *op_node : comp_node->operations) {
+				op_node->stats.reset_current();
+			}
+		}
+	}
+	graph->stats_operations.clear();
+	graph->stats_eval_start = deg_eval_stats_time_now();
+}
+
+void deg_eval_stats_aggregate(Depsgraph *graph) {
+	graph->stats_eval_time = deg_eval_stats_time_now() - graph->stats_eval_start;
+
+	for (IDNode *id_node : graph->id_nodes) {
+		for (ComponentNode *comp_node : id_node->components.values()) {
+			for (OperationNode *op_node : comp_node->operations) {
+				/* The scheduled flag is only cleared when the next evaluation is initialized. */
+				if (!op_node->scheduled || op_node->is_noop()) {
+					continue;
+				}
+				op_node->stats.total_time += op_node->stats.current_time;
+				comp_node->stats.current_time += op_node->stats.current_time;
+				graph->stats_operations.append(op_node);
+			}
+			comp_node->stats.total_time += comp_node->stats.current_time;
+			id_node->stats.current_time += comp_node->stats.current_time;
+		}
+		id_node->stats.total_time += id_node->stats.current_time;
+	}
+
+	std::sort(graph->stats_operations.begin(), graph->stats_operations.end(), [](const OperationNode *a, const OperationNode *b) { return a->start_time < b->start_time; });
+}
+
+bool deg_eval_stats_write_chrome_trace(const Depsgraph *graph, const char *filepath) {
+	FILE *file = fopen(filepath, "w");
+	if (file == nullptr) {
+		return false;
+	}
+
+	std::string json = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+	int max_thread_id = -1;
+	for (const OperationNode *op_node : graph->stats_operations) {
+		const ComponentNode *comp_node = op_node->owner;
+		const IDNode *id_node = comp_node->owner;
+
+		/* Complete event ("X") for the evaluation itself, the time the operation spent in the queue
+		 * before a thread picked it up is stored in the arguments. */
+		json += "{\"ph\":\"X\",\"pid\":1,\"tid\":";
+		json += std::to_string(op_node->thread_id);
+		json += ",\"name\":";
+		append_json_string(json, op_node->identifier().c_str());
+		json += ",\"cat\":";
+		append_json_string(json, DEG_node_type_as_string(comp_node->type));
+		json += ",\"ts\":";
+		append_json_number(json, seconds_to_trace_time(op_node->start_time));
+		json += ",\"dur\":";
+		append_json_number(json, seconds_to_trace_time(op_node->end_time - op_node->start_time));
+		json += ",\"args\":{\"id\":";
+		append_json_string(json, id_node->name.c_str());
+		json += ",\"component\":";
+		append_json_string(json, comp_node->identifier().c_str());
+		json += ",\"queue_wait_us\":";
+		append_json_number(json, seconds_to_trace_time(op_node->start_time - op_node->ready_time));
+		json += "}},\n";
+
+		max_thread_id = std::max(max_thread_id, op_node->thread_id);
+	}
+	/* Name the threads, so that the viewer does not only show bare numbers. */
+	for (int thread_id = 0; thread_id <= max_thread_id; thread_id++) {
+		json += "{\"ph\":\"M\",\"pid\":1,\"tid\":";
+		json += std::to_string(thread_id);
+		json += ",\"name\":\"thread_name\",\"args\":{\"name\":\"Depsgraph Thread ";
+		json += std::to_string(thread_id);
+		json += "\"}},\n";
+	}
+	json += "{\"ph\":\"M\",\"pid\":1,\"name\":\"process_name\",\"args\":{\"name\":\"Depsgraph Evaluation\"}}\n]}\n";
+
+	const bool ok = fwrite(json.data(), 1, json.size(), file) == json.size();
+	fclose(file);
+	return ok;
+}
+
+}  // namespace rose::depsgraph
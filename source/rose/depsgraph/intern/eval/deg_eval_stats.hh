@@ -0,0 +1,37 @@
+#ifndef DEG_EVAL_STATS_HH
+#define DEG_EVAL_STATS_HH
+
+namespace rose::depsgraph {
+
+struct Depsgraph;
+
+/**
+ * Monotonic time in seconds, used for all the timestamps of the evaluation statistics.
+ */
+double deg_eval_stats_time_now();
+
+/**
+ * Reset all the statistics of the graph, including the ones accumulated over evaluations.
+ */
+void deg_eval_stats_reset(struct Depsgraph *graph);
+
+/**
+ * Prepare the statistics for a new evaluation, called before any operation is scheduled.
+ */
+void deg_eval_stats_begin(struct Depsgraph *graph);
+
+/**
+ * Aggregate timing of the evaluated operations into their components and IDs, called once all the
+ * operations are evaluated.
+ */
+void deg_eval_stats_aggregate(struct Depsgraph *graph);
+
+/**
+ * Write the operations of the last evaluation as a Chrome trace event file, which can be loaded
+ * into `chrome://tracing` or Perfetto.
+ */
+bool deg_eval_stats_write_chrome_trace(const struct Depsgraph *graph, const char *filepath);
+
+}  // namespace rose::depsgraph
+
+#endif	// !DEG_EVAL_STATS_HH
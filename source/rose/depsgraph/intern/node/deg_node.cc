@@ -64,6 +64,25 @@ Node::TypeInfo::TypeInfo(NodeType type, const char *type_name, int recalc) : typ
 
 /** \} */
 
+/* -------------------------------------------------------------------- */
+/** \name Evaluation statistics.
+ * \{ */
+
+Node::Stats::Stats() {
+	reset();
+}
+
+void Node::Stats::reset() {
+	total_time = 0.0;
+	current_time = 0.0;
+}
+
+void Node::Stats::reset_current() {
+	current_time = 0.0;
+}
+
+/** \} */
+
 /* -------------------------------------------------------------------- */
 /** \name Node.
  * \{ */
@@ -153,6 +153,22 @@ struct Node {
 	 */
 	int custom_flags;
 
+	/* Evaluation statistics, only collected when enabled with #DEG_graph_stats_enable. */
+	struct Stats {
+		Stats();
+
+		/* Reset all the counters, including the ones accumulated over evaluations. */
+		void reset();
+		/* Reset the counters which only cover the current evaluation. */
+		void reset_current();
+
+		/* Time spent on this node over all the evaluations, in seconds. */
+		double total_time;
+		/* Time spent on this node during the last evaluation, in seconds. */
+		double current_time;
+	};
+	Stats stats;
+
 	Node();
 	virtual ~Node();
 
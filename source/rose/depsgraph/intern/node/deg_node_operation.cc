@@ -91,7 +91,7 @@ const char *DEG_operation_code_as_string(OperationCode opcode) {
 
 /* clang-format on */
 
-OperationNode::OperationNode() : name_tag(-1), flag(0) {
+OperationNode::OperationNode() : name_tag(-1), flag(0), ready_time(0.0), start_time(0.0), end_time(0.0), thread_id(0) {
 }
 
 std::string OperationNode::identifier() const {
@@ -210,6 +210,14 @@ struct OperationNode : public Node {
 	/* (OperationFlag) extra settings affecting evaluation. */
 	int flag;
 
+	/* Timestamps of the last evaluation, in seconds relative to the start of the evaluation of the
+	 * graph. Only valid when evaluation statistics are enabled. */
+	double ready_time;
+	double start_time;
+	double end_time;
+	/* Index of the thread which evaluated the operation. */
+	int thread_id;
+
 	DEG_DEPSNODE_DECLARE;
 };
 
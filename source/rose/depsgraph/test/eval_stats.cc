@@ -0,0 +1,200 @@
+#include "MEM_guardedalloc.h"
+
+#include "DNA_object_types.h"
+#include "DNA_scene_types.h"
+
+#include "KER_collection.h"
+#include "KER_idtype.h"
+#include "KER_layer.h"
+#include "KER_main.h"
+#include "KER_object.h"
+#include "KER_scene.h"
+
+#include "LIB_utildefines.h"
+
+#include "DEG_depsgraph.h"
+#include "DEG_depsgraph_build.h"
+#include "DEG_depsgraph_query.h"
+
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+
+#include "gtest/gtest.h"
+
+namespace {
+
+/** Minimal JSON syntax check, enough to know that a trace viewer can load the file. */
+class JsonValidator {
+	const std::string &text_;
+	size_t pos_ = 0;
+
+	void skip_whitespace() {
+		while (pos_ < text_.size() && std::isspace((unsigned char)text_[pos_])) {
+			pos_++;
+		}
+	}
+
+	bool consume(const char c) {
+		skip_whitespace();
+		if (pos_ < text_.size() && text_[pos_] == c) {
+			pos_++;
+			return true;
+		}
+		return false;
+	}
+
+	bool parse_string() {
+		if (!consume('"')) {
+			return false;
+		}
+		while (pos_ < text_.size() && text_[pos_] != '"') {
+			if ((unsigned char)text_[pos_] < 0x20) {
+				return false;
+			}
+			pos_ += (text_[pos_] == '\\') ? 2 : 1;
+		}
+		return consume('"');
+	}
+
+	bool parse_number() {
+		skip_whitespace();
+		const size_t start = pos_;
+		while (pos_ < text_.size() && (std::isdigit((unsigned char)text_[pos_]) || strchr("+-.eE", text_[pos_]))) {
+			pos_++;
+		}
+		return pos_ > start;
+	}
+
+	template<typename ParseItem> bool parse_sequence(const char end, ParseItem parse_item) {
+		if (consume(end)) {
+			return true;
+		}
+		do {
+			if (!parse_item()) {
+				return false;
+			}
+		} while (consume(','));
+		return consume(end);
+	}
+
+	bool parse_value() {
+		skip_whitespace();
+		if (pos_ >= text_.size()) {
+			return false;
+		}
+		switch (text_[pos_]) {
+			case '{':
+				pos_++;
+				return parse_sequence('}', [&]() { return parse_string() && consume(':') && parse_value(); });
+			case '[':
+				pos_++;
+				return parse_sequence(']', [&]() { return parse_value(); });
+			case '"':
+				return parse_string();
+			default:
+				for (const char *literal : {"true", "false", "null"}) {
+					if (text_.compare(pos_, strlen(literal), literal) == 0) {
+						pos_ += strlen(literal);
+						return true;
+					}
+				}
+				return parse_number();
+		}
+	}
+
+public:
+	JsonValidator(const std::string &text) : text_(text) {
+	}
+
+	bool is_valid() {
+		pos_ = 0;
+		if (!parse_value()) {
+			return false;
+		}
+		skip_whitespace();
+		return pos_ == text_.size();
+	}
+};
+
+size_t count_substrings(const std::string &text, const std::string &pattern) {
+	size_t count = 0;
+	for (size_t pos = text.find(pattern); pos != std::string::npos; pos = text.find(pattern, pos + pattern.size())) {
+		count++;
+	}
+	return count;
+}
+
+TEST(DepsgraphStats, EvaluateAndTrace) {
+	KER_idtype_init();
+	DEG_register_node_types();
+
+	Main *main = KER_main_new();
+	do {
+		Scene *scene = KER_scene_new(main, "Scene");
+		ViewLayer *view_layer = KER_view_layer_default_view(scene);
+		Object *objects[3];
+		for (int index = 0; index < int(ARRAY_SIZE(objects)); index++) {
+			objects[index] = KER_object_add(main, scene, OB_EMPTY, "Empty");
+			KER_collection_object_add(main, scene->master_collection, objects[index]);
+		}
+		/* Chain the objects, so that the evaluation has dependencies between IDs. */
+		objects[1]->parent = objects[0];
+		objects[2]->parent = objects[1];
+
+		Depsgraph *depsgraph = KER_scene_ensure_depsgraph(main, scene, view_layer);
+		ASSERT_NE(depsgraph, nullptr);
+		DEG_graph_stats_enable(depsgraph, true);
+		EXPECT_TRUE(DEG_graph_stats_enabled(depsgraph));
+
+		KER_scene_graph_update_tagged(depsgraph, main);
+		const int operations_num = DEG_stats_operations_num(depsgraph);
+		ASSERT_GT(operations_num, 0);
+
+		/* Every object is evaluated, the operations are ordered by their start time. */
+		std::map<const ID *, int> operations_per_id;
+		double start_time_prev = 0.0;
+		for (int index = 0; index < operations_num; index++) {
+			DEGOperationStats stats;
+			DEG_stats_operation_get(depsgraph, index, &stats);
+			operations_per_id[stats.id]++;
+
+			EXPECT_GE(stats.thread_id, 0);
+			EXPECT_LE(stats.ready_time, stats.start_time);
+			EXPECT_LE(stats.start_time, stats.end_time);
+			EXPECT_GE(stats.start_time, start_time_prev);
+			start_time_prev = stats.start_time;
+		}
+		for (Object *object : objects) {
+			EXPECT_GT(operations_per_id[&object->id], 0);
+			EXPECT_GE(DEG_stats_id_time(depsgraph, &object->id, false), 0.0);
+			EXPECT_GE(DEG_stats_id_time(depsgraph, &object->id, true), DEG_stats_id_time(depsgraph, &object->id, false));
+		}
+		/* The parented objects go through the same operations, with the parent transform on top. */
+		EXPECT_EQ(operations_per_id[&objects[1]->id], operations_per_id[&objects[2]->id]);
+		EXPECT_GT(operations_per_id[&objects[1]->id], operations_per_id[&objects[0]->id]);
+		EXPECT_GE(DEG_stats_evaluation_time(depsgraph), 0.0);
+
+		/* The trace is valid JSON, with one complete event per evaluated operation. */
+		const std::string filepath = testing::TempDir() + "depsgraph_trace.json";
+		ASSERT_TRUE(DEG_stats_write_chrome_trace(depsgraph, filepath.c_str()));
+		std::ifstream file(filepath);
+		std::stringstream buffer;
+		buffer << file.rdbuf();
+		const std::string trace = buffer.str();
+		EXPECT_TRUE(JsonValidator(trace).is_valid());
+		EXPECT_EQ(count_substrings(trace, "\"ph\":\"X\""), size_t(operations_num));
+		remove(filepath.c_str());
+
+		/* Disabling stops collecting. */
+		DEG_graph_stats_enable(depsgraph, false);
+		EXPECT_FALSE(DEG_graph_stats_enabled(depsgraph));
+	} while (false);
+	KER_main_free(main);
+}
+
+}  // namespace
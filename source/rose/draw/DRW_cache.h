@@ -6,6 +6,7 @@
 struct GPUBatch;
 struct GPUUniformBuf;
 
+struct ModifierData;
 struct Object;
 struct Mesh;
 struct Scene;
@@ -31,6 +32,8 @@ void DRW_global_cache_free(void);
 /** \name Default cache objects
  * \{ */
 
+/** \return True if the #MODIFIER_DEVICE_ONLY modifier can be applied on the GPU. */
+bool DRW_batch_cache_device_supported(const struct ModifierData *md);
 const struct Object *DRW_batch_cache_device_armature(const struct Object *object);
 
 /**
@@ -295,6 +295,10 @@ void DRW_batch_cache_generate(Object *object) {
 #undef ROUTE
 }
 
+bool DRW_batch_cache_device_supported(const ModifierData *md) {
+	return ELEM(md->type, MODIFIER_TYPE_ARMATURE);
+}
+
 const Object *DRW_batch_cache_device_armature(const Object *object) {
 	LISTBASE_FOREACH_BACKWARD(const ModifierData *, md, &object->modifiers) {
 		if ((md->flag & MODIFIER_DEVICE_ONLY) != 0) {
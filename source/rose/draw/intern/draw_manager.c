@@ -14,6 +14,7 @@
 #include "KER_layer.h"
 #include "KER_main.h"
 #include "KER_mesh.h"
+#include "KER_modifier.h"
 #include "KER_scene.h"
 #include "KER_object.h"
 
@@ -64,6 +65,7 @@ void DRW_engines_register(void) {
 	{
 		KER_mesh_batch_cache_tag_dirty_cb = DRW_mesh_batch_cache_tag_dirty;
 		KER_mesh_batch_cache_free_cb = DRW_mesh_batch_cache_free;
+		KER_modifier_device_supported_cb = DRW_batch_cache_device_supported;
 	}
 }
 
@@ -124,10 +124,10 @@ void extract_weights_mesh_ubo(const Object *obarmature, const Object *obtarget,
 }
 
 void extract_weights_mesh_vbo(const Object *obtarget, const Mesh *metarget, rose::MutableSpan<MDeformDeviceData> vbo_data) {
-	rose::Span<MDeformVert> dverts = KER_mesh_deform_verts_span(metarget);
+	rose::GroupedSpan<MDeformWeight> weights = KER_mesh_deform_weights_span(metarget);
 	rose::Span<int> vcorners = KER_mesh_corner_verts_span(metarget);
 
-	if (dverts.is_empty()) {
+	if (weights.offsets.is_empty()) {
 		vbo_data.fill(MDeformDeviceData());
 		return;
 	}
@@ -137,11 +137,9 @@ void extract_weights_mesh_vbo(const Object *obtarget, const Mesh *metarget, rose
 	/* gather the deform vertices for each vertex. */
 	rose::threading::parallel_for(vcorners.index_range(), 4096, [&](const rose::IndexRange range) {
 		for (const size_t corner : range) {
-			const MDeformVert *dvert = &dverts[vcorners[corner]];
-
 			vbo_data[corner] = MDeformDeviceData();
 
-			const rose::Span<MDeformWeight> dweights(dvert->dw, dvert->totweight);
+			const rose::Span<MDeformWeight> dweights = weights[vcorners[corner]];
 			if (dweights.size() <= 4) {
 				for (const size_t index : dweights.index_range()) {
 					vbo_data[corner].defgroup[index] = dweights[index].def_nr;
@@ -22,7 +22,7 @@ ROSE_STATIC wmOperatorStatus wm_fbx_import_exec(rContext *C, wmOperator *op) {
 	}
 
 	for (const std::string &path : paths) {
-		FBX_import(C, &path[0], 1.0f);
+		FBX_import(C, &path[0], 1.0f, nullptr);
 	}
 
 	return OPERATOR_FINISHED;
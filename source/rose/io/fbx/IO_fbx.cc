@@ -7,6 +7,7 @@
 #include "KER_object.h"
 
 #include "LIB_fileops.h"
+#include "LIB_mmap.h"
 #include "LIB_task.hh"
 
 #include "DEG_depsgraph.h"
@@ -24,6 +25,12 @@
 
 namespace rose::io::fbx {
 
+/**
+ * The share of the progress that goes to reading the file, the rest is split between the phases
+ * that build the scene.
+ */
+#define FBX_PROGRESS_LOAD 0.5f
+
 struct FbxImportContext {
 	const ufbx_scene *fbx;
 
@@ -33,7 +40,10 @@ struct FbxImportContext {
 
 	float fps;
 
-	FbxImportContext(Main *main, Scene *scene, const ufbx_scene *fbx, const char *filepath) : main(main), scene(scene), fbx(fbx) {
+	/** Optional, receives the progress of the phases and requests to stop the import. */
+	wmJobWorkerStatus *worker_status;
+
+	FbxImportContext(Main *main, Scene *scene, const ufbx_scene *fbx, const char *filepath, wmJobWorkerStatus *worker_status) : main(main), scene(scene), fbx(fbx), worker_status(worker_status) {
 		fps = (float)fbx->settings.frames_per_second;
 
 		ufbx_transform root_tr;
@@ -48,8 +58,19 @@ struct FbxImportContext {
 	void import_armatures();
 	void import_animation(double fps);
 
+	/** Report that the import reached \a progress, returns false when the import should stop. */
+	bool report_progress(float progress);
 };
 
+bool FbxImportContext::report_progress(float progress) {
+	if (this->worker_status == nullptr) {
+		return true;
+	}
+	this->worker_status->progress = FBX_PROGRESS_LOAD + (1.0f - FBX_PROGRESS_LOAD) * progress;
+	this->worker_status->do_update = true;
+	return !this->worker_status->stop;
+}
+
 void FbxImportContext::import_globals() {
 	RenderData *r = &this->scene->r;
 
@@ -87,13 +108,57 @@ static void fbx_task_wait_fn(void * /* user */, ufbx_thread_pool_context /* ctx
 	/* Empty implementation; #fbx_task_run_fn already waits for the tasks. This means that only one fbx "task group" is effectively scheduled at once. */
 }
 
-void importer_scene(Main *main, Scene *scene, ViewLayer *view_layer, ufbx_scene *fbx, const char *filepath) {
-	FbxImportContext ctx(main, scene, fbx, filepath);
+static ufbx_progress_result fbx_progress_fn(void *user, const ufbx_progress *progress) {
+	wmJobWorkerStatus *worker_status = static_cast<wmJobWorkerStatus *>(user);
+	if (progress->bytes_total) {
+		worker_status->progress = FBX_PROGRESS_LOAD * float(double(progress->bytes_read) / double(progress->bytes_total));
+		worker_status->do_update = true;
+	}
+	return worker_status->stop ? UFBX_PROGRESS_CANCEL : UFBX_PROGRESS_CONTINUE;
+}
+
+static ufbx_load_opts importer_load_opts(float unit, wmJobWorkerStatus *worker_status) {
+	ufbx_load_opts opts = {};
+	opts.evaluate_skinning = false;
+	opts.evaluate_caches = false;
+	opts.load_external_files = false;
+	opts.clean_skin_weights = true;
+	opts.use_blender_pbr_material = true;
+
+	opts.geometry_transform_handling = UFBX_GEOMETRY_TRANSFORM_HANDLING_MODIFY_GEOMETRY;
+	opts.pivot_handling = UFBX_PIVOT_HANDLING_ADJUST_TO_ROTATION_PIVOT;
+
+	opts.space_conversion = UFBX_SPACE_CONVERSION_ADJUST_TRANSFORMS;
+	opts.target_unit_meters = unit;
+
+	/* Setup ufbx threading to go through our own task system. */
+	opts.thread_opts.pool.run_fn = fbx_task_run_fn;
+	opts.thread_opts.pool.wait_fn = fbx_task_wait_fn;
+
+	if (worker_status) {
+		opts.progress_cb.fn = fbx_progress_fn;
+		opts.progress_cb.user = worker_status;
+	}
+
+	return opts;
+}
+
+void importer_scene(Main *main, Scene *scene, ViewLayer *view_layer, ufbx_scene *fbx, const char *filepath, wmJobWorkerStatus *worker_status) {
+	FbxImportContext ctx(main, scene, fbx, filepath, worker_status);
 
+	/* The phases are weighted by a rough estimate of their cost, the objects that were created before
+	 * the import was stopped are still added to the scene. */
 	ctx.import_globals();
-	ctx.import_armatures();
-	ctx.import_meshes();
-	ctx.import_animation(ctx.fps);
+	if (ctx.report_progress(0.0f)) {
+		ctx.import_armatures();
+	}
+	if (ctx.report_progress(0.2f)) {
+		ctx.import_meshes();
+	}
+	if (ctx.report_progress(0.6f)) {
+		ctx.import_animation(ctx.fps);
+	}
+	ctx.report_progress(1.0f);
 
 	LayerCollection *lc = KER_layer_collection_get_active(view_layer);
 
@@ -115,70 +180,70 @@ void importer_scene(Main *main, Scene *scene, ViewLayer *view_layer, ufbx_scene
 	DEG_relations_tag_update(main);
 }
 
-void importer_memory(Main *main, Scene *scene, ViewLayer *view_layer, const void *memory, size_t size, float unit) {
-	ufbx_load_opts opts = {};
-	opts.evaluate_skinning = false;
-	opts.evaluate_caches = false;
-	opts.load_external_files = false;
-	opts.clean_skin_weights = true;
-	opts.use_blender_pbr_material = true;
+static void importer_loaded(Main *main, Scene *scene, ViewLayer *view_layer, ufbx_scene *fbx, const ufbx_error *fbx_error, const char *filepath, wmJobWorkerStatus *worker_status) {
+	if (!fbx) {
+		if (fbx_error->type != UFBX_ERROR_CANCELLED) {
+			fprintf(stderr, "[FBX] Cannot import resource file : %s\n", fbx_error->description.data);
+		}
+		return;
+	}
 
-	opts.geometry_transform_handling = UFBX_GEOMETRY_TRANSFORM_HANDLING_MODIFY_GEOMETRY;
-	opts.pivot_handling = UFBX_PIVOT_HANDLING_ADJUST_TO_ROTATION_PIVOT;
+	importer_scene(main, scene, view_layer, fbx, filepath, worker_status);
 
-	opts.space_conversion = UFBX_SPACE_CONVERSION_ADJUST_TRANSFORMS;
-	opts.target_unit_meters = unit;
+	ufbx_free_scene(fbx);
+}
 
-	/* Setup ufbx threading to go through our own task system. */
-	opts.thread_opts.pool.run_fn = fbx_task_run_fn;
-	opts.thread_opts.pool.wait_fn = fbx_task_wait_fn;
+void importer_memory(Main *main, Scene *scene, ViewLayer *view_layer, const void *memory, size_t size, float unit, wmJobWorkerStatus *worker_status) {
+	ufbx_load_opts opts = importer_load_opts(unit, worker_status);
 
 	ufbx_error fbx_error;
 	ufbx_scene *fbx = ufbx_load_memory(memory, size, &opts, &fbx_error);
 
-	if (!fbx) {
-		fprintf(stderr, "[FBX] Cannot import resource file : %s\n", fbx_error.description.data);
-		return;
-	}
-
-	importer_scene(main, scene, view_layer, fbx, "");
-
-	ufbx_free_scene(fbx);
+	importer_loaded(main, scene, view_layer, fbx, &fbx_error, "", worker_status);
 }
 
-void importer_file(Main *main, Scene *scene, ViewLayer *view_layer, const char *filepath, float unit) {
+void importer_file(Main *main, Scene *scene, ViewLayer *view_layer, const char *filepath, float unit, wmJobWorkerStatus *worker_status) {
 	int fd = LIB_open(filepath, O_BINARY | O_RDONLY, 0);
-	if (!fd) {
+	if (fd == -1) {
 		fprintf(stderr, "[FBX] Cannot open resource file '%s'\n", filepath);
 		return;
 	}
 
-	uint64_t size = LIB_seek(fd, 0, SEEK_END);
-	if (size) {
-		void *memory = MEM_mallocN(size, __func__);
-		LIB_seek(fd, 0, SEEK_SET);
-		LIB_read(fd, memory, size);
+	/* Map the file instead of copying it into memory, the pages are only read once they are parsed. */
+	LIB_mmap_file *file = LIB_mmap_open(fd);
+	close(fd);
 
-		importer_memory(main, scene, view_layer, memory, size, unit);
+	ufbx_load_opts opts = importer_load_opts(unit, worker_status);
 
-		MEM_freeN(memory);
+	ufbx_error fbx_error;
+	ufbx_scene *fbx;
+	if (file) {
+		fbx = ufbx_load_memory(LIB_mmap_get_pointer(file), LIB_mmap_get_length(file), &opts, &fbx_error);
+	}
+	else {
+		/* Files that can not be mapped are streamed from the disk by ufbx instead. */
+		fbx = ufbx_load_file(filepath, &opts, &fbx_error);
 	}
 
-	close(fd);
+	importer_loaded(main, scene, view_layer, fbx, &fbx_error, filepath, worker_status);
+
+	if (file) {
+		LIB_mmap_free(file);
+	}
 }
 
-void FBX_import(rContext *C, const char *filepath, float unit) {
+void FBX_import(rContext *C, const char *filepath, float unit, wmJobWorkerStatus *worker_status) {
 	Main *main = CTX_data_main(C);
 	Scene *scene = CTX_data_scene(C);
 	ViewLayer *view_layer = CTX_data_view_layer(C);
 
-	importer_file(main, scene, view_layer, filepath, unit);
+	importer_file(main, scene, view_layer, filepath, unit, worker_status);
 }
 
-void FBX_import_memory(rContext *C, const void *memory, size_t size, float unit) {
+void FBX_import_memory(rContext *C, const void *memory, size_t size, float unit, wmJobWorkerStatus *worker_status) {
 	Main *main = CTX_data_main(C);
 	Scene *scene = CTX_data_scene(C);
 	ViewLayer *view_layer = CTX_data_view_layer(C);
 
-	importer_memory(main, scene, view_layer, memory, size, unit);
+	importer_memory(main, scene, view_layer, memory, size, unit, worker_status);
 }
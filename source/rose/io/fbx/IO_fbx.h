@@ -2,13 +2,18 @@
 #define IO_FBX_H
 
 struct rContext;
+struct wmJobWorkerStatus;
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
-void FBX_import(struct rContext *C, const char *filepath, float unit);
-void FBX_import_memory(struct rContext *C, const void *memory, size_t size, float unit);
+/**
+ * Import the FBX file into the active scene, the optional \a worker_status receives the progress
+ * of the import and can request it to stop.
+ */
+void FBX_import(struct rContext *C, const char *filepath, float unit, struct wmJobWorkerStatus *worker_status);
+void FBX_import_memory(struct rContext *C, const void *memory, size_t size, float unit, struct wmJobWorkerStatus *worker_status);
 
 #ifdef __cplusplus
 }
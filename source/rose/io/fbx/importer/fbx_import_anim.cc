@@ -1,9 +1,11 @@
+#include "LIB_array.hh"
 #include "LIB_map.hh"
 #include "LIB_memarena.h"
 #include "LIB_vector.hh"
 #include "LIB_vector_set.hh"
 #include "LIB_math_axis_angle.hh"
 #include "LIB_math_quaternion.hh"
+#include "LIB_task.hh"
 
 #include "KER_action.h"
 #include "KER_action.hh"
@@ -13,6 +15,8 @@
 
 #include "fbx_import_anim.hh"
 
+#include <algorithm>
+
 namespace rose::io::fbx {
 
 struct ElementAnimations {
@@ -188,6 +192,25 @@ void create_transform_curve_desc(FbxElementMapping *mapping, const ElementAnimat
 	}
 }
 
+/** Hack: force cubic keyframes to be linear, to match Python importer behavior. */
+ROSE_STATIC void force_linear_keyframes(const ElementAnimations *anim) {
+	for (const ufbx_anim_prop *prop : {anim->prop_position, anim->prop_rotation, anim->prop_scale}) {
+		if (prop == nullptr) {
+			continue;
+		}
+		for (const ufbx_anim_curve *curve : prop->anim_value->curves) {
+			if (curve == nullptr) {
+				continue;
+			}
+			for (const ufbx_keyframe &key : curve->keyframes) {
+				if (key.interpolation == UFBX_INTERPOLATION_CUBIC) {
+					const_cast<ufbx_keyframe &>(key).interpolation = UFBX_INTERPOLATION_LINEAR;
+				}
+			}
+		}
+	}
+}
+
 ROSE_STATIC double create_transform_curve_data(const FbxElementMapping *mapping, const ufbx_anim *fanim, const ElementAnimations *anim, const double fps, FCurve **fcurves) {
 	const ufbx_node *fnode = ufbx_as_node(anim->fbx_elem);
 	ufbx_matrix bone_xform = ufbx_identity_matrix;
@@ -254,10 +277,6 @@ ROSE_STATIC double create_transform_curve_data(const FbxElementMapping *mapping,
 	for (int i = 0; i < 9; i++) {
 		if (input_curves[i] != nullptr) {
 			for (const ufbx_keyframe &key : input_curves[i]->keyframes) {
-				if (key.interpolation == UFBX_INTERPOLATION_CUBIC) {
-					/* Hack: force cubic keyframes to be linear, to match Python importer behavior. */
-					const_cast<ufbx_keyframe &>(key).interpolation = UFBX_INTERPOLATION_LINEAR;
-				}
 				unique_key_times.add(key.time);
 			}
 		}
@@ -274,53 +293,65 @@ ROSE_STATIC double create_transform_curve_data(const FbxElementMapping *mapping,
 		KER_fcurve_bezt_resize(fcurves[i], sorted_key_times.size());
 	}
 
-	/* Evaluate transforms at all the key times. */
-	math::Quaternion quat_prev = math::Quaternion::identity();
-	for (size_t i = 0; i < sorted_key_times.size(); i++) {
-		double t = sorted_key_times[i];
-		float tf = float(t * fps);
-		ufbx_transform xform = ufbx_evaluate_transform(fanim, fnode, t);
+	/* Evaluate transforms at all the key times, the keys are independent so they are split in chunks. */
+	threading::parallel_for(sorted_key_times.index_range(), 256, [&](const IndexRange range) {
+		for (const int64_t i : range) {
+			double t = sorted_key_times[i];
+			float tf = float(t * fps);
+			ufbx_transform xform = ufbx_evaluate_transform(fanim, fnode, t);
 
-		if (is_bone) {
-			ufbx_matrix matrix = calc_bone_pose_matrix(xform, *fnode, bone_xform);
-			xform = ufbx_matrix_to_transform(&matrix);
-		}
+			if (is_bone) {
+				ufbx_matrix matrix = calc_bone_pose_matrix(xform, *fnode, bone_xform);
+				xform = ufbx_matrix_to_transform(&matrix);
+			}
 
-		set_curve_sample(fcurves[posindex + 0], i, tf, float(xform.translation.x));
-		set_curve_sample(fcurves[posindex + 1], i, tf, float(xform.translation.y));
-		set_curve_sample(fcurves[posindex + 2], i, tf, float(xform.translation.z));
+			set_curve_sample(fcurves[posindex + 0], i, tf, float(xform.translation.x));
+			set_curve_sample(fcurves[posindex + 1], i, tf, float(xform.translation.y));
+			set_curve_sample(fcurves[posindex + 2], i, tf, float(xform.translation.z));
+
+			math::Quaternion quat(xform.rotation.w, xform.rotation.x, xform.rotation.y, xform.rotation.z);
+			switch (rotmode) {
+				case ROT_MODE_QUAT:
+					set_curve_sample(fcurves[rotindex + 0], i, tf, quat.w);
+					set_curve_sample(fcurves[rotindex + 1], i, tf, quat.x);
+					set_curve_sample(fcurves[rotindex + 2], i, tf, quat.y);
+					set_curve_sample(fcurves[rotindex + 3], i, tf, quat.z);
+					break;
+				case ROT_MODE_AXISANGLE: {
+					const math::AxisAngle axis_angle = math::to_axis_angle(quat);
+					set_curve_sample(fcurves[rotindex + 0], i, tf, axis_angle.angle().radian());
+					set_curve_sample(fcurves[rotindex + 1], i, tf, axis_angle.axis().x);
+					set_curve_sample(fcurves[rotindex + 2], i, tf, axis_angle.axis().y);
+					set_curve_sample(fcurves[rotindex + 3], i, tf, axis_angle.axis().z);
+				} break;
+				default: {
+					math::EulerXYZ euler = math::to_euler(quat);
+					set_curve_sample(fcurves[rotindex + 0], i, tf, euler.x().radian());
+					set_curve_sample(fcurves[rotindex + 1], i, tf, euler.y().radian());
+					set_curve_sample(fcurves[rotindex + 2], i, tf, euler.z().radian());
+				} break;
+			}
 
-		math::Quaternion quat(xform.rotation.w, xform.rotation.x, xform.rotation.y, xform.rotation.z);
-		switch (rotmode) {
-			case ROT_MODE_QUAT:
-				/* Ensure shortest interpolation path between consecutive quaternions. */
-				if (i != 0 && math::dot(quat, quat_prev) < 0.0f) {
-					quat = -quat;
-				}
-				quat_prev = quat;
-				set_curve_sample(fcurves[rotindex + 0], i, tf, quat.w);
-				set_curve_sample(fcurves[rotindex + 1], i, tf, quat.x);
-				set_curve_sample(fcurves[rotindex + 2], i, tf, quat.y);
-				set_curve_sample(fcurves[rotindex + 3], i, tf, quat.z);
-				break;
-			case ROT_MODE_AXISANGLE: {
-				const math::AxisAngle axis_angle = math::to_axis_angle(quat);
-				set_curve_sample(fcurves[rotindex + 0], i, tf, axis_angle.angle().radian());
-				set_curve_sample(fcurves[rotindex + 1], i, tf, axis_angle.axis().x);
-				set_curve_sample(fcurves[rotindex + 2], i, tf, axis_angle.axis().y);
-				set_curve_sample(fcurves[rotindex + 3], i, tf, axis_angle.axis().z);
-			} break;
-			default: {
-				math::EulerXYZ euler = math::to_euler(quat);
-				set_curve_sample(fcurves[rotindex + 0], i, tf, euler.x().radian());
-				set_curve_sample(fcurves[rotindex + 1], i, tf, euler.y().radian());
-				set_curve_sample(fcurves[rotindex + 2], i, tf, euler.z().radian());
-			} break;
+			set_curve_sample(fcurves[sclindex + 0], i, tf, float(xform.scale.x));
+			set_curve_sample(fcurves[sclindex + 1], i, tf, float(xform.scale.y));
+			set_curve_sample(fcurves[sclindex + 2], i, tf, float(xform.scale.z));
 		}
+	});
 
-		set_curve_sample(fcurves[sclindex + 0], i, tf, float(xform.scale.x));
-		set_curve_sample(fcurves[sclindex + 1], i, tf, float(xform.scale.y));
-		set_curve_sample(fcurves[sclindex + 2], i, tf, float(xform.scale.z));
+	if (rotmode == ROT_MODE_QUAT) {
+		/* Ensure shortest interpolation path between consecutive quaternions, each key depends on the
+		 * previous one so this runs once all the keys are evaluated. */
+		for (size_t i = 1; i < sorted_key_times.size(); i++) {
+			float dot = 0.0f;
+			for (size_t c = 0; c < 4; c++) {
+				dot += fcurves[rotindex + c]->bezt[i].vec[1][1] * fcurves[rotindex + c]->bezt[i - 1].vec[1][1];
+			}
+			if (dot < 0.0f) {
+				for (size_t c = 0; c < 4; c++) {
+					fcurves[rotindex + c]->bezt[i].vec[1][1] *= -1.0f;
+				}
+			}
+		}
 	}
 
 	return sorted_key_times.last() * fps;
@@ -358,6 +389,15 @@ void import_animations(Main *main, Scene *scene, const ufbx_scene *fbx, FbxEleme
 				anims.append(&animation);
 			}
 
+			/**
+			 * The curves of all the animated elements of the layer, the elements are evaluated in
+			 * parallel once all their curves exist, \a anim_transform_curve_index refers to the first
+			 * curve of each element in \a layer_fcurves.
+			 */
+			rose::Vector<FCurve *> layer_fcurves;
+			rose::Vector<const ElementAnimations *> layer_anims;
+			rose::Vector<size_t> anim_transform_curve_index;
+
 			for (ID *id : ids) {
 				ROSE_assert(id);
 
@@ -386,42 +426,44 @@ void import_animations(Main *main, Scene *scene, const ufbx_scene *fbx, FbxEleme
 				 * their descriptors, then create the f-curves in one step, and finally fill their data.
 				 */
 				Vector<FCurveDescriptor> curve_desc;
-				rose::Vector<size_t> anim_transform_curve_index(id_anims.size());
 
 				MemArena *names = LIB_memory_arena_create(1024, "CurveNameAllocator");
-				for (const size_t index : id_anims.index_range()) {
-					const ElementAnimations *anim = id_anims[index];
+				for (const ElementAnimations *anim : id_anims) {
 					if (anim->prop_position || anim->prop_rotation || anim->prop_scale) {
-						std::string group_name_str = get_fbx_name(anim->fbx_elem->name, "");
-						anim_transform_curve_index[index] = curve_desc.size();
+						layer_anims.append(anim);
+						anim_transform_curve_index.append(layer_fcurves.size() + curve_desc.size());
 						create_transform_curve_desc(mapping, anim, names, curve_desc);
 					}
-					else {
-						anim_transform_curve_index[index] = -1;
-					}
 				}
 
-				rose::Vector<FCurve *> fcurves(curve_desc.size());
 				if (!curve_desc.is_empty()) {
-					KER_action_channelbag_fcurve_create_many(NULL, channelbag, curve_desc.data(), curve_desc.size(), fcurves.data());
+					const size_t curve_start = layer_fcurves.size();
+					layer_fcurves.resize(curve_start + curve_desc.size());
+					KER_action_channelbag_fcurve_create_many(NULL, channelbag, curve_desc.data(), curve_desc.size(), layer_fcurves.data() + curve_start);
 				}
-				
-				for (const size_t index : id_anims.index_range()) {
-					const ElementAnimations *anim = id_anims[index];
-					if (anim->prop_position || anim->prop_rotation || anim->prop_scale) {
-						float duration = create_transform_curve_data(mapping, flayer->anim, anim, fps, fcurves.data() + anim_transform_curve_index[index]);
 
-						action->frame_start = 0;
-						action->frame_end = duration;
-					}
-				}
+				LIB_memory_arena_destroy(names);
+			}
 
-				for (FCurve *curve : fcurves) {
+			/* The elements write to their own curves, so they are evaluated in parallel, the keyframes are
+			 * modified first since the input curves may be shared between elements. */
+			for (const ElementAnimations *anim : layer_anims) {
+				force_linear_keyframes(anim);
+			}
+			rose::Array<double> durations(layer_anims.size());
+			threading::parallel_for_each(layer_anims.index_range(), [&](const int64_t index) {
+				durations[index] = create_transform_curve_data(mapping, flayer->anim, layer_anims[index], fps, layer_fcurves.data() + anim_transform_curve_index[index]);
+			});
+			if (!durations.is_empty()) {
+				action->frame_start = 0;
+				action->frame_end = *std::max_element(durations.begin(), durations.end());
+			}
+
+			threading::parallel_for(layer_fcurves.index_range(), 64, [&](const IndexRange range) {
+				for (FCurve *curve : layer_fcurves.as_span().slice(range)) {
 					KER_fcurve_handles_recalc(curve);
 				}
-
-				LIB_memory_arena_destroy(names);
-			}
+			});
 		}
 	}
 }
@@ -1,3 +1,5 @@
+#include "MEM_guardedalloc.h"
+
 #include "KER_action.h"
 #include "KER_armature.h"
 #include "KER_deform.h"
@@ -8,18 +10,21 @@
 #include "KER_object.h"
 #include "KER_object_deform.h"
 
+#include "LIB_array.hh"
 #include "LIB_task.hh"
 #include "LIB_listbase.h"
 #include "LIB_math_matrix.hh"
 #include "LIB_math_matrix.h"
 #include "LIB_math_vector.hh"
 #include "LIB_math_vector.h"
+#include "LIB_offset_indices.hh"
 #include "LIB_span.hh"
 #include "LIB_vector_set.hh"
 #include "LIB_utildefines.h"
 
 #include "fbx_import_mesh.hh"
 
+#include <algorithm>
 #include <iomanip>
 
 namespace rose::io::fbx {
@@ -119,6 +124,12 @@ static bool is_skin_deformer_usable(const ufbx_mesh *mesh, const ufbx_skin_defor
 	return mesh != nullptr && skin != nullptr && skin->clusters.count > 0 && mesh->num_vertices > 0 && skin->vertices.count == mesh->num_vertices;
 }
 
+/** A cluster of a usable skin deformer and the vertex group its weights are imported into. */
+struct SkinClusterGroup {
+	const ufbx_skin_cluster *cluster;
+	int group_index;
+};
+
 ROSE_INLINE void import_skin_vertex_groups(const FbxElementMapping *mapping, const ufbx_mesh *fmesh, Mesh *mesh) {
 	if (fmesh->skin_deformers.count == 0) {
 		return;
@@ -129,8 +140,7 @@ ROSE_INLINE void import_skin_vertex_groups(const FbxElementMapping *mapping, con
 		return;
 	}
 
-	rose::MutableSpan<MDeformVert> dverts = KER_mesh_deform_verts_for_write_span(mesh);
-
+	rose::Vector<SkinClusterGroup> clusters;
 	for (const ufbx_skin_deformer *skin : fmesh->skin_deformers) {
 		if (!is_skin_deformer_usable(fmesh, skin)) {
 			continue;
@@ -146,16 +156,65 @@ ROSE_INLINE void import_skin_vertex_groups(const FbxElementMapping *mapping, con
 			if (group_index < 0) {
 				continue;
 			}
+			clusters.append({cluster, group_index});
+		}
+	}
+	if (clusters.is_empty()) {
+		return;
+	}
 
-			for (size_t index = 0; index < cluster->num_weights; index++) {
-				const size_t vertex = cluster->vertices[index];
-				if (vertex < dverts.size()) {
-					MDeformWeight *dw = KER_defvert_ensure_index(&dverts[vertex], group_index);
-					dw->weight = cluster->weights[index];
-				}
+	rose::MutableSpan<MDeformVert> dverts = KER_mesh_deform_verts_for_write_span(mesh);
+
+	/* Count the weights of every vertex first, so that the weights of a vertex are allocated once. */
+	rose::Array<int> offset_data(dverts.size() + 1, 0);
+	for (const SkinClusterGroup &group : clusters) {
+		for (size_t index = 0; index < group.cluster->num_weights; index++) {
+			const size_t vertex = group.cluster->vertices[index];
+			if (vertex < dverts.size()) {
+				offset_data[vertex]++;
+			}
+		}
+	}
+	const rose::OffsetIndices<int> offsets = rose::offset_indices::accumulate_counts_to_offsets(offset_data);
+
+	/* Gather the weights of every vertex in the order of the clusters. */
+	rose::Array<MDeformWeight> weights(offsets.total_size());
+	rose::Array<int> fill(offset_data.as_span().drop_back(1));
+	for (const SkinClusterGroup &group : clusters) {
+		for (size_t index = 0; index < group.cluster->num_weights; index++) {
+			const size_t vertex = group.cluster->vertices[index];
+			if (vertex < dverts.size()) {
+				weights[fill[vertex]++] = {static_cast<unsigned int>(group.group_index), static_cast<float>(group.cluster->weights[index])};
 			}
 		}
 	}
+
+	rose::threading::parallel_for(dverts.index_range(), 1024, [&](const IndexRange range) {
+		for (const int vertex : range) {
+			rose::MutableSpan<MDeformWeight> vweights = weights.as_mutable_span().slice(offsets[vertex]);
+			if (vweights.is_empty()) {
+				continue;
+			}
+
+			/* Clusters of the same bone share a group, the last weight wins like with #KER_defvert_ensure_index. */
+			int totweight = 0;
+			for (const MDeformWeight &dw : vweights) {
+				MDeformWeight *existing = std::find_if(vweights.begin(), vweights.begin() + totweight, [&](const MDeformWeight &other) { return other.def_nr == dw.def_nr; });
+				if (existing != vweights.begin() + totweight) {
+					existing->weight = dw.weight;
+				}
+				else {
+					vweights[totweight++] = dw;
+				}
+			}
+
+			MDeformVert &dvert = dverts[vertex];
+			ROSE_assert(dvert.dw == nullptr && dvert.totweight == 0);
+			dvert.dw = static_cast<MDeformWeight *>(MEM_mallocN(sizeof(MDeformWeight) * totweight, "MDeformWeight"));
+			memcpy(dvert.dw, vweights.data(), sizeof(MDeformWeight) * totweight);
+			dvert.totweight = totweight;
+		}
+	});
 }
 
 void import_meshes(Main *main, Scene *scene, const ufbx_scene *fbx, FbxElementMapping *mapping) {
@@ -176,6 +176,13 @@ enum {
 	 * (usual type-specific freeing is called though).
 	 */
 	ID_TAG_NOT_ALLOCATED = 1 << 18,
+	/**
+	 * The ID did not change since the undo step that is being restored, it was kept as is instead of
+	 * being read again (see #RLO_read_from_memfile).
+	 *
+	 * RESET_AFTER_USE
+	 */
+	ID_TAG_UNDO_OLD_ID_REUSED_UNCHANGED = 1 << 19,
 
 	/**
 	 * ID is newly duplicated/copied (see #ID_NEW_SET macro above).
@@ -79,6 +79,9 @@ typedef struct Action {
 	 */
 	float frame_start;
 	float frame_end;
+
+	/** The number of samples per frame of the curves when #ACT_BAKE_SAMPLES is set. */
+	float bake_rate;
 } Action;
 
 enum {
@@ -89,6 +92,11 @@ enum {
 	 * requires ACT_FRAME_RANGE.
 	 */
 	ACT_CYCLIC = (1 << 1),
+	/**
+	 * The curves are sampled at #Action::bake_rate before the action is evaluated and played back
+	 * from the samples, see #KER_action_bake_samples_ensure.
+	 */
+	ACT_BAKE_SAMPLES = (1 << 2),
 };
 
 /** \} */
@@ -214,6 +222,12 @@ typedef struct ActionChannelBag {
 	int totcurve;
 
 	int flag;
+	/**
+	 * Changes whenever curves are added or removed or a curve changes its path, the values are
+	 * unique between all the channel bags. Data resolved from the curves (e.g. #AnimDataRuntime)
+	 * is kept as long as it is unchanged, see #KER_action_channelbag_tag_changed.
+	 */
+	int generation;
 } ActionChannelBag;
 
 enum {
@@ -308,6 +322,8 @@ enum {
 	POSE_DONE = (1 << 9),
 };
 
+typedef struct PoseRuntime PoseRuntime;
+
 typedef struct Pose {
 	struct ListBase channelbase;
 	struct GHash *channelhash;
@@ -315,6 +331,9 @@ typedef struct Pose {
 	int flag;
 
 	PoseChannel **channels;
+
+	/** The flattened hierarchy used to evaluate the pose, see #KER_pose_where_is. */
+	PoseRuntime *runtime;
 } Pose;
 
 enum {
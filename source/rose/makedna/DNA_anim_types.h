@@ -20,6 +20,24 @@ typedef struct FPoint {
 	float vec[2];
 } FPoint;
 
+typedef struct FCurve_Runtime {
+	/**
+	 * Values of the keyframes sampled at a uniform rate between the first and the last keyframe,
+	 * NULL unless the curve was baked, see #KER_fcurve_bake_samples.
+	 */
+	float *baked;
+	int totbaked;
+	/** The time of the first sample and the number of samples per frame. */
+	float baked_start;
+	float baked_rate;
+
+	/** The keyframe ending the segment of the last evaluation, the next one starts looking there. */
+	int cursor;
+
+	/** The channel bag owning the curve, NULL for curves that are not part of an action. */
+	struct ActionChannelBag *channelbag;
+} FCurve_Runtime;
+
 typedef struct FCurve {
 	struct FCurve *prev, *next;
 
@@ -38,6 +56,8 @@ typedef struct FCurve {
 	 */
 	char *path;
 	int index;
+
+	FCurve_Runtime runtime;
 } FCurve;
 
 /** \} */
@@ -46,6 +66,8 @@ typedef struct FCurve {
 /** \name AnimData
  * \{ */
 
+typedef struct AnimDataRuntime AnimDataRuntime;
+
 typedef struct AnimData {
 	/**
 	 * Active action, acts as the tweaking track for the NLA.
@@ -62,6 +84,12 @@ typedef struct AnimData {
 	 * \example Defining `stime = scene->r.ctime` at the start would start the animation from the beginning.
 	 */
 	float stime;
+
+	/**
+	 * The resolved targets of the curves of the evaluated action slot, rebuilt when the action,
+	 * the slot or the relations of the depsgraph change, see #KER_animsys_evaluate_animdata.
+	 */
+	AnimDataRuntime *runtime;
 } AnimData;
 
 /** \} */
@@ -65,6 +65,15 @@ typedef struct Mesh {
 	MeshRuntime *runtime;
 } Mesh;
 
+/** #Mesh.flag */
+enum {
+	/**
+	 * Pick the diagonal of every quad again when the positions change, rather than keeping the one
+	 * the topology was first triangulated with, see #KER_mesh_looptris.
+	 */
+	ME_TESSELLATE_QUAD_SPLIT = (1 << 0),
+};
+
 #define MESH_MAX_VERTS 16777216
 
 #ifdef __cplusplus
@@ -292,12 +292,12 @@ bool DNATypeQualInterface::is_atomic() const {
 /** \name DNAType
  * \{ */
 
-eDNAType DNA_sdna_type_kind(SDNA *sdna, const DNAType *type) {
+eDNAType DNA_sdna_type_kind(const SDNA *sdna, const DNAType *type) {
 	UNUSED_VARS(sdna);
 	return reinterpret_cast<const DNATypeInterface *>(type)->type();
 }
 
-bool DNA_sdna_type_basic(SDNA *sdna, const DNAType *type) {
+bool DNA_sdna_type_basic(const SDNA *sdna, const DNAType *type) {
 	UNUSED_VARS(sdna);
 	return reinterpret_cast<const DNATypeInterface *>(type)->basic();
 }
@@ -308,12 +308,12 @@ bool DNA_sdna_type_basic(SDNA *sdna, const DNAType *type) {
 /** \name DNATypeBasic
  * \{ */
 
-bool DNA_sdna_basic_is_unsigned(SDNA *sdna, const DNATypeBasic *type) {
+bool DNA_sdna_basic_is_unsigned(const SDNA *sdna, const DNATypeBasic *type) {
 	UNUSED_VARS(sdna);
 	return reinterpret_cast<const DNATypeBasicInterface *>(type)->is_unsigned();
 }
 
-size_t DNA_sdna_basic_rank(SDNA *sdna, const DNATypeBasic *type) {
+size_t DNA_sdna_basic_rank(const SDNA *sdna, const DNATypeBasic *type) {
 	UNUSED_VARS(sdna);
 	return reinterpret_cast<const DNATypeBasicInterface *>(type)->rank();
 }
@@ -326,24 +326,24 @@ size_t DNA_sdna_basic_rank(SDNA *sdna, const DNATypeBasic *type) {
 
 // DNATypeEnumItem
 
-const char *DNA_sdna_enum_item_identifier(SDNA *sdna, const DNATypeEnum *type, const DNATypeEnumItem *item) {
+const char *DNA_sdna_enum_item_identifier(const SDNA *sdna, const DNATypeEnum *type, const DNATypeEnumItem *item) {
 	UNUSED_VARS(sdna, type);
 	return reinterpret_cast<const DNATypeEnumItemInterface *>(item)->identifier().c_str();
 }
 
 // DNATypeEnum
 
-const char *DNA_sdna_enum_identifier(SDNA *sdna, const DNATypeEnum *type) {
+const char *DNA_sdna_enum_identifier(const SDNA *sdna, const DNATypeEnum *type) {
 	UNUSED_VARS(sdna);
 	return reinterpret_cast<const DNATypeEnumInterface *>(type)->identifier().c_str();
 }
 
-const DNAType *DNA_sdna_enum_underlying_type(SDNA *sdna, const DNATypeEnum *type) {
+const DNAType *DNA_sdna_enum_underlying_type(const SDNA *sdna, const DNATypeEnum *type) {
 	UNUSED_VARS(sdna);
 	return reinterpret_cast<const DNAType *>(reinterpret_cast<const DNATypeEnumInterface *>(type)->base());
 }
 
-const ListBase *DNA_sdna_enum_items(SDNA *sdna, const DNATypeEnum *type) {
+const ListBase *DNA_sdna_enum_items(const SDNA *sdna, const DNATypeEnum *type) {
 	UNUSED_VARS(sdna);
 	return reinterpret_cast<const DNATypeEnumInterface *>(type)->items();
 }
@@ -354,12 +354,12 @@ const ListBase *DNA_sdna_enum_items(SDNA *sdna, const DNATypeEnum *type) {
 /** \name DNATypePointer
  * \{ */
 
-const DNAType *DNA_sdna_pointer_pointee(SDNA *sdna, const DNATypePointer *type) {
+const DNAType *DNA_sdna_pointer_pointee(const SDNA *sdna, const DNATypePointer *type) {
 	UNUSED_VARS(sdna);
 	return reinterpret_cast<const DNAType *>(reinterpret_cast<const DNATypePointerInterface *>(type)->pointee());
 }
 
-size_t DNA_sdna_pointer_level(SDNA *sdna, const DNAType *type) {
+size_t DNA_sdna_pointer_level(const SDNA *sdna, const DNAType *type) {
 	size_t level = 0;
 
 	const DNATypeInterface *derived = reinterpret_cast<const DNATypeInterface *>(type);
@@ -385,17 +385,17 @@ size_t DNA_sdna_pointer_level(SDNA *sdna, const DNAType *type) {
 /** \name DNATypeArray
  * \{ */
 
-const DNAType *DNA_sdna_array_element(SDNA *sdna, const DNATypeArray *type) {
+const DNAType *DNA_sdna_array_element(const SDNA *sdna, const DNATypeArray *type) {
 	UNUSED_VARS(sdna);
 	return reinterpret_cast<const DNAType *>(reinterpret_cast<const DNATypeArrayInterface *>(type)->element());
 }
 
-eDNAArrayBoundary DNA_sdna_array_boundary(SDNA *sdna, const DNATypeArray *type) {
+eDNAArrayBoundary DNA_sdna_array_boundary(const SDNA *sdna, const DNATypeArray *type) {
 	UNUSED_VARS(sdna);
 	return reinterpret_cast<const DNATypeArrayInterface *>(type)->boundary();
 }
 
-size_t DNA_sdna_array_length(SDNA *sdna, const DNATypeArray *type) {
+size_t DNA_sdna_array_length(const SDNA *sdna, const DNATypeArray *type) {
 	UNUSED_VARS(sdna);
 	return reinterpret_cast<const DNATypeArrayInterface *>(type)->length();
 }
@@ -408,34 +408,34 @@ size_t DNA_sdna_array_length(SDNA *sdna, const DNATypeArray *type) {
 
 // DNATypeStructField
 
-const char *DNA_sdna_struct_field_identifier(SDNA *sdna, const DNATypeStruct *type, const DNATypeStructField *field) {
+const char *DNA_sdna_struct_field_identifier(const SDNA *sdna, const DNATypeStruct *type, const DNATypeStructField *field) {
 	UNUSED_VARS(sdna, type);
 	return reinterpret_cast<const DNATypeStructFieldInterface *>(field)->identifier().c_str();
 }
 
-const DNAType *DNA_sdna_struct_field_type(SDNA *sdna, const DNATypeStruct *type, const DNATypeStructField *field) {
+const DNAType *DNA_sdna_struct_field_type(const SDNA *sdna, const DNATypeStruct *type, const DNATypeStructField *field) {
 	UNUSED_VARS(sdna, type);
 	return reinterpret_cast<const DNAType *>(reinterpret_cast<const DNATypeStructFieldInterface *>(field)->type());
 }
 
-size_t DNA_sdna_struct_field_alignment(SDNA *sdna, const DNATypeStruct *type, const DNATypeStructField *field) {
+size_t DNA_sdna_struct_field_alignment(const SDNA *sdna, const DNATypeStruct *type, const DNATypeStructField *field) {
 	UNUSED_VARS(sdna, type);
 	return reinterpret_cast<const DNATypeStructFieldInterface *>(field)->alignment();
 }
 
 // DNATypeStruct
 
-const char *DNA_sdna_struct_identifier(SDNA *sdna, const DNATypeStruct *type) {
+const char *DNA_sdna_struct_identifier(const SDNA *sdna, const DNATypeStruct *type) {
 	UNUSED_VARS(sdna);
 	return reinterpret_cast<const DNATypeStructInterface *>(type)->identifier().c_str();
 }
 
-const ListBase *DNA_sdna_struct_fields(SDNA *sdna, const DNATypeStruct *type) {
+const ListBase *DNA_sdna_struct_fields(const SDNA *sdna, const DNATypeStruct *type) {
 	UNUSED_VARS(sdna);
 	return reinterpret_cast<const DNATypeStructInterface *>(type)->fields();
 }
 
-const DNATypeStructField *DNA_sdna_struct_field_find(SDNA *sdna, const DNATypeStruct *type, const char *name) {
+const DNATypeStructField *DNA_sdna_struct_field_find(const SDNA *sdna, const DNATypeStruct *type, const char *name) {
 	const ListBase *lb = DNA_sdna_struct_fields(sdna, type);
 	
 	LISTBASE_FOREACH(DNATypeStructField *, field, lb) {
@@ -453,24 +453,24 @@ const DNATypeStructField *DNA_sdna_struct_field_find(SDNA *sdna, const DNATypeSt
 /** \name DNATypeQualInterface
  * \{ */
 
-const DNAType *DNA_sdna_qual_type(SDNA *sdna, const DNATypeQual *type) {
+const DNAType *DNA_sdna_qual_type(const SDNA *sdna, const DNATypeQual *type) {
 	UNUSED_VARS(sdna);
 	return reinterpret_cast<const DNAType *>(reinterpret_cast<const DNATypeQualInterface *>(type)->base());
 }
 
-bool DNA_sdna_qual_is_const(SDNA *sdna, const DNATypeQual *type) {
+bool DNA_sdna_qual_is_const(const SDNA *sdna, const DNATypeQual *type) {
 	UNUSED_VARS(sdna);
 	return reinterpret_cast<const DNATypeQualInterface *>(type)->is_const();
 }
-bool DNA_sdna_qual_is_restrict(SDNA *sdna, const DNATypeQual *type) {
+bool DNA_sdna_qual_is_restrict(const SDNA *sdna, const DNATypeQual *type) {
 	UNUSED_VARS(sdna);
 	return reinterpret_cast<const DNATypeQualInterface *>(type)->is_restrict();
 }
-bool DNA_sdna_qual_is_volatile(SDNA *sdna, const DNATypeQual *type) {
+bool DNA_sdna_qual_is_volatile(const SDNA *sdna, const DNATypeQual *type) {
 	UNUSED_VARS(sdna);
 	return reinterpret_cast<const DNATypeQualInterface *>(type)->is_volatile();
 }
-bool DNA_sdna_qual_is_atomic(SDNA *sdna, const DNATypeQual *type) {
+bool DNA_sdna_qual_is_atomic(const SDNA *sdna, const DNATypeQual *type) {
 	UNUSED_VARS(sdna);
 	return reinterpret_cast<const DNATypeQualInterface *>(type)->is_atomic();
 }
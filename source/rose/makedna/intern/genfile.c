@@ -198,6 +198,8 @@ SDNA *DNA_sdna_new_empty(void) {
 	sdna->parser = RT_parser_new(NULL);
 	sdna->types = LIB_ghash_str_new("SDNA::types");
 	sdna->visit = LIB_ghash_ptr_new("SDNA::visit");
+	sdna->struct_nr_from_type = NULL;
+	sdna->struct_nr_from_name = NULL;
 	sdna->context = RT_parser_context(sdna->parser);
 
 	sdna->data = NULL;
@@ -222,6 +224,8 @@ SDNA *DNA_sdna_new_memory(const void *memory, size_t length) {
 	sdna->parser = RT_parser_new(NULL);
 	sdna->types = LIB_ghash_str_new("SDNA::types");
 	sdna->visit = LIB_ghash_ptr_new("SDNA::visit");
+	sdna->struct_nr_from_type = NULL;
+	sdna->struct_nr_from_name = NULL;
 	sdna->context = RT_parser_context(sdna->parser);
 
 	sdna->data = (void *)memory;
@@ -244,6 +248,12 @@ void DNA_sdna_free(SDNA *sdna) {
 	if (sdna->visit) {
 		LIB_ghash_free(sdna->visit, NULL, NULL);
 	}
+	if (sdna->struct_nr_from_type) {
+		LIB_ghash_free(sdna->struct_nr_from_type, NULL, NULL);
+	}
+	if (sdna->struct_nr_from_name) {
+		LIB_ghash_free(sdna->struct_nr_from_name, NULL, NULL);
+	}
 	if (sdna->parser) {
 		RT_parser_free(sdna->parser);
 	}
@@ -514,6 +524,31 @@ ROSE_STATIC size_t dna_find_type_size(const SDNA *sdna, const RTType *type) {
 	return size;
 }
 
+ROSE_STATIC void dna_build_struct_nr_index(SDNA *sdna) {
+	if (sdna->struct_nr_from_type) {
+		LIB_ghash_free(sdna->struct_nr_from_type, NULL, NULL);
+	}
+	if (sdna->struct_nr_from_name) {
+		LIB_ghash_free(sdna->struct_nr_from_name, NULL, NULL);
+	}
+	sdna->struct_nr_from_type = LIB_ghash_ptr_new("SDNA::struct_nr_from_type");
+	sdna->struct_nr_from_name = LIB_ghash_str_new("SDNA::struct_nr_from_name");
+
+	GHashIterator iter;
+	GHASH_ITER(iter, sdna->visit) {
+		void *type = LIB_ghashIterator_getValue(&iter);
+		if (type) {
+			LIB_ghash_insert(sdna->struct_nr_from_type, type, LIB_ghashIterator_getKey(&iter));
+		}
+	}
+	GHASH_ITER(iter, sdna->types) {
+		void *struct_nr = LIB_ghash_lookup(sdna->struct_nr_from_type, LIB_ghashIterator_getValue(&iter));
+		if (struct_nr) {
+			LIB_ghash_insert(sdna->struct_nr_from_name, LIB_ghashIterator_getKey(&iter), struct_nr);
+		}
+	}
+}
+
 bool DNA_sdna_build_struct_list(SDNA *sdna) {
 	bool status = true;
 
@@ -535,6 +570,10 @@ bool DNA_sdna_build_struct_list(SDNA *sdna) {
 	sdna->parser->configuration.tp_size = LIB_ghash_lookup(sdna->types, "conf::tp_size");
 	sdna->parser->configuration.tp_enum = LIB_ghash_lookup(sdna->types, "conf::tp_enum");
 
+	if (status) {
+		dna_build_struct_nr_index(sdna);
+	}
+
 	return status;
 }
 
@@ -614,6 +653,10 @@ size_t DNA_sdna_struct_size(const SDNA *sdna, uint64_t struct_nr) {
 }
 
 uint64_t DNA_sdna_struct_ex(const SDNA *sdna, const struct RTType *type) {
+	if (sdna->struct_nr_from_type) {
+		return (uint64_t)LIB_ghash_lookup(sdna->struct_nr_from_type, type);
+	}
+
 	GHashIterator iter;
 	GHASH_ITER(iter, sdna->visit) {
 		if (LIB_ghashIterator_getValue(&iter) == type) {
@@ -624,6 +667,10 @@ uint64_t DNA_sdna_struct_ex(const SDNA *sdna, const struct RTType *type) {
 }
 
 uint64_t DNA_sdna_struct_id(const SDNA *sdna, const char *name) {
+	if (sdna->struct_nr_from_name) {
+		return (uint64_t)LIB_ghash_lookup(sdna->struct_nr_from_name, name);
+	}
+
 	const RTType *type = LIB_ghash_lookup(sdna->types, name);
 	if (type) {
 		return DNA_sdna_struct_ex(sdna, type);
@@ -637,16 +684,16 @@ uint64_t DNA_sdna_struct_id(const SDNA *sdna, const char *name) {
 /** \name DNA Util Methods
  * \{ */
 
-const DNAType *DNA_sdna_type(SDNA *sdna, const char *name) {
+const DNAType *DNA_sdna_type(const SDNA *sdna, const char *name) {
 	const RTType *type = LIB_ghash_lookup(sdna->types, name);
 	return (const DNAType *)(type);
 }
 
-const size_t DNA_sdna_sizeof(SDNA *sdna, const DNAType *type) {
+const size_t DNA_sdna_sizeof(const SDNA *sdna, const DNAType *type) {
 	return dna_find_type_size(sdna, (const RTType *)type);
 }
 
-const size_t DNA_sdna_offsetof(SDNA *sdna, const DNATypeStruct *type, const DNATypeStructField *field) {
+const size_t DNA_sdna_offsetof(const SDNA *sdna, const DNATypeStruct *type, const DNATypeStructField *field) {
 	return dna_find_member_offset(sdna, (const RTType *)type, (const RTField *)field);
 }
 
@@ -686,9 +733,19 @@ enum {
 	RECONSTRUCT_STEP_RECONSTRUCT,
 };
 
+/** The steps to convert one struct of the old DNA into the new DNA, see #DNA_ReconstructInfo. */
+typedef struct ReconstructPlan {
+	size_t size_old;
+	size_t size_new;
+	/** The layout is unchanged, the step is a single #RECONSTRUCT_STEP_MEMCPY of the whole struct. */
+	bool is_identical;
+
+	ReconstructStep step;
+} ReconstructPlan;
+
 ROSE_STATIC const RTType *dna_find_struct_with_matching_name(const SDNA *sdna, const char *name) {
 	const RTType *match = LIB_ghash_lookup(sdna->types, (void *)name);
-	if (match->kind == TP_STRUCT) {
+	if (match && match->kind == TP_STRUCT) {
 		return match;
 	}
 	return NULL;
@@ -703,17 +760,14 @@ ROSE_STATIC const RTField *dna_find_member_with_matching_name(const SDNA *sdna,
 	return NULL;
 }
 
-ROSE_STATIC void dna_init_reconstruct_step_for_member(const SDNA *dna_old, const SDNA *dna_new, const RTType *struct_old, const RTField *field_new, ReconstructStep *r_step) {
-	const RTType *struct_new = dna_find_struct_with_matching_name(dna_new, RT_token_as_string(struct_old->tp_struct.identifier));
-	const RTField *field_old = dna_find_member_with_matching_name(dna_old, struct_old, RT_token_as_string(field_new->identifier));
+ROSE_STATIC void dna_init_reconstruct_step_for_struct(const SDNA *dna_old, const SDNA *dna_new, const RTType *struct_old, const RTType *struct_new, ReconstructStep *r_step);
 
-	fprintf(stdout, "reconstruct info | struct: %s(new), %s(old) | ", RT_token_as_string(struct_new->tp_struct.identifier), RT_token_as_string(struct_old->tp_struct.identifier));
-	fprintf(stdout, "field: %s(new), %s(old) | ", RT_token_as_string(field_new->identifier), (field_old) ? RT_token_as_string(field_old->identifier) : "(null)");
+ROSE_STATIC void dna_init_reconstruct_step_for_member(const SDNA *dna_old, const SDNA *dna_new, const RTType *struct_old, const RTType *struct_new, const RTField *field_new, ReconstructStep *r_step) {
+	const RTField *field_old = dna_find_member_with_matching_name(dna_old, struct_old, RT_token_as_string(field_new->identifier));
 
 	if (!field_old) {
 		/** Could not find an old member to copy the data to the new member, init to zero! */
 		r_step->type = RECONSTRUCT_STEP_INIT_ZERO;
-		fprintf(stdout, "zero\n");
 		return;
 	}
 
@@ -743,78 +797,111 @@ ROSE_STATIC void dna_init_reconstruct_step_for_member(const SDNA *dna_old, const
 		type_new = LIB_ghash_lookup(dna_new->types, "conf::tp_size");
 	}
 
+	r_step->offset_old = dna_find_member_offset(dna_old, struct_old, field_old);
+	r_step->offset_new = dna_find_member_offset(dna_new, struct_new, field_new);
+
 	if (RT_type_same(type_new, type_old)) {
 		r_step->type = RECONSTRUCT_STEP_MEMCPY;
-		r_step->offset_old = dna_find_member_offset(dna_old, struct_old, field_old);
-		r_step->offset_new = dna_find_member_offset(dna_old, struct_new, field_new);
 		r_step->memcpy.size = dna_find_type_size(dna_new, type_new) * carr_len;
-		fprintf(stdout, "memcpy [%zd <- %zd x %zu]\n", r_step->offset_new, r_step->offset_old, carr_len);
 		return;
 	}
 
 	if (type_new->is_basic && type_old->is_basic) {
 		r_step->type = RECONSTRUCT_STEP_CAST_PRIMITIVE;
-		r_step->offset_old = dna_find_member_offset(dna_old, struct_old, field_old);
-		r_step->offset_new = dna_find_member_offset(dna_old, struct_new, field_new);
 		r_step->cast.length = carr_len;
 		r_step->cast.type_old = type_old;
 		r_step->cast.type_new = type_new;
-		fprintf(stdout, "cast [%zd <- %zd x %zu]\n", r_step->offset_new, r_step->offset_old, carr_len);
 		return;
 	}
 
 	if (type_new->kind == TP_STRUCT && type_old->kind == TP_STRUCT) {
-		size_t nfields = LIB_listbase_count(&type_new->tp_struct.fields);
-
-		r_step->type = RECONSTRUCT_STEP_RECONSTRUCT;
-		r_step->offset_old = dna_find_member_offset(dna_old, struct_old, field_old);
-		r_step->offset_new = dna_find_member_offset(dna_old, struct_new, field_new);
-		r_step->reconstruct.size_new = dna_find_type_size(dna_old, type_old);
-		r_step->reconstruct.size_old = dna_find_type_size(dna_new, type_new);
-		r_step->reconstruct.length = carr_len;
-		r_step->reconstruct.steps = nfields;
-		r_step->reconstruct.info = MEM_mallocN(sizeof(ReconstructStep) * nfields, "ReconstructStep[]");
-		fprintf(stdout, "reconstruct [%zd <- %zd x %zu]\n", r_step->offset_new, r_step->offset_old, carr_len);
-
-		size_t index;
-		LISTBASE_FOREACH_INDEX(RTField *, field, &type_new->tp_struct.fields, index) {
-			dna_init_reconstruct_step_for_member(dna_old, dna_new, type_old, field, &r_step->reconstruct.info[index]);
+		const ptrdiff_t offset_old = r_step->offset_old;
+		const ptrdiff_t offset_new = r_step->offset_new;
+		dna_init_reconstruct_step_for_struct(dna_old, dna_new, type_old, type_new, r_step);
+		if (r_step->type == RECONSTRUCT_STEP_MEMCPY) {
+			/* Identical nested struct (array), copy all of the elements at once. */
+			r_step->memcpy.size *= carr_len;
 		}
+		else {
+			r_step->reconstruct.length = carr_len;
+		}
+		r_step->offset_old += offset_old;
+		r_step->offset_new += offset_new;
 		return;
 	}
 
-	fprintf(stdout, "zero\n");
 	r_step->type = RECONSTRUCT_STEP_INIT_ZERO;
 }
 
-/** TODO: Add a lookup table that stores all the reconstruction steps for each struct so this doesn't run every time! */
-ROSE_STATIC ReconstructStep *dna_create_reconstruct_step_for_struct(const SDNA *dna_old, const SDNA *dna_new, const RTType *struct_old, const RTType *struct_new) {
-	size_t nfields = LIB_listbase_count(&struct_new->tp_struct.fields);
-	ReconstructStep *r_step = MEM_mallocN(sizeof(ReconstructStep), "ReconstructStep");
+/**
+ * Remove the steps that have nothing to do (the new data is zero initialized) and merge memcpy
+ * steps that are adjacent in both the old and new struct. The gap between them (padding) has to
+ * be the same in both, copying it along is harmless. A zero initialized member in between is not
+ * padding, merging over it would copy the bytes of whatever the old struct had there.
+ */
+ROSE_STATIC void dna_reconstruct_step_merge_children(ReconstructStep *step) {
+	size_t steps = 0;
+	bool barrier = false;
+	for (size_t index = 0; index < step->reconstruct.steps; index++) {
+		ReconstructStep *child = &step->reconstruct.info[index];
+		if (child->type == RECONSTRUCT_STEP_INIT_ZERO) {
+			barrier = true;
+			continue;
+		}
+		if (steps > 0 && !barrier) {
+			ReconstructStep *prev = &step->reconstruct.info[steps - 1];
+			if (prev->type == RECONSTRUCT_STEP_MEMCPY && child->type == RECONSTRUCT_STEP_MEMCPY) {
+				const ptrdiff_t gap_old = child->offset_old - prev->offset_old;
+				const ptrdiff_t gap_new = child->offset_new - prev->offset_new;
+				if (gap_old == gap_new && gap_old >= (ptrdiff_t)prev->memcpy.size) {
+					prev->memcpy.size = (size_t)gap_old + child->memcpy.size;
+					continue;
+				}
+			}
+		}
+		step->reconstruct.info[steps++] = *child;
+		barrier = false;
+	}
+	step->reconstruct.steps = steps;
+}
 
-	if (RT_type_same(struct_new, struct_old)) {
+ROSE_STATIC void dna_init_reconstruct_step_for_struct(const SDNA *dna_old, const SDNA *dna_new, const RTType *struct_old, const RTType *struct_new, ReconstructStep *r_step) {
+	const size_t size_old = dna_find_type_size(dna_old, struct_old);
+	const size_t size_new = dna_find_type_size(dna_new, struct_new);
+
+	r_step->offset_old = 0;
+	r_step->offset_new = 0;
+
+	if (RT_type_same(struct_new, struct_old) && size_old == size_new) {
 		r_step->type = RECONSTRUCT_STEP_MEMCPY;
-		r_step->offset_old = 0;
-		r_step->offset_new = 0;
-		r_step->memcpy.size = dna_find_type_size(dna_old, struct_new);
+		r_step->memcpy.size = size_new;
+		return;
 	}
-	else {
-		r_step->type = RECONSTRUCT_STEP_RECONSTRUCT;
-		r_step->offset_old = 0;
-		r_step->offset_new = 0;
-		r_step->reconstruct.size_old = dna_find_type_size(dna_old, struct_old);
-		r_step->reconstruct.size_new = dna_find_type_size(dna_new, struct_new);
-		r_step->reconstruct.length = 1;
-		r_step->reconstruct.steps = nfields;
-		r_step->reconstruct.info = MEM_mallocN(sizeof(ReconstructStep) * nfields, "ReconstructStep[]");
-
-		size_t index;
-		LISTBASE_FOREACH_INDEX(RTField *, field, &struct_new->tp_struct.fields, index) {
-			dna_init_reconstruct_step_for_member(dna_old, dna_new, struct_old, field, &r_step->reconstruct.info[index]);
-		}
+
+	size_t nfields = LIB_listbase_count(&struct_new->tp_struct.fields);
+
+	r_step->type = RECONSTRUCT_STEP_RECONSTRUCT;
+	r_step->reconstruct.size_old = size_old;
+	r_step->reconstruct.size_new = size_new;
+	r_step->reconstruct.length = 1;
+	r_step->reconstruct.steps = nfields;
+	r_step->reconstruct.info = MEM_mallocN(sizeof(ReconstructStep) * ROSE_MAX(nfields, 1), "ReconstructStep[]");
+
+	size_t index;
+	LISTBASE_FOREACH_INDEX(RTField *, field, &struct_new->tp_struct.fields, index) {
+		dna_init_reconstruct_step_for_member(dna_old, dna_new, struct_old, struct_new, field, &r_step->reconstruct.info[index]);
 	}
 
-	return r_step;
+	dna_reconstruct_step_merge_children(r_step);
+
+	ReconstructStep *first = &r_step->reconstruct.info[0];
+	if (r_step->reconstruct.steps == 1 && first->type == RECONSTRUCT_STEP_MEMCPY && first->offset_old == 0 && first->offset_new == 0 && first->memcpy.size == size_new && size_old == size_new) {
+		/* Only the declarations changed (e.g. a renamed type), the layout did not. The copy has to
+		 * cover the whole struct, a dropped trailing member is zeroed rather than copied. */
+		MEM_freeN(r_step->reconstruct.info);
+		r_step->type = RECONSTRUCT_STEP_MEMCPY;
+		r_step->memcpy.size = size_new;
+	}
 }
 
 ROSE_STATIC void memcast(void *ptr_a, const void *ptr_b, size_t length, const RTType *told, const RTType *tnew) {
@@ -907,7 +994,7 @@ ROSE_STATIC void memcast(void *ptr_a, const void *ptr_b, size_t length, const RT
 #undef CAST_EX
 }
 
-ROSE_STATIC void dna_reconstruct_struct(void *data_new, const void *data_old, ReconstructStep *step) {
+ROSE_STATIC void dna_reconstruct_struct(void *data_new, const void *data_old, const ReconstructStep *step) {
 	switch (step->type) {
 		case RECONSTRUCT_STEP_INIT_ZERO: {
 		} break;
@@ -947,9 +1034,9 @@ ROSE_STATIC void dna_reconstruct_struct(void *data_new, const void *data_old, Re
 		} break;
 		case RECONSTRUCT_STEP_RECONSTRUCT: {
 			for (size_t index = 0; index < step->reconstruct.length; index++) {
+				void *a = POINTER_OFFSET(data_new, step->offset_new + index * step->reconstruct.size_new);
+				const void *b = POINTER_OFFSET(data_old, step->offset_old + index * step->reconstruct.size_old);
 				for (size_t field = 0; field < step->reconstruct.steps; field++) {
-					void *a = POINTER_OFFSET(data_new, step->offset_new + index * step->reconstruct.size_new);
-					void *b = POINTER_OFFSET(data_old, step->offset_old + index * step->reconstruct.size_old);
 					dna_reconstruct_struct(a, b, &step->reconstruct.info[field]);
 				}
 			}
@@ -966,28 +1053,86 @@ ROSE_STATIC void dna_reconstruct_free_children(ReconstructStep *step) {
 	}
 }
 
-ROSE_STATIC void dna_reconstruct_free_step(ReconstructStep *step) {
-	dna_reconstruct_free_children(step);
-	MEM_freeN(step);
+ROSE_STATIC void dna_reconstruct_plan_free(void *plan_v) {
+	ReconstructPlan *plan = plan_v;
+	dna_reconstruct_free_children(&plan->step);
+	MEM_freeN(plan);
+}
+
+typedef struct DNA_ReconstructInfo {
+	const SDNA *dna_old;
+	const SDNA *dna_new;
+
+	/** The #ReconstructPlan of every struct of the old DNA that exists in the new one, keyed by struct_nr. */
+	GHash *plans;
+} DNA_ReconstructInfo;
+
+DNA_ReconstructInfo *DNA_sdna_reconstruct_info_new(const SDNA *dna_old, const SDNA *dna_new) {
+	DNA_ReconstructInfo *info = MEM_mallocN(sizeof(DNA_ReconstructInfo), "DNA_ReconstructInfo");
+	info->dna_old = dna_old;
+	info->dna_new = dna_new;
+	info->plans = LIB_ghash_ptr_new("DNA_ReconstructInfo::plans");
+
+	if (dna_old->struct_nr_from_name == NULL) {
+		/* The struct list was never built, nothing can be reconstructed. */
+		return info;
+	}
+
+	GHashIterator iter;
+	GHASH_ITER(iter, dna_old->struct_nr_from_name) {
+		void *struct_nr = LIB_ghashIterator_getValue(&iter);
+		const RTType *struct_old = LIB_ghash_lookup(dna_old->visit, struct_nr);
+		if (struct_old == NULL || struct_old->kind != TP_STRUCT || LIB_ghash_haskey(info->plans, struct_nr)) {
+			continue;
+		}
+		const RTType *struct_new = dna_find_struct_with_matching_name(dna_new, RT_token_as_string(struct_old->tp_struct.identifier));
+		if (struct_new == NULL) {
+			continue;
+		}
+
+		ReconstructPlan *plan = MEM_mallocN(sizeof(ReconstructPlan), "ReconstructPlan");
+		plan->size_old = dna_find_type_size(dna_old, struct_old);
+		plan->size_new = dna_find_type_size(dna_new, struct_new);
+		dna_init_reconstruct_step_for_struct(dna_old, dna_new, struct_old, struct_new, &plan->step);
+		plan->is_identical = (plan->step.type == RECONSTRUCT_STEP_MEMCPY);
+		LIB_ghash_insert(info->plans, struct_nr, plan);
+	}
+
+	return info;
+}
+
+void DNA_sdna_reconstruct_info_free(DNA_ReconstructInfo *info) {
+	LIB_ghash_free(info->plans, NULL, dna_reconstruct_plan_free);
+	MEM_freeN(info);
 }
 
-void *DNA_sdna_struct_reconstruct(const SDNA *dna_old, const SDNA *dna_new, uint64_t struct_nr, const void *data_old, const char *blockname) {
-	const RTType *struct_old = LIB_ghash_lookup(dna_old->visit, (void *)struct_nr);
-	if (!struct_old) {
-		fprintf(stderr, "Invalid reconstruct for struct %p.\n", (void *)struct_nr);
+void *DNA_sdna_struct_reconstruct(const DNA_ReconstructInfo *info, uint64_t struct_nr, size_t length, const void *data_old, const char *blockname) {
+	const ReconstructPlan *plan = LIB_ghash_lookup(info->plans, (void *)struct_nr);
+	if (plan == NULL) {
+		const RTType *struct_old = LIB_ghash_lookup(info->dna_old->visit, (void *)struct_nr);
+		if (struct_old == NULL) {
+			fprintf(stderr, "Invalid reconstruct for struct %p.\n", (void *)struct_nr);
+		}
+		else {
+			fprintf(stderr, "Invalid reconstruct for struct %s, missing equivalent.\n", RT_token_as_string(struct_old->tp_struct.identifier));
+		}
 		return NULL;
 	}
-	const RTType *struct_new = dna_find_struct_with_matching_name(dna_new, RT_token_as_string(struct_old->tp_struct.identifier));
-	if (!struct_old) {
-		fprintf(stderr, "Invalid reconstruct for struct %s, missing equivalent.\n", RT_token_as_string(struct_old->tp_struct.identifier));
+	if (length == 0) {
 		return NULL;
 	}
 
-	void *data_new = MEM_callocN(dna_find_type_size(dna_new, struct_new), blockname);
+	void *data_new = MEM_callocN(plan->size_new * length, blockname);
 
-	ReconstructStep *step = dna_create_reconstruct_step_for_struct(dna_old, dna_new, struct_old, struct_new);
-	dna_reconstruct_struct(data_new, data_old, step);
-	dna_reconstruct_free_step(step);
+	if (plan->is_identical) {
+		/* One bulk copy for the whole block. */
+		memcpy(data_new, data_old, plan->size_new * length);
+		return data_new;
+	}
+
+	for (size_t index = 0; index < length; index++) {
+		dna_reconstruct_struct(POINTER_OFFSET(data_new, plan->size_new * index), POINTER_OFFSET(data_old, plan->size_old * index), &plan->step);
+	}
 
 	return data_new;
 }
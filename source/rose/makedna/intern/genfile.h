@@ -21,6 +21,13 @@ typedef struct SDNA {
 	struct GHash *types;
 	struct GHash *visit;
 
+	/**
+	 * Reverse lookup of #visit, built by #DNA_sdna_build_struct_list, maps each struct type and
+	 * struct name to its struct_nr.
+	 */
+	struct GHash *struct_nr_from_type;
+	struct GHash *struct_nr_from_name;
+
 	void *data;
 	size_t length;
 	size_t allocated;
@@ -37,6 +44,13 @@ struct SDNA *DNA_sdna_new_empty(void);
 struct SDNA *DNA_sdna_new_memory(const void *memory, size_t length);
 struct SDNA *DNA_sdna_new_current(void);
 
+/**
+ * The DNA of the running executable, built the first time it is requested and shared by all
+ * callers (thread-safe). The returned SDNA must not be modified or freed, see
+ * #DNA_sdna_current_free.
+ */
+const struct SDNA *DNA_sdna_current_get(void);
+
 /** \} */
 
 /* -------------------------------------------------------------------- */
@@ -44,6 +58,8 @@ struct SDNA *DNA_sdna_new_current(void);
  * \{ */
 
 void DNA_sdna_free(struct SDNA *sdna);
+/** Free the shared DNA created by #DNA_sdna_current_get, called once on exit. */
+void DNA_sdna_current_free(void);
 
 /** \} */
 
@@ -106,6 +122,8 @@ void DNA_struct_switch_endian(const struct SDNA *sdna, uint64_t struct_nr, void
 
 size_t DNA_sdna_struct_size(const struct SDNA *sdna, uint64_t struct_nr);
 
+/** Returns the struct_nr of the specified struct type or name, zero if there is no such struct. */
+uint64_t DNA_sdna_struct_ex(const struct SDNA *sdna, const struct RTType *type);
 uint64_t DNA_sdna_struct_id(const struct SDNA *sdna, const char *name);
 
 /** \} */
@@ -138,10 +156,10 @@ typedef enum eDNAType {
 typedef struct DNAType DNAType;
 
 /** Returns the kind of type this type resolves to, for casting! */
-enum eDNAType DNA_sdna_type_kind(struct SDNA *sdna, const struct DNAType *type);
+enum eDNAType DNA_sdna_type_kind(const struct SDNA *sdna, const struct DNAType *type);
 
 /** Returns true if the type is a basic kind of type and therefore can be casted to #DNATypeBasic */
-bool DNA_sdna_type_basic(struct SDNA *sdna, const struct DNAType *type);
+bool DNA_sdna_type_basic(const struct SDNA *sdna, const struct DNAType *type);
 
 /** \} */
 
@@ -152,10 +170,10 @@ bool DNA_sdna_type_basic(struct SDNA *sdna, const struct DNAType *type);
 typedef struct DNATypeBasic DNATypeBasic;
 
 /** Returns true if the specified basic type is unsigned. */
-bool DNA_sdna_basic_is_unsigned(struct SDNA *sdna, const struct DNATypeBasic *type);
+bool DNA_sdna_basic_is_unsigned(const struct SDNA *sdna, const struct DNATypeBasic *type);
 
 /** Returns the size in bytes of the specfied basic type. */
-size_t DNA_sdna_basic_rank(struct SDNA *sdna, const struct DNATypeBasic *type);
+size_t DNA_sdna_basic_rank(const struct SDNA *sdna, const struct DNATypeBasic *type);
 
 /** \} */
 
@@ -169,18 +187,18 @@ typedef struct DNATypeEnumItem DNATypeEnumItem;
 // DNATypeEnumItem
 
 /** Returns the name/identifier of the enum item. */
-const char *DNA_sdna_enum_item_identifier(struct SDNA *sdna, const struct DNATypeEnum *type, const struct DNATypeEnumItem *item);
+const char *DNA_sdna_enum_item_identifier(const struct SDNA *sdna, const struct DNATypeEnum *type, const struct DNATypeEnumItem *item);
 
 // DNATypeEnum
 
 /** Returns the name/identifier of the enum tag. */
-const char *DNA_sdna_enum_identifier(struct SDNA *sdna, const struct DNATypeEnum *type);
+const char *DNA_sdna_enum_identifier(const struct SDNA *sdna, const struct DNATypeEnum *type);
 
 /** Returns the underlying type of the enum. */
-const struct DNAType *DNA_sdna_enum_underlying_type(struct SDNA *sdna, const struct DNATypeEnum *type);
+const struct DNAType *DNA_sdna_enum_underlying_type(const struct SDNA *sdna, const struct DNATypeEnum *type);
 
 /** Returns a pointer to the listbase that stores the enum items. */
-const ListBase *DNA_sdna_enum_items(struct SDNA *sdna, const struct DNATypeEnum *type);
+const ListBase *DNA_sdna_enum_items(const struct SDNA *sdna, const struct DNATypeEnum *type);
 
 /** \} */
 
@@ -190,9 +208,9 @@ const ListBase *DNA_sdna_enum_items(struct SDNA *sdna, const struct DNATypeEnum
 
 typedef struct DNATypePointer DNATypePointer;
 
-const struct DNAType *DNA_sdna_pointer_pointee(struct SDNA *sdna, const struct DNATypePointer *type);
+const struct DNAType *DNA_sdna_pointer_pointee(const struct SDNA *sdna, const struct DNATypePointer *type);
 
-size_t DNA_sdna_pointer_level(struct SDNA *sdna, const struct DNAType *type);
+size_t DNA_sdna_pointer_level(const struct SDNA *sdna, const struct DNAType *type);
 
 /** \} */
 
@@ -211,13 +229,13 @@ typedef enum eDNAArrayBoundary {
 } eDNAArrayBoundary;
 
 /** Returns the base type of the array (the type of each element within the array). */
-const struct DNAType *DNA_sdna_array_element(struct SDNA *sdna, const struct DNATypeArray *type);
+const struct DNAType *DNA_sdna_array_element(const struct SDNA *sdna, const struct DNATypeArray *type);
 
 /** Returns the boundary type of the specified array. */
-enum eDNAArrayBoundary DNA_sdna_array_boundary(struct SDNA *sdna, const struct DNATypeArray *type);
+enum eDNAArrayBoundary DNA_sdna_array_boundary(const struct SDNA *sdna, const struct DNATypeArray *type);
 
 /** Returns the constant evaluated length of the array if applicable. */
-size_t DNA_sdna_array_length(struct SDNA *sdna, const struct DNATypeArray *type);
+size_t DNA_sdna_array_length(const struct SDNA *sdna, const struct DNATypeArray *type);
 
 /** \} */
 
@@ -231,22 +249,22 @@ typedef struct DNATypeStructField DNATypeStructField;
 // DNATypeStructField
 
 /** Returns the identifier of the specified struct field. */
-const char *DNA_sdna_struct_field_identifier(struct SDNA *sdna, const struct DNATypeStruct *type, const struct DNATypeStructField *field);
+const char *DNA_sdna_struct_field_identifier(const struct SDNA *sdna, const struct DNATypeStruct *type, const struct DNATypeStructField *field);
 
 /** Returns the type of the specified struct field. */
-const struct DNAType *DNA_sdna_struct_field_type(struct SDNA *sdna, const struct DNATypeStruct *type, const struct DNATypeStructField *field);
+const struct DNAType *DNA_sdna_struct_field_type(const struct SDNA *sdna, const struct DNATypeStruct *type, const struct DNATypeStructField *field);
 
 /** Returns the alignment of the specified struct field. */
-size_t DNA_sdna_struct_field_alignment(struct SDNA *sdna, const struct DNATypeStruct *type, const struct DNATypeStructField *field);
+size_t DNA_sdna_struct_field_alignment(const struct SDNA *sdna, const struct DNATypeStruct *type, const struct DNATypeStructField *field);
 
 // DNATypeStruct
 
 /** Returns the tag of the specified struct. */
-const char *DNA_sdna_struct_identifier(struct SDNA *sdna, const struct DNATypeStruct *type);
+const char *DNA_sdna_struct_identifier(const struct SDNA *sdna, const struct DNATypeStruct *type);
 
 /** Returns the listbase containing the fields of the specified struct. */
-const struct ListBase *DNA_sdna_struct_fields(struct SDNA *sdna, const struct DNATypeStruct *type);
-const struct DNATypeStructField *DNA_sdna_struct_field_find(struct SDNA *sdna, const struct DNATypeStruct *type, const char *name);
+const struct ListBase *DNA_sdna_struct_fields(const struct SDNA *sdna, const struct DNATypeStruct *type);
+const struct DNATypeStructField *DNA_sdna_struct_field_find(const struct SDNA *sdna, const struct DNATypeStruct *type, const char *name);
 
 /** \} */
 
@@ -257,12 +275,12 @@ const struct DNATypeStructField *DNA_sdna_struct_field_find(struct SDNA *sdna, c
 typedef struct DNATypeQual DNATypeQual;
 
 /** Returns the base type of the qualified type. */
-const struct DNAType *DNA_sdna_qual_type(struct SDNA *sdna, const struct DNATypeQual *type);
+const struct DNAType *DNA_sdna_qual_type(const struct SDNA *sdna, const struct DNATypeQual *type);
 
-bool DNA_sdna_qual_is_const(struct SDNA *sdna, const struct DNATypeQual *type);
-bool DNA_sdna_qual_is_restrict(struct SDNA *sdna, const struct DNATypeQual *type);
-bool DNA_sdna_qual_is_volatile(struct SDNA *sdna, const struct DNATypeQual *type);
-bool DNA_sdna_qual_is_atomic(struct SDNA *sdna, const struct DNATypeQual *type);
+bool DNA_sdna_qual_is_const(const struct SDNA *sdna, const struct DNATypeQual *type);
+bool DNA_sdna_qual_is_restrict(const struct SDNA *sdna, const struct DNATypeQual *type);
+bool DNA_sdna_qual_is_volatile(const struct SDNA *sdna, const struct DNATypeQual *type);
+bool DNA_sdna_qual_is_atomic(const struct SDNA *sdna, const struct DNATypeQual *type);
 
 /** \} */
 
@@ -270,9 +288,9 @@ bool DNA_sdna_qual_is_atomic(struct SDNA *sdna, const struct DNATypeQual *type);
 /** \name DNA Util Methods
  * \{ */
 
-const struct DNAType *DNA_sdna_type(struct SDNA *sdna, const char *name);
-const size_t DNA_sdna_sizeof(struct SDNA *sdna, const struct DNAType *type);
-const size_t DNA_sdna_offsetof(struct SDNA *sdna, const struct DNATypeStruct *type, const struct DNATypeStructField *field);
+const struct DNAType *DNA_sdna_type(const struct SDNA *sdna, const char *name);
+const size_t DNA_sdna_sizeof(const struct SDNA *sdna, const struct DNAType *type);
+const size_t DNA_sdna_offsetof(const struct SDNA *sdna, const struct DNATypeStruct *type, const struct DNATypeStructField *field);
 
 /** \} */
 
@@ -280,6 +298,17 @@ const size_t DNA_sdna_offsetof(struct SDNA *sdna, const struct DNATypeStruct *ty
 /** \name Reconstruction Methods
  * \{ */
 
+typedef struct DNA_ReconstructInfo DNA_ReconstructInfo;
+
+/**
+ * Compute the steps to convert every struct of \a dna_old into the matching struct of \a dna_new,
+ * adjacent members are copied together and a struct with an identical layout is copied with a
+ * single memcpy. The result is never modified afterwards, so it can be used by many threads at
+ * once without any locking.
+ */
+struct DNA_ReconstructInfo *DNA_sdna_reconstruct_info_new(const struct SDNA *dna_old, const struct SDNA *dna_new);
+void DNA_sdna_reconstruct_info_free(struct DNA_ReconstructInfo *info);
+
 /**
  * This function, `DNA_sdna_struct_reconstruct`, serves as the high-level entry point for reconstructing a data structure
  * based on version-specific metadata provided by `SDNA`. It leverages information about the source (`dna_old`) and target
@@ -297,8 +326,12 @@ const size_t DNA_sdna_offsetof(struct SDNA *sdna, const struct DNATypeStruct *ty
  * NOTE: This function will NOT cast float to integer type or the opposite since this could lead to unintentional behaviour,
  * when for example we are casting `unsigned char [3]` to `float [3]` for a color, then we would end up with unormalized
  * float values, instead a warning is thrown!
+ *
+ * The steps of each struct are looked up in \a info, see #DNA_sdna_reconstruct_info_new.
+ *
+ * \param length: The number of consecutive structs stored in `data_old`.
  */
-void *DNA_sdna_struct_reconstruct(const struct SDNA *dna_old, const struct SDNA *dna_new, uint64_t struct_nr, const void *data_old, const char *blockname);
+void *DNA_sdna_struct_reconstruct(const struct DNA_ReconstructInfo *info, uint64_t struct_nr, size_t length, const void *data_old, const char *blockname);
 
 /** \} */
 
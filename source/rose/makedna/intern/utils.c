@@ -3,12 +3,15 @@
 #include "LIB_endian_switch.h"
 #include "LIB_ghash.h"
 #include "LIB_string.h"
+#include "LIB_thread.h"
 #include "LIB_utildefines.h"
 
 #include "RT_context.h"
 #include "RT_parser.h"
 #include "RT_token.h"
 
+#include "atomic_ops.h"
+
 #include "genfile.h"
 
 extern const unsigned char DNAstr[];
@@ -22,3 +25,34 @@ SDNA *DNA_sdna_new_current(void) {
 	}
 	return sdna;
 }
+
+/**
+ * Built on first use, afterwards it is only ever read so it can be shared between threads.
+ * Always accessed atomically, the store publishes the fully built #SDNA to the unlocked loads.
+ */
+static SDNA *g_sdna_current = NULL;
+
+const SDNA *DNA_sdna_current_get(void) {
+	SDNA *sdna = atomic_load_ptr((void *const *)&g_sdna_current);
+	if (!sdna) {
+		static ThreadMutex current_lock = ROSE_MUTEX_INITIALIZER;
+
+		LIB_mutex_lock(&current_lock);
+		sdna = atomic_load_ptr((void *const *)&g_sdna_current);
+		if (!sdna) {
+			sdna = DNA_sdna_new_current();
+			atomic_store_ptr((void **)&g_sdna_current, sdna);
+		}
+		LIB_mutex_unlock(&current_lock);
+	}
+
+	return sdna;
+}
+
+void DNA_sdna_current_free(void) {
+	SDNA *sdna = atomic_load_ptr((void *const *)&g_sdna_current);
+	if (sdna) {
+		atomic_store_ptr((void **)&g_sdna_current, NULL);
+		DNA_sdna_free(sdna);
+	}
+}
@@ -0,0 +1,268 @@
+#include "MEM_guardedalloc.h"
+
+#include "LIB_listbase.h"
+#include "LIB_string.h"
+#include "LIB_utildefines.h"
+
+#include "RT_context.h"
+#include "RT_object.h"
+#include "RT_parser.h"
+#include "RT_source.h"
+#include "RT_token.h"
+
+#include "intern/genfile.h"
+
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace {
+
+/**
+ * Build an #SDNA the way makedna does, from the typedef structs declared in the source text, the
+ * written data is then loaded into a second #SDNA the same way the generated DNA is.
+ */
+class SDNAFromSource {
+	SDNA *writer_;
+	SDNA *reader_;
+
+public:
+	SDNAFromSource(const char *text) {
+		writer_ = DNA_sdna_new_empty();
+
+		void *ptr = POINTER_OFFSET(writer_->data, writer_->length);
+
+		RTFileCache *cache = RT_fcache_new("test.c", text, LIB_strlen(text));
+		RTFile *file = RT_file_new("test.c", cache);
+		RTCParser *parser = RT_parser_new(file);
+
+		RTToken *conf_tp_size = RT_token_new_virtual_identifier(parser->context, "conf::tp_size");
+		EXPECT_TRUE(DNA_sdna_write_token(writer_, &ptr, ptr, conf_tp_size));
+		EXPECT_TRUE(DNA_sdna_write_type(writer_, &ptr, ptr, parser->configuration.tp_size));
+		RTToken *conf_tp_enum = RT_token_new_virtual_identifier(parser->context, "conf::tp_enum");
+		EXPECT_TRUE(DNA_sdna_write_token(writer_, &ptr, ptr, conf_tp_enum));
+		EXPECT_TRUE(DNA_sdna_write_type(writer_, &ptr, ptr, parser->configuration.tp_enum));
+
+		EXPECT_TRUE(RT_parser_do(parser));
+		LISTBASE_FOREACH(const RTNode *, node, &parser->nodes) {
+			if (ELEM(node->kind, NODE_OBJECT) && ELEM(node->type, OBJ_TYPEDEF)) {
+				const RTObject *object = RT_node_object(node);
+				if (object->type->kind != TP_STRUCT) {
+					continue;
+				}
+				EXPECT_TRUE(DNA_sdna_write_token(writer_, &ptr, ptr, object->identifier));
+				EXPECT_TRUE(DNA_sdna_write_type(writer_, &ptr, ptr, object->type));
+			}
+		}
+
+		RT_parser_free(parser);
+		RT_file_free(file);
+		RT_fcache_free(cache);
+
+		reader_ = DNA_sdna_new_memory(writer_->data, writer_->length);
+		EXPECT_TRUE(DNA_sdna_build_struct_list(reader_));
+	}
+	~SDNAFromSource() {
+		DNA_sdna_free(reader_);
+		DNA_sdna_free(writer_);
+	}
+
+	const SDNA *sdna() const {
+		return reader_;
+	}
+};
+
+TEST(Genfile, ReconstructIdentical) {
+	SDNAFromSource dna_old("typedef struct T { int a; float b; char c[4]; } T;");
+	SDNAFromSource dna_new("typedef struct T { int a; float b; char c[4]; } T;");
+
+	struct T {
+		int a;
+		float b;
+		char c[4];
+	} old[2] = {{1, 2.0f, "abc"}, {4, 5.0f, "def"}};
+
+	const uint64_t struct_nr = DNA_sdna_struct_id(dna_old.sdna(), "T");
+	ASSERT_NE(struct_nr, 0);
+
+	DNA_ReconstructInfo *info = DNA_sdna_reconstruct_info_new(dna_old.sdna(), dna_new.sdna());
+	EXPECT_EQ(DNA_sdna_struct_size(dna_old.sdna(), struct_nr), sizeof(T));
+
+	T *data = static_cast<T *>(DNA_sdna_struct_reconstruct(info, struct_nr, ARRAY_SIZE(old), old, "T"));
+	ASSERT_NE(data, nullptr);
+	for (size_t index = 0; index < ARRAY_SIZE(old); index++) {
+		EXPECT_EQ(data[index].a, old[index].a);
+		EXPECT_EQ(data[index].b, old[index].b);
+		EXPECT_STREQ(data[index].c, old[index].c);
+	}
+	MEM_freeN(data);
+
+	DNA_sdna_reconstruct_info_free(info);
+}
+
+TEST(Genfile, ReconstructRenamedMember) {
+	/** The middle member was renamed, the new one has to be zero and the others copied. */
+	SDNAFromSource dna_old("typedef struct T { int a; int x; int b; } T;");
+	SDNAFromSource dna_new("typedef struct T { int a; int y; int b; } T;");
+
+	const int old[2][3] = {{1, 2, 3}, {4, 5, 6}};
+
+	const uint64_t struct_nr = DNA_sdna_struct_id(dna_old.sdna(), "T");
+	ASSERT_NE(struct_nr, 0);
+
+	DNA_ReconstructInfo *info = DNA_sdna_reconstruct_info_new(dna_old.sdna(), dna_new.sdna());
+
+	int(*data)[3] = static_cast<int(*)[3]>(DNA_sdna_struct_reconstruct(info, struct_nr, ARRAY_SIZE(old), old, "T"));
+	ASSERT_NE(data, nullptr);
+	for (size_t index = 0; index < ARRAY_SIZE(old); index++) {
+		EXPECT_EQ(data[index][0], old[index][0]);
+		EXPECT_EQ(data[index][1], 0);
+		EXPECT_EQ(data[index][2], old[index][2]);
+	}
+	MEM_freeN(data);
+
+	DNA_sdna_reconstruct_info_free(info);
+}
+
+TEST(Genfile, ReconstructRenamedTrailingMember) {
+	/** The last member was renamed, the copy of the first one must not spill over the new one. */
+	SDNAFromSource dna_old("typedef struct T { int a; int x; } T;");
+	SDNAFromSource dna_new("typedef struct T { int a; int y; } T;");
+
+	const int old[2][2] = {{1, 2}, {4, 5}};
+
+	const uint64_t struct_nr = DNA_sdna_struct_id(dna_old.sdna(), "T");
+	ASSERT_NE(struct_nr, 0);
+
+	DNA_ReconstructInfo *info = DNA_sdna_reconstruct_info_new(dna_old.sdna(), dna_new.sdna());
+
+	int(*data)[2] = static_cast<int(*)[2]>(DNA_sdna_struct_reconstruct(info, struct_nr, ARRAY_SIZE(old), old, "T"));
+	ASSERT_NE(data, nullptr);
+	for (size_t index = 0; index < ARRAY_SIZE(old); index++) {
+		EXPECT_EQ(data[index][0], old[index][0]);
+		EXPECT_EQ(data[index][1], 0);
+	}
+	MEM_freeN(data);
+
+	DNA_sdna_reconstruct_info_free(info);
+}
+
+TEST(Genfile, ReconstructCastMember) {
+	/** The members around the widened one must not be merged into a single copy over it. */
+	SDNAFromSource dna_old("typedef struct T { int a; short b; short pad; int c; } T;");
+	SDNAFromSource dna_new("typedef struct T { int a; long long b; int c; } T;");
+
+	struct T_old {
+		int a;
+		short b;
+		short pad;
+		int c;
+	} old = {7, -8, 1, 9};
+	struct T_new {
+		int a;
+		long long b;
+		int c;
+	};
+
+	const uint64_t struct_nr = DNA_sdna_struct_id(dna_old.sdna(), "T");
+	ASSERT_NE(struct_nr, 0);
+
+	DNA_ReconstructInfo *info = DNA_sdna_reconstruct_info_new(dna_old.sdna(), dna_new.sdna());
+	EXPECT_EQ(DNA_sdna_struct_size(dna_new.sdna(), DNA_sdna_struct_id(dna_new.sdna(), "T")), sizeof(T_new));
+
+	T_new *data = static_cast<T_new *>(DNA_sdna_struct_reconstruct(info, struct_nr, 1, &old, "T"));
+	ASSERT_NE(data, nullptr);
+	EXPECT_EQ(data->a, 7);
+	EXPECT_EQ(data->b, -8);
+	EXPECT_EQ(data->c, 9);
+	MEM_freeN(data);
+
+	DNA_sdna_reconstruct_info_free(info);
+}
+
+TEST(Genfile, ReconstructThreaded) {
+	/** Blocks of two different structs, one of them nested in the other, reconstructed from many threads at once. */
+	SDNAFromSource dna_old("typedef struct A { int a; short b; short pad; int c; } A; typedef struct B { float x; A inner; int y; } B;");
+	SDNAFromSource dna_new("typedef struct A { int a; long long b; int c; } A; typedef struct B { float x; int z; A inner; int y; } B;");
+
+	struct A_old {
+		int a;
+		short b;
+		short pad;
+		int c;
+	};
+	struct B_old {
+		float x;
+		A_old inner;
+		int y;
+	};
+	struct A_new {
+		int a;
+		long long b;
+		int c;
+	};
+	struct B_new {
+		float x;
+		int z;
+		A_new inner;
+		int y;
+	};
+
+	const uint64_t struct_a = DNA_sdna_struct_id(dna_old.sdna(), "A");
+	const uint64_t struct_b = DNA_sdna_struct_id(dna_old.sdna(), "B");
+	ASSERT_NE(struct_a, 0);
+	ASSERT_NE(struct_b, 0);
+	const size_t size_a = DNA_sdna_struct_size(dna_new.sdna(), DNA_sdna_struct_id(dna_new.sdna(), "A"));
+	const size_t size_b = DNA_sdna_struct_size(dna_new.sdna(), DNA_sdna_struct_id(dna_new.sdna(), "B"));
+
+	const size_t length = 64;
+	std::vector<A_old> blocks_a(length);
+	std::vector<B_old> blocks_b(length);
+	for (size_t index = 0; index < length; index++) {
+		blocks_a[index] = {int(index), short(-int(index)), 0, int(index * 3)};
+		blocks_b[index] = {float(index) * 0.5f, {int(index) + 1, short(index), 0, -int(index)}, int(index * 7)};
+	}
+
+	DNA_ReconstructInfo *info = DNA_sdna_reconstruct_info_new(dna_old.sdna(), dna_new.sdna());
+
+	void *expected_a = DNA_sdna_struct_reconstruct(info, struct_a, length, blocks_a.data(), "A");
+	void *expected_b = DNA_sdna_struct_reconstruct(info, struct_b, length, blocks_b.data(), "B");
+	ASSERT_NE(expected_a, nullptr);
+	ASSERT_NE(expected_b, nullptr);
+	EXPECT_EQ(size_b, sizeof(B_new));
+	const B_new &b = static_cast<const B_new *>(expected_b)[5];
+	EXPECT_EQ(b.x, 2.5f);
+	EXPECT_EQ(b.z, 0);
+	EXPECT_EQ(b.inner.a, 6);
+	EXPECT_EQ(b.inner.b, 5);
+	EXPECT_EQ(b.inner.c, -5);
+	EXPECT_EQ(b.y, 35);
+
+	std::vector<std::thread> threads;
+	std::vector<int> mismatches(8, 0);
+	for (size_t thread = 0; thread < mismatches.size(); thread++) {
+		threads.emplace_back([&, thread]() {
+			for (int iteration = 0; iteration < 32; iteration++) {
+				const bool is_a = (iteration + thread) % 2 == 0;
+				void *data = (is_a) ? DNA_sdna_struct_reconstruct(info, struct_a, length, blocks_a.data(), "A") : DNA_sdna_struct_reconstruct(info, struct_b, length, blocks_b.data(), "B");
+				if (memcmp(data, (is_a) ? expected_a : expected_b, length * ((is_a) ? size_a : size_b)) != 0) {
+					mismatches[thread]++;
+				}
+				MEM_freeN(data);
+			}
+		});
+	}
+	for (std::thread &thread : threads) {
+		thread.join();
+	}
+	for (const int count : mismatches) {
+		EXPECT_EQ(count, 0);
+	}
+
+	MEM_freeN(expected_a);
+	MEM_freeN(expected_b);
+	DNA_sdna_reconstruct_info_free(info);
+}
+
+}  // namespace
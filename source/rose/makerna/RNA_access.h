@@ -162,6 +162,13 @@ void RNA_property_float_ui_range(struct PointerRNA *ptr, struct PropertyRNA *pro
 
 int RNA_property_float_clamp(struct PointerRNA *ptr, struct PropertyRNA *property, float *value);
 
+/**
+ * The address of the float values of the property in the DNA of \a ptr, NULL when the property
+ * is not stored as plain floats or has custom accessors, then the get and set functions must be used.
+ * Writing to the returned values skips the clamping of the setters.
+ */
+float *RNA_property_float_raw_data(struct PointerRNA *ptr, struct PropertyRNA *property);
+
 /* string */
 
 void RNA_property_string_get(struct PointerRNA *ptr, struct PropertyRNA *property, char *value);
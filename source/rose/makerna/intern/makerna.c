@@ -5,6 +5,8 @@
 
 #include "DNA_space_types.h"
 
+#include "intern/genfile.h"
+
 #include "RNA_define.h"
 #include "RNA_types.h"
 
@@ -909,6 +911,45 @@ ROSE_INLINE char *rna_def_property_end_func(FILE *fpout, StructRNA *srna, Proper
 	return func;
 }
 
+/**
+ * Properties that are stored as plain floats in DNA, without any custom accessor or range callback,
+ * can be read and written directly from the offset of their field, see #RNA_property_float_raw_data.
+ */
+ROSE_INLINE void rna_set_raw_property(PropertyDefRNA *defproperty, PropertyRNA *property) {
+	if (property->flag & PROP_IDPROPERTY) {
+		return;
+	}
+	if (!defproperty->dnastructname || !defproperty->dnaname || !defproperty->dnatype) {
+		return;
+	}
+	if ((defproperty->dnastructfromname && defproperty->dnastructfromprop) || defproperty->dnapointerlevel != 0 || defproperty->dnaoffset == -1) {
+		return;
+	}
+
+	const DNAType *type = (const DNAType *)defproperty->dnatype;
+	if (DNA_sdna_type_kind(DefRNA.sdna, type) == DNA_ARRAY) {
+		type = DNA_sdna_array_element(DefRNA.sdna, (const DNATypeArray *)type);
+	}
+
+	switch (property->type) {
+		case PROP_FLOAT: {
+			FloatPropertyRNA *fproperty = (FloatPropertyRNA *)property;
+			if (fproperty->range || fproperty->range_ex || fproperty->get_ex || fproperty->set_ex || fproperty->getarray_ex || fproperty->setarray_ex) {
+				return;
+			}
+			if (DNA_sdna_type_kind(DefRNA.sdna, type) != DNA_FLOAT) {
+				return;
+			}
+			property->rawtype = PROP_RAW_FLOAT;
+		} break;
+		default: {
+			return;
+		}
+	}
+
+	property->flagex |= PROP_INTERN_RAW_ACCESS;
+}
+
 ROSE_INLINE void rna_def_property_funcs(FILE *fpout, StructRNA *srna, PropertyDefRNA *defproperty) {
 	PropertyRNA *property = defproperty->ptr;
 
@@ -927,7 +968,7 @@ ROSE_INLINE void rna_def_property_funcs(FILE *fpout, StructRNA *srna, PropertyDe
 
 			if (!property->arraydimension) {
 				if (!fproperty->get && !fproperty->set) {
-					// rna_set_raw_property(defproperty, property);
+					rna_set_raw_property(defproperty, property);
 				}
 
 				fproperty->get = (PropFloatGetFunc)(rna_def_property_get_func(fpout, srna, property, defproperty, (const char *)fproperty->get));
@@ -935,7 +976,7 @@ ROSE_INLINE void rna_def_property_funcs(FILE *fpout, StructRNA *srna, PropertyDe
 			}
 			else {
 				if (!fproperty->getarray && !fproperty->setarray) {
-					// rna_set_raw_property(defproperty, property);
+					rna_set_raw_property(defproperty, property);
 				}
 
 				fproperty->getarray = (PropFloatArrayGetFunc)(rna_def_property_get_func(fpout, srna, property, defproperty, (const char *)fproperty->getarray));
@@ -1677,6 +1718,7 @@ ROSE_INLINE int rna_preprocess(const char *source, const char *binary) {
 	}
 
 	RNA_free(rna);
+	DNA_sdna_current_free();
 
 	return DefRNA.error;
 }
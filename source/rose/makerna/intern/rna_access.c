@@ -1664,6 +1664,16 @@ int RNA_property_float_clamp(PointerRNA *ptr, PropertyRNA *property, float *valu
 	return 0;
 }
 
+float *RNA_property_float_raw_data(PointerRNA *ptr, PropertyRNA *property) {
+	if (property->magic != RNA_MAGIC || ptr->data == NULL) {
+		return NULL;
+	}
+	if ((property->flag & PROP_IDPROPERTY) != 0 || property->rawtype != PROP_RAW_FLOAT) {
+		return NULL;
+	}
+	return (float *)POINTER_OFFSET(ptr->data, property->rawoffset);
+}
+
 /* string */
 
 void RNA_property_string_get(PointerRNA *ptr, PropertyRNA *property, char *value) {
@@ -47,7 +47,7 @@ RoseRNA *RNA_create(void) {
 	DefRNA.error = false;
 	DefRNA.preprocess = true;
 
-	DefRNA.sdna = DNA_sdna_new_current();
+	DefRNA.sdna = DNA_sdna_current_get();
 	if (DefRNA.sdna == NULL) {
 		DefRNA.error = true;
 	}
@@ -65,10 +65,6 @@ void RNA_define_free(RoseRNA *rna) {
 	}
 	LIB_freelistN(&DefRNA.allocs);
 
-	if (DefRNA.sdna) {
-		DNA_sdna_free(DefRNA.sdna);
-	}
-
 	memset(&DefRNA.sdna, 0, sizeof(RoseDefRNA));
 }
 
@@ -88,7 +88,7 @@ typedef struct AllocDefRNA {
  * \{ */
 
 typedef struct RoseDefRNA {
-	struct SDNA *sdna;
+	const struct SDNA *sdna;
 
 	struct ListBase structs;
 	struct ListBase allocs;
@@ -3,6 +3,7 @@
 ModifierTypeInfo MODType_NONE = {
 	.idname = "None",
 	.name = "None",
+	.dnastruct = "ModifierData",
 	.size = sizeof(ModifierData),
 	.type = MODIFIER_TYPE_NONE,
 
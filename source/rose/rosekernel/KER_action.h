@@ -176,6 +176,19 @@ struct ActionChannelBag *KER_action_channelbag_for_action_slot_ex(struct Action
 
 void KER_action_channelbag_fcurve_create_many(struct Main *main, struct ActionChannelBag *channelbag, const struct FCurveDescriptor *descriptors, int length, struct FCurve **newcurves);
 
+/**
+ * Bake the samples of the curves that have none (never baked or edited since), when the action
+ * has #ACT_BAKE_SAMPLES set. Called by the dependency graph before the users of the action are
+ * evaluated, so that editing keyframes with #KER_fcurve_handles_recalc bakes the curve again.
+ */
+void KER_action_bake_samples_ensure(struct Action *action);
+
+/**
+ * Give the channel bag a new #ActionChannelBag::generation, called when curves are added or
+ * removed and when a curve of the bag changes its path.
+ */
+void KER_action_channelbag_tag_changed(struct ActionChannelBag *channelbag);
+
 /** \} */
 
 #ifdef __cplusplus
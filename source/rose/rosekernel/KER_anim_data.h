@@ -6,7 +6,10 @@
 #include <stdbool.h>
 
 struct AnimData;
+struct LibraryForeachIDData;
 struct Main;
+struct RoseDataReader;
+struct RoseWriter;
 
 #ifdef __cplusplus
 extern "C" {
@@ -31,6 +34,19 @@ void KER_animdata_free(struct ID *id, const bool do_id_user);
 
 /** \} */
 
+/* -------------------------------------------------------------------- */
+/** \name Animation Data Runtime
+ * \{ */
+
+/**
+ * Rebuild the resolved targets of the curves on the next evaluation, needed when the data the
+ * paths point to may have moved without the action changing.
+ */
+void KER_animdata_runtime_tag_dirty(struct AnimData *adt);
+void KER_animdata_runtime_free(struct AnimData *adt);
+
+/** \} */
+
 /* -------------------------------------------------------------------- */
 /** \name Animation Data Iteration
  * \{ */
@@ -43,6 +59,17 @@ void KER_fcurves_id_cb(struct ID *id, ID_FCurve_Edit_Callback func, void *user_d
 
 /** \} */
 
+/* -------------------------------------------------------------------- */
+/** \name Animation Data Library Support
+ * \{ */
+
+void KER_animdata_foreach_id(struct AnimData *adt, struct LibraryForeachIDData *data);
+
+void KER_animdata_rose_write(struct RoseWriter *writer, struct ID *id);
+void KER_animdata_rose_read_data(struct RoseDataReader *reader, struct ID *id);
+
+/** \} */
+
 #ifdef __cplusplus
 }
 #endif
@@ -1,7 +1,9 @@
 #ifndef KER_ANIM_SYS_H
 #define KER_ANIM_SYS_H
 
+struct Action;
 struct AnimData;
+struct AnimationEvalCache;
 struct Depsgraph;
 struct ID;
 struct FCurve;
@@ -23,6 +25,22 @@ enum {
 };
 
 void KER_animsys_evaluate_animdata(struct ID *id, struct AnimData *adt, float time, int recalc);
+/** Evaluate the animation data, sharing the evaluation of the curves through \a cache when it is not NULL. */
+void KER_animsys_evaluate_animdata_ex(struct ID *id, struct AnimData *adt, float time, int recalc, struct AnimationEvalCache *cache);
+
+/**
+ * Evaluate the curves of the action slot and write them to the properties of \a pointer.
+ *
+ * The paths of the curves are resolved once and kept in the runtime data of \a adt, until the
+ * action or the slot change, curves are added, removed or renamed (see
+ * #ActionChannelBag::generation) or #KER_animdata_runtime_tag_dirty is called. Properties
+ * stored as plain floats in DNA are written directly, skipping the RNA setters.
+ *
+ * When \a cache is not NULL the values of the curves are taken from it, see #KER_animsys_eval_cache_lookup.
+ */
+void KER_anim_evaluate_action_cached(struct PointerRNA pointer, struct AnimData *adt, struct Action *action, int slot, float ctime, struct AnimationEvalCache *cache);
+
+bool KER_anim_write_to_rna_path(struct PathResolvedRNA *resolved, float value, bool force);
 void KER_animsys_eval_animdata(struct Depsgraph *depsgraph, struct ID *id);
 
 bool KER_animsys_rna_path_resolve(struct PointerRNA *ptr, const char *path, int index, struct PathResolvedRNA *result);
@@ -30,6 +48,27 @@ bool KER_animsys_rna_curve_resolve(struct PointerRNA *ptr, struct FCurve *fcurve
 
 /** \} */
 
+/* -------------------------------------------------------------------- */
+/** \name Animation Evaluation Cache
+ * \{ */
+
+/**
+ * The values of the curves of the actions evaluated during one evaluation of a depsgraph, IDs
+ * playing the same action slot at the same time evaluate its curves only once. The cache is
+ * thread-safe, the entries are only valid until it is cleared.
+ */
+struct AnimationEvalCache *KER_animsys_eval_cache_new(void);
+void KER_animsys_eval_cache_clear(struct AnimationEvalCache *cache);
+void KER_animsys_eval_cache_free(struct AnimationEvalCache *cache);
+
+/**
+ * The value of every curve of the channel bag of the slot at \a ctime, in the order of the curves,
+ * evaluated on the first lookup. NULL when the action has no curves for the slot.
+ */
+const float *KER_animsys_eval_cache_lookup(struct AnimationEvalCache *cache, struct Action *action, int slot, float ctime);
+
+/** \} */
+
 #ifdef __cplusplus
 }
 #endif
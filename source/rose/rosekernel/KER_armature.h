@@ -171,6 +171,25 @@ void KER_pose_remap_bone_pointers(struct Armature *armature, struct Pose *pose);
 void KER_pose_channel_to_mat4(const struct PoseChannel *pchannel, float r_mat[4][4]);
 void KER_pose_channel_do_mat4(struct PoseChannel *pchannel);
 
+/** The offset of \a bone from the tail of its parent, \a bone must have a parent. */
+void KER_bone_offset_matrix_get(const struct Bone *bone, float offs_bone[4][4]);
+
+/**
+ * Compute the pose and deform matrices of all the channels not tagged with #POSE_DONE, the
+ * channels at the same depth of the hierarchy are evaluated in parallel.
+ */
+void KER_pose_where_is_batched(struct Pose *pose);
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Pose Runtime
+ * \{ */
+
+/** Rebuild the flattened hierarchy on the next evaluation, when channels are added, removed or reordered. */
+void KER_pose_runtime_tag_dirty(struct Pose *pose);
+void KER_pose_runtime_free(struct Pose *pose);
+
 /** \} */
 
 /* -------------------------------------------------------------------- */
@@ -0,0 +1,42 @@
+#ifndef KER_BVHUTILS_HH
+#define KER_BVHUTILS_HH
+
+#include "LIB_bvhtree.hh"
+#include "LIB_math_vector_types.hh"
+#include "LIB_span.hh"
+
+struct Mesh;
+
+/* -------------------------------------------------------------------- */
+/** \name Mesh BVH
+ *
+ * A #rose::BVHTree over the triangles of #KER_mesh_looptris, the primitive indices of the tree and
+ * the indices of the query results are triangle indices. The tree is cached on the mesh runtime,
+ * it is built on first use and refit on the first use after the positions change.
+ * \{ */
+
+const rose::BVHTree &KER_mesh_looptris_bvh(const Mesh *mesh);
+/**
+ * Tag the cached tree so that the next query updates its bounds for the new positions, keeping
+ * the hierarchy. Called by #KER_mesh_positions_changed and the functions like it, does nothing
+ * when the tree is not cached.
+ */
+void KER_mesh_looptris_bvh_tag_refit(Mesh *mesh);
+
+/**
+ * Find the closest triangle hit by the ray, \a r_hit should be initialized with the maximum
+ * distance. The hit normal is the normal of the triangle.
+ */
+bool KER_mesh_bvh_ray_cast(const Mesh *mesh, const float3 &origin, const float3 &direction, rose::BVHTreeRayHit *r_hit);
+/**
+ * Find the nearest point on the surface, \a r_nearest should be initialized with the squared
+ * maximum search distance.
+ */
+bool KER_mesh_bvh_find_nearest(const Mesh *mesh, const float3 &co, rose::BVHTreeNearest *r_nearest);
+
+void KER_mesh_bvh_ray_cast_batch(const Mesh *mesh, rose::Span<float3> origins, rose::Span<float3> directions, rose::MutableSpan<rose::BVHTreeRayHit> r_hits);
+void KER_mesh_bvh_find_nearest_batch(const Mesh *mesh, rose::Span<float3> cos, rose::MutableSpan<rose::BVHTreeNearest> r_nearest);
+
+/** \} */
+
+#endif	// KER_BVHUTILS_HH
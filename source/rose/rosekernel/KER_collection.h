@@ -12,6 +12,8 @@ extern "C" {
 
 struct Collection;
 struct Main;
+struct RoseDataReader;
+struct RoseWriter;
 
 typedef struct CollectionParent {
 	struct CollectionParent *prev, *next;
@@ -38,6 +40,17 @@ bool KER_collection_child_rem(struct Main *main, struct Collection *collection,
 
 bool KER_collection_is_empty(const struct Collection *collection);
 
+/** Rebuild the runtime #Collection::parents lists of every collection, including the master ones. */
+void KER_main_collections_parent_relations_rebuild(struct Main *main);
+
+/**
+ * Write/read the data owned by a collection, used for regular collections and for the master
+ * collections that are embedded in scenes.
+ */
+void KER_collection_rose_write_prepare_nolib(struct Collection *collection);
+void KER_collection_rose_write_nolib(struct RoseWriter *writer, struct Collection *collection);
+void KER_collection_rose_read_data(struct RoseDataReader *reader, struct Collection *collection);
+
 #ifdef __cplusplus
 }
 #endif
@@ -12,6 +12,8 @@ extern "C" {
 struct CustomData;
 struct CustomData_MeshMasks;
 struct ID;
+struct RoseDataReader;
+struct RoseWriter;
 
 enum eCustomDataType;
 
@@ -423,6 +425,24 @@ enum {
 
 size_t CustomData_get_elem_size(const struct CustomDataLayer *layer);
 
+/* -------------------------------------------------------------------- */
+/** \name Rose File I/O
+ * \{ */
+
+/**
+ * Filter the layers of \a data (usually a shallow copy) that should be written, temporary layers
+ * and layers without data are skipped. The returned array should be freed after writing.
+ */
+struct CustomDataLayer *CustomData_rose_write_prepare(struct CustomData *data);
+/**
+ * Write the layers returned by #CustomData_rose_write_prepare, the data of every layer is written
+ * as a single block of \a count elements.
+ */
+void CustomData_rose_write(struct RoseWriter *writer, const struct CustomData *data, const struct CustomDataLayer *layers_to_write, int count);
+void CustomData_rose_read(struct RoseDataReader *reader, struct CustomData *data, int count);
+
+/** \} */
+
 #ifdef __cplusplus
 }
 #endif
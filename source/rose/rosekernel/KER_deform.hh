@@ -0,0 +1,39 @@
+#ifndef KER_DEFORM_HH
+#define KER_DEFORM_HH
+
+#include "DNA_meshdata_types.h"
+
+#include "LIB_array.hh"
+#include "LIB_offset_indices.hh"
+#include "LIB_span.hh"
+
+#include "KER_deform.h"
+
+namespace rose::kernel {
+
+/* -------------------------------------------------------------------- */
+/** \name Deform Weights
+ *
+ * A compact representation of the vertex group weights of a mesh, the weights of all the vertices
+ * are stored in a single array and grouped by an offsets array. This avoids a pointer indirection
+ * and an allocation per vertex compared to #MDeformVert, which remains the format used for editing
+ * and for files.
+ * \{ */
+
+struct DeformWeights {
+	/** The weights of vertex `i` are `weights[offsets[i]..offsets[i + 1]]`. */
+	Array<int> offsets;
+	Array<MDeformWeight> weights;
+
+	GroupedSpan<MDeformWeight> as_span() const {
+		return GroupedSpan<MDeformWeight>(OffsetIndices<int>(offsets, offset_indices::NoSortCheck()), weights);
+	}
+};
+
+void deform_weights_from_dverts(Span<MDeformVert> dverts, DeformWeights &r_weights);
+
+/** \} */
+
+}  // namespace rose::kernel
+
+#endif	// KER_DEFORM_HH
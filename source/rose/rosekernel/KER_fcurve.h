@@ -5,6 +5,9 @@
 
 #include "RNA_define.h"
 
+struct RoseDataReader;
+struct RoseWriter;
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -41,6 +44,10 @@ struct FCurve *KER_fcurve_copy(const struct FCurve *fcurve);
 void KER_fcurves_free(struct ListBase *list);
 void KER_fcurve_free(struct FCurve *fcurve);
 
+/** Write the data owned by the F-Curve, the #FCurve struct itself should be written by the owner. */
+void KER_fcurve_rose_write_data(struct RoseWriter *writer, struct FCurve *fcurve);
+void KER_fcurve_rose_read_data(struct RoseDataReader *reader, struct FCurve *fcurve);
+
 /** \} */
 
 /* -------------------------------------------------------------------- */
@@ -51,6 +58,31 @@ float KER_fcurve_evaluate(struct PathResolvedRNA *rna, struct FCurve *fcurve, fl
 
 /** \} */
 
+/* -------------------------------------------------------------------- */
+/** \name F-Curve Bake
+ * \{ */
+
+/** The most samples a single curve is baked with, see #KER_fcurve_bake_samples. */
+#define FCURVE_BAKE_SAMPLES_MAX (1 << 16)
+
+/**
+ * Sample the keyframes of the curve at \a rate samples per frame, the evaluation within the range
+ * of the keyframes then interpolates linearly between the two nearest samples instead of solving
+ * the segment of the keyframes. Sharp changes, like constant interpolation, are smoothed over one
+ * sample interval.
+ *
+ * The samples are freed when the keyframes are edited with #KER_fcurve_bezt_resize or
+ * #KER_fcurve_handles_recalc, actions with #ACT_BAKE_SAMPLES bake them again before they are
+ * evaluated (see #KER_action_bake_samples_ensure). Curves spanning many frames are baked with at
+ * most #FCURVE_BAKE_SAMPLES_MAX samples, lowering the rate.
+ */
+void KER_fcurve_bake_samples(struct FCurve *fcurve, float rate);
+/** Bake the samples of many curves at once, the curves are baked in parallel. */
+void KER_fcurves_bake_samples(struct FCurve **fcurves, int totcurve, float rate);
+void KER_fcurve_bake_free(struct FCurve *fcurve);
+
+/** \} */
+
 /* -------------------------------------------------------------------- */
 /** \name F-Curve Edit
  * \{ */
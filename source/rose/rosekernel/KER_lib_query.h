@@ -44,6 +44,16 @@ enum {
 	 * Callback is responsible to deal accordingly with #ID.user if needed.
 	 */
 	IDWALK_CB_USER = (1 << 3),
+	/**
+	 * This ID pointer points to an embedded ID, owned by the current one (e.g. the master collection
+	 * of a scene), it is not part of #Main and it is not refcounted.
+	 */
+	IDWALK_CB_EMBEDDED = (1 << 4),
+	/**
+	 * This ID pointer points to an embedded ID that is owned by another data-block (e.g. the master
+	 * layer collection of a view layer), it should never be followed as if it was the owner.
+	 */
+	IDWALK_CB_EMBEDDED_NOT_OWNING = (1 << 5),
 };
 
 typedef int (*LibraryIDLinkCallback)(LibraryIDLinkCallbackData *);
@@ -121,13 +121,19 @@ ROSE_INLINE int *KER_mesh_corner_edges_for_write(Mesh *mesh) {
 }
 
 void KER_mesh_poly_offsets_ensure_alloc(struct Mesh *mesh);
+/** Share an array assigned to #Mesh::poly_offset_indices directly, e.g. when reading files. */
+void KER_mesh_poly_offsets_sharing_info_ensure(struct Mesh *mesh);
 void KER_mesh_ensure_required_data_layers(struct Mesh *mesh);
 
 ROSE_INLINE const MDeformVert *KER_mesh_deform_verts(const Mesh *mesh) {
 	return (const MDeformVert *)CustomData_get_layer(&mesh->vdata, CD_MDEFORMVERT);
 }
 
+/** Tag the compact vertex group weights for recomputation, see #KER_mesh_deform_weights_span. */
+void KER_mesh_deform_weights_tag_dirty(struct Mesh *mesh);
+
 ROSE_INLINE MDeformVert *KER_mesh_deform_verts_for_write(Mesh *mesh) {
+	KER_mesh_deform_weights_tag_dirty(mesh);
 	MDeformVert *dvert = (MDeformVert *)CustomData_get_layer_for_write(&mesh->vdata, CD_MDEFORMVERT, mesh->totvert);
 	if (dvert == NULL) {
 		dvert = (MDeformVert *)CustomData_add_layer(&mesh->vdata, CD_MDEFORMVERT, CD_SET_DEFAULT, mesh->totvert);
@@ -135,6 +141,11 @@ ROSE_INLINE MDeformVert *KER_mesh_deform_verts_for_write(Mesh *mesh) {
 	return dvert;
 }
 
+/** Allocate a copy of the vertex positions, the caller owns the returned array. */
+float (*KER_mesh_vert_coords_alloc(const struct Mesh *mesh, int *r_vert_len))[3];
+/** Overwrite the vertex positions with \a vert_coords, which has to hold #Mesh.totvert elements. */
+void KER_mesh_vert_coords_apply(struct Mesh *mesh, const float (*vert_coords)[3]);
+
 /** \} */
 
 /* -------------------------------------------------------------------- */
@@ -166,18 +177,40 @@ void KER_mesh_runtime_free_data(struct Mesh *mesh);
 
 void KER_mesh_runtime_clear_cache(struct Mesh *mesh);
 void KER_mesh_runtime_clear_geometry(struct Mesh *mesh);
+/**
+ * Share the caches that only depend on the topology and on the vertex group weights of \a src with
+ * \a dst, which has to be a copy of \a src.
+ */
+void KER_mesh_runtime_share_topology_caches(struct Mesh *dst, const struct Mesh *src);
 
 void KER_mesh_positions_changed(struct Mesh *mesh);
 void KER_mesh_positions_changed_uniformly(struct Mesh *mesh);
 
 /** \} */
 
+/* -------------------------------------------------------------------- */
+/** \name Mesh Merge By Distance
+ * \{ */
+
+/**
+ * Merge the vertices closer than \a merge_distance to each other, every vertex is merged into the
+ * lowest index vertex in range that is kept. Edges and corners that collapse are removed, as well
+ * as faces left with less than three corners.
+ * \return The number of removed vertices.
+ */
+int KER_mesh_merge_by_distance(struct Mesh *mesh, float merge_distance);
+
+/** \} */
+
 /* -------------------------------------------------------------------- */
 /** \name Mesh Tesselation
  * \{ */
 
 /**
  * Returns an array of indices that can be used for corner vertices.
+ *
+ * Changing only the positions keeps the triangulation, quads keep their diagonal unless
+ * #ME_TESSELLATE_QUAD_SPLIT is set and n-gons are only filled again where a triangle folded over.
  */
 const MLoopTri *KER_mesh_looptris(const struct Mesh *mesh);
 
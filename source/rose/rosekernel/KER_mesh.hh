@@ -149,6 +149,13 @@ ROSE_INLINE rose::Span<float3> KER_mesh_corner_normals_span(const Mesh *mesh) {
 	return rose::Span<float3>(reinterpret_cast<const float3 *>(KER_mesh_corner_normals_ensure(mesh)), mesh->totloop);
 }
 
+/**
+ * Recompute the cached normals affected by moving the vertices in \a changed_verts: the normals of
+ * the faces using them, and the vertex and face corner normals of the vertices of these faces.
+ * Normals that are not cached are left to be computed from scratch when needed.
+ */
+void KER_mesh_normals_update_partial(Mesh *mesh, const rose::IndexMask &changed_verts);
+
 ROSE_INLINE rose::Span<MDeformVert> KER_mesh_deform_verts_span(const Mesh *mesh) {
 	const MDeformVert *ptr = KER_mesh_deform_verts(mesh);
 	return (ptr) ? rose::Span<MDeformVert>(ptr, mesh->totvert) : rose::Span<MDeformVert>();
@@ -158,6 +165,12 @@ ROSE_INLINE rose::MutableSpan<MDeformVert> KER_mesh_deform_verts_for_write_span(
 	return rose::MutableSpan<MDeformVert>(KER_mesh_deform_verts_for_write(mesh), mesh->totvert);
 }
 
+/**
+ * The vertex group weights of every vertex, stored contiguously. This is computed lazily from the
+ * #MDeformVert layer and is empty when the mesh has no vertex group weights.
+ */
+rose::GroupedSpan<MDeformWeight> KER_mesh_deform_weights_span(const Mesh *mesh);
+
 rose::GroupedSpan<int> KER_mesh_vert_to_face_map_span(const Mesh *mesh);
 
 
@@ -165,6 +178,12 @@ rose::GroupedSpan<int> KER_mesh_vert_to_face_map_span(const Mesh *mesh);
 /** \name Mesh Geometry Evaluation
  * \{ */
 
+/**
+ * A version of #KER_mesh_positions_changed for when only the vertices in \a changed_verts moved,
+ * the cached normals are updated in place so that the cost is proportional to the change.
+ */
+void KER_mesh_positions_changed_mask(Mesh *mesh, const rose::IndexMask &changed_verts);
+
 std::optional<rose::Bounds<float3>> KER_mesh_evaluated_geometry_bounds(Mesh *mesh);
 
 /** \} */
@@ -5,18 +5,37 @@
 
 #include "LIB_array.hh"
 #include "LIB_bounds_types.hh"
+#include "LIB_bvhtree.hh"
 #include "LIB_math_vector_types.hh"
 #include "LIB_implicit_sharing.hh"
 #include "LIB_shared_cache.hh"
 #include "LIB_span.hh"
 #include "LIB_vector.hh"
 
+#include "KER_deform.hh"
+
 #include <mutex>
 
 struct Mesh;
 
 namespace rose::kernel {
 
+/**
+ * The part of the triangulation of a mesh that is kept when the positions change, see
+ * #MeshRuntime::looptris_topology_cache.
+ */
+struct LooptrisTopology {
+	/** The triangles of every face, computed with the positions the topology was first seen with. */
+	Array<MLoopTri> looptris;
+	/** The quads, their diagonal is only picked again when #ME_TESSELLATE_QUAD_SPLIT is set. */
+	Array<int> quad_polys;
+	/**
+	 * The faces with more than four corners, their fill is only valid for the shape it was computed
+	 * with (a convex n-gon can be deformed into a concave one) and is checked when the positions change.
+	 */
+	Array<int> ngon_polys;
+};
+
 struct MeshRuntime {
 	/** Needed to ensure some thread-safety during render data pre-processing. */
 	std::mutex render_mutex = {};
@@ -32,9 +51,28 @@ struct MeshRuntime {
 	/** Implicit sharing user count for #Mesh::poly_offset_indices. */
 	const ImplicitSharingInfo *poly_offsets_sharing_info = nullptr;
 
-	/** Cache for derived triangulation of the mesh, accessed with #Mesh::looptris(). */
+	/**
+	 * Cache for the triangulation of the mesh that only depends on the topology, it is not tagged
+	 * dirty when the positions change so animated meshes do not triangulate every face again.
+	 */
+	SharedCache<LooptrisTopology> looptris_topology_cache = {};
+	/**
+	 * Cache for derived triangulation of the mesh, accessed with #KER_mesh_looptris(). Only used when
+	 * some faces depend on the positions, it is then #looptris_topology_cache with these faces
+	 * triangulated again.
+	 */
 	SharedCache<Array<MLoopTri>> looptris_cache = {};
+	/** The dirty #looptris_cache still holds the triangles of the current topology, only the faces that depend on the positions are updated. */
+	bool looptris_refresh = false;
 	SharedCache<Array<int>> looptri_polys_cache = {};
+	/**
+	 * Acceleration structure over the triangles of #looptris_cache for ray casts and nearest point
+	 * queries, see #KER_mesh_looptris_bvh(). When the positions change it is refit on the next query
+	 * rather than built again, since the hierarchy stays valid for moved triangles.
+	 */
+	SharedCache<BVHTree> bvh_looptris_cache = {};
+	/** The dirty #bvh_looptris_cache still holds the tree of the current topology, see #KER_mesh_looptris_bvh_tag_refit. */
+	bool bvh_looptris_refit = false;
 
 	/**
 	 * Caches for lazily computed vertex and polygon normals. These are stored here rather than in
@@ -54,6 +92,12 @@ struct MeshRuntime {
 	SharedCache<Array<int>> vert_to_face_offset_cache = {};
 	/** Cache of indices for vert to face map. */
 	SharedCache<Array<int>> vert_to_face_map_cache = {};
+
+	/**
+	 * Cache of the vertex group weights in a compact layout, see #DeformWeights. Since the layer
+	 * is shared on copy, the cache is shared with the copies until either of them writes weights.
+	 */
+	SharedCache<DeformWeights> deform_weights_cache = {};
 	
 	/**
      * Data used to efficiently draw the mesh in the viewport, especially useful when 
@@ -8,10 +8,13 @@
 #include "LIB_utildefines.h"
 
 struct ID;
+struct ListBase;
 struct Mesh;
 struct ModifierData;
 struct ModifierEvalContext;
 struct Object;
+struct RoseDataReader;
+struct RoseWriter;
 struct Scene;
 
 #ifdef __cplusplus
@@ -191,6 +194,22 @@ bool KER_modifier_deform_verts(struct ModifierData *md, const struct ModifierEva
 
 /** \} */
 
+/* -------------------------------------------------------------------- */
+/** \name Device Evaluation
+ * This is primarily part of the DRAW module but we export functions!
+ * \{ */
+
+/**
+ * \return True if the modifier is applied by the #draw module on the GPU and has to be skipped
+ * on the host, a #MODIFIER_DEVICE_ONLY modifier is still evaluated on the host when there is no
+ * draw module able to apply it (e.g. when running in background without a GPU).
+ */
+bool KER_modifier_is_device_evaluated(const struct ModifierData *md);
+
+extern bool (*KER_modifier_device_supported_cb)(const struct ModifierData *md);
+
+/** \} */
+
 /* -------------------------------------------------------------------- */
 /** \name ModifierData for each Query
  * \{ */
@@ -199,6 +218,15 @@ void KER_modifiers_foreach_ID_link(struct Object *object, IDWalkFunc walk, void
 
 /** \} */
 
+/* -------------------------------------------------------------------- */
+/** \name ModifierData File I/O
+ * \{ */
+
+void KER_modifier_rose_write(struct RoseWriter *writer, struct ListBase *modbase);
+void KER_modifier_rose_read_data(struct RoseDataReader *reader, struct ListBase *lb);
+
+/** \} */
+
 #ifdef __cplusplus
 }
 #endif
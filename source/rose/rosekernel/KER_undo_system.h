@@ -0,0 +1,45 @@
+#ifndef KER_UNDO_SYSTEM_H
+#define KER_UNDO_SYSTEM_H
+
+#include "LIB_listbase.h"
+#include "LIB_utildefines.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct Main;
+struct UndoStack;
+
+/* -------------------------------------------------------------------- */
+/** \name Undo Stack
+ *
+ * The database is written into a new step after every change (see #KER_undosys_step_push), undo
+ * and redo then restore the database to the state of a neighboring step. Only the IDs that differ
+ * between the active step and the restored one are read, so the database is expected to match the
+ * active step, a step has to be pushed after every change.
+ * \{ */
+
+/** Create a stack, which keeps at most \a step_limit steps (zero for no limit). */
+struct UndoStack *KER_undosys_stack_new(int step_limit);
+void KER_undosys_stack_clear(struct UndoStack *stack);
+void KER_undosys_stack_free(struct UndoStack *stack);
+
+/** Returns the memory used by the stack, chunks shared between steps are only counted once. */
+size_t KER_undosys_stack_memory(const struct UndoStack *stack);
+
+/**
+ * Write the current state of the database into a new step, the steps that were undone are dropped.
+ */
+bool KER_undosys_step_push(struct UndoStack *stack, struct Main *main, const char *name);
+
+bool KER_undosys_step_undo(struct UndoStack *stack, struct Main *main);
+bool KER_undosys_step_redo(struct UndoStack *stack, struct Main *main);
+
+/** \} */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif	// KER_UNDO_SYSTEM_H
@@ -2,6 +2,7 @@
 
 #include "KER_action.h"
 #include "KER_anim_data.h"
+#include "KER_armature.h"
 #include "KER_fcurve.h"
 #include "KER_idtype.h"
 #include "KER_lib_id.h"
@@ -18,6 +19,10 @@
 #include "LIB_string.h"
 #include "LIB_utildefines.h"
 
+#include "RLO_read_write.h"
+
+#include "atomic_ops.h"
+
 bool KER_id_foreach_action_slot_use(ID *animated, fnActionSlotCallback callback, void *userdata) {
 	AnimData *adt = KER_animdata_from_id(animated);
 
@@ -182,6 +187,7 @@ ActionChannelBag *KER_action_strip_keyframe_data_channelbag_add_ex(ActionStripKe
 
 	ActionChannelBag *nchannelbag = MEM_callocN(sizeof(ActionChannelBag), "ActionChannelBag");
 	nchannelbag->handle = handle;
+	KER_action_channelbag_tag_changed(nchannelbag);
 
 	strip_data->totchannelbag++;
 	strip_data->channelbags = (ActionChannelBag **)MEM_reallocN(strip_data->channelbags, sizeof(ActionChannelBag *) * strip_data->totchannelbag);
@@ -544,6 +550,7 @@ PoseChannel *KER_pose_channel_ensure(Pose *pose, const char *name) {
 	if (pose->channelhash) {
 		LIB_ghash_insert(pose->channelhash, chan->name, chan);
 	}
+	KER_pose_runtime_tag_dirty(pose);
 
 	return chan;
 }
@@ -653,6 +660,7 @@ void KER_pose_channels_free_ex(Pose *pose, const bool do_id_user) {
 	KER_pose_channels_hash_free(pose);
 
 	MEM_SAFE_FREE(pose->channels);
+	KER_pose_runtime_free(pose);
 }
 
 void KER_pose_channels_free(Pose *pose) {
@@ -915,6 +923,7 @@ void KER_action_channelbag_fcurve_create_many(Main *main, ActionChannelBag *chan
 		newcurves[i] = fcurve;
 
 		channelbag->fcurves[newindex] = fcurve;
+		fcurve->runtime.channelbag = channelbag;
 		if (descriptor->group) {
 			ActionGroup *group = KER_action_channelbag_group_ensure(channelbag, descriptor->group);
 			const int groupindex = group->fcurve_range_start + group->fcurve_range_length;
@@ -941,6 +950,49 @@ void KER_action_channelbag_fcurve_create_many(Main *main, ActionChannelBag *chan
 	LIB_gset_free(unique, NULL);
 
 	restore_channelbag_group_invariants(channelbag);
+	KER_action_channelbag_tag_changed(channelbag);
+}
+
+void KER_action_bake_samples_ensure(Action *action) {
+	if ((action->flag & ACT_BAKE_SAMPLES) == 0) {
+		return;
+	}
+
+	int totcurve = 0;
+	for (int i = 0; i < action->totstripkeyframedata; i++) {
+		const ActionStripKeyframeData *strip_data = action->stripkeyframedata[i];
+		for (int j = 0; j < strip_data->totchannelbag; j++) {
+			totcurve += strip_data->channelbags[j]->totcurve;
+		}
+	}
+	if (totcurve == 0) {
+		return;
+	}
+
+	FCurve **fcurves = MEM_mallocN(sizeof(FCurve *) * totcurve, __func__);
+	int totbake = 0;
+	for (int i = 0; i < action->totstripkeyframedata; i++) {
+		const ActionStripKeyframeData *strip_data = action->stripkeyframedata[i];
+		for (int j = 0; j < strip_data->totchannelbag; j++) {
+			const ActionChannelBag *channelbag = strip_data->channelbags[j];
+			for (int k = 0; k < channelbag->totcurve; k++) {
+				if (channelbag->fcurves[k]->runtime.baked == NULL) {
+					fcurves[totbake++] = channelbag->fcurves[k];
+				}
+			}
+		}
+	}
+	if (totbake) {
+		KER_fcurves_bake_samples(fcurves, totbake, action->bake_rate);
+	}
+	MEM_freeN(fcurves);
+}
+
+void KER_action_channelbag_tag_changed(ActionChannelBag *channelbag) {
+	/** Shared between all the channel bags, so that a new bag never reuses the generation of a freed one. */
+	static int generation = 0;
+
+	channelbag->generation = atomic_add_and_fetch_int32(&generation, 1);
 }
 
 /** \} */
@@ -953,6 +1005,7 @@ ROSE_STATIC void action_init_data(ID *id) {
 	Action *action = (Action *)id;
 
 	action->uidslot = 0x37627bf5;
+	action->bake_rate = 4.0f;
 }
 
 ROSE_INLINE void action_channel_bag_restore_channel_group_invariants(ActionChannelBag *self) {
@@ -991,6 +1044,7 @@ ROSE_INLINE void action_channel_bag_copy(ActionChannelBag *dst, const ActionChan
 	dst->fcurves = MEM_callocN(sizeof(FCurve *) * src->totcurve, __func__);
 	for (int i = 0; i < src->totcurve; i++) {
 		dst->fcurves[i] = KER_fcurve_copy(src->fcurves[i]);
+		dst->fcurves[i]->runtime.channelbag = dst;
 	}
 	dst->totcurve = src->totcurve;
 
@@ -1002,8 +1056,10 @@ ROSE_INLINE void action_channel_bag_copy(ActionChannelBag *dst, const ActionChan
 		dst->groups[i]->channelbag = dst;
 	}
 	dst->totgroup = src->totgroup;
+	dst->flag = src->flag;
 
 	action_channel_bag_restore_channel_group_invariants(dst);
+	KER_action_channelbag_tag_changed(dst);
 }
 
 ROSE_INLINE void action_strip_keyframe_data_copy(ActionStripKeyframeData *dst, const ActionStripKeyframeData *src) {
@@ -1088,6 +1144,114 @@ ROSE_STATIC void action_foreach_id(ID *id, struct LibraryForeachIDData *data) {
 	}
 }
 
+ROSE_STATIC void write_channelbag(RoseWriter *writer, ActionChannelBag *channelbag) {
+	RLO_write_struct(writer, ActionChannelBag, channelbag);
+
+	RLO_write_pointer_array(writer, channelbag->totgroup, (const void **)channelbag->groups);
+	for (int i = 0; i < channelbag->totgroup; i++) {
+		RLO_write_struct(writer, ActionGroup, channelbag->groups[i]);
+	}
+
+	RLO_write_pointer_array(writer, channelbag->totcurve, (const void **)channelbag->fcurves);
+	for (int i = 0; i < channelbag->totcurve; i++) {
+		RLO_write_struct(writer, FCurve, channelbag->fcurves[i]);
+		KER_fcurve_rose_write_data(writer, channelbag->fcurves[i]);
+	}
+}
+
+ROSE_STATIC void action_write(RoseWriter *writer, ID *id, const void *id_address) {
+	Action *action = (Action *)id;
+
+	/** Markers are not used by actions yet. */
+	LIB_listbase_clear(&action->markers);
+
+	RLO_write_id_struct(writer, Action, id_address, &action->id);
+
+	RLO_write_pointer_array(writer, action->totlayer, (const void **)action->layers);
+	for (int i = 0; i < action->totlayer; i++) {
+		ActionLayer *layer = action->layers[i];
+
+		RLO_write_struct(writer, ActionLayer, layer);
+		RLO_write_pointer_array(writer, layer->totstrip, (const void **)layer->strips);
+		for (int j = 0; j < layer->totstrip; j++) {
+			RLO_write_struct(writer, ActionStrip, layer->strips[j]);
+		}
+	}
+
+	RLO_write_pointer_array(writer, action->totslot, (const void **)action->slots);
+	for (int i = 0; i < action->totslot; i++) {
+		RLO_write_struct(writer, ActionSlot, action->slots[i]);
+	}
+
+	RLO_write_pointer_array(writer, action->totstripkeyframedata, (const void **)action->stripkeyframedata);
+	for (int i = 0; i < action->totstripkeyframedata; i++) {
+		ActionStripKeyframeData *data = action->stripkeyframedata[i];
+
+		RLO_write_struct(writer, ActionStripKeyframeData, data);
+		RLO_write_pointer_array(writer, data->totchannelbag, (const void **)data->channelbags);
+		for (int j = 0; j < data->totchannelbag; j++) {
+			write_channelbag(writer, data->channelbags[j]);
+		}
+	}
+}
+
+ROSE_STATIC void read_channelbag(RoseDataReader *reader, ActionChannelBag *channelbag) {
+	RLO_read_pointer_array(reader, channelbag->totgroup, (void **)&channelbag->groups);
+	for (int i = 0; i < channelbag->totgroup; i++) {
+		RLO_read_struct(reader, ActionGroup, &channelbag->groups[i]);
+
+		ActionGroup *group = channelbag->groups[i];
+		group->prev = NULL;
+		group->next = NULL;
+		group->channelbag = channelbag;
+	}
+
+	RLO_read_pointer_array(reader, channelbag->totcurve, (void **)&channelbag->fcurves);
+	for (int i = 0; i < channelbag->totcurve; i++) {
+		RLO_read_struct(reader, FCurve, &channelbag->fcurves[i]);
+		KER_fcurve_rose_read_data(reader, channelbag->fcurves[i]);
+		channelbag->fcurves[i]->runtime.channelbag = channelbag;
+	}
+
+	action_channel_bag_restore_channel_group_invariants(channelbag);
+	KER_action_channelbag_tag_changed(channelbag);
+}
+
+ROSE_STATIC void action_read_data(RoseDataReader *reader, ID *id) {
+	Action *action = (Action *)id;
+
+	LIB_listbase_clear(&action->markers);
+
+	RLO_read_pointer_array(reader, action->totlayer, (void **)&action->layers);
+	for (int i = 0; i < action->totlayer; i++) {
+		RLO_read_struct(reader, ActionLayer, &action->layers[i]);
+
+		ActionLayer *layer = action->layers[i];
+		RLO_read_pointer_array(reader, layer->totstrip, (void **)&layer->strips);
+		for (int j = 0; j < layer->totstrip; j++) {
+			RLO_read_struct(reader, ActionStrip, &layer->strips[j]);
+		}
+	}
+
+	RLO_read_pointer_array(reader, action->totslot, (void **)&action->slots);
+	for (int i = 0; i < action->totslot; i++) {
+		RLO_read_struct(reader, ActionSlot, &action->slots[i]);
+		KER_action_slot_runtime_init(action->slots[i]);
+	}
+
+	RLO_read_pointer_array(reader, action->totstripkeyframedata, (void **)&action->stripkeyframedata);
+	for (int i = 0; i < action->totstripkeyframedata; i++) {
+		RLO_read_struct(reader, ActionStripKeyframeData, &action->stripkeyframedata[i]);
+
+		ActionStripKeyframeData *data = action->stripkeyframedata[i];
+		RLO_read_pointer_array(reader, data->totchannelbag, (void **)&data->channelbags);
+		for (int j = 0; j < data->totchannelbag; j++) {
+			RLO_read_struct(reader, ActionChannelBag, &data->channelbags[j]);
+			read_channelbag(reader, data->channelbags[j]);
+		}
+	}
+}
+
 IDTypeInfo IDType_ID_AC = {
 	.idcode = ID_AC,
 
@@ -1107,8 +1271,8 @@ IDTypeInfo IDType_ID_AC = {
 
 	.foreach_id = action_foreach_id,
 
-	.write = NULL,
-	.read_data = NULL,
+	.write = action_write,
+	.read_data = action_read_data,
 };
 
 /** \} */
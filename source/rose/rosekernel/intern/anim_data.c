@@ -4,11 +4,14 @@
 #include "KER_anim_data.h"
 #include "KER_idtype.h"
 #include "KER_lib_id.h"
+#include "KER_lib_query.h"
 #include "KER_main.h"
 #include "KER_fcurve.h"
 
 #include "LIB_utildefines.h"
 
+#include "RLO_read_write.h"
+
 bool id_type_can_have_animdata(const short id_type) {
 	const IDTypeInfo *typeinfo = KER_idtype_get_info_from_idcode(id_type);
 	if (typeinfo != NULL) {
@@ -53,6 +56,7 @@ AnimData *KER_animdata_copy_ex(Main *main, AnimData *adt, int flag) {
 	}
 
 	AnimData *new_adt = (AnimData *)MEM_dupallocN(adt);
+	new_adt->runtime = NULL;
 
 	if (do_action) {
 		const int id_copy_flag = (flag & LIB_ID_CREATE_NO_MAIN) == 0 ? (flag & ~LIB_ID_CREATE_NO_USER_REFCOUNT) : flag;
@@ -85,6 +89,31 @@ void KER_animdata_free(ID *id, const bool do_id_user) {
 		}
 	}
 
+	KER_animdata_runtime_free(adt);
+
 	MEM_freeN(adt);
 	iat->adt = NULL;
 }
+
+void KER_animdata_foreach_id(AnimData *adt, struct LibraryForeachIDData *data) {
+	KER_LIB_FOREACHID_PROCESS_IDSUPER(data, adt->action, IDWALK_CB_USER);
+}
+
+void KER_animdata_rose_write(RoseWriter *writer, ID *id) {
+	AnimData *adt = KER_animdata_from_id(id);
+	if (adt != NULL) {
+		RLO_write_struct(writer, AnimData, adt);
+	}
+}
+
+void KER_animdata_rose_read_data(RoseDataReader *reader, ID *id) {
+	if (!id_can_have_animdata(id)) {
+		return;
+	}
+
+	IdAdtTemplate *iat = (IdAdtTemplate *)id;
+	RLO_read_struct(reader, AnimData, &iat->adt);
+	if (iat->adt) {
+		iat->adt->runtime = NULL;
+	}
+}
@@ -0,0 +1,206 @@
+#include "MEM_guardedalloc.h"
+
+#include "DNA_action_types.h"
+#include "DNA_anim_types.h"
+
+#include "KER_action.h"
+#include "KER_anim_data.h"
+#include "KER_anim_sys.h"
+#include "KER_fcurve.h"
+
+#include "LIB_math_rotation.h"
+#include "LIB_string.h"
+#include "LIB_index_range.hh"
+#include "LIB_utildefines.h"
+#include "LIB_vector.hh"
+
+#include "RNA_access.h"
+#include "RNA_types.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cstring>
+
+/**
+ * A property written by one or more consecutive curves of the action, the curves of an array
+ * property are grouped when their paths are the same so the array is written at once.
+ */
+typedef struct AnimDataTarget {
+	PathResolvedRNA resolved;
+	/** The values of the property in DNA, NULL when they have to be written through RNA. */
+	float *raw;
+	/** The hard range of the property, only used when writing to #raw. */
+	float min, max;
+
+	/** The range of the curves in the fcurve array of the channel bag. */
+	int fcurve_start;
+	int fcurve_num;
+	/** The length of the array when the curves are grouped, zero for curves written one by one. */
+	int array_length;
+	/** Incompletely keyed quaternions are normalized after the evaluation. */
+	bool is_quaternion;
+} AnimDataTarget;
+
+typedef struct AnimDataRuntime {
+	/** The data the targets were resolved for, any change rebuilds the targets. */
+	const ID *owner = nullptr;
+	const Action *action = nullptr;
+	int slot = 0;
+	/** The #ActionChannelBag::generation of the curves, bumped when they are added, removed or renamed. */
+	int generation = 0;
+
+	rose::Vector<AnimDataTarget> targets;
+
+	bool is_dirty = true;
+} AnimDataRuntime;
+
+namespace rose::kernel {
+
+ROSE_STATIC void anim_data_target_init_raw(AnimDataTarget &target) {
+	target.raw = RNA_property_float_raw_data(&target.resolved.ptr, target.resolved.property);
+	target.min = -FLT_MAX;
+	target.max = FLT_MAX;
+	if (target.raw) {
+		RNA_property_float_range(&target.resolved.ptr, target.resolved.property, &target.min, &target.max);
+	}
+}
+
+/** The number of curves following \a index that animate the same array, the same rule as #KER_anim_evaluate_fcurves. */
+ROSE_STATIC int anim_data_array_curves_num(const PathResolvedRNA &resolved, FCurve **fcurves, const int totcurve, const int index) {
+	PointerRNA ptr = resolved.ptr;
+	if (RNA_property_type(resolved.property) != PROP_FLOAT) {
+		return 0;
+	}
+	const int totarray = RNA_property_array_length(&ptr, resolved.property);
+	if (totarray <= 1 || totarray > 4) {
+		return 0;
+	}
+
+	int sequencial = 1;
+	while (sequencial < totarray && index + sequencial < totcurve) {
+		if (!STREQ(fcurves[index]->path, fcurves[index + sequencial]->path)) {
+			break;
+		}
+		sequencial++;
+	}
+	return (sequencial > 1) ? sequencial : 0;
+}
+
+ROSE_STATIC void anim_data_runtime_rebuild(AnimDataRuntime &runtime, PointerRNA pointer, FCurve **fcurves, const int totcurve) {
+	runtime.targets.clear();
+
+	for (int index = 0; index < totcurve; index++) {
+		AnimDataTarget target = {};
+		if (!KER_animsys_rna_curve_resolve(&pointer, fcurves[index], &target.resolved)) {
+			continue;
+		}
+
+		target.fcurve_start = index;
+		target.fcurve_num = 1;
+		if (const int sequencial = anim_data_array_curves_num(target.resolved, fcurves, totcurve, index)) {
+			target.fcurve_num = sequencial;
+			target.array_length = RNA_property_array_length(&target.resolved.ptr, target.resolved.property);
+			target.is_quaternion = STREQ(RNA_property_identifier(target.resolved.property), "quaternion");
+		}
+		anim_data_target_init_raw(target);
+
+		runtime.targets.append(target);
+		index += target.fcurve_num - 1;
+	}
+
+	runtime.is_dirty = false;
+}
+
+/** The value of a curve, read from the shared \a values when the action was already evaluated. */
+ROSE_INLINE float anim_data_curve_value(PathResolvedRNA &resolved, FCurve **fcurves, const float *values, const int index, const float ctime) {
+	return values ? values[index] : KER_fcurve_evaluate(&resolved, fcurves[index], ctime);
+}
+
+ROSE_STATIC void anim_data_target_evaluate(AnimDataTarget &target, FCurve **fcurves, const float *values_shared, const float ctime) {
+	PathResolvedRNA &resolved = target.resolved;
+
+	if (target.array_length == 0) {
+		const float value = anim_data_curve_value(resolved, fcurves, values_shared, target.fcurve_start, ctime);
+		if (target.raw) {
+			target.raw[std::max(resolved.index, 0)] = std::clamp(value, target.min, target.max);
+		}
+		else {
+			KER_anim_write_to_rna_path(&resolved, value, false);
+		}
+		return;
+	}
+
+	float values[4];
+	if (target.raw) {
+		memcpy(values, target.raw, sizeof(float) * target.array_length);
+	}
+	else {
+		RNA_property_float_get_array(&resolved.ptr, resolved.property, values);
+	}
+
+	for (const int index : IndexRange(target.fcurve_start, target.fcurve_num)) {
+		const int array_index = fcurves[index]->index;
+		if (array_index < 0 || array_index >= target.array_length) {
+			continue;
+		}
+		values[array_index] = anim_data_curve_value(resolved, fcurves, values_shared, index, ctime);
+	}
+	if (target.is_quaternion && target.fcurve_num < 4) {
+		/* This quaternion was incompletely keyed, so the result is a mixture of the unit quaternion
+		 * and values from FCurves. This means that it's almost certainly no longer of unit length. */
+		normalize_qt(values);
+	}
+
+	if (target.raw) {
+		for (int i = 0; i < target.array_length; i++) {
+			target.raw[i] = std::clamp(values[i], target.min, target.max);
+		}
+	}
+	else {
+		RNA_property_float_set_array(&resolved.ptr, resolved.property, values);
+	}
+}
+
+}  // namespace rose::kernel
+
+void KER_anim_evaluate_action_cached(PointerRNA pointer, AnimData *adt, Action *action, int slot, float ctime, AnimationEvalCache *cache) {
+	using namespace rose::kernel;
+
+	ActionChannelBag *bag = KER_action_channelbag_for_action_slot_ex(action, slot);
+	if (bag == nullptr) {
+		return;
+	}
+
+	if (adt->runtime == nullptr) {
+		adt->runtime = MEM_new<AnimDataRuntime>("AnimDataRuntime");
+	}
+	AnimDataRuntime &runtime = *adt->runtime;
+	if (runtime.owner != pointer.owner || runtime.action != action || runtime.slot != slot || runtime.generation != bag->generation) {
+		runtime.owner = pointer.owner;
+		runtime.action = action;
+		runtime.slot = slot;
+		runtime.generation = bag->generation;
+		runtime.is_dirty = true;
+	}
+	if (runtime.is_dirty) {
+		anim_data_runtime_rebuild(runtime, pointer, bag->fcurves, bag->totcurve);
+	}
+
+	const float *values = cache ? KER_animsys_eval_cache_lookup(cache, action, slot, ctime) : nullptr;
+	for (AnimDataTarget &target : runtime.targets) {
+		anim_data_target_evaluate(target, bag->fcurves, values, ctime);
+	}
+}
+
+void KER_animdata_runtime_tag_dirty(AnimData *adt) {
+	if (adt && adt->runtime) {
+		adt->runtime->is_dirty = true;
+	}
+}
+
+void KER_animdata_runtime_free(AnimData *adt) {
+	if (adt->runtime) {
+		MEM_delete<AnimDataRuntime>(adt->runtime);
+		adt->runtime = nullptr;
+	}
+}
@@ -0,0 +1,91 @@
+#include "MEM_guardedalloc.h"
+
+#include "DNA_action_types.h"
+#include "DNA_anim_types.h"
+
+#include "KER_action.h"
+#include "KER_anim_sys.h"
+#include "KER_fcurve.h"
+
+#include "LIB_array.hh"
+#include "LIB_cache_mutex.hh"
+#include "LIB_hash.hh"
+#include "LIB_map.hh"
+#include "LIB_task.hh"
+
+#include <memory>
+#include <mutex>
+
+namespace rose::kernel {
+
+struct AnimationEvalCacheKey {
+	const Action *action;
+	int slot;
+	float ctime;
+
+	uint64_t hash() const {
+		return get_default_hash(action, slot, ctime);
+	}
+
+	friend bool operator==(const AnimationEvalCacheKey &a, const AnimationEvalCacheKey &b) {
+		return a.action == b.action && a.slot == b.slot && a.ctime == b.ctime;
+	}
+};
+
+struct AnimationEvalCacheEntry {
+	CacheMutex mutex;
+	/** The value of every curve of the channel bag, in the order of the curves. */
+	Array<float> values;
+};
+
+}  // namespace rose::kernel
+
+/**
+ * The values of the curves of the actions evaluated during one evaluation of a depsgraph. The IDs
+ * that play the same action slot at the same time share the evaluation of its curves, so crowds of
+ * instances only pay for the distinct actions and times they use.
+ */
+typedef struct AnimationEvalCache {
+	std::mutex mutex;
+	rose::Map<rose::kernel::AnimationEvalCacheKey, std::unique_ptr<rose::kernel::AnimationEvalCacheEntry>> entries;
+} AnimationEvalCache;
+
+AnimationEvalCache *KER_animsys_eval_cache_new(void) {
+	return MEM_new<AnimationEvalCache>("AnimationEvalCache");
+}
+
+void KER_animsys_eval_cache_clear(AnimationEvalCache *cache) {
+	std::lock_guard lock{cache->mutex};
+	cache->entries.clear();
+}
+
+void KER_animsys_eval_cache_free(AnimationEvalCache *cache) {
+	MEM_delete<AnimationEvalCache>(cache);
+}
+
+const float *KER_animsys_eval_cache_lookup(AnimationEvalCache *cache, Action *action, int slot, float ctime) {
+	using namespace rose;
+	using namespace rose::kernel;
+
+	ActionChannelBag *bag = KER_action_channelbag_for_action_slot_ex(action, slot);
+	if (bag == nullptr) {
+		return nullptr;
+	}
+
+	AnimationEvalCacheEntry *entry;
+	{
+		std::lock_guard lock{cache->mutex};
+		entry = cache->entries.lookup_or_add_cb({action, slot, ctime}, []() { return std::make_unique<AnimationEvalCacheEntry>(); }).get();
+	}
+
+	/* The first ID to need the values evaluates them, the others wait for them. */
+	entry->mutex.ensure([&]() {
+		entry->values.reinitialize(bag->totcurve);
+		threading::parallel_for(entry->values.index_range(), 256, [&](const IndexRange range) {
+			for (const int index : range) {
+				entry->values[index] = KER_fcurve_evaluate(nullptr, bag->fcurves[index], ctime);
+			}
+		});
+	});
+	return entry->values.data();
+}
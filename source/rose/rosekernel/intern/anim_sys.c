@@ -183,6 +183,10 @@ void KER_anim_evaluate_and_apply_action(PointerRNA pointer, Action *action, int
 }
 
 void KER_animsys_evaluate_animdata(ID *id, AnimData *adt, float ctime, int recalc) {
+	KER_animsys_evaluate_animdata_ex(id, adt, ctime, recalc, NULL);
+}
+
+void KER_animsys_evaluate_animdata_ex(ID *id, AnimData *adt, float ctime, int recalc, struct AnimationEvalCache *cache) {
 	if (ELEM(NULL, id, adt)) {
 		return;
 	}
@@ -201,10 +205,10 @@ void KER_animsys_evaluate_animdata(ID *id, AnimData *adt, float ctime, int recal
 			const float time = action->frame_start + atime;
 
 			if (KER_action_is_layered(adt->action)) {
-				KER_anim_evaluate_and_apply_action(idptr, adt->action, adt->handle, time);
+				KER_anim_evaluate_action_cached(idptr, adt, adt->action, adt->handle, time, cache);
 			}
 			else {
-				KER_anim_evaluate_action(idptr, adt->action, 0, time);
+				KER_anim_evaluate_action_cached(idptr, adt, adt->action, 0, time, cache);
 			}
 		}
 	}
@@ -214,7 +218,7 @@ void KER_animsys_eval_animdata(Depsgraph *depsgraph, ID *id) {
 	float ctime = DEG_get_ctime(depsgraph);
 	AnimData *adt = KER_animdata_from_id(id);
 
-	KER_animsys_evaluate_animdata(id, adt, ctime, ADT_RECALC_ANIM);
+	KER_animsys_evaluate_animdata_ex(id, adt, ctime, ADT_RECALC_ANIM, DEG_get_anim_eval_cache(depsgraph));
 }
 
 bool KER_animsys_rna_path_resolve(PointerRNA *ptr, const char *path, int index, PathResolvedRNA *result) {
@@ -1,6 +1,7 @@
 ﻿#include "MEM_guardedalloc.h"
 
 #include "KER_action.h"
+#include "KER_anim_data.h"
 #include "KER_armature.h"
 #include "KER_idtype.h"
 #include "KER_idprop.h"
@@ -20,6 +21,8 @@
 #include "DEG_depsgraph.h"
 #include "DEG_depsgraph_build.h"
 
+#include "RLO_read_write.h"
+
 /* -------------------------------------------------------------------- */
 /** \name Armature Edit Routines
  * \{ */
@@ -259,6 +262,7 @@ void KER_pose_channels_clear_with_null_bone(Pose *pose, const bool do_id_user) {
 		if (pchan->bone == NULL) {
 			KER_pose_channel_free_ex(pchan, do_id_user);
 			KER_pose_channels_hash_free(pose);
+			KER_pose_runtime_tag_dirty(pose);
 			LIB_freelinkN(&pose->channelbase, pchan);
 		}
 	}
@@ -282,6 +286,9 @@ void KER_pose_rebuild(Main *main, Object *object, Armature *armature, bool do_id
 
 	KER_pose_channels_clear_with_null_bone(pose, do_id_user);
 	KER_pose_channels_hash_ensure(pose);
+	KER_pose_runtime_tag_dirty(pose);
+	/* The animation paths of the object may point to channels that were freed. */
+	KER_animdata_runtime_tag_dirty(KER_animdata_from_id(&object->id));
 
 	pose->flag &= ~POSE_RECALC;
 	pose->flag |= POSE_WAS_REBUILT;
@@ -300,6 +307,8 @@ void KER_pose_channel_index_rebuild(Pose *pose) {
 	LISTBASE_FOREACH_INDEX(PoseChannel *, pchannel, &pose->channelbase, index) {
 		pose->channels[index] = pchannel;
 	}
+
+	KER_pose_runtime_tag_dirty(pose);
 }
 
 void KER_pose_eval_init(Depsgraph *depsgraph, Scene *scene, Object *object) {
@@ -727,31 +736,24 @@ void KER_pose_where_is(Depsgraph *depsgraph, Scene *scene, Object *object) {
 
 	/* In edit-mode or rest-position we read the data from the bones. */
 	if (armature->ebonebase) {
+		float imat[4][4];
+
 		LISTBASE_FOREACH(PoseChannel *, pchannel, &object->pose->channelbase) {
 			Bone *bone = pchannel->bone;
 			if (bone) {
 				copy_m4_m4(pchannel->pose_mat, bone->arm_mat);
+
+				/* calculating deform matrices */
+				invert_m4_m4(imat, bone->arm_mat);
+				mul_m4_m4m4(pchannel->chan_mat, pchannel->pose_mat, imat);
 			}
 		}
 	}
 	else {
 		invert_m4_m4(object->invmat, object->obmat);
 
-		LISTBASE_FOREACH(PoseChannel *, pchannel, &object->pose->channelbase) {
-			if (!(pchannel->flag & POSE_DONE)) {
-				KER_pose_where_is_bone(depsgraph, scene, object, pchannel, 0.0f);
-			}
-		}
-	}
-
-	float imat[4][4];
-
-	/* calculating deform matrices */
-	LISTBASE_FOREACH(PoseChannel *, pchannel, &object->pose->channelbase) {
-		if (pchannel->bone) {
-			invert_m4_m4(imat, pchannel->bone->arm_mat);
-			mul_m4_m4m4(pchannel->chan_mat, pchannel->pose_mat, imat);
-		}
+		/* The deform matrices are computed along with the pose matrices. */
+		KER_pose_where_is_batched(object->pose);
 	}
 }
 
@@ -921,6 +923,56 @@ ROSE_STATIC void armature_foreach_id(ID *id, struct LibraryForeachIDData *data)
 	}
 }
 
+ROSE_STATIC void write_bone(RoseWriter *writer, Bone *bone) {
+	RLO_write_struct_list(writer, Bone, &bone->childbase);
+
+	LISTBASE_FOREACH(Bone *, child, &bone->childbase) {
+		write_bone(writer, child);
+	}
+}
+
+ROSE_STATIC void armature_write(RoseWriter *writer, ID *id, const void *id_address) {
+	Armature *armature = (Armature *)id;
+
+	/** Runtime data is never written, the bone hash is created again when reading. */
+	armature->bonehash = NULL;
+	armature->ebonebase = NULL;
+
+	RLO_write_id_struct(writer, Armature, id_address, &armature->id);
+	KER_animdata_rose_write(writer, id);
+
+	RLO_write_struct_list(writer, Bone, &armature->bonebase);
+	LISTBASE_FOREACH(Bone *, bone, &armature->bonebase) {
+		write_bone(writer, bone);
+	}
+}
+
+ROSE_STATIC void read_bone(RoseDataReader *reader, Bone *bone, Bone *parent) {
+	/** Bone properties are not written yet. */
+	bone->prop = NULL;
+	bone->parent = parent;
+
+	RLO_read_struct_list(reader, Bone, &bone->childbase);
+	LISTBASE_FOREACH(Bone *, child, &bone->childbase) {
+		read_bone(reader, child, bone);
+	}
+}
+
+ROSE_STATIC void armature_read_data(RoseDataReader *reader, ID *id) {
+	Armature *armature = (Armature *)id;
+
+	KER_animdata_rose_read_data(reader, id);
+
+	RLO_read_struct_list(reader, Bone, &armature->bonebase);
+	LISTBASE_FOREACH(Bone *, bone, &armature->bonebase) {
+		read_bone(reader, bone, NULL);
+	}
+
+	armature->bonehash = NULL;
+	armature->ebonebase = NULL;
+	KER_armature_bone_hash_make(armature);
+}
+
 /** \} */
 
 /* -------------------------------------------------------------------- */
@@ -946,8 +998,8 @@ IDTypeInfo IDType_ID_AR = {
 
 	.foreach_id = armature_foreach_id,
 
-	.write = NULL,
-	.read_data = NULL,
+	.write = armature_write,
+	.read_data = armature_read_data,
 };
 
 /** \} */
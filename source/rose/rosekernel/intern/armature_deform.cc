@@ -9,6 +9,7 @@
 #include "LIB_math_matrix.hh"
 #include "LIB_math_quaternion.hh"
 #include "LIB_math_vector.hh"
+#include "LIB_simd.h"
 #include "LIB_span.hh"
 #include "LIB_task.hh"
 
@@ -16,6 +17,13 @@
 
 namespace rose::kernel {
 
+/**
+ * Vertices whose total weight is below this are left untouched. Weight values and the total can
+ * be as small as 10e-39, dividing by these only amplifies the rounding errors. The value is kept
+ * fixed (close to #FLT_EPSILON) so that all the deform paths agree on which vertices are deformed.
+ */
+constexpr float contrib_threshold = 1e-7f;
+
 /**
  * Utility class for accumulating linear bone deformation.
  * If full_deform is true the deformation matrix is also computed.
@@ -49,6 +57,11 @@ struct ArmatureDeformParams {
 	const ListBase *pose_channels;
 
 	rose::Array<PoseChannel *> pose_channel_by_vertex_group;
+	/**
+	 * The deformation of every vertex group from target space to target space, the transforms into
+	 * and out of armature space folded with the pose, valid where #pose_channel_by_vertex_group is.
+	 */
+	rose::Array<float4x4> skin_matrix_by_vertex_group;
 
 	float4x4 target_to_armature;
 	float4x4 armature_to_target;
@@ -79,6 +92,17 @@ ROSE_INLINE ArmatureDeformParams get_armature_deform_params(const Object *obarma
 	deform_params.armature_to_target = float4x4(KER_object_world_to_object(obtarget)) * float4x4(KER_object_object_to_world(obarmature));
 	deform_params.target_to_armature = float4x4(KER_object_world_to_object(obarmature)) * float4x4(KER_object_object_to_world(obtarget));
 
+	deform_params.skin_matrix_by_vertex_group.reinitialize(deform_params.pose_channel_by_vertex_group.size());
+	for (const int64_t index : deform_params.pose_channel_by_vertex_group.index_range()) {
+		const PoseChannel *pchannel = deform_params.pose_channel_by_vertex_group[index];
+		if (pchannel) {
+			deform_params.skin_matrix_by_vertex_group[index] = deform_params.armature_to_target * float4x4(pchannel->chan_mat) * deform_params.target_to_armature;
+		}
+		else {
+			deform_params.skin_matrix_by_vertex_group[index] = float4x4::identity();
+		}
+	}
+
 	return deform_params;
 }
 
@@ -94,7 +118,7 @@ template<typename MixerT> ROSE_INLINE float pchannel_bone_deform(const PoseChann
 	return weight;
 }
 
-template<typename MixerT> ROSE_INLINE void armature_vert_task_with_mixer(const ArmatureDeformParams &params, const size_t index, const MDeformVert *dvert, MixerT &mixer) {
+template<typename MixerT> ROSE_INLINE void armature_vert_task_with_mixer(const ArmatureDeformParams &params, const size_t index, const Span<MDeformWeight> dweights, MixerT &mixer) {
 	const bool full_deform = !params.vert_deform_mats.is_empty();
 
 	float3 co = params.vert_coords[index];
@@ -105,9 +129,8 @@ template<typename MixerT> ROSE_INLINE void armature_vert_task_with_mixer(const A
 	float contrib = 0.0f;
 	bool deformed = false;
 	/* Apply vertex group deformation if enabled. */
-	if (params.use_dverts && dvert) {
+	if (params.use_dverts) {
 		const rose::IndexRange def_nr_range = params.pose_channel_by_vertex_group.index_range();
-		const rose::Span<MDeformWeight> dweights(dvert->dw, dvert->totweight);
 
 		for (const auto &dw : dweights) {
 			const PoseChannel *pchannel = def_nr_range.contains(dw.def_nr) ? params.pose_channel_by_vertex_group[dw.def_nr] : NULL;
@@ -123,8 +146,6 @@ template<typename MixerT> ROSE_INLINE void armature_vert_task_with_mixer(const A
 		}
 	}
 
-	/* TODO Actually should be EPSILON? Weight values and contrib can be like 10e-39 small. */
-	constexpr float contrib_threshold = 1e-7f;
 	if (contrib > contrib_threshold) {
 		float3 delta_co;
 		float3x3 local_deform_mat;
@@ -146,35 +167,166 @@ template<typename MixerT> ROSE_INLINE void armature_vert_task_with_mixer(const A
 	params.vert_coords[index] = co;
 }
 
-ROSE_INLINE void armature_vert_task_with_dvert(const ArmatureDeformParams &params, const size_t index, const MDeformVert *dvert) {
+ROSE_INLINE void armature_vert_task_with_dvert(const ArmatureDeformParams &params, const size_t index, const Span<MDeformWeight> dweights) {
 	const bool full_deform = !params.vert_deform_mats.is_empty();
 	if (full_deform) {
 		rose::kernel::BoneDeformLinearMixer<true> mixer;
-		armature_vert_task_with_mixer(params, index, dvert, mixer);
+		armature_vert_task_with_mixer(params, index, dweights, mixer);
 	}
 	else {
 		rose::kernel::BoneDeformLinearMixer<false> mixer;
-		armature_vert_task_with_mixer(params, index, dvert, mixer);
+		armature_vert_task_with_mixer(params, index, dweights, mixer);
+	}
+}
+
+/** The weights of the vertex, empty when the vertex is not deformed by vertex groups. */
+ROSE_INLINE Span<MDeformWeight> armature_vert_weights(const ArmatureDeformParams &params, const GroupedSpan<MDeformWeight> weights, const size_t index) {
+	if (params.use_dverts && weights.index_range().contains(index)) {
+		return weights[index];
+	}
+	return {};
+}
+
+/* -------------------------------------------------------------------- */
+/** \name Batched Skinning
+ *
+ * Without deformation matrices only the positions matter, the weights are normalized so blending
+ * the points transformed by the skinning matrices of the groups is the same deformation (see
+ * #ArmatureDeformParams.skin_matrix_by_vertex_group). Vertices are deformed four at a time with
+ * SSE2, the scalar version performs the same operations in the same order, both give identical
+ * results.
+ * \{ */
+
+/** The skinning matrix of the weight, NULL when the weight does not deform the vertex. */
+ROSE_INLINE const float4x4 *armature_skin_matrix(const ArmatureDeformParams &params, const MDeformWeight &dw) {
+	if (dw.weight == 0.0f || !params.pose_channel_by_vertex_group.index_range().contains(dw.def_nr) || params.pose_channel_by_vertex_group[dw.def_nr] == NULL) {
+		return NULL;
+	}
+	return &params.skin_matrix_by_vertex_group[dw.def_nr];
+}
+
+ROSE_INLINE float3 armature_skin_vert(const ArmatureDeformParams &params, const float3 &co, const Span<MDeformWeight> dweights) {
+	float3 accum(0.0f);
+	float contrib = 0.0f;
+	for (const MDeformWeight &dw : dweights) {
+		const float4x4 *skin_mat = armature_skin_matrix(params, dw);
+		if (skin_mat == NULL) {
+			continue;
+		}
+		const float(*m)[4] = skin_mat->ptr();
+		accum.x = accum.x + dw.weight * (m[0][0] * co.x + m[1][0] * co.y + m[2][0] * co.z + m[3][0]);
+		accum.y = accum.y + dw.weight * (m[0][1] * co.x + m[1][1] * co.y + m[2][1] * co.z + m[3][1]);
+		accum.z = accum.z + dw.weight * (m[0][2] * co.x + m[1][2] * co.y + m[2][2] * co.z + m[3][2]);
+		contrib = contrib + dw.weight;
+	}
+
+	if (contrib > contrib_threshold) {
+		return float3(accum.x / contrib, accum.y / contrib, accum.z / contrib);
+	}
+	return co;
+}
+
+#ifdef ROSE_HAVE_SSE2
+
+/** Deform the four vertices starting at \a index, see #armature_skin_vert for the scalar version. */
+ROSE_INLINE void armature_skin_vert_x4(const ArmatureDeformParams &params, const size_t index, const Span<MDeformWeight> dweights[4]) {
+	const rose::MutableSpan<float3> coords = params.vert_coords.slice(index, 4);
+
+	const __m128 x = _mm_setr_ps(coords[0].x, coords[1].x, coords[2].x, coords[3].x);
+	const __m128 y = _mm_setr_ps(coords[0].y, coords[1].y, coords[2].y, coords[3].y);
+	const __m128 z = _mm_setr_ps(coords[0].z, coords[1].z, coords[2].z, coords[3].z);
+
+	/** Inactive lanes still load a matrix, its content is masked out. */
+	static const float4x4 inactive_mat = float4x4::identity();
+
+	size_t totweight = 0;
+	for (int lane = 0; lane < 4; lane++) {
+		totweight = ROSE_MAX(totweight, dweights[lane].size());
+	}
+
+	__m128 accum_x = _mm_setzero_ps(), accum_y = _mm_setzero_ps(), accum_z = _mm_setzero_ps();
+	__m128 contrib = _mm_setzero_ps();
+	for (size_t weight_index = 0; weight_index < totweight; weight_index++) {
+		/** Gather the weight and the skinning matrix of every lane, inactive lanes are masked out. */
+		const float *mats[4];
+		float weights[4];
+		int active[4];
+		for (int lane = 0; lane < 4; lane++) {
+			const float4x4 *skin_mat = NULL;
+			if (weight_index < dweights[lane].size()) {
+				skin_mat = armature_skin_matrix(params, dweights[lane][weight_index]);
+			}
+			mats[lane] = (skin_mat) ? skin_mat->base_ptr() : inactive_mat.base_ptr();
+			weights[lane] = (skin_mat) ? dweights[lane][weight_index].weight : 0.0f;
+			active[lane] = (skin_mat) ? -1 : 0;
+		}
+		const __m128 mask = _mm_castsi128_ps(_mm_loadu_si128(reinterpret_cast<const __m128i *>(active)));
+		const __m128 weight = _mm_loadu_ps(weights);
+
+		/** Columns of the matrices, transposed so that every register holds one element of the four lanes. */
+		__m128 c0x = _mm_loadu_ps(mats[0] + 0), c0y = _mm_loadu_ps(mats[1] + 0), c0z = _mm_loadu_ps(mats[2] + 0), c0w = _mm_loadu_ps(mats[3] + 0);
+		__m128 c1x = _mm_loadu_ps(mats[0] + 4), c1y = _mm_loadu_ps(mats[1] + 4), c1z = _mm_loadu_ps(mats[2] + 4), c1w = _mm_loadu_ps(mats[3] + 4);
+		__m128 c2x = _mm_loadu_ps(mats[0] + 8), c2y = _mm_loadu_ps(mats[1] + 8), c2z = _mm_loadu_ps(mats[2] + 8), c2w = _mm_loadu_ps(mats[3] + 8);
+		__m128 c3x = _mm_loadu_ps(mats[0] + 12), c3y = _mm_loadu_ps(mats[1] + 12), c3z = _mm_loadu_ps(mats[2] + 12), c3w = _mm_loadu_ps(mats[3] + 12);
+		_MM_TRANSPOSE4_PS(c0x, c0y, c0z, c0w);
+		_MM_TRANSPOSE4_PS(c1x, c1y, c1z, c1w);
+		_MM_TRANSPOSE4_PS(c2x, c2y, c2z, c2w);
+		_MM_TRANSPOSE4_PS(c3x, c3y, c3z, c3w);
+
+		const __m128 px = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(c0x, x), _mm_mul_ps(c1x, y)), _mm_mul_ps(c2x, z)), c3x);
+		const __m128 py = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(c0y, x), _mm_mul_ps(c1y, y)), _mm_mul_ps(c2y, z)), c3y);
+		const __m128 pz = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(c0z, x), _mm_mul_ps(c1z, y)), _mm_mul_ps(c2z, z)), c3z);
+
+		accum_x = _mm_add_ps(accum_x, _mm_and_ps(mask, _mm_mul_ps(weight, px)));
+		accum_y = _mm_add_ps(accum_y, _mm_and_ps(mask, _mm_mul_ps(weight, py)));
+		accum_z = _mm_add_ps(accum_z, _mm_and_ps(mask, _mm_mul_ps(weight, pz)));
+		contrib = _mm_add_ps(contrib, _mm_and_ps(mask, weight));
+	}
+
+	const __m128 deformed = _mm_cmpgt_ps(contrib, _mm_set1_ps(contrib_threshold));
+
+	float rx[4], ry[4], rz[4];
+	_mm_storeu_ps(rx, _mm_or_ps(_mm_and_ps(deformed, _mm_div_ps(accum_x, contrib)), _mm_andnot_ps(deformed, x)));
+	_mm_storeu_ps(ry, _mm_or_ps(_mm_and_ps(deformed, _mm_div_ps(accum_y, contrib)), _mm_andnot_ps(deformed, y)));
+	_mm_storeu_ps(rz, _mm_or_ps(_mm_and_ps(deformed, _mm_div_ps(accum_z, contrib)), _mm_andnot_ps(deformed, z)));
+	for (int lane = 0; lane < 4; lane++) {
+		coords[lane] = float3(rx[lane], ry[lane], rz[lane]);
 	}
 }
 
-ROSE_INLINE void armature_deform_coords(const Object *obarmature, const Object *obtarget, const ListBase *defbase, const rose::MutableSpan<float3> vert_coords, const rose::MutableSpan<float3x3> vert_deform_mats, rose::Span<MDeformVert> dverts, const Mesh *metarget) {
+#endif
+
+ROSE_INLINE void armature_deform_coords_batched(const ArmatureDeformParams &params, const GroupedSpan<MDeformWeight> weights) {
+	rose::threading::parallel_for(params.vert_coords.index_range(), 256, [&](const IndexRange range) {
+		size_t index = range.start();
+#ifdef ROSE_HAVE_SSE2
+		for (; index + 4 <= range.one_after_last(); index += 4) {
+			Span<MDeformWeight> dweights_x4[4];
+			for (int lane = 0; lane < 4; lane++) {
+				dweights_x4[lane] = armature_vert_weights(params, weights, index + lane);
+			}
+			armature_skin_vert_x4(params, index, dweights_x4);
+		}
+#endif
+		for (; index < range.one_after_last(); index++) {
+			params.vert_coords[index] = armature_skin_vert(params, params.vert_coords[index], armature_vert_weights(params, weights, index));
+		}
+	});
+}
+
+/** \} */
+
+ROSE_INLINE void armature_deform_coords(const Object *obarmature, const Object *obtarget, const ListBase *defbase, const rose::MutableSpan<float3> vert_coords, const rose::MutableSpan<float3x3> vert_deform_mats, const GroupedSpan<MDeformWeight> weights) {
 	ArmatureDeformParams params = get_armature_deform_params(obarmature, obtarget, defbase, vert_coords, vert_deform_mats);
 
+	if (vert_deform_mats.is_empty()) {
+		armature_deform_coords_batched(params, weights);
+		return;
+	}
+
 	rose::threading::parallel_for(vert_coords.index_range(), 32, [&](const IndexRange range) {
 		for (const size_t index : range) {
-			const MDeformVert *dvert = NULL;
-			if (params.use_dverts) {
-				if (metarget) {
-					ROSE_assert(index < metarget->totvert);
-					dvert = &(dverts[index]);
-				}
-				else if (index < dverts.size()) {
-					dvert = &(dverts[index]);
-				}
-			}
-
-			armature_vert_task_with_dvert(params, index, dvert);
+			armature_vert_task_with_dvert(params, index, armature_vert_weights(params, weights, index));
 		}
 	});
 }
@@ -197,17 +349,17 @@ void KER_armature_deform_coords_with_mesh(Object *armature, Object *obtarget, fl
 		defbase = KER_id_defgroup_list_get(&obtarget->id);
 	}
 
-	rose::Span<MDeformVert> dverts;
+	rose::GroupedSpan<MDeformWeight> weights;
 
 	switch (obtarget->type) {
 		case OB_MESH: {
-			dverts = KER_mesh_deform_verts_span(metarget);
+			weights = KER_mesh_deform_weights_span(metarget);
 		} break;
 	}
 
 	rose::MutableSpan<float3> vert_coords = rose::MutableSpan<float3>(reinterpret_cast<float3 *>(positions), length);
 
-	armature_deform_coords(armature, obtarget, defbase, vert_coords, rose::MutableSpan<float3x3>(), dverts, metarget);
+	armature_deform_coords(armature, obtarget, defbase, vert_coords, rose::MutableSpan<float3x3>(), weights);
 }
 
 /** \} */
\ No newline at end of file
@@ -0,0 +1,159 @@
+#include "MEM_guardedalloc.h"
+
+#include "DNA_action_types.h"
+#include "DNA_armature_types.h"
+
+#include "KER_armature.h"
+
+#include "LIB_array.hh"
+#include "LIB_listbase.h"
+#include "LIB_map.hh"
+#include "LIB_math_matrix.h"
+#include "LIB_math_matrix.hh"
+#include "LIB_task.hh"
+#include "LIB_vector.hh"
+
+/**
+ * The pose hierarchy flattened into arrays, the channels are sorted by their depth so every level
+ * of the hierarchy is a contiguous range that only depends on the levels before it.
+ */
+typedef struct PoseRuntime {
+	/** The channels sorted by depth, parents always come before their children. */
+	rose::Array<PoseChannel *> channels;
+	/** The index of the parent of every channel in #channels, -1 for root channels. */
+	rose::Array<int> parents;
+	/** The boundaries of the levels in #channels, the last one is the number of channels. */
+	rose::Vector<int> level_offsets;
+	/** The pose matrices in the order of #channels, so children read them without following pointers. */
+	rose::Array<float4x4> pose_mats;
+
+	bool is_dirty = true;
+} PoseRuntime;
+
+namespace rose::kernel {
+
+/** Channels in levels smaller than this are evaluated on a single thread. */
+static constexpr int pose_level_grain_size = 64;
+
+ROSE_STATIC void pose_runtime_rebuild(const Pose *pose, PoseRuntime &runtime) {
+	Vector<PoseChannel *> channels;
+	Map<const PoseChannel *, int> channel_indices;
+	LISTBASE_FOREACH(PoseChannel *, pchannel, &pose->channelbase) {
+		channel_indices.add_new(pchannel, int(channels.size()));
+		channels.append(pchannel);
+	}
+
+	/* The depth of every channel, the channels are not guaranteed to follow their parents in the list. */
+	Array<int> depths(channels.size(), -1);
+	int depth_max = -1;
+	for (const int index : channels.index_range()) {
+		int depth = 0;
+		for (const PoseChannel *parent = channels[index]->parent; parent; parent = parent->parent) {
+			const int parent_index = channel_indices.lookup(parent);
+			if (depths[parent_index] != -1) {
+				depth += depths[parent_index] + 1;
+				break;
+			}
+			depth++;
+		}
+		depths[index] = depth;
+		depth_max = std::max(depth_max, depth);
+	}
+
+	/* Counting sort of the channels by depth, the list order is kept within a level. */
+	runtime.level_offsets.clear();
+	runtime.level_offsets.append_n_times(0, depth_max + 2);
+	for (const int depth : depths) {
+		runtime.level_offsets[depth + 1]++;
+	}
+	for (const int level : IndexRange(depth_max + 1)) {
+		runtime.level_offsets[level + 1] += runtime.level_offsets[level];
+	}
+
+	Array<int> sorted_indices(channels.size());
+	Array<int> level_fill(runtime.level_offsets.as_span().drop_back(1));
+	for (const int index : channels.index_range()) {
+		sorted_indices[index] = level_fill[depths[index]]++;
+	}
+
+	runtime.channels.reinitialize(channels.size());
+	runtime.parents.reinitialize(channels.size());
+	runtime.pose_mats.reinitialize(channels.size());
+	for (const int index : channels.index_range()) {
+		const PoseChannel *parent = channels[index]->parent;
+		runtime.channels[sorted_indices[index]] = channels[index];
+		runtime.parents[sorted_indices[index]] = parent ? sorted_indices[channel_indices.lookup(parent)] : -1;
+	}
+
+	runtime.is_dirty = false;
+}
+
+ROSE_INLINE void pose_channel_eval(PoseRuntime &runtime, const int index) {
+	PoseChannel *pchannel = runtime.channels[index];
+	const Bone *bone = pchannel->bone;
+	if (bone == nullptr) {
+		runtime.pose_mats[index] = float4x4(pchannel->pose_mat);
+		return;
+	}
+
+	if ((pchannel->flag & POSE_DONE) == 0) {
+		KER_pose_channel_do_mat4(pchannel);
+
+		/* pose_mat(b) = pose_mat(b-1) * yoffs(b-1) * d_root(b) * bone_mat(b) * chan_mat(b) */
+		const int parent = runtime.parents[index];
+		if (parent != -1) {
+			float offs_bone[4][4];
+			KER_bone_offset_matrix_get(bone, offs_bone);
+			runtime.pose_mats[index] = runtime.pose_mats[parent] * float4x4(offs_bone) * float4x4(pchannel->chan_mat);
+		}
+		else {
+			runtime.pose_mats[index] = float4x4(bone->arm_mat) * float4x4(pchannel->chan_mat);
+		}
+		copy_m4_m4(pchannel->pose_mat, runtime.pose_mats[index].ptr());
+	}
+	else {
+		runtime.pose_mats[index] = float4x4(pchannel->pose_mat);
+	}
+
+	/* The deform matrix, from the rest position to the pose. */
+	const float4x4 chan_mat = runtime.pose_mats[index] * math::invert(float4x4(bone->arm_mat));
+	copy_m4_m4(pchannel->chan_mat, chan_mat.ptr());
+}
+
+}  // namespace rose::kernel
+
+void KER_pose_where_is_batched(Pose *pose) {
+	using namespace rose;
+	using namespace rose::kernel;
+
+	if (pose->runtime == nullptr) {
+		pose->runtime = MEM_new<PoseRuntime>("PoseRuntime");
+	}
+	PoseRuntime &runtime = *pose->runtime;
+	if (runtime.is_dirty) {
+		pose_runtime_rebuild(pose, runtime);
+	}
+
+	/* The levels are evaluated in order, the channels of a level only read the matrices of their parents. */
+	for (const int level : runtime.level_offsets.index_range().drop_back(1)) {
+		const IndexRange range(runtime.level_offsets[level], runtime.level_offsets[level + 1] - runtime.level_offsets[level]);
+		threading::parallel_for(range, pose_level_grain_size, [&](const IndexRange sub_range) {
+			for (const int index : sub_range) {
+				pose_channel_eval(runtime, index);
+			}
+		});
+	}
+}
+
+void KER_pose_runtime_tag_dirty(Pose *pose) {
+	if (pose->runtime) {
+		pose->runtime->is_dirty = true;
+	}
+}
+
+void KER_pose_runtime_free(Pose *pose) {
+	if (pose->runtime) {
+		MEM_delete<PoseRuntime>(pose->runtime);
+		pose->runtime = nullptr;
+	}
+}
@@ -0,0 +1,138 @@
+#include "LIB_math_geom.h"
+#include "LIB_math_vector.hh"
+#include "LIB_task.hh"
+
+#include "KER_bvhutils.hh"
+#include "KER_mesh.hh"
+#include "KER_mesh_types.hh"
+
+/* -------------------------------------------------------------------- */
+/** \name Mesh BVH
+ * \{ */
+
+static rose::Span<MLoopTri> mesh_looptris_span(const Mesh *mesh) {
+	if (mesh->totpoly == 0) {
+		return {};
+	}
+	return rose::Span<MLoopTri>(KER_mesh_looptris(mesh), poly_to_tri_count(mesh->totpoly, mesh->totloop));
+}
+
+static rose::Array<rose::Bounds<float3>> looptris_bounds(const Mesh *mesh) {
+	const rose::Span<float3> positions = KER_mesh_vert_positions_span(mesh);
+	const rose::Span<int> corner_verts = KER_mesh_corner_verts_span(mesh);
+	const rose::Span<MLoopTri> looptris = mesh_looptris_span(mesh);
+
+	rose::Array<rose::Bounds<float3>> bounds(looptris.size());
+	rose::threading::parallel_for(looptris.index_range(), 4096, [&](const rose::IndexRange range) {
+		for (const int index : range) {
+			const MLoopTri &tri = looptris[index];
+			const float3 &v0 = positions[corner_verts[tri.tri[0]]];
+			const float3 &v1 = positions[corner_verts[tri.tri[1]]];
+			const float3 &v2 = positions[corner_verts[tri.tri[2]]];
+			bounds[index] = rose::Bounds<float3>(rose::math::min(rose::math::min(v0, v1), v2), rose::math::max(rose::math::max(v0, v1), v2));
+		}
+	});
+	return bounds;
+}
+
+const rose::BVHTree &KER_mesh_looptris_bvh(const Mesh *mesh) {
+	mesh->runtime->bvh_looptris_cache.ensure([&](rose::BVHTree &r_data) {
+		const rose::Array<rose::Bounds<float3>> bounds = looptris_bounds(mesh);
+		/* Only the positions changed since the tree was built, the hierarchy is kept. */
+		if (mesh->runtime->bvh_looptris_refit && bounds.size() == r_data.prim_indices().size()) {
+			r_data.refit(bounds);
+		}
+		else {
+			r_data = rose::BVHTree(bounds);
+		}
+	});
+	return mesh->runtime->bvh_looptris_cache.data();
+}
+
+void KER_mesh_looptris_bvh_tag_refit(Mesh *mesh) {
+	rose::SharedCache<rose::BVHTree> &cache = mesh->runtime->bvh_looptris_cache;
+	if (!cache.is_cached()) {
+		/* Either never built or already waiting to be built again from scratch. */
+		return;
+	}
+	cache.tag_dirty_keep_data();
+	mesh->runtime->bvh_looptris_refit = true;
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Mesh BVH Queries
+ * \{ */
+
+/** The triangle data the query callbacks need, gathered once per query or batch. */
+struct MeshBVHTriangles {
+	rose::Span<float3> positions;
+	rose::Span<int> corner_verts;
+	rose::Span<MLoopTri> looptris;
+
+	MeshBVHTriangles(const Mesh *mesh) : positions(KER_mesh_vert_positions_span(mesh)), corner_verts(KER_mesh_corner_verts_span(mesh)), looptris(mesh_looptris_span(mesh)) {
+	}
+
+	void ray_cast(const int index, const float3 &origin, const float3 &direction, rose::BVHTreeRayHit &hit) const {
+		const MLoopTri &tri = looptris[index];
+		const float3 &v0 = positions[corner_verts[tri.tri[0]]];
+		const float3 &v1 = positions[corner_verts[tri.tri[1]]];
+		const float3 &v2 = positions[corner_verts[tri.tri[2]]];
+
+		float dist;
+		if (isect_ray_tri_watertight_v3_simple(origin, direction, v0, v1, v2, &dist, nullptr) && dist < hit.dist) {
+			hit.index = index;
+			hit.dist = dist;
+			hit.co = origin + direction * dist;
+			normal_tri_v3(hit.no, v0, v1, v2);
+		}
+	}
+
+	void find_nearest(const int index, const float3 &co, rose::BVHTreeNearest &nearest) const {
+		const MLoopTri &tri = looptris[index];
+		float3 closest;
+		closest_on_tri_to_point_v3(closest, co, positions[corner_verts[tri.tri[0]]], positions[corner_verts[tri.tri[1]]], positions[corner_verts[tri.tri[2]]]);
+
+		const float dist_sq = rose::math::distance_squared(co, closest);
+		if (dist_sq < nearest.dist_sq) {
+			nearest.index = index;
+			nearest.dist_sq = dist_sq;
+			nearest.co = closest;
+		}
+	}
+};
+
+bool KER_mesh_bvh_ray_cast(const Mesh *mesh, const float3 &origin, const float3 &direction, rose::BVHTreeRayHit *r_hit) {
+	const rose::BVHTree &tree = KER_mesh_looptris_bvh(mesh);
+	const MeshBVHTriangles triangles(mesh);
+	return tree.ray_cast(origin, direction, *r_hit, [&](const int index, const float3 &ray_origin, const float3 &ray_direction, rose::BVHTreeRayHit &hit) {
+		triangles.ray_cast(index, ray_origin, ray_direction, hit);
+	});
+}
+
+bool KER_mesh_bvh_find_nearest(const Mesh *mesh, const float3 &co, rose::BVHTreeNearest *r_nearest) {
+	const rose::BVHTree &tree = KER_mesh_looptris_bvh(mesh);
+	const MeshBVHTriangles triangles(mesh);
+	return tree.find_nearest(co, *r_nearest, [&](const int index, const float3 &query_co, rose::BVHTreeNearest &nearest) {
+		triangles.find_nearest(index, query_co, nearest);
+	});
+}
+
+void KER_mesh_bvh_ray_cast_batch(const Mesh *mesh, const rose::Span<float3> origins, const rose::Span<float3> directions, rose::MutableSpan<rose::BVHTreeRayHit> r_hits) {
+	const rose::BVHTree &tree = KER_mesh_looptris_bvh(mesh);
+	const MeshBVHTriangles triangles(mesh);
+	tree.ray_cast_batch(origins, directions, r_hits, [&](const int index, const float3 &ray_origin, const float3 &ray_direction, rose::BVHTreeRayHit &hit) {
+		triangles.ray_cast(index, ray_origin, ray_direction, hit);
+	});
+}
+
+void KER_mesh_bvh_find_nearest_batch(const Mesh *mesh, const rose::Span<float3> cos, rose::MutableSpan<rose::BVHTreeNearest> r_nearest) {
+	const rose::BVHTree &tree = KER_mesh_looptris_bvh(mesh);
+	const MeshBVHTriangles triangles(mesh);
+	tree.find_nearest_batch(cos, r_nearest, [&](const int index, const float3 &query_co, rose::BVHTreeNearest &nearest) {
+		triangles.find_nearest(index, query_co, nearest);
+	});
+}
+
+/** \} */
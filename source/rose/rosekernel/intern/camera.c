@@ -10,6 +10,8 @@
 #include "LIB_math_matrix.h"
 #include "LIB_rect.h"
 
+#include "RLO_read_write.h"
+
 /* -------------------------------------------------------------------- */
 /** \name Data-block Creation
  * \{ */
@@ -117,6 +119,12 @@ ROSE_INLINE void camera_free_data(ID *id) {
 	Camera *camera = (Camera *)id;
 }
 
+ROSE_INLINE void camera_write(RoseWriter *writer, ID *id, const void *id_address) {
+	Camera *camera = (Camera *)id;
+
+	RLO_write_id_struct(writer, Camera, id_address, &camera->id);
+}
+
 IDTypeInfo IDType_ID_CA = {
 	.idcode = ID_CA,
 
@@ -136,7 +144,7 @@ IDTypeInfo IDType_ID_CA = {
 
 	.foreach_id = NULL,
 
-	.write = NULL,
+	.write = camera_write,
 	.read_data = NULL,
 };
 
@@ -11,6 +11,8 @@
 
 #include "DEG_depsgraph.h"
 
+#include "RLO_read_write.h"
+
 /* -------------------------------------------------------------------- */
 /** \name Prototypes
  * \{ */
@@ -80,6 +82,44 @@ ROSE_STATIC void collection_foreach_id(ID *id, struct LibraryForeachIDData *data
 	}
 }
 
+void KER_collection_rose_write_prepare_nolib(Collection *collection) {
+	/** Runtime data is never written, the caches and the parents are rebuilt after reading. */
+	LIB_listbase_clear(&collection->object_cache);
+	LIB_listbase_clear(&collection->object_cache_instanced);
+	LIB_listbase_clear(&collection->parents);
+
+	collection->flag &= ~(COLLECTION_HAS_OBJECT_CACHE | COLLECTION_HAS_OBJECT_CACHE_INSTANCED);
+}
+
+void KER_collection_rose_write_nolib(RoseWriter *writer, Collection *collection) {
+	RLO_write_struct_list(writer, CollectionObject, &collection->objects);
+	RLO_write_struct_list(writer, CollectionChild, &collection->children);
+}
+
+ROSE_STATIC void collection_write(RoseWriter *writer, ID *id, const void *id_address) {
+	Collection *collection = (Collection *)id;
+
+	KER_collection_rose_write_prepare_nolib(collection);
+
+	RLO_write_id_struct(writer, Collection, id_address, &collection->id);
+	KER_collection_rose_write_nolib(writer, collection);
+}
+
+void KER_collection_rose_read_data(RoseDataReader *reader, Collection *collection) {
+	RLO_read_struct_list(reader, CollectionObject, &collection->objects);
+	RLO_read_struct_list(reader, CollectionChild, &collection->children);
+
+	LIB_listbase_clear(&collection->object_cache);
+	LIB_listbase_clear(&collection->object_cache_instanced);
+	LIB_listbase_clear(&collection->parents);
+
+	collection->flag &= ~(COLLECTION_HAS_OBJECT_CACHE | COLLECTION_HAS_OBJECT_CACHE_INSTANCED);
+}
+
+ROSE_STATIC void collection_read_data(RoseDataReader *reader, ID *id) {
+	KER_collection_rose_read_data(reader, (Collection *)id);
+}
+
 /** This will return the #Scene that owns the #Collection. */
 ROSE_STATIC ID *collection_owner_get(Main *main, ID *id) {
 	if ((id->flag & ID_FLAG_EMBEDDED_DATA) == 0) {
@@ -345,6 +385,43 @@ bool KER_collection_is_empty(const Collection *collection) {
 
 /** \} */
 
+/* -------------------------------------------------------------------- */
+/** \name Collection Parents
+ * \{ */
+
+ROSE_STATIC void collection_parents_rebuild(Collection *collection) {
+	LISTBASE_FOREACH(CollectionChild *, child, &collection->children) {
+		if (child->collection == NULL) {
+			continue;
+		}
+		CollectionParent *cparent = MEM_mallocN(sizeof(CollectionParent), "CollectionParent");
+		cparent->collection = collection;
+		LIB_addtail(&child->collection->parents, cparent);
+	}
+}
+
+void KER_main_collections_parent_relations_rebuild(Main *main) {
+	LISTBASE_FOREACH(Collection *, collection, &main->collections) {
+		LIB_freelistN(&collection->parents);
+	}
+	LISTBASE_FOREACH(Scene *, scene, &main->scenes) {
+		if (scene->master_collection) {
+			LIB_freelistN(&scene->master_collection->parents);
+		}
+	}
+
+	LISTBASE_FOREACH(Collection *, collection, &main->collections) {
+		collection_parents_rebuild(collection);
+	}
+	LISTBASE_FOREACH(Scene *, scene, &main->scenes) {
+		if (scene->master_collection) {
+			collection_parents_rebuild(scene->master_collection);
+		}
+	}
+}
+
+/** \} */
+
 /* -------------------------------------------------------------------- */
 /** \name Object List Cache
  * \{ */
@@ -613,8 +690,8 @@ IDTypeInfo IDType_ID_GR = {
 
 	.foreach_id = collection_foreach_id,
 
-	.write = NULL,
-	.read_data = NULL,
+	.write = collection_write,
+	.read_data = collection_read_data,
 };
 
 /** \} */
@@ -31,6 +31,8 @@
 #include "KER_customdata.h"
 #include "KER_main.h"
 
+#include "RLO_read_write.h"
+
 #include <inttypes.h>
 #include <optional>
 
@@ -2753,6 +2755,263 @@ bool CustomData_layer_validate(CustomDataLayer *layer, const uint totitems, cons
 
 /** \} */
 
+/* -------------------------------------------------------------------- */
+/** \name Rose File I/O
+ * \{ */
+
+static bool customdata_layer_is_written(const CustomDataLayer &layer) {
+	if (layer.data == nullptr || (layer.flag & CD_FLAG_NOCOPY) != 0) {
+		return false;
+	}
+	switch (layer.type) {
+		case CD_MDEFORMVERT:
+		case CD_NORMAL:
+		case CD_PROP_FLOAT:
+		case CD_PROP_INT32:
+		case CD_PROP_STRING:
+		case CD_PROP_BYTE_COLOR:
+		case CD_PROP_INT8:
+		case CD_PROP_INT16_2D:
+		case CD_PROP_INT32_2D:
+		case CD_PROP_COLOR:
+		case CD_PROP_FLOAT3:
+		case CD_PROP_FLOAT2:
+		case CD_PROP_BOOL:
+		case CD_HAIRLENGTH:
+			return true;
+	}
+	return false;
+}
+
+CustomDataLayer *CustomData_rose_write_prepare(CustomData *data) {
+	CustomDataLayer *layers_to_write = nullptr;
+	int count = 0;
+
+	if (data->totlayer > 0) {
+		layers_to_write = static_cast<CustomDataLayer *>(MEM_mallocN(sizeof(CustomDataLayer) * data->totlayer, __func__));
+		for (int i = 0; i < data->totlayer; i++) {
+			if (customdata_layer_is_written(data->layers[i])) {
+				CustomDataLayer &layer = layers_to_write[count++];
+				layer = data->layers[i];
+				layer.sharing_info = nullptr;
+			}
+		}
+	}
+	if (count == 0) {
+		MEM_SAFE_FREE(layers_to_write);
+		data->layers = nullptr;
+	}
+
+	data->totlayer = count;
+	data->maxlayer = count;
+	data->totsize = 0;
+	data->pool = nullptr;
+
+	return layers_to_write;
+}
+
+static void write_mdeformverts(RoseWriter *writer, const int count, const MDeformVert *dverts) {
+	RLO_write_struct_array(writer, MDeformVert, count, dverts);
+
+	int totweight = 0;
+	const MDeformWeight *first_dw = nullptr;
+	for (int i = 0; i < count; i++) {
+		if (dverts[i].dw && dverts[i].totweight > 0) {
+			first_dw = (first_dw) ? first_dw : dverts[i].dw;
+			totweight += dverts[i].totweight;
+		}
+	}
+	if (totweight == 0) {
+		return;
+	}
+
+	/**
+	 * The weights of all the vertices are written as a single block, stored at the address of the
+	 * first weight array, see #read_mdeformverts.
+	 */
+	MDeformWeight *weights = static_cast<MDeformWeight *>(MEM_mallocN(sizeof(MDeformWeight) * totweight, __func__));
+	int offset = 0;
+	for (int i = 0; i < count; i++) {
+		if (dverts[i].dw && dverts[i].totweight > 0) {
+			memcpy(&weights[offset], dverts[i].dw, sizeof(MDeformWeight) * dverts[i].totweight);
+			offset += dverts[i].totweight;
+		}
+	}
+	RLO_write_struct_array_at_address(writer, MDeformWeight, totweight, first_dw, weights);
+	MEM_freeN(weights);
+}
+
+static void write_layer_data(RoseWriter *writer, const CustomDataLayer &layer, const int count) {
+	switch (layer.type) {
+		case CD_MDEFORMVERT:
+			write_mdeformverts(writer, count, static_cast<const MDeformVert *>(layer.data));
+			break;
+		case CD_PROP_FLOAT:
+		case CD_HAIRLENGTH:
+			RLO_write_float_array(writer, count, static_cast<const float *>(layer.data));
+			break;
+		case CD_PROP_FLOAT2:
+			RLO_write_float_array(writer, count * 2, static_cast<const float *>(layer.data));
+			break;
+		case CD_NORMAL:
+		case CD_PROP_FLOAT3:
+			RLO_write_float_array(writer, count * 3, static_cast<const float *>(layer.data));
+			break;
+		case CD_PROP_COLOR:
+			RLO_write_float_array(writer, count * 4, static_cast<const float *>(layer.data));
+			break;
+		case CD_PROP_INT32:
+			RLO_write_int32_array(writer, count, static_cast<const int32_t *>(layer.data));
+			break;
+		case CD_PROP_INT32_2D:
+			RLO_write_int32_array(writer, count * 2, static_cast<const int32_t *>(layer.data));
+			break;
+		case CD_PROP_INT16_2D:
+			RLO_write_int16_array(writer, count * 2, static_cast<const int16_t *>(layer.data));
+			break;
+		case CD_PROP_INT8:
+			RLO_write_int8_array(writer, count, static_cast<const int8_t *>(layer.data));
+			break;
+		case CD_PROP_STRING:
+		case CD_PROP_BYTE_COLOR:
+		case CD_PROP_BOOL:
+			RLO_write_uint8_array(writer, count * LAYERTYPEINFO[layer.type].size, static_cast<const uint8_t *>(layer.data));
+			break;
+		default:
+			ROSE_assert_unreachable();
+			break;
+	}
+}
+
+void CustomData_rose_write(RoseWriter *writer, const CustomData *data, const CustomDataLayer *layers_to_write, const int count) {
+	if (data->totlayer == 0) {
+		return;
+	}
+
+	RLO_write_struct_array_at_address(writer, CustomDataLayer, data->totlayer, data->layers, layers_to_write);
+	for (int i = 0; i < data->totlayer; i++) {
+		write_layer_data(writer, layers_to_write[i], count);
+	}
+
+	if (data->external) {
+		RLO_write_struct(writer, CustomDataExternal, data->external);
+	}
+}
+
+static void read_mdeformverts(RoseDataReader *reader, const int count, MDeformVert **dverts_p) {
+	RLO_read_struct_array(reader, MDeformVert, count, dverts_p);
+
+	MDeformVert *dverts = *dverts_p;
+	if (dverts == nullptr) {
+		return;
+	}
+
+	int totweight = 0;
+	MDeformWeight *weights = nullptr;
+	for (int i = 0; i < count; i++) {
+		if (dverts[i].dw && dverts[i].totweight > 0) {
+			weights = (weights) ? weights : dverts[i].dw;
+			totweight += dverts[i].totweight;
+		}
+	}
+	if (totweight > 0) {
+		RLO_read_struct_array(reader, MDeformWeight, totweight, &weights);
+	}
+
+	/** Each vertex owns its weights, split the block that was written by #write_mdeformverts. */
+	int offset = 0;
+	for (int i = 0; i < count; i++) {
+		if (weights && dverts[i].dw && dverts[i].totweight > 0) {
+			dverts[i].dw = static_cast<MDeformWeight *>(MEM_mallocN(sizeof(MDeformWeight) * dverts[i].totweight, "MDeformWeight"));
+			memcpy(dverts[i].dw, &weights[offset], sizeof(MDeformWeight) * dverts[i].totweight);
+			offset += dverts[i].totweight;
+		}
+		else {
+			dverts[i].dw = nullptr;
+			dverts[i].totweight = 0;
+		}
+	}
+	MEM_SAFE_FREE(weights);
+}
+
+static void read_layer_data(RoseDataReader *reader, CustomDataLayer &layer, const int count) {
+	switch (layer.type) {
+		case CD_MDEFORMVERT:
+			read_mdeformverts(reader, count, reinterpret_cast<MDeformVert **>(&layer.data));
+			break;
+		case CD_PROP_FLOAT:
+		case CD_HAIRLENGTH:
+			RLO_read_float_array(reader, count, reinterpret_cast<float **>(&layer.data));
+			break;
+		case CD_PROP_FLOAT2:
+			RLO_read_float_array(reader, count * 2, reinterpret_cast<float **>(&layer.data));
+			break;
+		case CD_NORMAL:
+		case CD_PROP_FLOAT3:
+			RLO_read_float_array(reader, count * 3, reinterpret_cast<float **>(&layer.data));
+			break;
+		case CD_PROP_COLOR:
+			RLO_read_float_array(reader, count * 4, reinterpret_cast<float **>(&layer.data));
+			break;
+		case CD_PROP_INT32:
+			RLO_read_int32_array(reader, count, reinterpret_cast<int32_t **>(&layer.data));
+			break;
+		case CD_PROP_INT32_2D:
+			RLO_read_int32_array(reader, count * 2, reinterpret_cast<int32_t **>(&layer.data));
+			break;
+		case CD_PROP_INT16_2D:
+			RLO_read_int16_array(reader, count * 2, reinterpret_cast<int16_t **>(&layer.data));
+			break;
+		case CD_PROP_INT8:
+			RLO_read_int8_array(reader, count, reinterpret_cast<int8_t **>(&layer.data));
+			break;
+		case CD_PROP_STRING:
+		case CD_PROP_BYTE_COLOR:
+		case CD_PROP_BOOL:
+			RLO_read_uint8_array(reader, count * LAYERTYPEINFO[layer.type].size, reinterpret_cast<uint8_t **>(&layer.data));
+			break;
+		default:
+			/** Unknown layer types are never written. */
+			layer.data = nullptr;
+			break;
+	}
+}
+
+void CustomData_rose_read(RoseDataReader *reader, CustomData *data, const int count) {
+	RLO_read_struct_array(reader, CustomDataLayer, data->totlayer, &data->layers);
+	if (data->layers == nullptr) {
+		data->totlayer = 0;
+	}
+
+	data->maxlayer = data->totlayer;
+	data->pool = nullptr;
+
+	int i = 0;
+	while (i < data->totlayer) {
+		CustomDataLayer *layer = &data->layers[i];
+
+		layer->sharing_info = nullptr;
+		read_layer_data(reader, *layer, count);
+		if (layer->data == nullptr && count > 0 && !CustomData_layer_ensure_data_exists(layer, count)) {
+			/** Drop the layer instead of keeping one without data. */
+			memmove(layer, layer + 1, sizeof(CustomDataLayer) * (data->totlayer - i - 1));
+			data->totlayer--;
+			continue;
+		}
+		if (layer->data) {
+			layer->sharing_info = make_implicit_sharing_info_for_layer(eCustomDataType(layer->type), layer->data, count);
+		}
+		i++;
+	}
+
+	RLO_read_struct(reader, CustomDataExternal, &data->external);
+
+	customData_update_offsets(data);
+	CustomData_update_typemap(data);
+}
+
+/** \} */
+
 size_t CustomData_get_elem_size(const CustomDataLayer *layer) {
 	return LAYERTYPEINFO[layer->type].size;
 }
@@ -0,0 +1,34 @@
+#include "LIB_array_utils.hh"
+#include "LIB_task.hh"
+
+#include "KER_deform.hh"
+
+#include <algorithm>
+
+/* -------------------------------------------------------------------- */
+/** \name Deform Weights
+ * \{ */
+
+namespace rose::kernel {
+
+void deform_weights_from_dverts(Span<MDeformVert> dverts, DeformWeights &r_weights) {
+	r_weights.offsets.reinitialize(dverts.size() + 1);
+	for (const size_t index : dverts.index_range()) {
+		r_weights.offsets[index] = dverts[index].dw ? dverts[index].totweight : 0;
+	}
+	const OffsetIndices<int> offsets = offset_indices::accumulate_counts_to_offsets(r_weights.offsets);
+
+	r_weights.weights.reinitialize(offsets.total_size());
+	threading::parallel_for(dverts.index_range(), 4096, [&](const IndexRange range) {
+		for (const size_t index : range) {
+			const IndexRange group = offsets[index];
+			if (!group.is_empty()) {
+				std::copy_n(dverts[index].dw, group.size(), &r_weights.weights[group.first()]);
+			}
+		}
+	});
+}
+
+}  // namespace rose::kernel
+
+/** \} */
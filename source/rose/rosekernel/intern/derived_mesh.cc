@@ -1,3 +1,5 @@
+#include "MEM_guardedalloc.h"
+
 #include "KER_derived_mesh.h"
 #include "KER_layer.h"
 #include "KER_mesh.hh"
@@ -49,7 +51,6 @@ ROSE_INLINE void mesh_calc_modifiers(Depsgraph *depsgraph, Scene *scene, Object
 	 * multiple sequential deform only modifiers. */
 	float (*deformed_verts)[3] = NULL;
 	int num_deformed_verts = mesh_input->totvert;
-	bool is_prev_deform = false;
 
 	ModifierEvalContext mectx;
 	mectx.object = ob;
@@ -66,13 +67,15 @@ ROSE_INLINE void mesh_calc_modifiers(Depsgraph *depsgraph, Scene *scene, Object
 				break;
 			}
 
-			if (md->flag & MODIFIER_DEVICE_ONLY) {
+			if (KER_modifier_is_device_evaluated(md)) {
 				continue;
 			}
 
-			// TODO!
-
-			ROSE_assert_unreachable();
+			if (!deformed_verts) {
+				deformed_verts = KER_mesh_vert_coords_alloc(mesh_input, &num_deformed_verts);
+			}
+			/* The input mesh is only read (e.g. the vertex groups), the positions live in the array. */
+			KER_modifier_deform_verts(md, &mectx, mesh_input, deformed_verts, num_deformed_verts);
 		}
 
 		/* Result of all leading deforming modifiers is cached for
@@ -82,7 +85,7 @@ ROSE_INLINE void mesh_calc_modifiers(Depsgraph *depsgraph, Scene *scene, Object
 			mesh_deform = KER_mesh_copy_for_eval(mesh_input, true);
 
 			if (deformed_verts) {
-				ROSE_assert_unreachable();
+				KER_mesh_vert_coords_apply(mesh_deform, deformed_verts);
 			}
 		}
 	}
@@ -96,13 +99,20 @@ ROSE_INLINE void mesh_calc_modifiers(Depsgraph *depsgraph, Scene *scene, Object
 			continue;
 		}
 
-		if (md->flag & MODIFIER_DEVICE_ONLY) {
+		if (KER_modifier_is_device_evaluated(md)) {
 			continue;
 		}
 
-		// TODO!
+		/* #OnlyDeform is the only type of modifier there is, see #eModifierInfoType. */
+		ROSE_assert(mti->type == OnlyDeform);
 
-		ROSE_assert_unreachable();
+		/* No constructive modifier ran, the positions of the final mesh (if any) are still the
+		 * ones of the input mesh until the deformed ones are applied. */
+		Mesh *mesh = (mesh_final) ? mesh_final : mesh_input;
+		if (!deformed_verts) {
+			deformed_verts = KER_mesh_vert_coords_alloc(mesh, &num_deformed_verts);
+		}
+		KER_modifier_deform_verts(md, &mectx, mesh, deformed_verts, num_deformed_verts);
 	}
 
 	/* Yay, we are done. If we have a Mesh and deformed vertices,
@@ -117,7 +127,10 @@ ROSE_INLINE void mesh_calc_modifiers(Depsgraph *depsgraph, Scene *scene, Object
 		}
 	}
 	if (deformed_verts) {
-		ROSE_assert_unreachable();
+		/* A single copy of the positions, whatever the number of consecutive deform modifiers. */
+		KER_mesh_vert_coords_apply(mesh_final, deformed_verts);
+		MEM_freeN(deformed_verts);
+		deformed_verts = NULL;
 	}
 
 	/* Denotes whether the object which the modifier stack came from owns the mesh or whether the
@@ -8,10 +8,16 @@
 #include "LIB_math_vector.h"
 #include "LIB_listbase.h"
 #include "LIB_string.h"
+#include "LIB_task.h"
 #include "LIB_utildefines.h"
 
+#include "KER_action.h"
 #include "KER_fcurve.h"
 
+#include "RLO_read_write.h"
+
+#include "atomic_ops.h"
+
 #define SMALL -1.0e-10
 
 /* -------------------------------------------------------------------- */
@@ -36,10 +42,12 @@ FCurve *KER_fcurve_copy(const struct FCurve *fcu) {
 	fcu_d = MEM_dupallocN(fcu);
 	fcu_d->next = fcu_d->prev = NULL;
 	fcu_d->group = NULL;
+	fcu_d->runtime.channelbag = NULL;
 
 	/* Copy curve data. */
 	fcu_d->bezt = MEM_dupallocN(fcu_d->bezt);
 	fcu_d->fpt = MEM_dupallocN(fcu_d->fpt);
+	fcu_d->runtime.baked = MEM_dupallocN(fcu_d->runtime.baked);
 
 	/* Copy rna-path. */
 	fcu_d->path = MEM_dupallocN(fcu_d->path);
@@ -70,10 +78,37 @@ void KER_fcurve_free(FCurve *fcurve) {
 	MEM_SAFE_FREE(fcurve->bezt);
 	MEM_SAFE_FREE(fcurve->fpt);
 	MEM_SAFE_FREE(fcurve->path);
+	KER_fcurve_bake_free(fcurve);
 	
 	MEM_freeN(fcurve);
 }
 
+void KER_fcurve_rose_write_data(RoseWriter *writer, FCurve *fcurve) {
+	/** Keyframes and samples are written as single blocks, each one is read back with one read. */
+	if (fcurve->bezt) {
+		RLO_write_struct_array(writer, BezTriple, fcurve->totvert, fcurve->bezt);
+	}
+	if (fcurve->fpt) {
+		RLO_write_float_array(writer, fcurve->totvert * 2, (const float *)fcurve->fpt);
+	}
+	if (fcurve->path) {
+		RLO_write_string(writer, fcurve->path);
+	}
+}
+
+void KER_fcurve_rose_read_data(RoseDataReader *reader, FCurve *fcurve) {
+	fcurve->prev = NULL;
+	fcurve->next = NULL;
+	/** Groups are owned by the channel-bag, they are assigned again when it is read. */
+	fcurve->group = NULL;
+
+	memset(&fcurve->runtime, 0, sizeof(fcurve->runtime));
+
+	RLO_read_struct_array(reader, BezTriple, fcurve->totvert, &fcurve->bezt);
+	RLO_read_float_array(reader, fcurve->totvert * 2, (float **)&fcurve->fpt);
+	RLO_read_data_address(reader, &fcurve->path);
+}
+
 /** \} */
 
 /* -------------------------------------------------------------------- */
@@ -134,6 +169,27 @@ ROSE_INLINE int KER_fcurve_bezt_binarysearch_index_ex(const BezTriple *array, co
 	return start;
 }
 
+/**
+ * Most evaluations happen close to the previous one, so the segment of the last evaluation and the
+ * one after it are checked before searching all the keyframes. Only segments the evaluation time is
+ * strictly inside of are accepted, the binary search handles the times on top of keyframes.
+ *
+ * \return The index of the keyframe ending the segment, -1 when the search is needed.
+ */
+ROSE_INLINE int fcurve_bezt_cursor_index(const BezTriple *array, const float frame, const int length, const float threshold, int *cursor) {
+	/* The cursor is only a hint, concurrent evaluations of the same curve may overwrite it. */
+	const int hint = atomic_load_int32(cursor);
+	for (int a = hint; a <= hint + 1; a++) {
+		if (a < 1 || a >= length) {
+			continue;
+		}
+		if (frame - array[a - 1].vec[1][0] >= threshold && array[a].vec[1][0] - frame >= threshold) {
+			return a;
+		}
+	}
+	return -1;
+}
+
 /** \} */
 
 /* -------------------------------------------------------------------- */
@@ -371,9 +427,10 @@ ROSE_INLINE float fcurve_eval_keyframes_extrapolate(const FCurve *fcu, const Bez
 	return endpoint_bezt->vec[1][1] - (fac * dx);
 }
 
-static float fcurve_eval_keyframes_interpolate(const FCurve *fcu, const BezTriple *bezts, float evaltime) {
+static float fcurve_eval_keyframes_interpolate(const FCurve *fcu, const BezTriple *bezts, float evaltime, int *cursor) {
 	const float eps = 1.e-8f;
-	uint a;
+	const float threshold = 0.0001f;
+	int a;
 
 	/* Evaluation-time occurs somewhere in the middle of the curve. */
 	bool exact = false;
@@ -387,7 +444,10 @@ static float fcurve_eval_keyframes_interpolate(const FCurve *fcu, const BezTripl
 	 * - 0.00001 is too fine:
 	 *   Weird errors, like selecting the wrong keyframe range, occur.
 	 */
-	a = KER_fcurve_bezt_binarysearch_index_ex(bezts, evaltime, fcu->totvert, 0.0001, &exact);
+	if ((a = fcurve_bezt_cursor_index(bezts, evaltime, fcu->totvert, threshold, cursor)) == -1) {
+		a = KER_fcurve_bezt_binarysearch_index_ex(bezts, evaltime, fcu->totvert, threshold, &exact);
+		atomic_store_int32(cursor, a);
+	}
 	const BezTriple *bezt = bezts + a;
 
 	if (exact) {
@@ -473,7 +533,7 @@ static float fcurve_eval_keyframes_interpolate(const FCurve *fcu, const BezTripl
 }
 
 /* Calculate F-Curve value for 'evaltime' using #BezTriple keyframes. */
-ROSE_INLINE float fcurve_eval_keyframes(const FCurve *fcu, const BezTriple *bezts, float evaltime) {
+ROSE_INLINE float fcurve_eval_keyframes(const FCurve *fcu, const BezTriple *bezts, float evaltime, int *cursor) {
 	if (evaltime < bezts->vec[1][0]) {
 		return fcurve_eval_keyframes_extrapolate(fcu, bezts, evaltime, 0, +1);
 	}
@@ -483,7 +543,7 @@ ROSE_INLINE float fcurve_eval_keyframes(const FCurve *fcu, const BezTriple *bezt
 		return fcurve_eval_keyframes_extrapolate(fcu, bezts, evaltime, fcu->totvert - 1, -1);
 	}
 
-	return fcurve_eval_keyframes_interpolate(fcu, bezts, evaltime);
+	return fcurve_eval_keyframes_interpolate(fcu, bezts, evaltime, cursor);
 }
 
 /* Calculate F-Curve value for 'evaltime' using #FPoint samples. */
@@ -521,9 +581,37 @@ ROSE_INLINE float fcurve_eval_samples(const FCurve *fcu, const FPoint *fpts, flo
 	return cvalue;
 }
 
+/**
+ * Linear interpolation of the baked samples, the caller makes sure that the time is within the
+ * baked range.
+ */
+ROSE_INLINE float fcurve_eval_baked(const FCurve *fcurve, float ctime) {
+	const FCurve_Runtime *runtime = &fcurve->runtime;
+
+	const float position = (ctime - runtime->baked_start) * runtime->baked_rate;
+	const int index = (int)position;
+	if (index >= runtime->totbaked - 1) {
+		return runtime->baked[runtime->totbaked - 1];
+	}
+	return interpf(runtime->baked[index + 1], runtime->baked[index], position - (float)index);
+}
+
+ROSE_INLINE bool fcurve_baked_contains(const FCurve *fcurve, float ctime) {
+	const FCurve_Runtime *runtime = &fcurve->runtime;
+	if (runtime->baked == NULL) {
+		return false;
+	}
+	const float baked_end = runtime->baked_start + (float)(runtime->totbaked - 1) / runtime->baked_rate;
+	return runtime->baked_start <= ctime && ctime <= baked_end;
+}
+
 ROSE_INLINE float fcurve_evaluate_ex(FCurve *fcurve, float ctime, float cvalue) {
-	if (fcurve->bezt) {
-		cvalue = fcurve_eval_keyframes(fcurve, fcurve->bezt, ctime);
+	if (fcurve_baked_contains(fcurve, ctime)) {
+		/* Extrapolation outside of the keyframes is cheap, it never uses the samples. */
+		cvalue = fcurve_eval_baked(fcurve, ctime);
+	}
+	else if (fcurve->bezt) {
+		cvalue = fcurve_eval_keyframes(fcurve, fcurve->bezt, ctime, &fcurve->runtime.cursor);
 	}
 	else if (fcurve->fpt) {
 		cvalue = fcurve_eval_samples(fcurve, fcurve->fpt, ctime);
@@ -550,6 +638,70 @@ float KER_fcurve_evaluate(PathResolvedRNA *rna, FCurve *fcurve, float ctime) {
 
 /** \} */
 
+/* -------------------------------------------------------------------- */
+/** \name F-Curve Bake
+ * \{ */
+
+void KER_fcurve_bake_samples(FCurve *fcurve, float rate) {
+	KER_fcurve_bake_free(fcurve);
+
+	if (fcurve->bezt == NULL || fcurve->totvert < 2 || rate <= 0.0f) {
+		return;
+	}
+
+	const float start = fcurve->bezt[0].vec[1][0];
+	const float end = fcurve->bezt[fcurve->totvert - 1].vec[1][0];
+	if (!(start < end)) {
+		return;
+	}
+
+	/* The spacing is adjusted so that the last sample lands on the last keyframe, long curves use
+	 * fewer samples per frame rather than an unbounded amount of memory. */
+	const float count = ceilf((end - start) * rate) + 1.0f;
+	const int totbaked = (count < (float)FCURVE_BAKE_SAMPLES_MAX) ? (int)count : FCURVE_BAKE_SAMPLES_MAX;
+	float *baked = MEM_mallocN(sizeof(float) * totbaked, "FCurve::runtime.baked");
+
+	int cursor = 0;
+	for (int index = 0; index < totbaked; index++) {
+		const float ctime = (index == totbaked - 1) ? end : start + (end - start) * ((float)index / (float)(totbaked - 1));
+		baked[index] = fcurve_eval_keyframes(fcurve, fcurve->bezt, ctime, &cursor);
+	}
+
+	fcurve->runtime.baked_start = start;
+	fcurve->runtime.baked_rate = (float)(totbaked - 1) / (end - start);
+	fcurve->runtime.totbaked = totbaked;
+	fcurve->runtime.baked = baked;
+}
+
+typedef struct FCurvesBakeData {
+	FCurve **fcurves;
+	float rate;
+} FCurvesBakeData;
+
+ROSE_STATIC void fcurves_bake_samples_fn(void *__restrict userdata, int index, const TaskParallelTLS *__restrict tls) {
+	FCurvesBakeData *data = (FCurvesBakeData *)userdata;
+	KER_fcurve_bake_samples(data->fcurves[index], data->rate);
+}
+
+void KER_fcurves_bake_samples(FCurve **fcurves, int totcurve, float rate) {
+	FCurvesBakeData data = {
+		.fcurves = fcurves,
+		.rate = rate,
+	};
+
+	TaskParallelSettings settings;
+	LIB_parallel_range_settings_defaults(&settings);
+	settings.min_iter_per_thread = 4;
+	LIB_task_parallel_range(0, totcurve, &data, fcurves_bake_samples_fn, &settings);
+}
+
+void KER_fcurve_bake_free(FCurve *fcurve) {
+	MEM_SAFE_FREE(fcurve->runtime.baked);
+	fcurve->runtime.totbaked = 0;
+}
+
+/** \} */
+
 /* -------------------------------------------------------------------- */
 /** \name F-Curve Edit
  * \{ */
@@ -557,6 +709,8 @@ float KER_fcurve_evaluate(PathResolvedRNA *rna, FCurve *fcurve, float ctime) {
 void KER_fcurve_bezt_resize(FCurve *fcurve, int totvert) {
 	ROSE_assert(totvert >= 0);
 
+	KER_fcurve_bake_free(fcurve);
+
 	if (totvert == 0) {
 		fcurve_bezt_free(fcurve);
 		return;
@@ -582,6 +736,10 @@ void KER_fcurve_path_set_ex(FCurve *fcurve, const char *newpath, bool compile) {
 		 * Copy the new path over and invalidate the runtime canonical path.
 		 */
 		fcurve->path = LIB_strdupN(newpath);
+
+		if (fcurve->runtime.channelbag) {
+			KER_action_channelbag_tag_changed(fcurve->runtime.channelbag);
+		}
 	}
 }
 
@@ -1384,7 +1542,14 @@ void KER_fcurve_handles_recalc(FCurve *fcu) {
 }
 
 void KER_fcurve_handles_recalc_ex(FCurve *fcu, int flag) {
-	if (ELEM(NULL, fcu, fcu->bezt) || (fcu->totvert < 2)) {
+	if (fcu == NULL) {
+		return;
+	}
+
+	/* The keyframes were edited, the samples no longer match them. */
+	KER_fcurve_bake_free(fcu);
+
+	if (fcu->bezt == NULL || (fcu->totvert < 2)) {
 		return;
 	}
 
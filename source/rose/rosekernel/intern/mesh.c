@@ -1,13 +1,19 @@
 #include "MEM_guardedalloc.h"
 
+#include "DNA_object_types.h"
+
 #include "LIB_listbase.h"
 
+#include "KER_anim_data.h"
+#include "KER_customdata.h"
 #include "KER_deform.h"
 #include "KER_idtype.h"
 #include "KER_lib_id.h"
 #include "KER_main.h"
 #include "KER_mesh.h"
 
+#include "RLO_read_write.h"
+
 void KER_mesh_copy_data(Main *main, Mesh *dst, const Mesh *src, int flag) {
 	CustomData_MeshMasks mask = CD_MASK_MESH;
 
@@ -35,6 +41,7 @@ void KER_mesh_copy_data(Main *main, Mesh *dst, const Mesh *src, int flag) {
 	else {
 		CustomData_reset(&dst->fdata);
 	}
+	KER_mesh_runtime_share_topology_caches(dst, src);
 
 	KER_mesh_normals_tag_dirty(dst);
 }
@@ -73,6 +80,60 @@ ROSE_STATIC void mesh_free_data(ID *id) {
 	LIB_freelistN(&mesh->vertex_group_names);
 }
 
+ROSE_STATIC void mesh_write(RoseWriter *writer, ID *id, const void *id_address) {
+	Mesh *mesh = (Mesh *)id;
+
+	/** Runtime data is never written, it is created again when reading. */
+	mesh->runtime = NULL;
+
+	CustomDataLayer *vlayers = CustomData_rose_write_prepare(&mesh->vdata);
+	CustomDataLayer *elayers = CustomData_rose_write_prepare(&mesh->edata);
+	CustomDataLayer *flayers = CustomData_rose_write_prepare(&mesh->fdata);
+	CustomDataLayer *players = CustomData_rose_write_prepare(&mesh->pdata);
+	CustomDataLayer *llayers = CustomData_rose_write_prepare(&mesh->ldata);
+
+	RLO_write_id_struct(writer, Mesh, id_address, &mesh->id);
+	KER_animdata_rose_write(writer, id);
+
+	RLO_write_struct_list(writer, DeformGroup, &mesh->vertex_group_names);
+
+	CustomData_rose_write(writer, &mesh->vdata, vlayers, mesh->totvert);
+	CustomData_rose_write(writer, &mesh->edata, elayers, mesh->totedge);
+	CustomData_rose_write(writer, &mesh->fdata, flayers, mesh->totface);
+	CustomData_rose_write(writer, &mesh->pdata, players, mesh->totpoly);
+	CustomData_rose_write(writer, &mesh->ldata, llayers, mesh->totloop);
+
+	if (mesh->poly_offset_indices) {
+		RLO_write_int32_array(writer, mesh->totpoly + 1, mesh->poly_offset_indices);
+	}
+
+	MEM_SAFE_FREE(vlayers);
+	MEM_SAFE_FREE(elayers);
+	MEM_SAFE_FREE(flayers);
+	MEM_SAFE_FREE(players);
+	MEM_SAFE_FREE(llayers);
+}
+
+ROSE_STATIC void mesh_read_data(RoseDataReader *reader, ID *id) {
+	Mesh *mesh = (Mesh *)id;
+
+	KER_animdata_rose_read_data(reader, id);
+
+	RLO_read_struct_list(reader, DeformGroup, &mesh->vertex_group_names);
+
+	CustomData_rose_read(reader, &mesh->vdata, mesh->totvert);
+	CustomData_rose_read(reader, &mesh->edata, mesh->totedge);
+	CustomData_rose_read(reader, &mesh->fdata, mesh->totface);
+	CustomData_rose_read(reader, &mesh->pdata, mesh->totpoly);
+	CustomData_rose_read(reader, &mesh->ldata, mesh->totloop);
+
+	RLO_read_int32_array(reader, mesh->totpoly + 1, &mesh->poly_offset_indices);
+
+	KER_mesh_runtime_init_data(mesh);
+	KER_mesh_poly_offsets_sharing_info_ensure(mesh);
+	KER_mesh_normals_tag_dirty(mesh);
+}
+
 IDTypeInfo IDType_ID_ME = {
 	.idcode = ID_ME,
 
@@ -92,8 +153,8 @@ IDTypeInfo IDType_ID_ME = {
 
 	.foreach_id = NULL,
 
-	.write = NULL,
-	.read_data = NULL,
+	.write = mesh_write,
+	.read_data = mesh_read_data,
 };
 
 /** \} */
@@ -82,6 +82,10 @@ void KER_mesh_geometry_clear(Mesh *mesh) {
 	CustomData_free(&mesh->fdata, mesh->totface);
 	CustomData_free(&mesh->ldata, mesh->totloop);
 	CustomData_free(&mesh->pdata, mesh->totpoly);
+	if (mesh->runtime) {
+		KER_mesh_runtime_clear_geometry(mesh);
+		KER_mesh_normals_tag_dirty(mesh);
+	}
 
 	if (mesh->poly_offset_indices) {
         rose::implicit_sharing::free_shared_data(&mesh->poly_offset_indices, &mesh->runtime->poly_offsets_sharing_info);
@@ -107,6 +111,12 @@ void KER_mesh_poly_offsets_ensure_alloc(Mesh *mesh) {
 	mesh->poly_offset_indices[mesh->totpoly] = mesh->totloop;
 }
 
+void KER_mesh_poly_offsets_sharing_info_ensure(Mesh *mesh) {
+	if (mesh->poly_offset_indices && mesh->runtime->poly_offsets_sharing_info == NULL) {
+		mesh->runtime->poly_offsets_sharing_info = rose::implicit_sharing::info_for_mem_free(mesh->poly_offset_indices);
+	}
+}
+
 void KER_mesh_ensure_required_data_layers(Mesh *mesh) {
 	CustomData_add_layer_named(&mesh->vdata, CD_PROP_FLOAT3, CD_SET_DEFAULT, mesh->totvert, "position");
 	CustomData_add_layer_named(&mesh->edata, CD_PROP_INT32_2D, CD_SET_DEFAULT, mesh->totedge, ".edge_verts");
@@ -131,4 +141,23 @@ int *KER_mesh_poly_offsets_for_write(Mesh *mesh) {
 	return mesh->poly_offset_indices;
 }
 
+float (*KER_mesh_vert_coords_alloc(const Mesh *mesh, int *r_vert_len))[3] {
+	const size_t size = sizeof(float[3]) * mesh->totvert;
+	float(*vert_coords)[3] = static_cast<float(*)[3]>(MEM_mallocN(ROSE_MAX(size, 1), "KER_mesh_vert_coords_alloc"));
+	if (size) {
+		memcpy(vert_coords, KER_mesh_vert_positions(mesh), size);
+	}
+	if (r_vert_len) {
+		*r_vert_len = mesh->totvert;
+	}
+	return vert_coords;
+}
+
+void KER_mesh_vert_coords_apply(Mesh *mesh, const float (*vert_coords)[3]) {
+	if (mesh->totvert) {
+		memcpy(KER_mesh_vert_positions_for_write(mesh), vert_coords, sizeof(float[3]) * mesh->totvert);
+	}
+	KER_mesh_positions_changed(mesh);
+}
+
 /** \} */
@@ -0,0 +1,159 @@
+#include "MEM_guardedalloc.h"
+
+#include "LIB_array.hh"
+#include "LIB_kdtree.hh"
+#include "LIB_map.hh"
+#include "LIB_task.hh"
+#include "LIB_vector.hh"
+#include "LIB_implicit_sharing.hh"
+
+#include "KER_customdata.h"
+#include "KER_mesh.h"
+#include "KER_mesh.hh"
+#include "KER_mesh_types.hh"
+
+/* -------------------------------------------------------------------- */
+/** \name Mesh Merge By Distance
+ * \{ */
+
+namespace rose::kernel {
+
+/** Replace the layers of \a data with the elements at \a src_indices, in that order. */
+ROSE_STATIC void customdata_gather(CustomData *data, const int src_num, const Span<int> src_indices) {
+	CustomData dst;
+	CustomData_copy_layout(data, &dst, CD_MASK_ALL, CD_CONSTRUCT, int(src_indices.size()));
+	for (const int dst_index : src_indices.index_range()) {
+		CustomData_copy_data(data, &dst, src_indices[dst_index], dst_index, 1);
+	}
+	CustomData_free(data, src_num);
+	*data = dst;
+}
+
+/**
+ * The vertex each vertex is merged into, with the indices of the vertices after the merge. Vertices
+ * that are kept get consecutive indices, the lowest index of every cluster keeps its attributes.
+ */
+ROSE_STATIC int calc_vert_map(const Span<float3> positions, const float merge_distance, MutableSpan<int> r_vert_map, Vector<int> &r_kept_verts) {
+	const KDTree_3d tree(positions);
+	Array<int> duplicates(positions.size());
+	tree.find_duplicates(merge_distance, duplicates);
+
+	for (const int vert : positions.index_range()) {
+		if (duplicates[vert] == -1) {
+			r_vert_map[vert] = int(r_kept_verts.size());
+			r_kept_verts.append(vert);
+		}
+	}
+	threading::parallel_for(positions.index_range(), 4096, [&](const IndexRange range) {
+		for (const int vert : range) {
+			if (duplicates[vert] != -1) {
+				r_vert_map[vert] = r_vert_map[duplicates[vert]];
+			}
+		}
+	});
+	return int(positions.size() - r_kept_verts.size());
+}
+
+}  // namespace rose::kernel
+
+int KER_mesh_merge_by_distance(Mesh *mesh, const float merge_distance) {
+	using namespace rose;
+	using namespace rose::kernel;
+
+	if (mesh->totvert == 0) {
+		return 0;
+	}
+
+	Array<int> vert_map(mesh->totvert);
+	Vector<int> kept_verts;
+	const int merged_num = calc_vert_map(KER_mesh_vert_positions_span(mesh), merge_distance, vert_map, kept_verts);
+	if (merged_num == 0) {
+		return 0;
+	}
+
+	/* Edges whose vertices were merged together disappear, edges connecting the same vertices after the merge are combined. */
+	const Span<int2> edges = KER_mesh_edges_span(mesh);
+	Array<int> edge_map(edges.size(), -1);
+	Vector<int> kept_edges;
+	Vector<int2> new_edges;
+	Map<int2, int> edge_by_verts;
+	for (const int edge : edges.index_range()) {
+		const int2 verts(vert_map[edges[edge][0]], vert_map[edges[edge][1]]);
+		if (verts[0] == verts[1]) {
+			continue;
+		}
+		const int2 key(std::min(verts[0], verts[1]), std::max(verts[0], verts[1]));
+		edge_map[edge] = edge_by_verts.lookup_or_add_cb(key, [&]() {
+			kept_edges.append(edge);
+			new_edges.append(verts);
+			return int(new_edges.size() - 1);
+		});
+	}
+
+	/**
+	 * A corner is dropped when it is merged with the next corner of its face, the edge of the corner
+	 * before it then leads to the vertex of the next kept corner. Faces left with less than three
+	 * corners are dropped, the edges they used stay as loose edges.
+	 */
+	const Span<int> poly_offsets = KER_mesh_poly_offsets_span(mesh);
+	const Span<int> corner_verts = KER_mesh_corner_verts_span(mesh);
+	const Span<int> corner_edges = KER_mesh_corner_edges_span(mesh);
+	Vector<int> kept_polys;
+	Vector<int> kept_corners;
+	Vector<int> new_poly_offsets;
+	for (const int poly : IndexRange(mesh->totpoly)) {
+		const IndexRange corners(poly_offsets[poly], poly_offsets[poly + 1] - poly_offsets[poly]);
+		const int64_t corners_start = kept_corners.size();
+		for (const int corner : corners) {
+			const int next = (corner + 1 == int(corners.one_after_last())) ? int(corners.start()) : corner + 1;
+			if (vert_map[corner_verts[corner]] != vert_map[corner_verts[next]]) {
+				kept_corners.append(corner);
+			}
+		}
+		if (kept_corners.size() - corners_start < 3) {
+			kept_corners.resize(corners_start);
+			continue;
+		}
+		kept_polys.append(poly);
+		new_poly_offsets.append(int(corners_start));
+	}
+	new_poly_offsets.append(int(kept_corners.size()));
+
+	Array<int> new_corner_verts(kept_corners.size());
+	Array<int> new_corner_edges(kept_corners.size());
+	threading::parallel_for(kept_corners.index_range(), 4096, [&](const IndexRange range) {
+		for (const int i : range) {
+			new_corner_verts[i] = vert_map[corner_verts[kept_corners[i]]];
+			new_corner_edges[i] = edge_map[corner_edges[kept_corners[i]]];
+		}
+	});
+
+	customdata_gather(&mesh->vdata, mesh->totvert, kept_verts);
+	customdata_gather(&mesh->edata, mesh->totedge, kept_edges);
+	customdata_gather(&mesh->ldata, mesh->totloop, kept_corners);
+	customdata_gather(&mesh->pdata, mesh->totpoly, kept_polys);
+
+	mesh->totvert = int(kept_verts.size());
+	mesh->totedge = int(kept_edges.size());
+	mesh->totloop = int(kept_corners.size());
+	mesh->totpoly = int(kept_polys.size());
+
+	KER_mesh_edges_for_write_span(mesh).copy_from(new_edges);
+	KER_mesh_corner_verts_for_write_span(mesh).copy_from(new_corner_verts);
+	KER_mesh_corner_edges_for_write_span(mesh).copy_from(new_corner_edges);
+
+	if (mesh->poly_offset_indices) {
+		implicit_sharing::free_shared_data(&mesh->poly_offset_indices, &mesh->runtime->poly_offsets_sharing_info);
+	}
+	KER_mesh_poly_offsets_ensure_alloc(mesh);
+	if (mesh->totpoly) {
+		KER_mesh_poly_offsets_for_write_span(mesh).copy_from(new_poly_offsets);
+	}
+
+	KER_mesh_runtime_clear_geometry(mesh);
+	KER_mesh_normals_tag_dirty(mesh);
+	KER_mesh_batch_cache_tag_dirty(mesh, KER_MESH_BATCH_DIRTY_ALL);
+	return merged_num;
+}
+
+/** \} */
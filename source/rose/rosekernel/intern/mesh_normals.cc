@@ -236,39 +236,45 @@ ROSE_STATIC float3 poly_normal_calc(const Span<float3> vert_positions, const Spa
 	return float3(0);
 }
 
-void normals_calc_polys(const Span<float3> positions, const OffsetIndices<int> polys, const Span<int> corner_verts, MutableSpan<float3> poly_normals) {
+/** Only the normals of the faces in \a mask are written. */
+static void normals_calc_polys(const Span<float3> positions, const OffsetIndices<int> polys, const Span<int> corner_verts, const IndexMask &mask, MutableSpan<float3> poly_normals) {
 	ROSE_assert(polys.size() == poly_normals.size());
-	threading::parallel_for(polys.index_range(), 1024, [&](const IndexRange range) {
-		for (const int i : range) {
-			poly_normals[i] = poly_normal_calc(positions, corner_verts.slice(polys[i]));
-		}
+	mask.foreach_index(GrainSize(1024), [&](const int i) {
+		poly_normals[i] = poly_normal_calc(positions, corner_verts.slice(polys[i]));
 	});
 }
 
-void normals_calc_verts(const Span<float3> positions, const OffsetIndices<int> polys, const Span<int> corner_verts, const GroupedSpan<int> vert_to_face_map, const Span<float3> poly_normals, MutableSpan<float3> vert_normals) {
-	threading::parallel_for(positions.index_range(), 1024, [&](const IndexRange range) {
-		for (const int vert_i : range) {
-			const Span<int> vert_faces = vert_to_face_map[vert_i];
-			if (vert_faces.is_empty()) {
-				vert_normals[vert_i] = math::normalize(positions[vert_i]);
-				continue;
-			}
+void normals_calc_polys(const Span<float3> positions, const OffsetIndices<int> polys, const Span<int> corner_verts, MutableSpan<float3> poly_normals) {
+	normals_calc_polys(positions, polys, corner_verts, polys.index_range(), poly_normals);
+}
 
-			float3 vert_normal(0);
-			for (const int poly_i : vert_faces) {
-				const int2 adjacent_verts = mesh::face_find_adjacent_verts(polys[poly_i], corner_verts, vert_i);
-				const float3 dir_prev = math::normalize(positions[adjacent_verts[0]] - positions[vert_i]);
-				const float3 dir_next = math::normalize(positions[adjacent_verts[1]] - positions[vert_i]);
-				const float factor = math::safe_acos(math::dot(dir_prev, dir_next));
+/** Only the normals of the vertices in \a mask are written. */
+static void normals_calc_verts(const Span<float3> positions, const OffsetIndices<int> polys, const Span<int> corner_verts, const GroupedSpan<int> vert_to_face_map, const Span<float3> poly_normals, const IndexMask &mask, MutableSpan<float3> vert_normals) {
+	mask.foreach_index(GrainSize(1024), [&](const int vert_i) {
+		const Span<int> vert_faces = vert_to_face_map[vert_i];
+		if (vert_faces.is_empty()) {
+			vert_normals[vert_i] = math::normalize(positions[vert_i]);
+			return;
+		}
 
-				vert_normal += poly_normals[poly_i] * factor;
-			}
+		float3 vert_normal(0);
+		for (const int poly_i : vert_faces) {
+			const int2 adjacent_verts = mesh::face_find_adjacent_verts(polys[poly_i], corner_verts, vert_i);
+			const float3 dir_prev = math::normalize(positions[adjacent_verts[0]] - positions[vert_i]);
+			const float3 dir_next = math::normalize(positions[adjacent_verts[1]] - positions[vert_i]);
+			const float factor = math::safe_acos(math::dot(dir_prev, dir_next));
 
-			vert_normals[vert_i] = math::normalize(vert_normal);
+			vert_normal += poly_normals[poly_i] * factor;
 		}
+
+		vert_normals[vert_i] = math::normalize(vert_normal);
 	});
 }
 
+void normals_calc_verts(const Span<float3> positions, const OffsetIndices<int> polys, const Span<int> corner_verts, const GroupedSpan<int> vert_to_face_map, const Span<float3> poly_normals, MutableSpan<float3> vert_normals) {
+	normals_calc_verts(positions, polys, corner_verts, vert_to_face_map, poly_normals, positions.index_range(), vert_normals);
+}
+
 struct VertCornerInfo {
 	int face;
 	int corner;
@@ -515,7 +521,13 @@ ROSE_NOINLINE static void handle_fan_result_and_custom_normals(const Span<short2
 	r_local_space_groups->append({std::move(fan_corners), fan_space});
 }
 
-void normals_calc_corners(const Span<float3> vert_positions, const OffsetIndices<int> polys, const Span<int> corner_verts, const Span<int> corner_edges, const GroupedSpan<int> vert_to_face_map, const Span<float3> poly_normals, const Span<bool> sharp_edges, const Span<bool> sharp_faces, const Span<short2> custom_normals, CornerNormalSpaceArray *r_fan_spaces, MutableSpan<float3> corner_normals) {
+/**
+ * Only the normals of the corners of the vertices in \a vert_mask are written, the fan spaces can
+ * only be built for all the vertices.
+ */
+static void normals_calc_corners(const Span<float3> vert_positions, const OffsetIndices<int> polys, const Span<int> corner_verts, const Span<int> corner_edges, const GroupedSpan<int> vert_to_face_map, const Span<float3> poly_normals, const Span<bool> sharp_edges, const Span<bool> sharp_faces, const Span<short2> custom_normals, const IndexMask &vert_mask, CornerNormalSpaceArray *r_fan_spaces, MutableSpan<float3> corner_normals) {
+	ROSE_assert(r_fan_spaces == nullptr || vert_mask.size() == vert_positions.size());
+
 	/* Mesh is not empty, but there are no faces, so no normals. */
 	if (corner_verts.is_empty()) {
 		return;
@@ -523,7 +535,7 @@ void normals_calc_corners(const Span<float3> vert_positions, const OffsetIndices
 
 	threading::EnumerableThreadSpecific<Vector<CornerSpaceGroup, 0>> space_groups;
 
-	threading::parallel_for(vert_positions.index_range(), 256, [&](const IndexRange range) {
+	threading::parallel_for(vert_mask.index_range(), 256, [&](const IndexRange range) {
 		Vector<VertCornerInfo, 16> corner_infos;
 		LocalEdgeVectorSet local_edge_by_vert;
 		Vector<VertEdgeInfo, 16> edge_infos;
@@ -533,14 +545,14 @@ void normals_calc_corners(const Span<float3> vert_positions, const OffsetIndices
 
 		Vector<CornerSpaceGroup, 0> *local_space_groups = r_fan_spaces ? &space_groups.local() : nullptr;
 
-		for (const int vert : range) {
+		vert_mask.slice(range).foreach_index([&](const int vert) {
 			const float3 vert_position = vert_positions[vert];
 			const Span<int> vert_polys = vert_to_face_map[vert];
 
 			/* Because we're iterating over vertices in order to batch work for their connected face
 			 * corners, we have to handle loose vertices and vertices not used by faces. */
 			if (vert_polys.is_empty()) {
-				continue;
+				return;
 			}
 
 			corner_infos.resize(vert_polys.size());
@@ -595,7 +607,7 @@ void normals_calc_corners(const Span<float3> vert_positions, const OffsetIndices
 				}
 			}
 			ROSE_assert(visited_count == corner_infos.size());
-		}
+		});
 	});
 
 	if (!r_fan_spaces) {
@@ -642,6 +654,10 @@ void normals_calc_corners(const Span<float3> vert_positions, const OffsetIndices
 	});
 }
 
+void normals_calc_corners(const Span<float3> vert_positions, const OffsetIndices<int> polys, const Span<int> corner_verts, const Span<int> corner_edges, const GroupedSpan<int> vert_to_face_map, const Span<float3> poly_normals, const Span<bool> sharp_edges, const Span<bool> sharp_faces, const Span<short2> custom_normals, CornerNormalSpaceArray *r_fan_spaces, MutableSpan<float3> corner_normals) {
+	normals_calc_corners(vert_positions, polys, corner_verts, corner_edges, vert_to_face_map, poly_normals, sharp_edges, sharp_faces, custom_normals, vert_positions.index_range(), r_fan_spaces, corner_normals);
+}
+
 void normals_calc_poly_vert(const Span<float3> positions, const OffsetIndices<int> polys, const Span<int> corner_verts, MutableSpan<float3> poly_normals, MutableSpan<float3> vert_normals) {
 	/* Zero the vertex normal array for accumulation. */
 	memset(vert_normals.data(), 0, vert_normals.as_span().size_in_bytes());
@@ -983,6 +999,31 @@ const float (*KER_mesh_poly_normals_ensure(const struct Mesh *mesh))[3] {
 	return reinterpret_cast<const float (*)[3]>(poly_normals.data());
 }
 
+/** Compute the normals of the corners of the vertices in \a vert_mask, see #normals_calc_corners. */
+static void mesh_corner_normals_calc(const Mesh *mesh, const rose::IndexMask &vert_mask, rose::MutableSpan<float3> r_data) {
+	const rose::Span<bool> sharp_edges = KER_mesh_edge_sharp_edge_span(mesh);
+	const rose::Span<bool> sharp_faces = KER_mesh_poly_sharp_face_span(mesh);
+
+	const rose::Span<float3> positions = KER_mesh_vert_positions_span(mesh);
+	const rose::OffsetIndices<int> polys = KER_mesh_poly_offsets_span(mesh);
+	const rose::Span<int> corner_verts = KER_mesh_corner_verts_span(mesh);
+	const rose::Span<int> corner_edges = KER_mesh_corner_edges_span(mesh);
+	const rose::GroupedSpan<int> vert_to_face = KER_mesh_vert_to_face_map_span(mesh);
+	const rose::Span<float3> poly_normals = KER_mesh_poly_normals_span(mesh);
+
+	if (CustomData_get_layer_named(&mesh->ldata, CD_PROP_INT16_2D, "custom_normal")) {
+		rose::Span<short2> custom_normals(
+			static_cast<const short2 *>(CustomData_get_layer_named(&mesh->ldata, CD_PROP_INT16_2D, "custom_normal")),
+			mesh->totloop
+		);
+
+		rose::kernel::mesh::normals_calc_corners(positions, polys, corner_verts, corner_edges, vert_to_face, poly_normals, sharp_edges, sharp_faces, custom_normals, vert_mask, NULL, r_data);
+	}
+	else {
+		rose::kernel::mesh::normals_calc_corners(positions, polys, corner_verts, corner_edges, vert_to_face, poly_normals, sharp_edges, sharp_faces, rose::Span<short2>(), vert_mask, NULL, r_data);
+	}
+}
+
 const float (*KER_mesh_corner_normals_ensure(const struct Mesh *mesh))[3] {
 	if (mesh->totpoly == 0) {
 		return {};
@@ -1001,31 +1042,82 @@ const float (*KER_mesh_corner_normals_ensure(const struct Mesh *mesh))[3] {
 			return;
 		}
 
-		const rose::Span<bool> sharp_edges = KER_mesh_edge_sharp_edge_span(mesh);
-		const rose::Span<bool> sharp_faces = KER_mesh_poly_sharp_face_span(mesh);
+		mesh_corner_normals_calc(mesh, rose::IndexRange(mesh->totvert), r_data);
+	});
 
-		const rose::Span<float3> positions = KER_mesh_vert_positions_span(mesh);
-		const rose::OffsetIndices<int> polys = KER_mesh_poly_offsets_span(mesh);
-		const rose::Span<int> corner_verts = KER_mesh_corner_verts_span(mesh);
-		const rose::Span<int> corner_edges = KER_mesh_corner_edges_span(mesh);
-		const rose::GroupedSpan<int> vert_to_face = KER_mesh_vert_to_face_map_span(mesh);
-		const rose::Span<float3> poly_normals = KER_mesh_poly_normals_span(mesh);
+	const rose::Vector<float3> &corner_normals = mesh->runtime->corner_normals_cache.data();
+	return reinterpret_cast<const float(*)[3]>(corner_normals.data());
+}
 
-		if (CustomData_get_layer_named(&mesh->ldata, CD_PROP_INT16_2D, "custom_normal")) {
-			rose::Span<short2> custom_normals(
-				static_cast<const short2 *>(CustomData_get_layer_named(&mesh->ldata, CD_PROP_INT16_2D, "custom_normal")),
-				mesh->totloop
-			);
+/** Sort the indices and remove the duplicates, as expected by #IndexMask::from_indices. */
+static void sort_unique_indices(rose::Vector<int> &indices) {
+	std::sort(indices.begin(), indices.end());
+	indices.resize(std::unique(indices.begin(), indices.end()) - indices.begin());
+}
 
-			rose::kernel::mesh::normals_calc_corners(positions, polys, corner_verts, corner_edges, vert_to_face, poly_normals, sharp_edges, sharp_faces, custom_normals, NULL, r_data);
-		}
-		else {
-			rose::kernel::mesh::normals_calc_corners(positions, polys, corner_verts, corner_edges, vert_to_face, poly_normals, sharp_edges, sharp_faces, rose::Span<short2>(), NULL, r_data);
-		}
+void KER_mesh_normals_update_partial(Mesh *mesh, const rose::IndexMask &changed_verts) {
+	rose::kernel::MeshRuntime &runtime = *mesh->runtime;
+	if (changed_verts.is_empty()) {
+		return;
+	}
+	if (runtime.poly_normals_cache.is_dirty()) {
+		/* The other normals are computed from the face normals, they will all be computed again. */
+		KER_mesh_normals_tag_dirty(mesh);
+		return;
+	}
+
+	const rose::Span<float3> positions = KER_mesh_vert_positions_span(mesh);
+	const rose::OffsetIndices<int> polys = KER_mesh_poly_offsets_span(mesh);
+	const rose::Span<int> corner_verts = KER_mesh_corner_verts_span(mesh);
+	const rose::GroupedSpan<int> vert_to_face = KER_mesh_vert_to_face_map_span(mesh);
+
+	/**
+	 * The normals of the faces using a moved vertex change, and with them the normals of all the
+	 * vertices of these faces, which also depend on the positions of their neighbors.
+	 */
+	rose::IndexMaskMemory memory;
+	rose::Vector<int> affected_polys;
+	changed_verts.foreach_index([&](const int vert) {
+		affected_polys.extend(vert_to_face[vert]);
 	});
+	sort_unique_indices(affected_polys);
+	const rose::IndexMask poly_mask = rose::IndexMask::from_indices<int>(affected_polys, memory);
 
-	const rose::Vector<float3> &corner_normals = mesh->runtime->corner_normals_cache.data();
-	return reinterpret_cast<const float(*)[3]>(corner_normals.data());
+	rose::Vector<int> affected_verts;
+	changed_verts.foreach_index([&](const int vert) {
+		affected_verts.append(vert);
+	});
+	poly_mask.foreach_index([&](const int poly) {
+		affected_verts.extend(corner_verts.slice(polys[poly]));
+	});
+	sort_unique_indices(affected_verts);
+	const rose::IndexMask vert_mask = rose::IndexMask::from_indices<int>(affected_verts, memory);
+
+	runtime.poly_normals_cache.update([&](rose::Vector<float3> &r_data) {
+		rose::kernel::mesh::normals_calc_polys(positions, polys, corner_verts, poly_mask, r_data);
+	});
+	const rose::Span<float3> poly_normals = runtime.poly_normals_cache.data();
+
+	if (runtime.vert_normals_cache.is_cached()) {
+		runtime.vert_normals_cache.update([&](rose::Vector<float3> &r_data) {
+			rose::kernel::mesh::normals_calc_verts(positions, polys, corner_verts, vert_to_face, poly_normals, vert_mask, r_data);
+		});
+	}
+	else {
+		runtime.vert_normals_cache.tag_dirty();
+	}
+
+	/* Custom normals stored as vectors do not depend on the positions. */
+	if (runtime.corner_normals_cache.is_cached()) {
+		if (!CustomData_get_layer_named(&mesh->ldata, CD_PROP_FLOAT3, "custom_normal")) {
+			runtime.corner_normals_cache.update([&](rose::Vector<float3> &r_data) {
+				mesh_corner_normals_calc(mesh, vert_mask, r_data);
+			});
+		}
+	}
+	else {
+		runtime.corner_normals_cache.tag_dirty();
+	}
 }
 
 static void normalize_vecs(rose::MutableSpan<float3> normals) {
@@ -4,6 +4,7 @@
 #include "LIB_offset_indices.hh"
 #include "LIB_thread.h"
 
+#include "KER_bvhutils.hh"
 #include "KER_lib_id.h"
 #include "KER_mesh_types.hh"
 #include "KER_mesh.hh"
@@ -43,7 +44,34 @@ void KER_mesh_runtime_clear_cache(Mesh *mesh) {
 void KER_mesh_runtime_clear_geometry(Mesh *mesh) {
 	mesh->runtime->bounds_cache.tag_dirty();
 	mesh->runtime->looptris_cache.tag_dirty();
+	mesh->runtime->looptris_refresh = false;
 	mesh->runtime->looptri_polys_cache.tag_dirty();
+	mesh->runtime->looptris_topology_cache.tag_dirty();
+	mesh->runtime->bvh_looptris_cache.tag_dirty();
+	mesh->runtime->bvh_looptris_refit = false;
+	mesh->runtime->vert_to_face_offset_cache.tag_dirty();
+	mesh->runtime->vert_to_face_map_cache.tag_dirty();
+	mesh->runtime->deform_weights_cache.tag_dirty();
+}
+
+void KER_mesh_runtime_share_topology_caches(Mesh *dst, const Mesh *src) {
+	/* The #SharedCache copies only increment the user count of the cached data. */
+	dst->runtime->looptris_topology_cache = src->runtime->looptris_topology_cache;
+	dst->runtime->looptri_polys_cache = src->runtime->looptri_polys_cache;
+	dst->runtime->vert_to_face_offset_cache = src->runtime->vert_to_face_offset_cache;
+	dst->runtime->vert_to_face_map_cache = src->runtime->vert_to_face_map_cache;
+	dst->runtime->deform_weights_cache = src->runtime->deform_weights_cache;
+}
+
+/** Keep the triangles for the next #KER_mesh_looptris, it only updates the faces that depend on the positions. */
+static void mesh_looptris_tag_refresh(Mesh *mesh) {
+	rose::SharedCache<rose::Array<MLoopTri>> &cache = mesh->runtime->looptris_cache;
+	if (!cache.is_cached()) {
+		/* Either never computed or already waiting to be updated. */
+		return;
+	}
+	cache.tag_dirty_keep_data();
+	mesh->runtime->looptris_refresh = true;
 }
 
 void KER_mesh_positions_changed(Mesh *mesh) {
@@ -51,12 +79,23 @@ void KER_mesh_positions_changed(Mesh *mesh) {
 	KER_mesh_batch_cache_tag_dirty(mesh, KER_MESH_BATCH_DIRTY_ALL);
 
 	mesh->runtime->bounds_cache.tag_dirty();
-	mesh->runtime->looptris_cache.tag_dirty();
+	mesh_looptris_tag_refresh(mesh);
+	KER_mesh_looptris_bvh_tag_refit(mesh);
+}
+
+void KER_mesh_positions_changed_mask(Mesh *mesh, const rose::IndexMask &changed_verts) {
+	KER_mesh_normals_update_partial(mesh, changed_verts);
+	KER_mesh_batch_cache_tag_dirty(mesh, KER_MESH_BATCH_DIRTY_ALL);
+
+	mesh->runtime->bounds_cache.tag_dirty();
+	mesh_looptris_tag_refresh(mesh);
+	KER_mesh_looptris_bvh_tag_refit(mesh);
 }
 
 void KER_mesh_positions_changed_uniformly(Mesh *mesh) {
 	/* The normals and triangulation didn't change, since all verts moved by the same amount. */
 	mesh->runtime->bounds_cache.tag_dirty();
+	KER_mesh_looptris_bvh_tag_refit(mesh);
 }
 
 /** \} */
@@ -125,6 +164,22 @@ rose::GroupedSpan<int> KER_mesh_vert_to_face_map_span(const Mesh *mesh) {
 	return rose::GroupedSpan<int>(offsets, mesh->runtime->vert_to_face_map_cache.data());
 }
 
+rose::GroupedSpan<MDeformWeight> KER_mesh_deform_weights_span(const Mesh *mesh) {
+	const rose::Span<MDeformVert> dverts = KER_mesh_deform_verts_span(mesh);
+	if (dverts.is_empty()) {
+		return {};
+	}
+	mesh->runtime->deform_weights_cache.ensure([&](rose::kernel::DeformWeights &r_data) {
+		rose::kernel::deform_weights_from_dverts(dverts, r_data);
+	});
+	return mesh->runtime->deform_weights_cache.data().as_span();
+}
+
+void KER_mesh_deform_weights_tag_dirty(Mesh *mesh) {
+	mesh->runtime->deform_weights_cache.tag_dirty();
+}
+
+
 /** \} */
 
 /* -------------------------------------------------------------------- */
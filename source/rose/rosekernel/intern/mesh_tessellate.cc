@@ -1,6 +1,7 @@
 #include "MEM_guardedalloc.h"
 
 #include "LIB_enumerable_thread_specific.hh"
+#include "LIB_index_mask.hh"
 #include "LIB_math_geom.h"
 #include "LIB_math_matrix.h"
 #include "LIB_math_matrix.hh"
@@ -146,7 +147,7 @@ ROSE_STATIC void mesh_calc_tessellation_for_face_fn(void *userdata, const int in
 
 	TesselationUserTLS *tls = static_cast<TesselationUserTLS *>(tls_v->userdata_chunk);
 	int i = (int)poly_to_tri_count(index, data->polys[index].start());
-	mesh_calc_tessellation_for_face_impl(data->corner_verts, data->polys, data->positions, i, &data->mlooptri[index], &tls->pf_arena, false, NULL);
+	mesh_calc_tessellation_for_face_impl(data->corner_verts, data->polys, data->positions, index, &data->mlooptri[i], &tls->pf_arena, false, NULL);
 }
 
 ROSE_STATIC void mesh_calc_tessellation_for_face_with_normal_fn(void *userdata, const int index, const TaskParallelTLS *tls_v) {
@@ -154,7 +155,7 @@ ROSE_STATIC void mesh_calc_tessellation_for_face_with_normal_fn(void *userdata,
 
 	TesselationUserTLS *tls = static_cast<TesselationUserTLS *>(tls_v->userdata_chunk);
 	int i = (int)poly_to_tri_count(index, data->polys[index].start());
-	mesh_calc_tessellation_for_face_impl(data->corner_verts, data->polys, data->positions, i, &data->mlooptri[index], &tls->pf_arena, true, data->poly_normals[index]);
+	mesh_calc_tessellation_for_face_impl(data->corner_verts, data->polys, data->positions, index, &data->mlooptri[i], &tls->pf_arena, true, data->poly_normals[index]);
 }
 
 ROSE_STATIC void mesh_calc_tessellation_for_face_free_fn(const void *userdata, void *tls_v) {
@@ -209,35 +210,130 @@ ROSE_STATIC void looptris_calc_with_normals(const Span<float3> vert_positions, c
 	looptris_calc_all(vert_positions, polys, corner_verts, poly_normals, looptris);
 }
 
+/** The faces whose triangulation depends on the positions, see #LooptrisTopology. */
+ROSE_STATIC void looptris_calc_position_dependent_polys(const OffsetIndices<int> polys, Array<int> &r_quad_polys, Array<int> &r_ngon_polys) {
+	IndexMaskMemory memory;
+	const IndexMask quads = IndexMask::from_predicate(polys.index_range(), GrainSize(1024), memory, [&](const size_t i) {
+		return polys[i].size() == 4;
+	});
+	const IndexMask ngons = IndexMask::from_predicate(polys.index_range(), GrainSize(1024), memory, [&](const size_t i) {
+		return polys[i].size() > 4;
+	});
+	r_quad_polys.reinitialize(quads.size());
+	quads.to_indices<int>(r_quad_polys);
+	r_ngon_polys.reinitialize(ngons.size());
+	ngons.to_indices<int>(r_ngon_polys);
+}
+
+/** Triangulate the faces in \a poly_indices again, the triangles of the other faces are unchanged. */
+ROSE_STATIC void looptris_calc_polys(const Span<float3> positions, const OffsetIndices<int> polys, const Span<int> corner_verts, const Span<int> poly_indices, MutableSpan<MLoopTri> looptris) {
+	threading::parallel_for(poly_indices.index_range(), 1024, [&](const IndexRange range) {
+		MemArena *pf_arena = NULL;
+		for (const size_t i : range) {
+			const int poly_index = poly_indices[i];
+			const int tri_index = poly_to_tri_count(poly_index, (int)polys[poly_index].start());
+			mesh_calc_tessellation_for_face(corner_verts, polys, positions, poly_index, &looptris[tri_index], &pf_arena);
+		}
+		if (pf_arena) {
+			LIB_memory_arena_destroy(pf_arena);
+		}
+	});
+}
+
+/**
+ * Whether the fill \a mlt of the n-gon still covers it, every triangle of the fill faces the same
+ * way as the face. Deforming a convex n-gon into a concave one folds some of them over.
+ */
+ROSE_INLINE bool ngon_fill_is_valid(const Span<float3> positions, const IndexRange poly, const Span<int> corner_verts, const MLoopTri *mlt, float r_normal[3]) {
+	const float *co_prev = positions[corner_verts[poly.last()]];
+	zero_v3(r_normal);
+	for (const size_t corner : poly) {
+		const float *co_curr = positions[corner_verts[corner]];
+		add_newell_cross_v3_v3v3(r_normal, co_prev, co_curr);
+		co_prev = co_curr;
+	}
+	if (normalize_v3(r_normal) == 0.0f) {
+		r_normal[2] = 1.0f;
+	}
+
+	for (const size_t i : IndexRange(poly.size() - 2)) {
+		float normal[3];
+		cross_tri_v3(normal, positions[corner_verts[mlt[i].tri[0]]], positions[corner_verts[mlt[i].tri[1]]], positions[corner_verts[mlt[i].tri[2]]]);
+		if (dot_v3v3(normal, r_normal) < 0.0f) {
+			return false;
+		}
+	}
+	return true;
+}
+
+/** Fill the n-gons in \a ngon_polys again where the current fill no longer covers the face. */
+ROSE_STATIC void looptris_refresh_ngons(const Span<float3> positions, const OffsetIndices<int> polys, const Span<int> corner_verts, const Span<int> ngon_polys, MutableSpan<MLoopTri> looptris) {
+	threading::parallel_for(ngon_polys.index_range(), 256, [&](const IndexRange range) {
+		MemArena *pf_arena = NULL;
+		for (const size_t i : range) {
+			const int poly_index = ngon_polys[i];
+			MLoopTri *mlt = &looptris[poly_to_tri_count(poly_index, (int)polys[poly_index].start())];
+			float normal[3];
+			if (!ngon_fill_is_valid(positions, polys[poly_index], corner_verts, mlt, normal)) {
+				mesh_calc_tessellation_for_face_with_normal(corner_verts, polys, positions, poly_index, mlt, &pf_arena, normal);
+			}
+		}
+		if (pf_arena) {
+			LIB_memory_arena_destroy(pf_arena);
+		}
+	});
+}
+
 }  // namespace rose::kernel::mesh
 
 const MLoopTri *KER_mesh_looptris(const struct Mesh *mesh) {
-	mesh->runtime->looptris_cache.ensure([&](rose::Array<MLoopTri> &r_data) {
-		const rose::Span<float3> positions = rose::Span<float3>(
-			reinterpret_cast<const float3 *>(KER_mesh_vert_positions(mesh)),
-			mesh->totvert
-		);
-		const rose::OffsetIndices<int> polys = rose::Span<int>(
-			KER_mesh_poly_offsets(mesh),
-			mesh->totpoly + 1
-		);
-		const rose::Span<int> corner_verts = rose::Span<int>(
-			KER_mesh_corner_verts(mesh),
-			mesh->totloop
-		);
-
-		r_data.reinitialize(poly_to_tri_count((int)polys.size(), (int)corner_verts.size()));
+	const rose::Span<float3> positions = rose::Span<float3>(
+		reinterpret_cast<const float3 *>(KER_mesh_vert_positions(mesh)),
+		mesh->totvert
+	);
+	const rose::OffsetIndices<int> polys = rose::Span<int>(
+		KER_mesh_poly_offsets(mesh),
+		mesh->totpoly + 1
+	);
+	const rose::Span<int> corner_verts = rose::Span<int>(
+		KER_mesh_corner_verts(mesh),
+		mesh->totloop
+	);
+
+	bool topology_calculated = false;
+	mesh->runtime->looptris_topology_cache.ensure([&](rose::kernel::LooptrisTopology &r_data) {
+		r_data.looptris.reinitialize(poly_to_tri_count((int)polys.size(), (int)corner_verts.size()));
 
 		if (KER_mesh_poly_normals_are_dirty(mesh)) {
-			rose::kernel::mesh::looptris_calc(positions, polys, corner_verts, r_data);
+			rose::kernel::mesh::looptris_calc(positions, polys, corner_verts, r_data.looptris);
 		}
 		else {
 			const rose::Span<float3> poly_normals = rose::Span<float3>(
 				reinterpret_cast<const float3 *>(KER_mesh_poly_normals_ensure(mesh)),
 				mesh->totpoly
 			);
-			rose::kernel::mesh::looptris_calc_with_normals(positions, polys, corner_verts, poly_normals, r_data);
+			rose::kernel::mesh::looptris_calc_with_normals(positions, polys, corner_verts, poly_normals, r_data.looptris);
+		}
+		rose::kernel::mesh::looptris_calc_position_dependent_polys(polys, r_data.quad_polys, r_data.ngon_polys);
+		topology_calculated = true;
+	});
+	const rose::kernel::LooptrisTopology &topology = mesh->runtime->looptris_topology_cache.data();
+	const rose::Span<int> quad_polys = (mesh->flag & ME_TESSELLATE_QUAD_SPLIT) ? topology.quad_polys.as_span() : rose::Span<int>();
+	if (quad_polys.is_empty() && topology.ngon_polys.is_empty()) {
+		return topology.looptris.data();
+	}
+
+	mesh->runtime->looptris_cache.ensure([&](rose::Array<MLoopTri> &r_data) {
+		if (!mesh->runtime->looptris_refresh || r_data.size() != topology.looptris.size()) {
+			/* Only copied once for each topology, the position changes after that update it in place. */
+			r_data = topology.looptris;
+			/* The topology was just triangulated with the current positions, there is nothing to update. */
+			if (topology_calculated) {
+				return;
+			}
 		}
+		rose::kernel::mesh::looptris_calc_polys(positions, polys, corner_verts, quad_polys, r_data);
+		rose::kernel::mesh::looptris_refresh_ngons(positions, polys, corner_verts, topology.ngon_polys, r_data);
 	});
 	/** Using .data().data() does not seem very nice but since we need to cast it to C pointer we just use the compiler optimizations! */
 	const rose::Array<MLoopTri>& looptris = mesh->runtime->looptris_cache.data();
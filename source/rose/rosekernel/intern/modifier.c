@@ -12,6 +12,8 @@
 #include "KER_mesh.h"
 #include "KER_modifier.h"
 
+#include "RLO_read_write.h"
+
 static ModifierTypeInfo *mod_types[NUM_MODIFIER_TYPES];
 
 /* -------------------------------------------------------------------- */
@@ -138,9 +140,10 @@ bool KER_modifier_deform_verts(ModifierData *md, const ModifierEvalContext *ctx,
 	const ModifierTypeInfo *mti = KER_modifier_get_info(md->type);
 
 	if (mti->deform_verts) {
-		if ((md->flag & MODIFIER_DEVICE_ONLY) == 0) {
+		if (!KER_modifier_is_device_evaluated(md)) {
 			mti->deform_verts(md, ctx, mesh, positions, length);
-			if (mesh) {
+			/* The positions may be a separate buffer, the mesh is then only used as input. */
+			if (mesh && positions == KER_mesh_vert_positions(mesh)) {
 				KER_mesh_positions_changed(mesh);
 			}
 		}
@@ -153,6 +156,20 @@ bool KER_modifier_deform_verts(ModifierData *md, const ModifierEvalContext *ctx,
 
 /** \} */
 
+/* -------------------------------------------------------------------- */
+/** \name Device Evaluation
+ * \{ */
+
+bool KER_modifier_is_device_evaluated(const ModifierData *md) {
+	if ((md->flag & MODIFIER_DEVICE_ONLY) != 0) {
+		return KER_modifier_device_supported_cb && KER_modifier_device_supported_cb(md);
+	}
+	return false;
+}
+
+bool (*KER_modifier_device_supported_cb)(const ModifierData *md) = NULL;
+
+/** \} */
 
 /* -------------------------------------------------------------------- */
 /** \name ModifierData for each Query
@@ -169,3 +186,28 @@ void KER_modifiers_foreach_ID_link(Object *object, IDWalkFunc walk, void *user_d
 }
 
 /** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name ModifierData File I/O
+ * \{ */
+
+void KER_modifier_rose_write(RoseWriter *writer, ListBase *modbase) {
+	LISTBASE_FOREACH(ModifierData *, md, modbase) {
+		const ModifierTypeInfo *mti = KER_modifier_get_info(md->type);
+		ROSE_assert(mti != NULL && mti->dnastruct[0] != '\0');
+
+		/** Write the whole modifier data, not only the #ModifierData header. */
+		RLO_write_struct_by_name(writer, mti->dnastruct, md);
+	}
+}
+
+void KER_modifier_rose_read_data(RoseDataReader *reader, ListBase *lb) {
+	RLO_read_struct_list(reader, ModifierData, lb);
+
+	LISTBASE_FOREACH(ModifierData *, md, lb) {
+		md->error = NULL;
+		md->runtime = NULL;
+	}
+}
+
+/** \} */
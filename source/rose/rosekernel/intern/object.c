@@ -6,6 +6,7 @@
 #include "LIB_string.h"
 
 #include "KER_action.h"
+#include "KER_anim_data.h"
 #include "KER_armature.h"
 #include "KER_camera.h"
 #include "KER_derived_mesh.h"
@@ -22,6 +23,8 @@
 #include "DEG_depsgraph.h"
 #include "DEG_depsgraph_query.h"
 
+#include "RLO_read_write.h"
+
 #include <stdio.h>
 
 /* -------------------------------------------------------------------- */
@@ -146,27 +149,59 @@ ROSE_INLINE void object_foreach_id(struct ID *id, struct LibraryForeachIDData *d
 	KER_LIB_FOREACHID_PROCESS_FUNCTION_CALL(data, KER_modifiers_foreach_ID_link(ob, library_foreach_modifiersForeachIDLink, data));
 }
 
-/**
- * typedef void (*IDTypeRoseWriteFunction)(struct RoseWriter *writer, struct ID *id, const void *address);
- * typedef void (*IDTypeRoseReadDataFunction)(struct RoseDataReader *reader, struct ID *id);
- */
+ROSE_STATIC void write_pose(RoseWriter *writer, Pose *pose) {
+	RLO_write_struct(writer, Pose, pose);
+	RLO_write_struct_list(writer, PoseChannel, &pose->channelbase);
+}
+
+ROSE_STATIC void read_pose(RoseDataReader *reader, Pose *pose) {
+	RLO_read_struct_list(reader, PoseChannel, &pose->channelbase);
+
+	LISTBASE_FOREACH(PoseChannel *, pchannel, &pose->channelbase) {
+		/** Bone pointers are restored when the pose is rebuilt, see #KER_pose_rebuild. */
+		pchannel->bone = NULL;
+		pchannel->parent = RLO_read_get_new_data_address_no_user(reader, pchannel->parent);
+		pchannel->child = RLO_read_get_new_data_address_no_user(reader, pchannel->child);
+		KER_pose_channel_runtime_reset(&pchannel->runtime);
+	}
+
+	pose->channelhash = NULL;
+	pose->channels = NULL;
+	pose->runtime = NULL;
+	pose->flag |= POSE_RECALC;
+}
 
-ROSE_INLINE void object_write(RoseWriter *writer, ID *id, const void *address) {
+ROSE_STATIC void object_write(RoseWriter *writer, ID *id, const void *id_address) {
 	Object *ob = (Object *)id;
 
-	// Write pose!
+	/** Runtime data is never written, it is created again when reading. */
+	memset(&ob->runtime, 0, sizeof(Object_Runtime));
+	LIB_listbase_clear((ListBase *)&ob->drawdata);
+
+	RLO_write_id_struct(writer, Object, id_address, &ob->id);
+	KER_animdata_rose_write(writer, id);
 
-	LISTBASE_FOREACH(ModifierData *, md, &ob->modifiers) {
-		// Write modifiers!
+	if (ob->pose) {
+		write_pose(writer, ob->pose);
 	}
 
-	memset(&ob->runtime, 0, sizeof(Object_Runtime));
+	KER_modifier_rose_write(writer, &ob->modifiers);
 }
 
-ROSE_INLINE void object_read_data(RoseDataReader *reader, ID *id) {
+ROSE_STATIC void object_read_data(RoseDataReader *reader, ID *id) {
 	Object *ob = (Object *)id;
 
+	KER_animdata_rose_read_data(reader, id);
+
+	RLO_read_struct(reader, Pose, &ob->pose);
+	if (ob->pose) {
+		read_pose(reader, ob->pose);
+	}
 
+	KER_modifier_rose_read_data(reader, &ob->modifiers);
+
+	memset(&ob->runtime, 0, sizeof(Object_Runtime));
+	LIB_listbase_clear((ListBase *)&ob->drawdata);
 }
 
 ROSE_STATIC void object_init(Object *ob, int type) {
@@ -762,8 +797,8 @@ IDTypeInfo IDType_ID_OB = {
 
 	.foreach_id = object_foreach_id,
 
-	.write = NULL,
-	.read_data = NULL,
+	.write = object_write,
+	.read_data = object_read_data,
 };
 
 /** \} */
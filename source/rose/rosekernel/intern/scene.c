@@ -3,6 +3,7 @@
 #include "LIB_ghash.h"
 #include "LIB_utildefines.h"
 
+#include "KER_anim_data.h"
 #include "KER_collection.h"
 #include "KER_idtype.h"
 #include "KER_layer.h"
@@ -15,6 +16,8 @@
 #include "DEG_depsgraph_build.h"
 #include "DEG_depsgraph_query.h"
 
+#include "RLO_read_write.h"
+
 /* -------------------------------------------------------------------- */
 /** \name Scene Creation
  * \{ */
@@ -302,7 +305,9 @@ ROSE_STATIC void scene_foreach_layer_collection(struct LibraryForeachIDData *dat
 	const int data_flags = KER_lib_query_foreachid_process_flags_get(data);
 
 	LISTBASE_FOREACH(LayerCollection *, lc, lb) {
-		KER_LIB_FOREACHID_PROCESS_IDSUPER(data, lc->collection, IDWALK_CB_NOP);
+		/** The master collection is owned by the scene, it is processed along with the scene. */
+		const int cb_flag = (is_master) ? IDWALK_CB_EMBEDDED_NOT_OWNING : IDWALK_CB_NOP;
+		KER_LIB_FOREACHID_PROCESS_IDSUPER(data, lc->collection, cb_flag);
 		scene_foreach_layer_collection(data, &lc->layer_collections, false);
 	}
 }
@@ -314,7 +319,7 @@ ROSE_STATIC void scene_foreach_id(ID *id, struct LibraryForeachIDData *data) {
 	KER_LIB_FOREACHID_PROCESS_IDSUPER(data, scene->camera, IDWALK_CB_NOP);
 	/* This pointer can be nullptr during old files reading, better be safe than sorry. */
 	if (scene->master_collection != NULL) {
-		KER_LIB_FOREACHID_PROCESS_ID(data, scene->master_collection, IDWALK_CB_NOP);
+		KER_LIB_FOREACHID_PROCESS_ID(data, scene->master_collection, IDWALK_CB_EMBEDDED);
 	}
 
 	LISTBASE_FOREACH(ViewLayer *, view_layer, &scene->view_layers) {
@@ -326,6 +331,85 @@ ROSE_STATIC void scene_foreach_id(ID *id, struct LibraryForeachIDData *data) {
 	}
 }
 
+ROSE_STATIC void scene_write_layer_collections(RoseWriter *writer, ListBase *lb) {
+	RLO_write_struct_list(writer, LayerCollection, lb);
+
+	LISTBASE_FOREACH(LayerCollection *, lc, lb) {
+		scene_write_layer_collections(writer, &lc->layer_collections);
+	}
+}
+
+ROSE_STATIC void scene_write(RoseWriter *writer, ID *id, const void *id_address) {
+	Scene *scene = (Scene *)id;
+
+	/** Runtime data is never written, the dependency graphs are created again when needed. */
+	scene->depsgraph_hash = NULL;
+
+	RLO_write_id_struct(writer, Scene, id_address, &scene->id);
+	KER_animdata_rose_write(writer, id);
+
+	LISTBASE_FOREACH(ViewLayer *, view_layer, &scene->view_layers) {
+		RLO_write_struct(writer, ViewLayer, view_layer);
+		RLO_write_struct_list(writer, Base, &view_layer->bases);
+		scene_write_layer_collections(writer, &view_layer->layer_collections);
+	}
+
+	if (scene->master_collection) {
+		/** The master collection is not part of #Main, write it along with its owner. */
+		Collection master_collection = *scene->master_collection;
+		KER_collection_rose_write_prepare_nolib(&master_collection);
+		RLO_write_struct_at_address(writer, Collection, scene->master_collection, &master_collection);
+		KER_collection_rose_write_nolib(writer, &master_collection);
+	}
+}
+
+ROSE_STATIC void scene_read_layer_collections(RoseDataReader *reader, ListBase *lb, const bool is_master) {
+	RLO_read_struct_list(reader, LayerCollection, lb);
+
+	LISTBASE_FOREACH(LayerCollection *, lc, lb) {
+		if (is_master) {
+			/** The master collection is read along with the scene, it is not linked later. */
+			lc->collection = RLO_read_get_new_data_address_no_user(reader, lc->collection);
+		}
+		scene_read_layer_collections(reader, &lc->layer_collections, false);
+	}
+}
+
+ROSE_STATIC void scene_read_view_layer(RoseDataReader *reader, ViewLayer *view_layer) {
+	RLO_read_struct_list(reader, Base, &view_layer->bases);
+	LISTBASE_FOREACH(Base *, base, &view_layer->bases) {
+		memset(&base->runtime, 0, sizeof(Base_Runtime));
+	}
+	view_layer->active = RLO_read_get_new_data_address_no_user(reader, view_layer->active);
+
+	scene_read_layer_collections(reader, &view_layer->layer_collections, true);
+	view_layer->active_collection = RLO_read_get_new_data_address_no_user(reader, view_layer->active_collection);
+
+	LIB_listbase_clear(&view_layer->drawdata);
+	view_layer->object_bases_array = NULL;
+	view_layer->object_bases_hash = NULL;
+}
+
+ROSE_STATIC void scene_read_data(RoseDataReader *reader, ID *id) {
+	Scene *scene = (Scene *)id;
+
+	KER_animdata_rose_read_data(reader, id);
+
+	RLO_read_struct(reader, Collection, &scene->master_collection);
+	if (scene->master_collection) {
+		RLO_read_embedded_id(reader, &scene->master_collection->id);
+	}
+
+	RLO_read_struct_list(reader, ViewLayer, &scene->view_layers);
+	LISTBASE_FOREACH(ViewLayer *, view_layer, &scene->view_layers) {
+		scene_read_view_layer(reader, view_layer);
+	}
+
+	scene->depsgraph_hash = NULL;
+	/** World data-blocks do not exist yet. */
+	scene->world = NULL;
+}
+
  IDTypeInfo IDType_ID_SCE = {
 	.idcode = ID_SCE,
 
@@ -345,8 +429,8 @@ ROSE_STATIC void scene_foreach_id(ID *id, struct LibraryForeachIDData *data) {
 
 	.foreach_id = scene_foreach_id,
 
-	.write = NULL,
-	.read_data = NULL,
+	.write = scene_write,
+	.read_data = scene_read_data,
 };
 
 /** \} */
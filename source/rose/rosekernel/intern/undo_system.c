@@ -0,0 +1,152 @@
+#include "MEM_guardedalloc.h"
+
+#include "LIB_listbase.h"
+#include "LIB_string.h"
+#include "LIB_utildefines.h"
+
+#include "KER_main.h"
+#include "KER_undo_system.h"
+
+#include "RLO_readfile.h"
+#include "RLO_undofile.h"
+#include "RLO_writefile.h"
+
+/* -------------------------------------------------------------------- */
+/** \name Data Structures
+ * \{ */
+
+typedef struct UndoStep {
+	struct UndoStep *prev, *next;
+
+	char name[64];
+
+	/** The whole database, sharing the chunks that did not change with the previous step. */
+	MemFile memfile;
+} UndoStep;
+
+typedef struct UndoStack {
+	ListBase steps;
+
+	/** The step the database currently corresponds to. */
+	UndoStep *step_active;
+
+	/** The maximum number of steps kept in the stack, zero for no limit. */
+	int step_limit;
+} UndoStack;
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Undo Step
+ * \{ */
+
+ROSE_STATIC void undosys_step_free(UndoStack *stack, UndoStep *step) {
+	/** The next step may share the chunks of this one, it takes them over. */
+	if (step->next) {
+		RLO_memfile_merge(&step->memfile, &step->next->memfile);
+	}
+	else {
+		RLO_memfile_free(&step->memfile);
+	}
+
+	if (stack->step_active == step) {
+		stack->step_active = NULL;
+	}
+	LIB_remlink(&stack->steps, step);
+	MEM_freeN(step);
+}
+
+/** Drop the steps that were undone, they can no longer be redone once a new step is pushed. */
+ROSE_STATIC void undosys_stack_clear_after_active(UndoStack *stack) {
+	UndoStep *first = (stack->step_active) ? stack->step_active->next : (UndoStep *)stack->steps.first;
+	while (first) {
+		/** Free from the end, a step never owns memory of the ones that precede it. */
+		UndoStep *last = (UndoStep *)stack->steps.last;
+		if (last == first) {
+			first = NULL;
+		}
+		undosys_step_free(stack, last);
+	}
+}
+
+ROSE_STATIC void undosys_stack_limit(UndoStack *stack) {
+	if (stack->step_limit <= 0) {
+		return;
+	}
+	while (LIB_listbase_count(&stack->steps) > stack->step_limit) {
+		undosys_step_free(stack, (UndoStep *)stack->steps.first);
+	}
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Undo Stack
+ * \{ */
+
+UndoStack *KER_undosys_stack_new(int step_limit) {
+	UndoStack *stack = MEM_callocN(sizeof(UndoStack), "UndoStack");
+	stack->step_limit = step_limit;
+	return stack;
+}
+
+void KER_undosys_stack_clear(UndoStack *stack) {
+	while (stack->steps.last) {
+		undosys_step_free(stack, (UndoStep *)stack->steps.last);
+	}
+	stack->step_active = NULL;
+}
+
+void KER_undosys_stack_free(UndoStack *stack) {
+	KER_undosys_stack_clear(stack);
+	MEM_freeN(stack);
+}
+
+size_t KER_undosys_stack_memory(const UndoStack *stack) {
+	size_t memory = 0;
+	LISTBASE_FOREACH(const UndoStep *, step, &stack->steps) {
+		memory += step->memfile.size;
+	}
+	return memory;
+}
+
+bool KER_undosys_step_push(UndoStack *stack, Main *main, const char *name) {
+	undosys_stack_clear_after_active(stack);
+
+	UndoStep *step = MEM_callocN(sizeof(UndoStep), "UndoStep");
+	LIB_strcpy(step->name, ARRAY_SIZE(step->name), name);
+
+	MemFile *reference = (stack->step_active) ? &stack->step_active->memfile : NULL;
+	if (!RLO_write_file_mem(main, reference, &step->memfile, 0)) {
+		RLO_memfile_free(&step->memfile);
+		MEM_freeN(step);
+		return false;
+	}
+
+	LIB_addtail(&stack->steps, step);
+	stack->step_active = step;
+
+	undosys_stack_limit(stack);
+	return true;
+}
+
+ROSE_STATIC bool undosys_step_load(UndoStack *stack, Main *main, UndoStep *step) {
+	if (step == NULL || stack->step_active == NULL) {
+		return false;
+	}
+	if (!RLO_read_from_memfile(main, &step->memfile, &stack->step_active->memfile)) {
+		return false;
+	}
+	stack->step_active = step;
+	return true;
+}
+
+bool KER_undosys_step_undo(UndoStack *stack, Main *main) {
+	return undosys_step_load(stack, main, (stack->step_active) ? stack->step_active->prev : NULL);
+}
+
+bool KER_undosys_step_redo(UndoStack *stack, Main *main) {
+	return undosys_step_load(stack, main, (stack->step_active) ? stack->step_active->next : NULL);
+}
+
+/** \} */
@@ -0,0 +1,249 @@
+#include "MEM_guardedalloc.h"
+
+#include "DNA_action_types.h"
+#include "DNA_anim_types.h"
+#include "DNA_object_types.h"
+
+#include "KER_action.h"
+#include "KER_anim_data.h"
+#include "KER_anim_sys.h"
+#include "KER_collection.h"
+#include "KER_fcurve.h"
+#include "KER_idtype.h"
+#include "KER_layer.h"
+#include "KER_lib_id.h"
+#include "KER_main.h"
+#include "KER_object.h"
+#include "KER_scene.h"
+
+#include "LIB_math_vector.h"
+#include "LIB_utildefines.h"
+
+#include "DEG_depsgraph.h"
+#include "DEG_depsgraph_build.h"
+#include "DEG_depsgraph_query.h"
+
+#include "gtest/gtest.h"
+
+namespace {
+
+void set_linear_keys(FCurve *fcurve, const float value_start, const float value_end) {
+	KER_fcurve_bezt_resize(fcurve, 2);
+	for (int index = 0; index < 2; index++) {
+		BezTriple &bezt = fcurve->bezt[index];
+		bezt.vec[1][0] = 10.0f * float(index);
+		bezt.vec[1][1] = (index == 0) ? value_start : value_end;
+		bezt.ipo = BEZT_IPO_LINEAR;
+		bezt.f1 = bezt.f2 = bezt.f3 = BEZT_FLAG_SELECT;
+		bezt.h1 = bezt.h2 = HD_AUTO_ANIM;
+	}
+	KER_fcurve_handles_recalc(fcurve);
+}
+
+TEST(AnimSys, EvaluateCached) {
+	KER_idtype_init();
+
+	Main *main = KER_main_new();
+	do {
+		Scene *scene = KER_scene_new(main, "Scene");
+		Object *object = KER_object_add(main, scene, OB_EMPTY, "Empty");
+
+		Action *action = static_cast<Action *>(KER_id_new(main, ID_AC, "Action"));
+		KER_action_keystrip_ensure(action);
+		action->frame_start = 0;
+		action->frame_end = 20;
+
+		ActionSlot *slot = KER_action_slot_add_for_idtype(action, ID_OB);
+		KER_action_slot_identifier_define(action, slot, object->id.name + 2);
+		KER_animdata_ensure_id(&object->id);
+		ASSERT_TRUE(KER_action_assign(action, &object->id));
+		ASSERT_TRUE(KER_action_slot_assign(slot, &object->id));
+
+		/* The location is animated as a whole, only one axis of the scale and two of the quaternion are. */
+		const FCurveDescriptor descriptors[] = {
+			{"location", 0, -1, -1, NULL},
+			{"location", 1, -1, -1, NULL},
+			{"location", 2, -1, -1, NULL},
+			{"scale", 1, -1, -1, NULL},
+			{"quaternion", 0, -1, -1, NULL},
+			{"quaternion", 2, -1, -1, NULL},
+			{"invalid_path", 0, -1, -1, NULL},
+		};
+		FCurve *fcurves[ARRAY_SIZE(descriptors)];
+		ActionStripKeyframeData *strip_data = KER_action_strip_data(action, action->layers[0]->strips[0]);
+		ActionChannelBag *channelbag = KER_action_strip_keyframe_data_ensure_channelbag_for_slot(strip_data, slot);
+		KER_action_channelbag_fcurve_create_many(NULL, channelbag, descriptors, ARRAY_SIZE(descriptors), fcurves);
+
+		set_linear_keys(fcurves[0], 0.0f, 10.0f);
+		set_linear_keys(fcurves[1], 0.0f, -10.0f);
+		set_linear_keys(fcurves[2], 1.0f, 1.0f);
+		set_linear_keys(fcurves[3], 1.0f, 3.0f);
+		set_linear_keys(fcurves[4], 0.5f, 0.5f);
+		set_linear_keys(fcurves[5], 0.5f, 0.5f);
+		set_linear_keys(fcurves[6], 0.0f, 1.0f);
+
+		AnimData *adt = KER_animdata_from_id(&object->id);
+
+		/* The second evaluation reuses the resolved paths. */
+		for (const float ctime : {5.0f, 2.5f}) {
+			copy_v4_fl4(object->quat, 1.0f, 1.0f, 0.0f, 0.0f);
+			KER_animsys_evaluate_animdata(&object->id, adt, ctime, ADT_RECALC_ANIM);
+			EXPECT_NE(adt->runtime, nullptr);
+
+			EXPECT_FLOAT_EQ(object->loc[0], ctime);
+			EXPECT_FLOAT_EQ(object->loc[1], -ctime);
+			EXPECT_FLOAT_EQ(object->loc[2], 1.0f);
+			EXPECT_FLOAT_EQ(object->scale[1], 1.0f + 0.2f * ctime);
+			/* The incompletely keyed quaternion is normalized, (0.5, 1, 0.5, 0) is of length sqrt(1.5). */
+			const float length = sqrtf(1.5f);
+			EXPECT_FLOAT_EQ(object->quat[0], 0.5f / length);
+			EXPECT_FLOAT_EQ(object->quat[1], 1.0f / length);
+			EXPECT_FLOAT_EQ(object->quat[2], 0.5f / length);
+			EXPECT_FLOAT_EQ(object->quat[3], 0.0f);
+		}
+
+		/* Changing the paths of the curves invalidates the resolved paths. */
+		const int generation = channelbag->generation;
+		KER_fcurve_path_set(fcurves[3], "euler");
+		KER_fcurve_path_set(fcurves[5], "euler");
+		EXPECT_NE(channelbag->generation, generation);
+
+		copy_v4_fl4(object->quat, 1.0f, 1.0f, 0.0f, 0.0f);
+		KER_animsys_evaluate_animdata(&object->id, adt, 5.0f, ADT_RECALC_ANIM);
+		EXPECT_FLOAT_EQ(object->rot[1], 2.0f);
+		EXPECT_FLOAT_EQ(object->rot[2], 0.5f);
+		/* A lone quaternion curve is written on its own, without normalizing the quaternion. */
+		EXPECT_FLOAT_EQ(object->quat[0], 0.5f);
+		EXPECT_FLOAT_EQ(object->quat[1], 1.0f);
+		EXPECT_FLOAT_EQ(object->quat[2], 0.0f);
+	} while (false);
+	KER_main_free(main);
+}
+
+TEST(AnimSys, EvaluateShared) {
+	KER_idtype_init();
+
+	Main *main = KER_main_new();
+	do {
+		Scene *scene = KER_scene_new(main, "Scene");
+		Action *action = static_cast<Action *>(KER_id_new(main, ID_AC, "Action"));
+		KER_action_keystrip_ensure(action);
+		action->frame_start = 0;
+		action->frame_end = 20;
+
+		ActionSlot *slot = KER_action_slot_add_for_idtype(action, ID_OB);
+		KER_action_slot_identifier_define(action, slot, "Agent");
+
+		const FCurveDescriptor descriptors[] = {
+			{"location", 0, -1, -1, NULL},
+			{"location", 2, -1, -1, NULL},
+		};
+		FCurve *fcurves[ARRAY_SIZE(descriptors)];
+		ActionStripKeyframeData *strip_data = KER_action_strip_data(action, action->layers[0]->strips[0]);
+		ActionChannelBag *channelbag = KER_action_strip_keyframe_data_ensure_channelbag_for_slot(strip_data, slot);
+		KER_action_channelbag_fcurve_create_many(NULL, channelbag, descriptors, ARRAY_SIZE(descriptors), fcurves);
+		set_linear_keys(fcurves[0], 0.0f, 10.0f);
+		set_linear_keys(fcurves[1], 2.0f, 2.0f);
+
+		/* The agents share the action, one of them starts later. */
+		Object *agents[3];
+		for (int index = 0; index < 3; index++) {
+			agents[index] = KER_object_add(main, scene, OB_EMPTY, "Agent");
+			KER_animdata_ensure_id(&agents[index]->id);
+			ASSERT_TRUE(KER_action_assign(action, &agents[index]->id));
+			ASSERT_TRUE(KER_action_slot_assign(slot, &agents[index]->id));
+		}
+		KER_animdata_from_id(&agents[2]->id)->stime = 1.0f;
+
+		AnimationEvalCache *cache = KER_animsys_eval_cache_new();
+		for (Object *agent : agents) {
+			KER_animsys_evaluate_animdata_ex(&agent->id, KER_animdata_from_id(&agent->id), 5.0f, ADT_RECALC_ANIM, cache);
+		}
+		EXPECT_FLOAT_EQ(agents[0]->loc[0], 5.0f);
+		EXPECT_FLOAT_EQ(agents[1]->loc[0], 5.0f);
+		EXPECT_FLOAT_EQ(agents[2]->loc[0], 4.0f);
+		EXPECT_FLOAT_EQ(agents[0]->loc[2], 2.0f);
+		EXPECT_FLOAT_EQ(agents[2]->loc[2], 2.0f);
+
+		/* One evaluation per distinct time. */
+		EXPECT_EQ(KER_animsys_eval_cache_lookup(cache, action, slot->handle, 5.0f), KER_animsys_eval_cache_lookup(cache, action, slot->handle, 5.0f));
+		EXPECT_NE(KER_animsys_eval_cache_lookup(cache, action, slot->handle, 5.0f), KER_animsys_eval_cache_lookup(cache, action, slot->handle, 4.0f));
+
+		KER_animsys_eval_cache_clear(cache);
+		KER_animsys_eval_cache_free(cache);
+	} while (false);
+	KER_main_free(main);
+}
+
+TEST(AnimSys, BakeBeforeEvaluation) {
+	KER_idtype_init();
+	DEG_register_node_types();
+
+	Main *main = KER_main_new();
+	do {
+		Scene *scene = KER_scene_new(main, "Scene");
+		ViewLayer *view_layer = KER_view_layer_default_view(scene);
+		Object *object = KER_object_add(main, scene, OB_EMPTY, "Empty");
+		KER_collection_object_add(main, scene->master_collection, object);
+
+		Action *action = static_cast<Action *>(KER_id_new(main, ID_AC, "Action"));
+		KER_action_keystrip_ensure(action);
+		action->frame_start = 0;
+		action->frame_end = 20;
+		action->flag |= ACT_BAKE_SAMPLES;
+
+		ActionSlot *slot = KER_action_slot_add_for_idtype(action, ID_OB);
+		KER_action_slot_identifier_define(action, slot, object->id.name + 2);
+		KER_animdata_ensure_id(&object->id);
+		ASSERT_TRUE(KER_action_assign(action, &object->id));
+		ASSERT_TRUE(KER_action_slot_assign(slot, &object->id));
+
+		const FCurveDescriptor descriptors[] = {
+			{"location", 0, -1, -1, NULL},
+		};
+		FCurve *fcurves[ARRAY_SIZE(descriptors)];
+		ActionStripKeyframeData *strip_data = KER_action_strip_data(action, action->layers[0]->strips[0]);
+		ActionChannelBag *channelbag = KER_action_strip_keyframe_data_ensure_channelbag_for_slot(strip_data, slot);
+		KER_action_channelbag_fcurve_create_many(NULL, channelbag, descriptors, ARRAY_SIZE(descriptors), fcurves);
+		set_linear_keys(fcurves[0], 0.0f, 10.0f);
+
+		/* The evaluated action is baked before the object is evaluated. */
+		Depsgraph *depsgraph = KER_scene_ensure_depsgraph(main, scene, view_layer);
+		KER_scene_graph_update_tagged(depsgraph, main);
+		Action *action_eval = reinterpret_cast<Action *>(DEG_get_evaluated_id(depsgraph, &action->id));
+		ActionChannelBag *channelbag_eval = KER_action_channelbag_for_action_slot(action_eval, action_eval->slots[0]);
+		ASSERT_NE(channelbag_eval, nullptr);
+		FCurve *fcurve_eval = channelbag_eval->fcurves[0];
+		EXPECT_NE(fcurve_eval->runtime.baked, nullptr);
+		EXPECT_EQ(fcurve_eval->runtime.totbaked, 10 * int(action->bake_rate) + 1);
+		EXPECT_EQ(fcurves[0]->runtime.baked, nullptr);
+
+		/* Editing the keyframes drops the samples until the action is evaluated again. */
+		fcurve_eval->bezt[1].vec[1][1] = 20.0f;
+		KER_fcurve_handles_recalc(fcurve_eval);
+		EXPECT_EQ(fcurve_eval->runtime.baked, nullptr);
+		KER_action_bake_samples_ensure(action_eval);
+		ASSERT_NE(fcurve_eval->runtime.baked, nullptr);
+		EXPECT_FLOAT_EQ(KER_fcurve_evaluate(nullptr, fcurve_eval, 5.0f), 10.0f);
+
+		/* The same happens to edits of the original once the action is tagged. */
+		fcurves[0]->bezt[1].vec[1][1] = 30.0f;
+		KER_fcurve_handles_recalc(fcurves[0]);
+		DEG_id_tag_update_ex(main, &action->id, ID_RECALC_COPY_ON_WRITE);
+		KER_scene_graph_update_tagged(depsgraph, main);
+		channelbag_eval = KER_action_channelbag_for_action_slot(action_eval, action_eval->slots[0]);
+		fcurve_eval = channelbag_eval->fcurves[0];
+		ASSERT_NE(fcurve_eval->runtime.baked, nullptr);
+		EXPECT_FLOAT_EQ(KER_fcurve_evaluate(nullptr, fcurve_eval, 5.0f), 15.0f);
+		EXPECT_EQ(fcurves[0]->runtime.baked, nullptr);
+
+		/* Without the flag nothing is baked. */
+		KER_fcurve_bake_free(fcurve_eval);
+		action_eval->flag &= ~ACT_BAKE_SAMPLES;
+		KER_action_bake_samples_ensure(action_eval);
+		EXPECT_EQ(fcurve_eval->runtime.baked, nullptr);
+	} while (false);
+	KER_main_free(main);
+}
+
+}  // namespace
@@ -0,0 +1,105 @@
+#include "MEM_guardedalloc.h"
+
+#include "LIB_listbase.h"
+#include "LIB_math_matrix.h"
+#include "LIB_math_matrix.hh"
+#include "LIB_math_vector_types.hh"
+#include "LIB_string.h"
+
+#include "DNA_action_types.h"
+#include "DNA_armature_types.h"
+#include "DNA_mesh_types.h"
+#include "DNA_object_types.h"
+
+#include "KER_action.h"
+#include "KER_armature.h"
+#include "KER_deform.h"
+#include "KER_idtype.h"
+#include "KER_lib_id.h"
+#include "KER_main.h"
+#include "KER_mesh.h"
+#include "KER_mesh.hh"
+#include "KER_object.h"
+#include "KER_scene.h"
+
+#include "gtest/gtest.h"
+
+namespace {
+
+void add_bone(Armature *armature, const char *name) {
+	Bone *bone = static_cast<Bone *>(MEM_callocN(sizeof(Bone), "Bone"));
+	LIB_strcpy(bone->name, ARRAY_SIZE(bone->name), name);
+	LIB_addtail(&armature->bonebase, bone);
+}
+
+TEST(ArmatureDeform, Batched) {
+	KER_idtype_init();
+
+	Main *main = KER_main_new();
+	do {
+		Scene *scene = KER_scene_new(main, "Scene");
+		Armature *armature = KER_armature_add(main, "Armature");
+		add_bone(armature, "A");
+		add_bone(armature, "B");
+		Object *obarmature = KER_object_add_for_data(main, scene, OB_ARMATURE, "Armature", &armature->id, true);
+		KER_pose_ensure(main, obarmature, armature, false);
+
+		PoseChannel *pchan_a = KER_pose_channel_find_name(obarmature->pose, "A");
+		PoseChannel *pchan_b = KER_pose_channel_find_name(obarmature->pose, "B");
+		ASSERT_NE(pchan_a, nullptr);
+		ASSERT_NE(pchan_b, nullptr);
+		copy_m4_m4(pchan_a->chan_mat, rose::math::from_location<float4x4>(float3(1.0f, 2.0f, 3.0f)).ptr());
+		copy_m4_m4(pchan_b->chan_mat, rose::math::from_scale<float4x4>(float3(2.0f, 0.5f, 3.0f)).ptr());
+
+		/* Five vertices, the first four are deformed together, the last one on its own. */
+		Mesh *mesh = static_cast<Mesh *>(KER_id_new(main, ID_ME, "Mesh"));
+		Object *obmesh = KER_object_add_for_data(main, scene, OB_MESH, "Mesh", &mesh->id, true);
+		for (Object *object : {obarmature, obmesh}) {
+			unit_m4(object->obmat);
+			unit_m4(object->invmat);
+		}
+		KER_object_defgroup_new(obmesh, "A");
+		KER_object_defgroup_new(obmesh, "Unknown");
+		KER_object_defgroup_new(obmesh, "B");
+
+		mesh->totvert = 5;
+		KER_mesh_ensure_required_data_layers(mesh);
+		MDeformVert *dverts = KER_mesh_deform_verts_for_write(mesh);
+		float3 positions[5] = {{0.5f, -1.0f, 2.0f}, {1.0f, 1.0f, 1.0f}, {-3.0f, 0.25f, 0.0f}, {2.0f, 2.0f, -2.0f}, {0.5f, -1.0f, 2.0f}};
+		for (int index : {0, 4}) {
+			KER_defvert_ensure_index(&dverts[index], 0)->weight = 0.25f;
+			KER_defvert_ensure_index(&dverts[index], 1)->weight = 1.0f;
+			KER_defvert_ensure_index(&dverts[index], 2)->weight = 0.5f;
+		}
+		KER_defvert_ensure_index(&dverts[1], 0)->weight = 1.0f;
+		KER_defvert_ensure_index(&dverts[2], 2)->weight = 0.0f;
+
+		KER_armature_deform_coords_with_mesh(obarmature, obmesh, reinterpret_cast<float(*)[3]>(positions), 5, mesh);
+
+		/* The scalar version gives identical results. */
+		EXPECT_EQ(memcmp(&positions[0], &positions[4], sizeof(float3)), 0);
+
+		const float3 expected_0 = (float3(1.5f, 1.0f, 5.0f) * 0.25f + float3(1.0f, -0.5f, 6.0f) * 0.5f) / 0.75f;
+		for (int axis = 0; axis < 3; axis++) {
+			EXPECT_NEAR(positions[0][axis], expected_0[axis], 1e-5f);
+		}
+		EXPECT_EQ(positions[1], float3(2.0f, 3.0f, 4.0f));
+		/* Zero weights and vertices without weights are left as they are. */
+		EXPECT_EQ(positions[2], float3(-3.0f, 0.25f, 0.0f));
+		EXPECT_EQ(positions[3], float3(2.0f, 2.0f, -2.0f));
+
+		/* The compact weights are shared with copies until the weights of either mesh are written. */
+		const rose::GroupedSpan<MDeformWeight> weights = KER_mesh_deform_weights_span(mesh);
+		EXPECT_EQ(weights[0].size(), 3);
+		EXPECT_EQ(weights[3].size(), 0);
+		Mesh *mesh_copy = KER_mesh_copy_for_eval(mesh, false);
+		EXPECT_EQ(KER_mesh_deform_weights_span(mesh_copy).data.data(), weights.data.data());
+		KER_defvert_ensure_index(&KER_mesh_deform_verts_for_write(mesh_copy)[3], 0)->weight = 1.0f;
+		EXPECT_EQ(KER_mesh_deform_weights_span(mesh_copy)[3].size(), 1);
+		EXPECT_EQ(KER_mesh_deform_weights_span(mesh)[3].size(), 0);
+		KER_id_free(NULL, &mesh_copy->id);
+	} while (false);
+	KER_main_free(main);
+}
+
+}  // namespace
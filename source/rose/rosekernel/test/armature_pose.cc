@@ -0,0 +1,108 @@
+#include "MEM_guardedalloc.h"
+
+#include "LIB_array.hh"
+#include "LIB_listbase.h"
+#include "LIB_math_matrix.h"
+#include "LIB_math_matrix.hh"
+#include "LIB_math_vector.h"
+#include "LIB_string.h"
+
+#include "DNA_action_types.h"
+#include "DNA_armature_types.h"
+#include "DNA_object_types.h"
+
+#include "KER_action.h"
+#include "KER_armature.h"
+#include "KER_idtype.h"
+#include "KER_lib_id.h"
+#include "KER_main.h"
+#include "KER_object.h"
+#include "KER_scene.h"
+
+#include "gtest/gtest.h"
+
+namespace {
+
+Bone *add_bone(Armature *armature, Bone *parent, const int index, const float3 &head, const float3 &tail) {
+	Bone *bone = static_cast<Bone *>(MEM_callocN(sizeof(Bone), "Bone"));
+	LIB_strnformat(bone->name, ARRAY_SIZE(bone->name), "Bone%d", index);
+	copy_v3_v3(bone->head, head);
+	copy_v3_v3(bone->tail, tail);
+	bone->roll = 0.1f * float(index % 7);
+	bone->parent = parent;
+	if (parent && index % 2) {
+		bone->flag |= BONE_CONNECTED;
+	}
+	LIB_addtail(parent ? &parent->childbase : &armature->bonebase, bone);
+	return bone;
+}
+
+TEST(ArmaturePose, WhereIsBatched) {
+	KER_idtype_init();
+
+	Main *main = KER_main_new();
+	do {
+		Scene *scene = KER_scene_new(main, "Scene");
+		Armature *armature = KER_armature_add(main, "Armature");
+
+		/* A root with many short chains, so that the levels are wide enough to be split between threads. */
+		int index = 0;
+		Bone *root = add_bone(armature, nullptr, index++, float3(0.0f), float3(0.0f, 0.0f, 1.0f));
+		for (int chain = 0; chain < 100; chain++) {
+			Bone *parent = root;
+			for (int depth = 0; depth < 3; depth++) {
+				const float3 head(0.01f * float(chain), 0.1f * float(depth), 0.0f);
+				parent = add_bone(armature, parent, index++, head, head + float3(0.0f, 0.5f, 0.25f));
+			}
+		}
+		KER_armature_where_is(armature);
+
+		Object *object = KER_object_add_for_data(main, scene, OB_ARMATURE, "Armature", &armature->id, true);
+		unit_m4(object->obmat);
+		KER_pose_ensure(main, object, armature, false);
+
+		int channel_index = 0;
+		LISTBASE_FOREACH(PoseChannel *, pchannel, &object->pose->channelbase) {
+			const float f = float(channel_index++);
+			copy_v3_fl3(pchannel->loc, 0.01f * f, -0.02f, 0.5f);
+			copy_v3_fl3(pchannel->scale, 1.0f, 1.0f + 0.001f * f, 0.9f);
+			pchannel->rotmode = (channel_index % 2) ? ROT_MODE_XYZ : ROT_MODE_QUAT;
+			copy_v3_fl3(pchannel->euler, 0.1f, 0.01f * f, -0.2f);
+			copy_v4_fl4(pchannel->quat, 1.0f, 0.1f, 0.0f, 0.01f * f);
+		}
+
+		/* The reference is the serial evaluation of the channels in the list, parents come first. */
+		rose::Array<float4x4> pose_mats_expected(index);
+		rose::Array<float4x4> chan_mats_expected(index);
+		channel_index = 0;
+		LISTBASE_FOREACH(PoseChannel *, pchannel, &object->pose->channelbase) {
+			KER_pose_where_is_bone(nullptr, scene, object, pchannel, 0.0f);
+			pose_mats_expected[channel_index] = float4x4(pchannel->pose_mat);
+			chan_mats_expected[channel_index] = float4x4(pchannel->pose_mat) * rose::math::invert(float4x4(pchannel->bone->arm_mat));
+			channel_index++;
+		}
+		LISTBASE_FOREACH(PoseChannel *, pchannel, &object->pose->channelbase) {
+			unit_m4(pchannel->pose_mat);
+		}
+
+		/* Evaluate twice, the second time reuses the flattened hierarchy. */
+		for (int pass = 0; pass < 2; pass++) {
+			KER_pose_where_is(nullptr, scene, object);
+			EXPECT_NE(object->pose->runtime, nullptr);
+
+			channel_index = 0;
+			LISTBASE_FOREACH(PoseChannel *, pchannel, &object->pose->channelbase) {
+				for (int i = 0; i < 4; i++) {
+					for (int j = 0; j < 4; j++) {
+						EXPECT_NEAR(pchannel->pose_mat[i][j], pose_mats_expected[channel_index][i][j], 1e-5f);
+						EXPECT_NEAR(pchannel->chan_mat[i][j], chan_mats_expected[channel_index][i][j], 1e-4f);
+					}
+				}
+				channel_index++;
+			}
+		}
+	} while (false);
+	KER_main_free(main);
+}
+
+}  // namespace
@@ -0,0 +1,108 @@
+#include "MEM_guardedalloc.h"
+
+#include "LIB_listbase.h"
+#include "LIB_math_matrix.h"
+#include "LIB_math_vector.h"
+#include "LIB_math_vector_types.hh"
+#include "LIB_string.h"
+
+#include "DNA_action_types.h"
+#include "DNA_armature_types.h"
+#include "DNA_mesh_types.h"
+#include "DNA_modifier_types.h"
+#include "DNA_object_types.h"
+#include "DNA_scene_types.h"
+
+#include "KER_action.h"
+#include "KER_armature.h"
+#include "KER_collection.h"
+#include "KER_deform.h"
+#include "KER_idtype.h"
+#include "KER_layer.h"
+#include "KER_main.h"
+#include "KER_mesh.h"
+#include "KER_modifier.h"
+#include "KER_object.h"
+#include "KER_scene.h"
+
+#include "DEG_depsgraph.h"
+#include "DEG_depsgraph_build.h"
+#include "DEG_depsgraph_query.h"
+
+#include "gtest/gtest.h"
+
+namespace {
+
+bool device_supported_all(const ModifierData * /*md*/) {
+	return true;
+}
+
+/** Evaluates a mesh deformed by a single armature modifier and returns the evaluated position. */
+float3 evaluate_armature_modifier(const int modifier_flag) {
+	float3 position;
+
+	Main *main = KER_main_new();
+	do {
+		Scene *scene = KER_scene_new(main, "Scene");
+		ViewLayer *view_layer = KER_view_layer_default_view(scene);
+
+		Armature *armature = KER_armature_add(main, "Armature");
+		Bone *bone = static_cast<Bone *>(MEM_callocN(sizeof(Bone), "Bone"));
+		LIB_strcpy(bone->name, ARRAY_SIZE(bone->name), "A");
+		copy_v3_fl3(bone->tail, 0.0f, 1.0f, 0.0f);
+		LIB_addtail(&armature->bonebase, bone);
+		KER_armature_where_is(armature);
+
+		Object *obarmature = KER_object_add_for_data(main, scene, OB_ARMATURE, "Armature", &armature->id, true);
+		KER_collection_object_add(main, scene->master_collection, obarmature);
+		KER_pose_ensure(main, obarmature, armature, false);
+		copy_v3_fl3(KER_pose_channel_find_name(obarmature->pose, "A")->loc, 1.0f, 2.0f, 3.0f);
+
+		Mesh *mesh = KER_mesh_add(main, "Mesh");
+		mesh->totvert = 1;
+		KER_mesh_ensure_required_data_layers(mesh);
+		zero_v3(KER_mesh_vert_positions_for_write(mesh)[0]);
+		Object *obmesh = KER_object_add_for_data(main, scene, OB_MESH, "Mesh", &mesh->id, true);
+		KER_collection_object_add(main, scene->master_collection, obmesh);
+		KER_object_defgroup_new(obmesh, "A");
+		KER_defvert_ensure_index(&KER_mesh_deform_verts_for_write(mesh)[0], 0)->weight = 1.0f;
+
+		ArmatureModifierData *amd = reinterpret_cast<ArmatureModifierData *>(KER_modifier_new(MODIFIER_TYPE_ARMATURE));
+		amd->modifier.flag |= modifier_flag;
+		amd->object = obarmature;
+		LIB_addtail(&obmesh->modifiers, amd);
+
+		Depsgraph *depsgraph = KER_scene_ensure_depsgraph(main, scene, view_layer);
+		KER_scene_graph_update_tagged(depsgraph, main);
+
+		const Object *obmesh_eval = DEG_get_evaluated_object(depsgraph, obmesh);
+		const Mesh *mesh_eval = static_cast<const Mesh *>(obmesh_eval->data);
+		copy_v3_v3(position, KER_mesh_vert_positions(mesh_eval)[0]);
+
+		/* The original mesh is never deformed. */
+		EXPECT_TRUE(is_zero_v3(KER_mesh_vert_positions(mesh)[0]));
+	} while (false);
+	KER_main_free(main);
+
+	return position;
+}
+
+TEST(DerivedMesh, ArmatureModifierOnHost) {
+	KER_idtype_init();
+	KER_modifier_init();
+	DEG_register_node_types();
+
+	EXPECT_EQ(evaluate_armature_modifier(0), float3(1.0f, 2.0f, 3.0f));
+
+	/* Without a draw module to apply them, device only modifiers are evaluated on the host. */
+	ASSERT_EQ(KER_modifier_device_supported_cb, nullptr);
+	EXPECT_EQ(evaluate_armature_modifier(MODIFIER_DEVICE_ONLY), float3(1.0f, 2.0f, 3.0f));
+
+	/* Otherwise they are left to the draw module. */
+	KER_modifier_device_supported_cb = device_supported_all;
+	EXPECT_EQ(evaluate_armature_modifier(MODIFIER_DEVICE_ONLY), float3(0.0f, 0.0f, 0.0f));
+	EXPECT_EQ(evaluate_armature_modifier(0), float3(1.0f, 2.0f, 3.0f));
+	KER_modifier_device_supported_cb = nullptr;
+}
+
+}  // namespace
@@ -0,0 +1,90 @@
+#include "MEM_guardedalloc.h"
+
+#include "DNA_anim_types.h"
+
+#include "KER_fcurve.h"
+
+#include "LIB_utildefines.h"
+
+#include "gtest/gtest.h"
+
+namespace {
+
+FCurve *bezier_curve_new() {
+	const float keys[][2] = {{0.0f, 0.0f}, {10.0f, 4.0f}, {15.0f, -2.0f}, {30.0f, 1.0f}, {31.0f, 1.0f}};
+
+	FCurve *fcurve = KER_fcurve_new();
+	KER_fcurve_bezt_resize(fcurve, ARRAY_SIZE(keys));
+	for (int index = 0; index < int(ARRAY_SIZE(keys)); index++) {
+		BezTriple &bezt = fcurve->bezt[index];
+		bezt.vec[1][0] = keys[index][0];
+		bezt.vec[1][1] = keys[index][1];
+		bezt.ipo = (index == 3) ? BEZT_IPO_CONST : BEZT_IPO_BEZ;
+		bezt.f1 = bezt.f2 = bezt.f3 = BEZT_FLAG_SELECT;
+		bezt.h1 = bezt.h2 = HD_AUTO_ANIM;
+	}
+	KER_fcurve_handles_recalc(fcurve);
+	return fcurve;
+}
+
+TEST(FCurve, EvaluateCursor) {
+	FCurve *fcurve = bezier_curve_new();
+	FCurve *reference = bezier_curve_new();
+
+	/* Forward playback, scrubbing backwards and jumps, compared with a curve that always searches. */
+	for (const float ctime : {-1.0f, 0.0f, 0.5f, 3.0f, 9.9f, 10.0f, 12.0f, 14.0f, 29.0f, 30.5f, 31.0f, 40.0f, 20.0f, 11.0f, 2.0f, 15.0f}) {
+		reference->runtime.cursor = 0;
+		EXPECT_FLOAT_EQ(KER_fcurve_evaluate(nullptr, fcurve, ctime), KER_fcurve_evaluate(nullptr, reference, ctime));
+	}
+
+	KER_fcurve_free(fcurve);
+	KER_fcurve_free(reference);
+}
+
+TEST(FCurve, BakedSamples) {
+	FCurve *fcurve = bezier_curve_new();
+	FCurve *reference = bezier_curve_new();
+
+	FCurve *fcurves[] = {fcurve};
+	KER_fcurves_bake_samples(fcurves, 1, 10.0f);
+	ASSERT_NE(fcurve->runtime.baked, nullptr);
+	EXPECT_EQ(fcurve->runtime.totbaked, 311);
+
+	/* The keyframes and the extrapolation are exact, the smooth segments are close. */
+	for (const float ctime : {-5.0f, 0.0f, 10.0f, 15.0f, 31.0f, 35.0f}) {
+		EXPECT_FLOAT_EQ(KER_fcurve_evaluate(nullptr, fcurve, ctime), KER_fcurve_evaluate(nullptr, reference, ctime));
+	}
+	for (float ctime = 0.0f; ctime < 30.0f; ctime += 0.37f) {
+		EXPECT_NEAR(KER_fcurve_evaluate(nullptr, fcurve, ctime), KER_fcurve_evaluate(nullptr, reference, ctime), 0.01f);
+	}
+
+	/* Editing the keyframes drops the samples. */
+	fcurve->bezt[1].vec[1][1] = 8.0f;
+	KER_fcurve_handles_recalc(fcurve);
+	EXPECT_EQ(fcurve->runtime.baked, nullptr);
+	EXPECT_FLOAT_EQ(KER_fcurve_evaluate(nullptr, fcurve, 10.0f), 8.0f);
+
+	/* Copies keep their own samples. */
+	KER_fcurve_bake_samples(fcurve, 2.0f);
+	FCurve *copy = KER_fcurve_copy(fcurve);
+	EXPECT_NE(copy->runtime.baked, fcurve->runtime.baked);
+	EXPECT_EQ(copy->runtime.totbaked, fcurve->runtime.totbaked);
+
+	KER_fcurve_free(copy);
+	KER_fcurve_free(fcurve);
+	KER_fcurve_free(reference);
+}
+
+TEST(FCurve, BakedSamplesCapped) {
+	FCurve *fcurve = bezier_curve_new();
+
+	/* The rate is lowered to stay within the maximum amount of samples, the last one is still on the last keyframe. */
+	KER_fcurve_bake_samples(fcurve, 1e6f);
+	EXPECT_EQ(fcurve->runtime.totbaked, FCURVE_BAKE_SAMPLES_MAX);
+	EXPECT_FLOAT_EQ(fcurve->runtime.baked[fcurve->runtime.totbaked - 1], 1.0f);
+	EXPECT_FLOAT_EQ(KER_fcurve_evaluate(nullptr, fcurve, 31.0f), 1.0f);
+
+	KER_fcurve_free(fcurve);
+}
+
+}  // namespace
@@ -1,16 +1,21 @@
 #include "MEM_guardedalloc.h"
 
 #include "LIB_math_geom.h"
+#include "LIB_array.hh"
+#include "LIB_index_mask.hh"
 #include "LIB_math_vector_types.hh"
 
 #include "DNA_screen_types.h"
 #include "DNA_windowmanager_types.h"
 
+#include "KER_bvhutils.hh"
 #include "KER_idtype.h"
 #include "KER_lib_id.h"
 #include "KER_lib_remap.h"
 #include "KER_main.h"
 #include "KER_mesh.h"
+#include "KER_mesh.hh"
+#include "KER_mesh_types.hh"
 #include "KER_object.h"
 
 #include "RM_include.h"
@@ -110,4 +115,336 @@ TEST(Mesh, Tesselation) {
     KER_main_free(main);
 }
 
+TEST(Mesh, PartialNormals) {
+	KER_idtype_init();
+
+	Main *main = KER_main_new();
+	do {
+		RMesh *rm_cube = RM_preset_cube_create((const float *)float3(1.0f, 1.0f, 1.0f));
+		Mesh *me_cube = (Mesh *)KER_object_obdata_add_from_type(main, OB_MESH, "Cube");
+		RMeshToMeshParams params = {
+			0,
+		};
+		RM_mesh_rm_to_me(main, rm_cube, me_cube, &params);
+		RM_mesh_free(rm_cube);
+
+		/* The normals have to be cached to be updated. */
+		KER_mesh_vert_normals_ensure(me_cube);
+		KER_mesh_corner_normals_ensure(me_cube);
+
+		KER_mesh_vert_positions_for_write_span(me_cube)[0] += float3(0.5f, -0.25f, 1.0f);
+		KER_mesh_positions_changed_mask(me_cube, rose::IndexRange(0, 1));
+
+		const rose::Array<float3> vert_normals(KER_mesh_vert_normals_span(me_cube));
+		const rose::Array<float3> poly_normals(KER_mesh_poly_normals_span(me_cube));
+		const rose::Array<float3> corner_normals(KER_mesh_corner_normals_span(me_cube));
+
+		/* The partial update gives the same normals as computing them from scratch. */
+		KER_mesh_normals_tag_dirty(me_cube);
+		EXPECT_EQ(vert_normals.as_span(), KER_mesh_vert_normals_span(me_cube));
+		EXPECT_EQ(poly_normals.as_span(), KER_mesh_poly_normals_span(me_cube));
+		EXPECT_EQ(corner_normals.as_span(), KER_mesh_corner_normals_span(me_cube));
+		EXPECT_NE(poly_normals[0], float3(-1.0f, 0.0f, 0.0f));
+	} while (false);
+	KER_main_free(main);
+}
+
+TEST(Mesh, TessellationPositionsChanged) {
+	KER_idtype_init();
+
+	Main *main = KER_main_new();
+	do {
+		RMesh *rm_cube = RM_preset_cube_create((const float *)float3(1.0f, 1.0f, 1.0f));
+		Mesh *me_cube = (Mesh *)KER_object_obdata_add_from_type(main, OB_MESH, "Cube");
+		RMeshToMeshParams params = {
+			0,
+		};
+		RM_mesh_rm_to_me(main, rm_cube, me_cube, &params);
+		RM_mesh_free(rm_cube);
+
+		const MLoopTri *looptris_topology = KER_mesh_looptris(me_cube);
+		const rose::Array<MLoopTri> looptris_before(rose::Span<MLoopTri>(looptris_topology, 2 * 6));
+
+		/* Move the second corner of every quad past the first diagonal, the quads are split the other way. */
+		const rose::OffsetIndices<int> polys = KER_mesh_poly_offsets_span(me_cube);
+		const rose::Span<int> corner_verts = KER_mesh_corner_verts_span(me_cube);
+		rose::MutableSpan<float3> positions = KER_mesh_vert_positions_for_write_span(me_cube);
+		for (const size_t poly : polys.index_range()) {
+			const int vert = corner_verts[polys[poly].first() + 1];
+			const float3 opposite = positions[corner_verts[polys[poly].first() + 3]];
+			positions[vert] = positions[vert] + (opposite - positions[vert]) * 0.75f;
+		}
+		KER_mesh_positions_changed(me_cube);
+
+		/* By default the quads keep their diagonal, the triangles of the topology are used as they are. */
+		EXPECT_EQ(KER_mesh_looptris(me_cube), looptris_topology);
+		EXPECT_TRUE(me_cube->runtime->looptris_cache.is_dirty());
+
+		me_cube->flag |= ME_TESSELLATE_QUAD_SPLIT;
+		const rose::Array<MLoopTri> looptris(rose::Span<MLoopTri>(KER_mesh_looptris(me_cube), 2 * 6));
+		KER_mesh_runtime_clear_geometry(me_cube);
+		const rose::Span<MLoopTri> looptris_full(KER_mesh_looptris(me_cube), 2 * 6);
+		for (const size_t i : looptris.index_range()) {
+			EXPECT_EQ(memcmp(&looptris[i], &looptris_full[i], sizeof(MLoopTri)), 0);
+			EXPECT_NE(memcmp(&looptris[i], &looptris_before[i], sizeof(MLoopTri)), 0);
+		}
+	} while (false);
+	KER_main_free(main);
+}
+
+/** A mesh with a single face, its corners are the \a positions in order. */
+Mesh *polygon_mesh_add(Main *main, const rose::Span<float3> positions) {
+	Mesh *me = (Mesh *)KER_object_obdata_add_from_type(main, OB_MESH, "Polygon");
+	me->totvert = (int)positions.size();
+	me->totedge = (int)positions.size();
+	me->totloop = (int)positions.size();
+	me->totpoly = 1;
+	KER_mesh_ensure_required_data_layers(me);
+	KER_mesh_poly_offsets_ensure_alloc(me);
+
+	KER_mesh_vert_positions_for_write_span(me).copy_from(positions);
+	rose::MutableSpan<int2> edges = KER_mesh_edges_for_write_span(me);
+	rose::MutableSpan<int> corner_verts = KER_mesh_corner_verts_for_write_span(me);
+	rose::MutableSpan<int> corner_edges = KER_mesh_corner_edges_for_write_span(me);
+	for (const int i : rose::IndexRange(me->totloop)) {
+		edges[i] = int2(i, (i + 1) % me->totloop);
+		corner_verts[i] = i;
+		corner_edges[i] = i;
+	}
+	return me;
+}
+
+TEST(Mesh, TessellationNgonKept) {
+	KER_idtype_init();
+
+	Main *main = KER_main_new();
+	do {
+		/* The triangle is never triangulated again. */
+		const float3 triangle_data[] = {{0.0f, 0.0f, 0.0f}, {1.0f, 0.0f, 0.0f}, {0.0f, 1.0f, 0.0f}};
+		Mesh *me_triangle = polygon_mesh_add(main, rose::Span<float3>(triangle_data, ARRAY_SIZE(triangle_data)));
+		const MLoopTri *looptris_triangle = KER_mesh_looptris(me_triangle);
+		KER_mesh_vert_positions_for_write_span(me_triangle)[0] = float3(2.0f, 2.0f, 0.0f);
+		KER_mesh_positions_changed(me_triangle);
+		EXPECT_EQ(KER_mesh_looptris(me_triangle), looptris_triangle);
+		EXPECT_TRUE(me_triangle->runtime->looptris_cache.is_dirty());
+
+		/* A concave pentagon pulled out into a convex one keeps its fill (still covering the face) in
+		 * place, even though filling the new shape from scratch picks other triangles. */
+		const float3 pentagon_data[] = {{0.0f, 0.0f, 0.0f}, {2.0f, 0.0f, 0.0f}, {1.0f, 1.5f, 0.0f}, {1.0f, 3.0f, 0.0f}, {0.0f, 2.0f, 0.0f}};
+		const float3 pentagon_moved_data[] = {{0.0f, 0.0f, 0.0f}, {2.0f, 0.0f, 0.0f}, {2.0f, 2.0f, 0.0f}, {1.0f, 3.0f, 0.0f}, {0.0f, 2.0f, 0.0f}};
+		const rose::Span<float3> pentagon(pentagon_data, ARRAY_SIZE(pentagon_data));
+		const rose::Span<float3> pentagon_moved(pentagon_moved_data, ARRAY_SIZE(pentagon_moved_data));
+
+		Mesh *me = polygon_mesh_add(main, pentagon);
+		const MLoopTri *looptris_ptr = KER_mesh_looptris(me);
+		const rose::Array<MLoopTri> looptris_before(rose::Span<MLoopTri>(looptris_ptr, 3));
+		KER_mesh_vert_positions_for_write_span(me).copy_from(pentagon_moved);
+		KER_mesh_positions_changed(me);
+		EXPECT_EQ(KER_mesh_looptris(me), looptris_ptr);
+		EXPECT_EQ(memcmp(looptris_ptr, looptris_before.data(), sizeof(MLoopTri) * 3), 0);
+
+		Mesh *me_moved = polygon_mesh_add(main, pentagon_moved);
+		EXPECT_NE(memcmp(KER_mesh_looptris(me_moved), looptris_before.data(), sizeof(MLoopTri) * 3), 0);
+	} while (false);
+	KER_main_free(main);
+}
+
+TEST(Mesh, TessellationNgonBecomesConcave) {
+	KER_idtype_init();
+
+	Main *main = KER_main_new();
+	do {
+		const float3 positions_data[] = {{0.0f, 0.0f, 0.0f}, {2.0f, 0.0f, 0.0f}, {2.0f, 2.0f, 0.0f}, {1.0f, 3.0f, 0.0f}, {0.0f, 2.0f, 0.0f}};
+		Mesh *me = polygon_mesh_add(main, rose::Span<float3>(positions_data, ARRAY_SIZE(positions_data)));
+		KER_mesh_looptris(me);
+
+		/* The convex pentagon is pushed in at every vertex in turn, the fill always covers the
+		 * face without any folded triangle. */
+		for (const int vert : rose::IndexRange(5)) {
+			rose::MutableSpan<float3> positions = KER_mesh_vert_positions_for_write_span(me);
+			positions.copy_from(rose::Span<float3>(positions_data, ARRAY_SIZE(positions_data)));
+			positions[vert] = positions[vert] * 0.25f + float3(1.0f, 1.25f, 0.0f) * 0.75f;
+			KER_mesh_positions_changed(me);
+
+			const rose::Span<MLoopTri> looptris(KER_mesh_looptris(me), 3);
+			for (const MLoopTri &lt : looptris) {
+				EXPECT_GT(area_tri_signed_v2(positions[lt.tri[0]], positions[lt.tri[1]], positions[lt.tri[2]]), 0.0f);
+			}
+		}
+	} while (false);
+	KER_main_free(main);
+}
+
+TEST(Mesh, MeshToRMesh) {
+	KER_idtype_init();
+
+	Main *main = KER_main_new();
+	do {
+		/* A quad split in two triangles, the edge between vertex 0 and 2 is used by both faces. */
+		Mesh *me = (Mesh *)KER_object_obdata_add_from_type(main, OB_MESH, "Quad");
+		me->totvert = 4;
+		me->totedge = 5;
+		me->totloop = 6;
+		me->totpoly = 2;
+		KER_mesh_ensure_required_data_layers(me);
+		KER_mesh_poly_offsets_ensure_alloc(me);
+		KER_mesh_poly_offsets_for_write_span(me)[1] = 3;
+
+		const float3 positions_data[] = {{0.0f, 0.0f, 0.0f}, {1.0f, 0.0f, 0.0f}, {1.0f, 1.0f, 0.0f}, {0.0f, 1.0f, 0.0f}};
+		const int2 edges_data[] = {{0, 1}, {1, 2}, {2, 0}, {2, 3}, {3, 0}};
+		const int corner_verts_data[] = {0, 1, 2, 0, 2, 3};
+		const int corner_edges_data[] = {0, 1, 2, 2, 3, 4};
+		const rose::Span<float3> positions(positions_data, ARRAY_SIZE(positions_data));
+		const rose::Span<int2> edges(edges_data, ARRAY_SIZE(edges_data));
+		const rose::Span<int> corner_verts(corner_verts_data, ARRAY_SIZE(corner_verts_data));
+		const rose::Span<int> corner_edges(corner_edges_data, ARRAY_SIZE(corner_edges_data));
+		KER_mesh_vert_positions_for_write_span(me).copy_from(positions);
+		KER_mesh_edges_for_write_span(me).copy_from(edges);
+		KER_mesh_corner_verts_for_write_span(me).copy_from(corner_verts);
+		KER_mesh_corner_edges_for_write_span(me).copy_from(corner_edges);
+
+		RMesh *rm = RM_mesh_create();
+		RMeshFromMeshParams from_params = {
+			true,
+			true,
+		};
+		RM_mesh_me_to_rm(rm, me, &from_params);
+
+		EXPECT_EQ(rm->totvert, 4);
+		EXPECT_EQ(rm->totedge, 5);
+		EXPECT_EQ(rm->totloop, 6);
+		EXPECT_EQ(rm->totface, 2);
+		EXPECT_EQ(float3(RM_face_at_index(rm, 1)->no), float3(0.0f, 0.0f, 1.0f));
+
+		/* The disk cycle of every vertex visits all the edges using it. */
+		const int vert_edges_num[] = {3, 2, 3, 2};
+		for (const int index : rose::IndexRange(4)) {
+			RMVert *v = RM_vert_at_index(rm, index);
+			RMEdge *e = v->e;
+			int num = 0;
+			do {
+				EXPECT_TRUE(RM_vert_in_edge(e, v));
+				num++;
+			} while ((e = RM_DISK_EDGE_NEXT(e, v)) != v->e && num < 8);
+			EXPECT_EQ(num, vert_edges_num[index]);
+		}
+
+		/* The radial cycle of the shared edge has the two faces. */
+		RMEdge *e_shared = RM_edge_exists(RM_vert_at_index(rm, 0), RM_vert_at_index(rm, 2));
+		EXPECT_EQ(e_shared, RM_edge_at_index(rm, 2));
+		EXPECT_NE(e_shared->l->radial_next, e_shared->l);
+		EXPECT_EQ(e_shared->l->radial_next->radial_next, e_shared->l);
+		EXPECT_NE(e_shared->l->f, e_shared->l->radial_next->f);
+
+		/* Converting back gives the same topology. */
+		Mesh *me_back = (Mesh *)KER_object_obdata_add_from_type(main, OB_MESH, "Quad");
+		RMeshToMeshParams to_params = {
+			0,
+		};
+		RM_mesh_rm_to_me(main, rm, me_back, &to_params);
+		RM_mesh_free(rm);
+
+		EXPECT_EQ(KER_mesh_vert_positions_span(me_back), positions);
+		EXPECT_EQ(KER_mesh_edges_span(me_back), edges);
+		EXPECT_EQ(KER_mesh_corner_verts_span(me_back), corner_verts);
+		EXPECT_EQ(KER_mesh_corner_edges_span(me_back), corner_edges);
+		EXPECT_EQ(KER_mesh_poly_offsets_span(me_back), KER_mesh_poly_offsets_span(me));
+	} while (false);
+	KER_main_free(main);
+}
+
+TEST(Mesh, BVHRefit) {
+	KER_idtype_init();
+
+	Main *main = KER_main_new();
+	do {
+		RMesh *rm_cube = RM_preset_cube_create((const float *)float3(1.0f, 1.0f, 1.0f));
+		Mesh *me_cube = (Mesh *)KER_object_obdata_add_from_type(main, OB_MESH, "Cube");
+		RMeshToMeshParams params = {
+			0,
+		};
+		RM_mesh_rm_to_me(main, rm_cube, me_cube, &params);
+		RM_mesh_free(rm_cube);
+
+		const float3 origin(0.25f, 0.25f, 10.0f);
+		const float3 direction(0.0f, 0.0f, -1.0f);
+
+		rose::BVHTreeRayHit hit;
+		EXPECT_TRUE(KER_mesh_bvh_ray_cast(me_cube, origin, direction, &hit));
+		const float top = origin.z - hit.dist;
+		EXPECT_FLOAT_EQ(std::abs(hit.no.z), 1.0f);
+
+		/* Moving the positions only tags the cached tree, the next query refits it instead of
+		 * building it again. */
+		const int *prim_indices = KER_mesh_looptris_bvh(me_cube).prim_indices().data();
+		for (float3 &position : KER_mesh_vert_positions_for_write_span(me_cube)) {
+			position.z += 2.0f;
+		}
+		KER_mesh_positions_changed(me_cube);
+		EXPECT_TRUE(me_cube->runtime->bvh_looptris_cache.is_dirty());
+		KER_mesh_positions_changed_uniformly(me_cube);
+
+		hit = {};
+		EXPECT_TRUE(KER_mesh_bvh_ray_cast(me_cube, origin, direction, &hit));
+		EXPECT_TRUE(me_cube->runtime->bvh_looptris_cache.is_cached());
+		EXPECT_EQ(KER_mesh_looptris_bvh(me_cube).prim_indices().data(), prim_indices);
+		EXPECT_FLOAT_EQ(origin.z - hit.dist, top + 2.0f);
+
+		const float3 cos[] = {{0.0f, 0.0f, 20.0f}, {0.0f, 0.0f, -20.0f}};
+		rose::Array<rose::BVHTreeNearest> nearest(2);
+		KER_mesh_bvh_find_nearest_batch(me_cube, rose::Span<float3>(cos, ARRAY_SIZE(cos)), nearest);
+		EXPECT_FLOAT_EQ(nearest[0].co.z, top + 2.0f);
+		EXPECT_FLOAT_EQ(nearest[1].co.z, top + 2.0f - 2.0f * top);
+	} while (false);
+	KER_main_free(main);
+}
+
+TEST(Mesh, MergeByDistance) {
+	KER_idtype_init();
+
+	Main *main = KER_main_new();
+	do {
+		RMesh *rm_cube = RM_preset_cube_create((const float *)float3(1.0f, 1.0f, 1.0f));
+		Mesh *me_cube = (Mesh *)KER_object_obdata_add_from_type(main, OB_MESH, "Cube");
+		RMeshToMeshParams params = {
+			0,
+		};
+		RM_mesh_rm_to_me(main, rm_cube, me_cube, &params);
+		RM_mesh_free(rm_cube);
+
+		/* The faces of the preset do not share vertices or edges. */
+		EXPECT_EQ(me_cube->totvert, 24);
+		EXPECT_EQ(KER_mesh_merge_by_distance(me_cube, 1e-4f), 16);
+		EXPECT_EQ(me_cube->totvert, 8);
+		EXPECT_EQ(me_cube->totedge, 12);
+		EXPECT_EQ(me_cube->totloop, 24);
+		EXPECT_EQ(me_cube->totpoly, 6);
+
+		/* Every edge is used by two faces once the cube is welded. */
+		rose::Array<int> edge_users(me_cube->totedge, 0);
+		for (const int edge : KER_mesh_corner_edges_span(me_cube)) {
+			edge_users[edge]++;
+		}
+		for (const int users : edge_users) {
+			EXPECT_EQ(users, 2);
+		}
+		const rose::Span<int2> edges = KER_mesh_edges_span(me_cube);
+		const rose::Span<int> corner_verts = KER_mesh_corner_verts_span(me_cube);
+		const rose::Span<int> corner_edges = KER_mesh_corner_edges_span(me_cube);
+		for (const int corner : corner_verts.index_range()) {
+			const int2 edge = edges[corner_edges[corner]];
+			EXPECT_TRUE(edge[0] == corner_verts[corner] || edge[1] == corner_verts[corner]);
+		}
+		EXPECT_EQ(KER_mesh_poly_offsets_span(me_cube).last(), 24);
+
+		/* Collapsing the whole cube leaves nothing but a single vertex. */
+		EXPECT_EQ(KER_mesh_merge_by_distance(me_cube, 10.0f), 7);
+		EXPECT_EQ(me_cube->totvert, 1);
+		EXPECT_EQ(me_cube->totedge, 0);
+		EXPECT_EQ(me_cube->totloop, 0);
+		EXPECT_EQ(me_cube->totpoly, 0);
+	} while (false);
+	KER_main_free(main);
+}
+
 }  // namespace
@@ -0,0 +1,82 @@
+#include "MEM_guardedalloc.h"
+
+#include "LIB_math_vector_types.hh"
+
+#include "DNA_mesh_types.h"
+#include "DNA_object_types.h"
+#include "DNA_scene_types.h"
+
+#include "KER_collection.h"
+#include "KER_idtype.h"
+#include "KER_lib_id.h"
+#include "KER_main.h"
+#include "KER_mesh.h"
+#include "KER_object.h"
+#include "KER_scene.h"
+#include "KER_undo_system.h"
+
+#include "RM_include.h"
+
+#include "gtest/gtest.h"
+
+namespace {
+
+Mesh *add_cube(Main *main, Scene *scene, const char *name) {
+	RMesh *rm_cube = RM_preset_cube_create((const float *)float3(1.0f, 1.0f, 1.0f));
+	Mesh *mesh = reinterpret_cast<Mesh *>(KER_object_obdata_add_from_type(main, OB_MESH, name));
+	RMeshToMeshParams params = {
+		0,
+	};
+	RM_mesh_rm_to_me(main, rm_cube, mesh, &params);
+	RM_mesh_free(rm_cube);
+
+	Object *object = KER_object_add_for_data(main, scene, OB_MESH, name, &mesh->id, true);
+	KER_collection_object_add(main, scene->master_collection, object);
+	return mesh;
+}
+
+TEST(UndoSystem, MemFile) {
+	KER_idtype_init();
+
+	Main *main = KER_main_new();
+	UndoStack *stack = KER_undosys_stack_new(0);
+	do {
+		Scene *scene = KER_scene_new(main, "Scene");
+		Mesh *mesh_a = add_cube(main, scene, "A");
+		Mesh *mesh_b = add_cube(main, scene, "B");
+		EXPECT_TRUE(KER_undosys_step_push(stack, main, "Initial"));
+		const size_t initial_memory = KER_undosys_stack_memory(stack);
+
+		KER_mesh_vert_positions_for_write(mesh_a)[0][0] = 5.0f;
+		KER_mesh_positions_changed(mesh_a);
+		EXPECT_TRUE(KER_undosys_step_push(stack, main, "Move"));
+		/* Only the chunks of the edited mesh are stored again. */
+		EXPECT_LT(KER_undosys_stack_memory(stack) - initial_memory, initial_memory / 2);
+
+		KER_id_free(main, KER_main_id_lookup(main, ID_OB, "B"));
+		EXPECT_TRUE(KER_undosys_step_push(stack, main, "Delete"));
+		EXPECT_EQ(LIB_listbase_count(&main->objects), 1);
+
+		EXPECT_TRUE(KER_undosys_step_undo(stack, main));
+		EXPECT_EQ(LIB_listbase_count(&main->objects), 2);
+		Object *object_b = reinterpret_cast<Object *>(KER_main_id_lookup(main, ID_OB, "B"));
+		ASSERT_NE(object_b, nullptr);
+		/* The mesh did not change, it is kept as is. */
+		EXPECT_EQ(object_b->data, mesh_b);
+		EXPECT_EQ(LIB_listbase_count(&scene->master_collection->objects), 2);
+
+		EXPECT_TRUE(KER_undosys_step_undo(stack, main));
+		/* Changed IDs are restored in place. */
+		EXPECT_EQ(KER_main_id_lookup(main, ID_ME, "A"), mesh_a);
+		EXPECT_EQ(KER_mesh_vert_positions(mesh_a)[0][0], -1.0f);
+		EXPECT_FALSE(KER_undosys_step_undo(stack, main));
+
+		EXPECT_TRUE(KER_undosys_step_redo(stack, main));
+		EXPECT_EQ(KER_mesh_vert_positions(mesh_a)[0][0], 5.0f);
+		EXPECT_EQ(mesh_a->id.user, 1);
+	} while (false);
+	KER_undosys_stack_free(stack);
+	KER_main_free(main);
+}
+
+}  // namespace
@@ -0,0 +1,114 @@
+#ifndef LIB_BVHTREE_HH
+#define LIB_BVHTREE_HH
+
+#include "LIB_array.hh"
+#include "LIB_bounds_types.hh"
+#include "LIB_function_ref.hh"
+#include "LIB_math_vector_types.hh"
+#include "LIB_span.hh"
+
+#include <cfloat>
+
+namespace rose {
+
+struct BVHTreeRayHit {
+	/** The index of the primitive that was hit, -1 when nothing was hit. */
+	int index = -1;
+	/** The distance along the ray, the maximum distance of the cast until something is hit. */
+	float dist = FLT_MAX;
+	float3 co;
+	float3 no;
+};
+
+struct BVHTreeNearest {
+	/** The index of the nearest primitive, -1 when nothing was found. */
+	int index = -1;
+	/** The squared distance to the nearest point, the maximum search distance until something is found. */
+	float dist_sq = FLT_MAX;
+	float3 co;
+};
+
+/**
+ * A bounding volume hierarchy over primitives that are only known by their bounds, the exact
+ * tests against the primitives are left to the callbacks of the queries.
+ *
+ * The hierarchy is built with a binned surface area heuristic, subtrees are built in parallel.
+ * When the primitives move without changing the topology #refit keeps the hierarchy and only
+ * updates the bounds of the nodes, which is much cheaper than building the tree again.
+ */
+class BVHTree {
+public:
+	struct Node {
+		Bounds<float3> bounds;
+		/** The range of the primitives of the subtree in #BVHTree::prim_indices. */
+		int prim_start;
+		int prim_num;
+		/** The index of the first child, the second one follows it, -1 for leaves. */
+		int children;
+	};
+
+	/** Called with the primitives of the leaves hit by the ray, should shorten the hit when it finds a closer one. */
+	using RayCastFn = FunctionRef<void(int index, const float3 &origin, const float3 &direction, BVHTreeRayHit &hit)>;
+	/** Called with the primitives of the leaves close enough, should update the nearest point when it is closer. */
+	using NearestFn = FunctionRef<void(int index, const float3 &co, BVHTreeNearest &nearest)>;
+	/**
+	 * Called with the index of every primitive in the leaves that overlap the query bounds, the
+	 * tree does not store the bounds of the primitives so the callback does the exact test.
+	 */
+	using OverlapFn = FunctionRef<void(int index)>;
+
+private:
+	/** The nodes of the tree, the root is the first one and children always follow their parent. */
+	Array<Node> nodes_;
+	/** The primitive indices, ordered so that every node references a contiguous range. */
+	Array<int> prim_indices_;
+
+public:
+	BVHTree() = default;
+	/**
+	 * Build the tree for the primitives with the given bounds, the leaves hold at most
+	 * \a leaf_size primitives unless they cannot be split.
+	 */
+	BVHTree(Span<Bounds<float3>> prim_bounds, int leaf_size = 4);
+
+	bool is_empty() const {
+		return nodes_.is_empty();
+	}
+	Span<Node> nodes() const {
+		return nodes_;
+	}
+	Span<int> prim_indices() const {
+		return prim_indices_;
+	}
+
+	/**
+	 * Recompute the bounds of the nodes for the moved primitives, the number of primitives has to
+	 * match the one the tree was built with.
+	 */
+	void refit(Span<Bounds<float3>> prim_bounds);
+
+	/**
+	 * Find the closest hit along the ray, \a hit should be initialized with the maximum distance.
+	 * \return True when a primitive was hit.
+	 */
+	bool ray_cast(const float3 &origin, const float3 &direction, BVHTreeRayHit &hit, RayCastFn fn) const;
+	/**
+	 * Find the nearest point to \a co, \a nearest should be initialized with the squared maximum
+	 * search distance. \return True when a primitive was found.
+	 */
+	bool find_nearest(const float3 &co, BVHTreeNearest &nearest, NearestFn fn) const;
+	void overlap(const Bounds<float3> &bounds, OverlapFn fn) const;
+
+	/**
+	 * Batched versions of the queries that run in parallel, the callbacks are called from multiple
+	 * threads and must be thread-safe.
+	 */
+	void ray_cast_batch(Span<float3> origins, Span<float3> directions, MutableSpan<BVHTreeRayHit> hits, RayCastFn fn) const;
+	void find_nearest_batch(Span<float3> cos, MutableSpan<BVHTreeNearest> nearest, NearestFn fn) const;
+	/** Called with the index of the query bounds and of the primitive, see #OverlapFn. */
+	void overlap_batch(Span<Bounds<float3>> bounds, FunctionRef<void(int query, int index)> fn) const;
+};
+
+}  // namespace rose
+
+#endif	// LIB_BVHTREE_HH
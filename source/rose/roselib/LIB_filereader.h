@@ -26,6 +26,24 @@ typedef struct FileReader {
 /** Raw byte read from simple native file descriptor! */
 FileReader *LIB_filereader_new_file(int descr);
 
+/**
+ * Memory map the file, the descriptor is not owned by the reader and may be closed right away.
+ * Returns NULL when the file can not be mapped (e.g. it is empty or on an unsupported file-system).
+ */
+FileReader *LIB_filereader_new_mmap(int descr);
+/**
+ * Access the memory of a reader created with #LIB_filereader_new_mmap, which allows reading
+ * without copying. The memory is a private mapping, modifying it does not affect the file.
+ * Returns NULL for any other kind of reader.
+ */
+void *LIB_filereader_mmap_data(FileReader *reader, size_t *r_length);
+
+/**
+ * Decompress a gzip stream read from \a base, which is owned (and closed) by the returned reader.
+ * Only available when built with zlib, the returned reader does not support seeking.
+ */
+FileReader *LIB_filereader_new_gzip(FileReader *base);
+
 #ifdef __cplusplus
 }
 #endif
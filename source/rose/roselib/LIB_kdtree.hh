@@ -0,0 +1,275 @@
+#ifndef LIB_KDTREE_HH
+#define LIB_KDTREE_HH
+
+#include "LIB_array.hh"
+#include "LIB_function_ref.hh"
+#include "LIB_math_vector.hh"
+#include "LIB_math_vector_types.hh"
+#include "LIB_span.hh"
+#include "LIB_task.hh"
+#include "LIB_vector.hh"
+
+#include <algorithm>
+#include <cfloat>
+#include <climits>
+
+namespace rose {
+
+/**
+ * A balanced KD-tree over points of 1 to 4 dimensions, the points keep the index they had in the
+ * span the tree was built from.
+ *
+ * The tree is stored implicitly, the nodes of a subtree occupy a contiguous range of the node
+ * array with the splitting node in the middle, so no child links are needed. The subtrees are
+ * built in parallel and the queries are safe to run from multiple threads.
+ */
+template<int DimsNum> class KDTree {
+	static_assert(DimsNum >= 1 && DimsNum <= 4, "KDTree supports 1 to 4 dimensions");
+
+public:
+	using PointT = VecBase<float, DimsNum>;
+
+	struct Nearest {
+		/** The index of the point, -1 when no point was found. */
+		int index = -1;
+		float dist_sq = FLT_MAX;
+		PointT co;
+	};
+
+	/** Called with every point in range, the points are not visited in any particular order. */
+	using RangeFn = FunctionRef<void(int index, const PointT &co, float dist_sq)>;
+
+private:
+	struct Node {
+		PointT co;
+		int index;
+		/** The axis the subtree of the node is split along. */
+		int axis;
+	};
+
+	/** Subtrees with more points than this are built in parallel. */
+	static constexpr int parallel_threshold = 4096;
+
+	Array<Node> nodes_;
+
+public:
+	KDTree() = default;
+	KDTree(const Span<PointT> points) : nodes_(points.size()) {
+		threading::parallel_for(points.index_range(), 4096, [&](const IndexRange range) {
+			for (const int index : range) {
+				nodes_[index].co = points[index];
+				nodes_[index].index = index;
+			}
+		});
+		this->build(nodes_);
+	}
+
+	int size() const {
+		return int(nodes_.size());
+	}
+	bool is_empty() const {
+		return nodes_.is_empty();
+	}
+
+	/** \return True when a point was found closer than the initial distance of \a r_nearest. */
+	bool find_nearest(const PointT &co, Nearest &r_nearest) const {
+		this->find_nearest_impl(nodes_, co, r_nearest);
+		return r_nearest.index != -1;
+	}
+
+	/**
+	 * Find the `r_nearest.size()` nearest points, sorted by distance.
+	 * \return The number of points found, smaller than requested when the tree has fewer points.
+	 */
+	int find_nearest_n(const PointT &co, MutableSpan<Nearest> r_nearest) const {
+		int found = 0;
+		this->find_nearest_n_impl(nodes_, co, r_nearest, found);
+		return found;
+	}
+
+	void find_range(const PointT &co, const float range, const RangeFn fn) const {
+		this->find_range_impl(nodes_, co, range * range, fn);
+	}
+
+	/** Gather the indices of the points in range, in no particular order. */
+	void find_range(const PointT &co, const float range, Vector<int> &r_indices) const {
+		this->find_range(co, range, [&](const int index, const PointT & /*co*/, const float /*dist_sq*/) { r_indices.append(index); });
+	}
+
+	/**
+	 * Compute a merge map for the points closer than \a range to each other. Every point is merged
+	 * into the point with the lowest index in range that is not merged itself, the result is the
+	 * same as visiting the points in index order and merging their unmerged neighbors into them.
+	 *
+	 * \param r_duplicates: The index of the point each point is merged into, -1 for points that are
+	 * kept. Its size is the number of points of the tree.
+	 * \return The number of merged points.
+	 */
+	int find_duplicates(const float range, MutableSpan<int> r_duplicates) const {
+		ROSE_assert(r_duplicates.size() == nodes_.size());
+		const float range_sq = range * range;
+
+		/* The lowest index in range of every point, in most cases that point is kept and it is the target. */
+		Array<int> lowest(nodes_.size());
+		Array<int> node_of_point(nodes_.size());
+		threading::parallel_for(nodes_.index_range(), 1024, [&](const IndexRange nodes_range) {
+			for (const int i : nodes_range) {
+				const Node &node = nodes_[i];
+				int lowest_index = node.index;
+				this->find_range_impl(nodes_, node.co, range_sq, [&](const int index, const PointT & /*co*/, const float /*dist_sq*/) {
+					lowest_index = std::min(lowest_index, index);
+				});
+				lowest[node.index] = lowest_index;
+				node_of_point[node.index] = i;
+			}
+		});
+
+		/* Resolve the chains in index order, only points whose lowest neighbor was merged are queried again. */
+		int duplicates_num = 0;
+		for (const int index : r_duplicates.index_range()) {
+			const int target = lowest[index];
+			if (target == index) {
+				r_duplicates[index] = -1;
+				continue;
+			}
+			if (r_duplicates[target] == -1) {
+				r_duplicates[index] = target;
+				duplicates_num++;
+				continue;
+			}
+
+			const PointT &co = nodes_[node_of_point[index]].co;
+			int kept_index = INT_MAX;
+			this->find_range_impl(nodes_, co, range_sq, [&](const int other, const PointT & /*co*/, const float /*dist_sq*/) {
+				if (other < index && r_duplicates[other] == -1) {
+					kept_index = std::min(kept_index, other);
+				}
+			});
+			r_duplicates[index] = (kept_index == INT_MAX) ? -1 : kept_index;
+			duplicates_num += (kept_index != INT_MAX);
+		}
+		return duplicates_num;
+	}
+
+private:
+	static float dist_squared(const PointT &a, const PointT &b) {
+		return math::distance_squared(a, b);
+	}
+
+	void build(MutableSpan<Node> nodes) {
+		if (nodes.size() <= 1) {
+			if (nodes.size() == 1) {
+				nodes[0].axis = 0;
+			}
+			return;
+		}
+
+		/* Split along the axis with the largest spread. */
+		PointT min = nodes[0].co;
+		PointT max = nodes[0].co;
+		for (const Node &node : nodes) {
+			min = math::min(min, node.co);
+			max = math::max(max, node.co);
+		}
+		const PointT spread = max - min;
+		int axis = 0;
+		for (int i = 1; i < DimsNum; i++) {
+			if (spread[i] > spread[axis]) {
+				axis = i;
+			}
+		}
+
+		const size_t mid = nodes.size() / 2;
+		std::nth_element(nodes.begin(), nodes.begin() + mid, nodes.end(), [axis](const Node &a, const Node &b) { return a.co[axis] < b.co[axis]; });
+		nodes[mid].axis = axis;
+
+		threading::parallel_invoke(nodes.size() > parallel_threshold,
+			[&]() {
+				this->build(nodes.take_front(mid));
+			},
+			[&]() {
+				this->build(nodes.drop_front(mid + 1));
+			}
+		);
+	}
+
+	void find_nearest_impl(const Span<Node> nodes, const PointT &co, Nearest &r_nearest) const {
+		if (nodes.is_empty()) {
+			return;
+		}
+		const size_t mid = nodes.size() / 2;
+		const Node &node = nodes[mid];
+
+		const float dist_sq = dist_squared(node.co, co);
+		if (dist_sq < r_nearest.dist_sq) {
+			r_nearest.index = node.index;
+			r_nearest.dist_sq = dist_sq;
+			r_nearest.co = node.co;
+		}
+
+		const float diff = co[node.axis] - node.co[node.axis];
+		const Span<Node> near_nodes = (diff < 0.0f) ? nodes.take_front(mid) : nodes.drop_front(mid + 1);
+		const Span<Node> far_nodes = (diff < 0.0f) ? nodes.drop_front(mid + 1) : nodes.take_front(mid);
+		this->find_nearest_impl(near_nodes, co, r_nearest);
+		if (diff * diff < r_nearest.dist_sq) {
+			this->find_nearest_impl(far_nodes, co, r_nearest);
+		}
+	}
+
+	void find_nearest_n_impl(const Span<Node> nodes, const PointT &co, MutableSpan<Nearest> r_nearest, int &found) const {
+		if (nodes.is_empty() || r_nearest.is_empty()) {
+			return;
+		}
+		const size_t mid = nodes.size() / 2;
+		const Node &node = nodes[mid];
+
+		const float dist_sq = dist_squared(node.co, co);
+		if (found < int(r_nearest.size()) || dist_sq < r_nearest[found - 1].dist_sq) {
+			/* Insertion into the sorted list, the number of requested points is expected to be small. */
+			int i = std::min(found, int(r_nearest.size()) - 1);
+			for (; i > 0 && r_nearest[i - 1].dist_sq > dist_sq; i--) {
+				r_nearest[i] = r_nearest[i - 1];
+			}
+			r_nearest[i] = {node.index, dist_sq, node.co};
+			found = std::min(found + 1, int(r_nearest.size()));
+		}
+
+		const float diff = co[node.axis] - node.co[node.axis];
+		const Span<Node> near_nodes = (diff < 0.0f) ? nodes.take_front(mid) : nodes.drop_front(mid + 1);
+		const Span<Node> far_nodes = (diff < 0.0f) ? nodes.drop_front(mid + 1) : nodes.take_front(mid);
+		this->find_nearest_n_impl(near_nodes, co, r_nearest, found);
+		if (found < int(r_nearest.size()) || diff * diff < r_nearest[found - 1].dist_sq) {
+			this->find_nearest_n_impl(far_nodes, co, r_nearest, found);
+		}
+	}
+
+	void find_range_impl(const Span<Node> nodes, const PointT &co, const float range_sq, const RangeFn fn) const {
+		if (nodes.is_empty()) {
+			return;
+		}
+		const size_t mid = nodes.size() / 2;
+		const Node &node = nodes[mid];
+
+		const float dist_sq = dist_squared(node.co, co);
+		if (dist_sq <= range_sq) {
+			fn(node.index, node.co, dist_sq);
+		}
+
+		const float diff = co[node.axis] - node.co[node.axis];
+		if (diff <= 0.0f || diff * diff <= range_sq) {
+			this->find_range_impl(nodes.take_front(mid), co, range_sq, fn);
+		}
+		if (diff >= 0.0f || diff * diff <= range_sq) {
+			this->find_range_impl(nodes.drop_front(mid + 1), co, range_sq, fn);
+		}
+	}
+};
+
+using KDTree_1d = KDTree<1>;
+using KDTree_2d = KDTree<2>;
+using KDTree_3d = KDTree<3>;
+using KDTree_4d = KDTree<4>;
+
+}  // namespace rose
+
+#endif	// LIB_KDTREE_HH
@@ -0,0 +1,30 @@
+#ifndef LIB_MMAP_H
+#define LIB_MMAP_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct LIB_mmap_file LIB_mmap_file;
+
+/**
+ * Map the whole file into memory, the file descriptor can be closed afterwards.
+ *
+ * The mapping is private (copy-on-write), writing to the memory only modifies the pages that are
+ * written to and never the file itself, which allows fixing up data in place.
+ */
+LIB_mmap_file *LIB_mmap_open(int fd);
+
+void *LIB_mmap_get_pointer(LIB_mmap_file *file);
+size_t LIB_mmap_get_length(const LIB_mmap_file *file);
+
+void LIB_mmap_free(LIB_mmap_file *file);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif	// LIB_MMAP_H
@@ -49,6 +49,20 @@ public:
 		}
 	}
 
+	/**
+	 * Like #tag_dirty, but the current value remains available to the next #ensure (copied from
+	 * shared data if necessary), so that it can be updated there rather than computed from scratch.
+	 * The update itself is deferred until the data is needed, unlike #update.
+	 */
+	void tag_dirty_keep_data() {
+		if (cache_.use_count() == 1) {
+			cache_->mutex.tag_dirty();
+		}
+		else {
+			cache_ = std::make_shared<CacheData>(cache_->data);
+		}
+	}
+
 	/**
 	 * If the cache is dirty, trigger its computation with the provided function which should set
 	 * the proper data.
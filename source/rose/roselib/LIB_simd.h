@@ -0,0 +1,14 @@
+#ifndef LIB_SIMD_H
+#define LIB_SIMD_H
+
+/**
+ * SSE2 is part of every x86-64 processor, code using it still needs a scalar version for other
+ * architectures, guarded by #ROSE_HAVE_SSE2.
+ */
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#	include <emmintrin.h>
+#	define ROSE_HAVE_SSE2
+#endif
+
+#endif	// LIB_SIMD_H
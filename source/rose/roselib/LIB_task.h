@@ -14,12 +14,14 @@ struct MemPool;
 /** \name Task Scheduler
  *
  * Central scheduler that holds running threads ready to execute tasks.
- * A single queue holds the task from all pools.
+ * Each thread owns a queue of tasks, idle threads steal tasks from the other queues.
  *
  * Initialize/exit must be called before/after any task pools are created/freed, and must
  * be called from the main threads. All other scheduler and pool functions are thread-safe.
+ * Until initialized, all the tasks are executed on the calling thread.
  * \{ */
 
+/** Start #LIB_system_thread_count threads, including the calling thread. */
 void LIB_task_scheduler_init(void);
 void LIB_task_scheduler_exit(void);
 int LIB_task_scheduler_num_threads(void);
@@ -265,6 +267,11 @@ ROSE_INLINE void LIB_parallel_mempool_settings_defaults(TaskParallelSettings *se
 /**
  * Don't use this, store any thread specific data in `tls->userdata_chunk` instead.
  * Only here for code to be removed.
+ *
+ * Returns a value in the range [0, #LIB_task_scheduler_num_threads) for the threads owned by the
+ * scheduler and zero for the thread that called #LIB_task_scheduler_init. Every other thread gets
+ * its own index at or above #LIB_task_scheduler_num_threads, increasing with each new thread, so
+ * the value can not be used to index an array sized by the number of scheduler threads.
  */
 int LIB_task_parallel_thread_id(const TaskParallelTLS *tls);
 
@@ -303,7 +310,8 @@ int LIB_task_parallel_thread_id(const TaskParallelTLS *tls);
  * Any node can be triggered to start a chain of tasks. Normally you would trigger a root node but
  * it is supported to start the chain of tasks anywhere in the forest or tree. When a node
  * completes, the execution flow is forwarded via the created edges.
- * When a child node has multiple parents the child node will be triggered once for each parent.
+ * When a child node has multiple parents the child node is only triggered once, after all of its
+ * parents have completed. Nodes that are ready run in parallel on the task scheduler.
  *
  *    `LIB_task_graph_node_push_work(root);`
  *
@@ -319,8 +327,10 @@ int LIB_task_parallel_thread_id(const TaskParallelTLS *tls);
  *
  *    `LIB_task_graph_free(task_graph);`
  *
- * Work can enter a tree on any node. Normally this would be the root_node.
- * A `task_graph` can be reused, but the caller needs to make sure the task_data is reset.
+ * Work can enter a tree on any node. Normally this would be the root_node. The node that work is
+ * pushed to runs regardless of its parents.
+ * A `task_graph` can be reused after #LIB_task_graph_work_and_wait returned, but the caller needs
+ * to make sure the task_data is reset.
  *
  * Task-Data
  * ---------
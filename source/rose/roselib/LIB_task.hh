@@ -23,6 +23,11 @@
 #			undef NOMINMAX
 #		endif
 #	endif
+#else
+#	include <iterator>
+#	include <mutex>
+#	include <optional>
+#	include <vector>
 #endif
 
 #include "LIB_function_ref.hh"
@@ -46,20 +51,50 @@ struct GrainSize {
 
 namespace rose::threading {
 
+namespace detail {
+void parallel_for_impl(IndexRange range, size_t grain_size, FunctionRef<void(IndexRange)> function);
+#ifndef WITH_TBB
+/**
+ * Number of threads that would work on \a range in parallel, one when the range is too small to be
+ * split into sub-ranges of \a grain_size.
+ */
+int parallel_participants_num(IndexRange range, size_t grain_size);
+/**
+ * Invoke \a function for sub-ranges of at most \a grain_size elements. The participating thread
+ * passed to \a function is smaller than \a participants_num and never runs concurrently with itself.
+ */
+void parallel_for_participants_impl(IndexRange range, size_t grain_size, int participants_num, FunctionRef<void(int participant, IndexRange range)> function);
+/** Invoke \a function on up to #LIB_task_scheduler_num_threads threads at the same time. */
+void parallel_run_impl(FunctionRef<void()> function);
+void parallel_invoke_impl(const FunctionRef<void()> *functions, int functions_num);
+void isolate_task_impl(FunctionRef<void()> function);
+#endif
+}  // namespace detail
+
 template<typename Range, typename Function> inline void parallel_for_each(Range &&range, const Function &function) {
 #ifdef WITH_TBB
 	tbb::parallel_for_each(range, function);
 #else
-	for (const auto &value : range) {
-		function(value);
-	}
+	using Iterator = decltype(std::begin(range));
+	Iterator iterator = std::begin(range);
+	const Iterator end = std::end(range);
+	std::mutex mutex;
+	/* The items are handed out one at a time, each of them is expected to do a lot of work. */
+	detail::parallel_run_impl([&]() {
+		while (true) {
+			std::unique_lock<std::mutex> lock(mutex);
+			if (!(iterator != end)) {
+				break;
+			}
+			const Iterator current = iterator;
+			++iterator;
+			lock.unlock();
+			function(*current);
+		}
+	});
 #endif
 }
 
-namespace detail {
-void parallel_for_impl(IndexRange range, size_t grain_size, FunctionRef<void(IndexRange)> function);
-}  // namespace detail
-
 template<typename Function> inline void parallel_for(IndexRange range, size_t grain_size, const Function &function) {
 	if (range.is_empty()) {
 		return;
@@ -109,7 +144,24 @@ template<typename Value, typename Function, typename Reduction> inline Value par
 		return tbb::parallel_reduce(tbb::blocked_range<size_t>(range.first(), range.one_after_last(), grain_size), identity, [&](const tbb::blocked_range<size_t> &subrange, const Value &ident) { return function(IndexRange(subrange.begin(), subrange.size()), ident); }, reduction);
 	}
 #else
-	UNUSED_VARS(grain_size, reduction);
+	const int participants_num = detail::parallel_participants_num(range, grain_size);
+	if (participants_num > 1) {
+		lazy_threading::send_hint();
+		/* Every participant accumulates the sub-ranges it processed, the results of the participants
+		 * are joined afterwards, on the calling thread. */
+		std::vector<std::optional<Value>> values(participants_num);
+		detail::parallel_for_participants_impl(range, grain_size, participants_num, [&](const int participant, const IndexRange sub_range) {
+			std::optional<Value> &value = values[participant];
+			value = function(sub_range, value.has_value() ? *value : identity);
+		});
+		Value result = identity;
+		for (const std::optional<Value> &value : values) {
+			if (value.has_value()) {
+				result = reduction(result, *value);
+			}
+		}
+		return result;
+	}
 #endif
 	return function(range, identity);
 }
@@ -134,7 +186,8 @@ template<typename... Functions> inline void parallel_invoke(Functions &&...funct
 #ifdef WITH_TBB
 	tbb::parallel_invoke(std::forward<Functions>(functions)...);
 #else
-	(functions(), ...);
+	const FunctionRef<void()> function_refs[] = {functions...};
+	detail::parallel_invoke_impl(function_refs, int(sizeof...(Functions)));
 #endif
 }
 
@@ -155,11 +208,11 @@ template<typename... Functions> inline void parallel_invoke(const bool use_threa
 
 /** See #LIB_task_isolate for a description of what isolating a task means. */
 template<typename Function> inline void isolate_task(const Function &function) {
-#ifdef WITH_TBB
 	lazy_threading::ReceiverIsolation isolation;
+#ifdef WITH_TBB
 	tbb::this_task_arena::isolate(function);
 #else
-	function();
+	detail::isolate_task_impl(function);
 #endif
 }
 
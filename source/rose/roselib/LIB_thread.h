@@ -160,6 +160,13 @@ void LIB_thread_queue_nowait(ThreadQueue *queue);
 
 size_t LIB_system_thread_count();
 
+/**
+ * Override the number of threads reported by #LIB_system_thread_count, zero restores the amount of
+ * processors. Has to be set before #LIB_task_scheduler_init to affect the task scheduler.
+ */
+void LIB_system_num_threads_override_set(int num);
+int LIB_system_num_threads_override_get(void);
+
 /** \} */
 
 #ifdef __cplusplus
@@ -0,0 +1,360 @@
+#include "LIB_array_utils.hh"
+#include "LIB_bvhtree.hh"
+#include "LIB_math_vector.hh"
+#include "LIB_task.hh"
+#include "LIB_vector.hh"
+
+#include <algorithm>
+#include <atomic>
+
+namespace rose {
+
+/** The number of bins the centroids are sorted into to evaluate the surface area heuristic. */
+constexpr int BVH_BINS_NUM = 16;
+/** Subtrees with more primitives than this are built and refit in parallel. */
+constexpr int BVH_PARALLEL_THRESHOLD = 4096;
+
+/* -------------------------------------------------------------------- */
+/** \name Bounds Utils
+ * \{ */
+
+ROSE_INLINE Bounds<float3> bvh_bounds_empty() {
+	return Bounds<float3>(float3(FLT_MAX), float3(-FLT_MAX));
+}
+
+ROSE_INLINE float bvh_bounds_half_area(const Bounds<float3> &bounds) {
+	const float3 size = bounds.max - bounds.min;
+	return size.x * size.y + size.y * size.z + size.z * size.x;
+}
+
+ROSE_INLINE bool bvh_bounds_overlap(const Bounds<float3> &a, const Bounds<float3> &b) {
+	return a.min.x <= b.max.x && a.min.y <= b.max.y && a.min.z <= b.max.z && b.min.x <= a.max.x && b.min.y <= a.max.y && b.min.z <= a.max.z;
+}
+
+ROSE_INLINE float bvh_bounds_dist_squared(const Bounds<float3> &bounds, const float3 &co) {
+	return math::distance_squared(co, math::clamp(co, bounds.min, bounds.max));
+}
+
+/** Slab test of the ray against the bounds, \a r_tmin is the entry distance clamped to the origin. */
+ROSE_INLINE bool bvh_bounds_isect_ray(const Bounds<float3> &bounds, const float3 &origin, const float3 &inv_direction, float *r_tmin) {
+	const float3 t0 = (bounds.min - origin) * inv_direction;
+	const float3 t1 = (bounds.max - origin) * inv_direction;
+	const float tmin = math::max(math::reduce_max(math::min(t0, t1)), 0.0f);
+	const float tmax = math::reduce_min(math::max(t0, t1));
+	*r_tmin = tmin;
+	return tmin <= tmax;
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Tree Construction
+ * \{ */
+
+struct BVHBuildContext {
+	Span<Bounds<float3>> prim_bounds;
+	Span<float3> centroids;
+	MutableSpan<int> prim_indices;
+	MutableSpan<BVHTree::Node> nodes;
+	/** The nodes are allocated in pairs while the subtrees are built concurrently. */
+	std::atomic<int> nodes_num;
+	int leaf_size;
+};
+
+/**
+ * Find the number of primitives that go to the first child and sort them to the front of the
+ * range, the split is the one with the lowest surface area heuristic cost among the bins.
+ */
+static int bvh_build_split(BVHBuildContext &ctx, MutableSpan<int> prims, const Bounds<float3> &centroid_bounds) {
+	const float3 extent = centroid_bounds.max - centroid_bounds.min;
+	const int axis = (extent.x >= extent.y && extent.x >= extent.z) ? 0 : ((extent.y >= extent.z) ? 1 : 2);
+	if (!(extent[axis] > 0.0f)) {
+		/* All the centroids are at the same location, any split is as good as the other. */
+		return int(prims.size() / 2);
+	}
+
+	const float bin_scale = float(BVH_BINS_NUM) / extent[axis];
+	const float bin_min = centroid_bounds.min[axis];
+	auto bin_of = [&](const int prim) {
+		return std::min(int((ctx.centroids[prim][axis] - bin_min) * bin_scale), BVH_BINS_NUM - 1);
+	};
+
+	int bin_counts[BVH_BINS_NUM] = {0};
+	Bounds<float3> bin_bounds[BVH_BINS_NUM];
+	std::fill_n(bin_bounds, BVH_BINS_NUM, bvh_bounds_empty());
+	for (const int prim : prims) {
+		const int bin = bin_of(prim);
+		bin_counts[bin]++;
+		bin_bounds[bin] = bounds::merge(bin_bounds[bin], ctx.prim_bounds[prim]);
+	}
+
+	/* The cost of the primitives right of every split, accumulated from the last bin. */
+	float right_costs[BVH_BINS_NUM];
+	Bounds<float3> right_bounds = bvh_bounds_empty();
+	int right_count = 0;
+	for (int bin = BVH_BINS_NUM - 1; bin > 0; bin--) {
+		right_bounds = bounds::merge(right_bounds, bin_bounds[bin]);
+		right_count += bin_counts[bin];
+		right_costs[bin] = (right_count) ? bvh_bounds_half_area(right_bounds) * right_count : 0.0f;
+	}
+
+	int best_bin = -1;
+	float best_cost = FLT_MAX;
+	Bounds<float3> left_bounds = bvh_bounds_empty();
+	int left_count = 0;
+	for (int bin = 0; bin < BVH_BINS_NUM - 1; bin++) {
+		left_bounds = bounds::merge(left_bounds, bin_bounds[bin]);
+		left_count += bin_counts[bin];
+		if (left_count == 0 || left_count == int(prims.size())) {
+			continue;
+		}
+		const float cost = bvh_bounds_half_area(left_bounds) * left_count + right_costs[bin + 1];
+		if (cost < best_cost) {
+			best_cost = cost;
+			best_bin = bin;
+		}
+	}
+
+	if (best_bin != -1) {
+		int *mid = std::partition(prims.begin(), prims.end(), [&](const int prim) { return bin_of(prim) <= best_bin; });
+		return int(mid - prims.begin());
+	}
+
+	/* All the centroids fell in a single bin, split at the median instead. */
+	const int mid = int(prims.size() / 2);
+	std::nth_element(prims.begin(), prims.begin() + mid, prims.end(), [&](const int a, const int b) {
+		return ctx.centroids[a][axis] < ctx.centroids[b][axis];
+	});
+	return mid;
+}
+
+static void bvh_build_node(BVHBuildContext &ctx, const int node_index, const int prim_start, const int prim_num) {
+	BVHTree::Node &node = ctx.nodes[node_index];
+	node.prim_start = prim_start;
+	node.prim_num = prim_num;
+	node.children = -1;
+
+	MutableSpan<int> prims = ctx.prim_indices.slice(prim_start, prim_num);
+
+	Bounds<float3> node_bounds = bvh_bounds_empty();
+	Bounds<float3> centroid_bounds = bvh_bounds_empty();
+	for (const int prim : prims) {
+		node_bounds = bounds::merge(node_bounds, ctx.prim_bounds[prim]);
+		centroid_bounds.min = math::min(centroid_bounds.min, ctx.centroids[prim]);
+		centroid_bounds.max = math::max(centroid_bounds.max, ctx.centroids[prim]);
+	}
+	node.bounds = node_bounds;
+
+	if (prim_num <= ctx.leaf_size) {
+		return;
+	}
+
+	const int mid = bvh_build_split(ctx, prims, centroid_bounds);
+	const int children = ctx.nodes_num.fetch_add(2);
+	node.children = children;
+
+	threading::parallel_invoke(prim_num > BVH_PARALLEL_THRESHOLD,
+		[&]() {
+			bvh_build_node(ctx, children, prim_start, mid);
+		},
+		[&]() {
+			bvh_build_node(ctx, children + 1, prim_start + mid, prim_num - mid);
+		}
+	);
+}
+
+BVHTree::BVHTree(const Span<Bounds<float3>> prim_bounds, const int leaf_size) {
+	if (prim_bounds.is_empty()) {
+		return;
+	}
+
+	Array<float3> centroids(prim_bounds.size());
+	threading::parallel_for(prim_bounds.index_range(), 4096, [&](const IndexRange range) {
+		for (const int index : range) {
+			centroids[index] = prim_bounds[index].center();
+		}
+	});
+
+	prim_indices_.reinitialize(prim_bounds.size());
+	array_utils::fill_index_range<int>(prim_indices_);
+
+	/* A binary tree with a primitive per leaf has this many nodes, there are fewer with bigger leaves. */
+	Array<Node> nodes(prim_bounds.size() * 2 - 1);
+
+	BVHBuildContext ctx;
+	ctx.prim_bounds = prim_bounds;
+	ctx.centroids = centroids;
+	ctx.prim_indices = prim_indices_;
+	ctx.nodes = nodes;
+	ctx.nodes_num = 1;
+	ctx.leaf_size = std::max(leaf_size, 1);
+
+	bvh_build_node(ctx, 0, 0, int(prim_bounds.size()));
+
+	nodes_ = nodes.as_span().take_front(ctx.nodes_num);
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Refit
+ * \{ */
+
+static void bvh_refit_node(MutableSpan<BVHTree::Node> nodes, const Span<int> prim_indices, const Span<Bounds<float3>> prim_bounds, const int node_index) {
+	BVHTree::Node &node = nodes[node_index];
+	if (node.children == -1) {
+		Bounds<float3> node_bounds = bvh_bounds_empty();
+		for (const int prim : prim_indices.slice(node.prim_start, node.prim_num)) {
+			node_bounds = bounds::merge(node_bounds, prim_bounds[prim]);
+		}
+		node.bounds = node_bounds;
+		return;
+	}
+
+	threading::parallel_invoke(node.prim_num > BVH_PARALLEL_THRESHOLD,
+		[&]() {
+			bvh_refit_node(nodes, prim_indices, prim_bounds, node.children);
+		},
+		[&]() {
+			bvh_refit_node(nodes, prim_indices, prim_bounds, node.children + 1);
+		}
+	);
+	node.bounds = bounds::merge(nodes[node.children].bounds, nodes[node.children + 1].bounds);
+}
+
+void BVHTree::refit(const Span<Bounds<float3>> prim_bounds) {
+	ROSE_assert(prim_bounds.size() == prim_indices_.size());
+	if (this->is_empty()) {
+		return;
+	}
+	bvh_refit_node(nodes_, prim_indices_, prim_bounds, 0);
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Queries
+ * \{ */
+
+bool BVHTree::ray_cast(const float3 &origin, const float3 &direction, BVHTreeRayHit &hit, const RayCastFn fn) const {
+	if (this->is_empty()) {
+		return false;
+	}
+
+	const float3 inv_direction = float3(1.0f) / direction;
+
+	Vector<int, 64> stack;
+	stack.append(0);
+	while (!stack.is_empty()) {
+		const Node &node = nodes_[stack.pop_last()];
+
+		float tmin;
+		if (!bvh_bounds_isect_ray(node.bounds, origin, inv_direction, &tmin) || tmin > hit.dist) {
+			continue;
+		}
+		if (node.children == -1) {
+			for (const int prim : prim_indices_.as_span().slice(node.prim_start, node.prim_num)) {
+				fn(prim, origin, direction, hit);
+			}
+			continue;
+		}
+
+		/* Visit the closest child first so that the hit distance prunes more of the other one. */
+		float t0, t1;
+		const bool hit0 = bvh_bounds_isect_ray(nodes_[node.children].bounds, origin, inv_direction, &t0) && t0 <= hit.dist;
+		const bool hit1 = bvh_bounds_isect_ray(nodes_[node.children + 1].bounds, origin, inv_direction, &t1) && t1 <= hit.dist;
+		if (hit0 && hit1) {
+			stack.append((t0 <= t1) ? node.children + 1 : node.children);
+			stack.append((t0 <= t1) ? node.children : node.children + 1);
+		}
+		else if (hit0) {
+			stack.append(node.children);
+		}
+		else if (hit1) {
+			stack.append(node.children + 1);
+		}
+	}
+	return hit.index != -1;
+}
+
+bool BVHTree::find_nearest(const float3 &co, BVHTreeNearest &nearest, const NearestFn fn) const {
+	if (this->is_empty()) {
+		return false;
+	}
+
+	Vector<int, 64> stack;
+	stack.append(0);
+	while (!stack.is_empty()) {
+		const Node &node = nodes_[stack.pop_last()];
+
+		if (bvh_bounds_dist_squared(node.bounds, co) > nearest.dist_sq) {
+			continue;
+		}
+		if (node.children == -1) {
+			for (const int prim : prim_indices_.as_span().slice(node.prim_start, node.prim_num)) {
+				fn(prim, co, nearest);
+			}
+			continue;
+		}
+
+		const float d0 = bvh_bounds_dist_squared(nodes_[node.children].bounds, co);
+		const float d1 = bvh_bounds_dist_squared(nodes_[node.children + 1].bounds, co);
+		stack.append((d0 <= d1) ? node.children + 1 : node.children);
+		stack.append((d0 <= d1) ? node.children : node.children + 1);
+	}
+	return nearest.index != -1;
+}
+
+void BVHTree::overlap(const Bounds<float3> &bounds, const OverlapFn fn) const {
+	if (this->is_empty()) {
+		return;
+	}
+
+	Vector<int, 64> stack;
+	stack.append(0);
+	while (!stack.is_empty()) {
+		const Node &node = nodes_[stack.pop_last()];
+
+		if (!bvh_bounds_overlap(node.bounds, bounds)) {
+			continue;
+		}
+		if (node.children == -1) {
+			for (const int prim : prim_indices_.as_span().slice(node.prim_start, node.prim_num)) {
+				fn(prim);
+			}
+			continue;
+		}
+		stack.append(node.children + 1);
+		stack.append(node.children);
+	}
+}
+
+void BVHTree::ray_cast_batch(const Span<float3> origins, const Span<float3> directions, MutableSpan<BVHTreeRayHit> hits, const RayCastFn fn) const {
+	ROSE_assert(origins.size() == directions.size() && origins.size() == hits.size());
+	threading::parallel_for(hits.index_range(), 64, [&](const IndexRange range) {
+		for (const int index : range) {
+			this->ray_cast(origins[index], directions[index], hits[index], fn);
+		}
+	});
+}
+
+void BVHTree::find_nearest_batch(const Span<float3> cos, MutableSpan<BVHTreeNearest> nearest, const NearestFn fn) const {
+	ROSE_assert(cos.size() == nearest.size());
+	threading::parallel_for(nearest.index_range(), 64, [&](const IndexRange range) {
+		for (const int index : range) {
+			this->find_nearest(cos[index], nearest[index], fn);
+		}
+	});
+}
+
+void BVHTree::overlap_batch(const Span<Bounds<float3>> bounds, const FunctionRef<void(int query, int index)> fn) const {
+	threading::parallel_for(bounds.index_range(), 64, [&](const IndexRange range) {
+		for (const int query : range) {
+			this->overlap(bounds[query], [&](const int index) { fn(query, index); });
+		}
+	});
+}
+
+/** \} */
+
+}  // namespace rose
@@ -0,0 +1,93 @@
+#include <limits.h>
+#include <zlib.h>
+
+#include "MEM_guardedalloc.h"
+
+#include "LIB_filereader.h"
+#include "LIB_utildefines.h"
+
+/** Size of the compressed data read from the base reader at once. */
+#define GZIP_IN_BUFFER_SIZE (1 << 16)
+
+typedef struct GzipReader {
+	FileReader reader;
+
+	FileReader *base;
+
+	z_stream strm;
+
+	void *in_buf;
+	size_t in_size;
+} GzipReader;
+
+ROSE_STATIC uint64_t gzip_read(FileReader *reader, void *buffer, size_t size) {
+	GzipReader *gzip = (GzipReader *)reader;
+
+	uint64_t readsize = 0;
+	while (readsize < size) {
+		/* The output size of the stream is an unsigned integer, large reads are done in parts. */
+		const uInt chunk = (uInt)ROSE_MIN(size - readsize, (size_t)UINT_MAX);
+		gzip->strm.avail_out = chunk;
+		gzip->strm.next_out = (Bytef *)buffer + readsize;
+
+		bool stream_end = false;
+		while (gzip->strm.avail_out > 0) {
+			if (gzip->strm.avail_in == 0) {
+				/* Ran out of buffered input data, read some more. */
+				const int64_t basesize = (int64_t)gzip->base->read(gzip->base, gzip->in_buf, gzip->in_size);
+				if (basesize <= 0) {
+					/* Reached EOF or failed to read the file. */
+					stream_end = true;
+					break;
+				}
+				gzip->strm.next_in = (Bytef *)gzip->in_buf;
+				gzip->strm.avail_in = (uInt)basesize;
+			}
+
+			const int ret = inflate(&gzip->strm, Z_NO_FLUSH);
+			if (!ELEM(ret, Z_OK, Z_BUF_ERROR)) {
+				/* End of the stream or corrupt data. */
+				stream_end = true;
+				break;
+			}
+		}
+
+		readsize += chunk - gzip->strm.avail_out;
+		if (stream_end) {
+			break;
+		}
+	}
+
+	reader->offset += readsize;
+	return readsize;
+}
+
+ROSE_STATIC void gzip_close(FileReader *reader) {
+	GzipReader *gzip = (GzipReader *)reader;
+
+	inflateEnd(&gzip->strm);
+	gzip->base->close(gzip->base);
+
+	MEM_freeN(gzip->in_buf);
+	MEM_freeN(gzip);
+}
+
+FileReader *LIB_filereader_new_gzip(FileReader *base) {
+	GzipReader *gzip = MEM_callocN(sizeof(GzipReader), "GzipReader");
+	gzip->base = base;
+
+	/* Add 16 to the window bits, so that zlib expects (and skips) a gzip header. */
+	if (inflateInit2(&gzip->strm, 16 + MAX_WBITS) != Z_OK) {
+		MEM_freeN(gzip);
+		return NULL;
+	}
+
+	gzip->in_size = GZIP_IN_BUFFER_SIZE;
+	gzip->in_buf = MEM_mallocN(gzip->in_size, "GzipReader.in_buf");
+
+	gzip->reader.read = gzip_read;
+	gzip->reader.seek = NULL;
+	gzip->reader.close = gzip_close;
+
+	return (FileReader *)gzip;
+}
@@ -0,0 +1,81 @@
+#include <string.h>
+
+#include "MEM_guardedalloc.h"
+
+#include "LIB_fileops.h"
+#include "LIB_filereader.h"
+#include "LIB_mmap.h"
+#include "LIB_utildefines.h"
+
+typedef struct MmapReader {
+	FileReader reader;
+
+	LIB_mmap_file *mmap;
+
+	const char *data;
+	size_t length;
+} MmapReader;
+
+ROSE_STATIC uint64_t mmap_read(FileReader *reader, void *buffer, size_t size) {
+	MmapReader *mmap = (MmapReader *)reader;
+
+	if (reader->offset >= mmap->length) {
+		return 0;
+	}
+	const size_t readsize = ROSE_MIN(size, mmap->length - (size_t)reader->offset);
+	memcpy(buffer, mmap->data + reader->offset, readsize);
+	reader->offset += readsize;
+	return readsize;
+}
+
+ROSE_STATIC uint64_t mmap_seek(FileReader *reader, uint64_t offset, int whence) {
+	MmapReader *mmap = (MmapReader *)reader;
+
+	switch (whence) {
+		case SEEK_SET:
+			break;
+		case SEEK_CUR:
+			offset += reader->offset;
+			break;
+		case SEEK_END:
+			offset += mmap->length;
+			break;
+		default:
+			return (uint64_t)-1;
+	}
+	reader->offset = offset;
+	return reader->offset;
+}
+
+ROSE_STATIC void mmap_close(FileReader *reader) {
+	MmapReader *mmap = (MmapReader *)reader;
+	LIB_mmap_free(mmap->mmap);
+	MEM_freeN(mmap);
+}
+
+FileReader *LIB_filereader_new_mmap(int descr) {
+	LIB_mmap_file *file = LIB_mmap_open(descr);
+	if (file == NULL) {
+		return NULL;
+	}
+
+	MmapReader *mmap = MEM_callocN(sizeof(MmapReader), "MmapReader");
+	mmap->mmap = file;
+	mmap->data = LIB_mmap_get_pointer(file);
+	mmap->length = LIB_mmap_get_length(file);
+
+	mmap->reader.read = mmap_read;
+	mmap->reader.seek = mmap_seek;
+	mmap->reader.close = mmap_close;
+
+	return (FileReader *)mmap;
+}
+
+void *LIB_filereader_mmap_data(FileReader *reader, size_t *r_length) {
+	if (reader->read != mmap_read) {
+		return NULL;
+	}
+	MmapReader *mmap = (MmapReader *)reader;
+	*r_length = mmap->length;
+	return (void *)mmap->data;
+}
@@ -0,0 +1,91 @@
+#include "MEM_guardedalloc.h"
+
+#include "LIB_fileops.h"
+#include "LIB_mmap.h"
+#include "LIB_utildefines.h"
+
+#include <sys/stat.h>
+
+#if defined(WIN32)
+#	include <windows.h>
+#else
+#	include <sys/mman.h>
+#endif
+
+typedef struct LIB_mmap_file {
+	void *memory;
+	size_t length;
+
+#if defined(WIN32)
+	HANDLE handle;
+#endif
+} LIB_mmap_file;
+
+LIB_mmap_file *LIB_mmap_open(int fd) {
+	/* The size is queried without seeking, callers fall back to reading the descriptor from where
+	 * it was when the file can not be mapped. */
+#if defined(WIN32)
+	struct _stat64 st;
+	if (_fstat64(fd, &st) == -1) {
+		return NULL;
+	}
+#else
+	struct stat st;
+	if (fstat(fd, &st) == -1) {
+		return NULL;
+	}
+#endif
+	void *memory;
+	const size_t length = (size_t)st.st_size;
+	if (length == 0) {
+		/* Empty files can not be mapped. */
+		return NULL;
+	}
+
+#if defined(WIN32)
+	HANDLE file_handle = (HANDLE)_get_osfhandle(fd);
+	if (file_handle == INVALID_HANDLE_VALUE) {
+		return NULL;
+	}
+	HANDLE handle = CreateFileMapping(file_handle, NULL, PAGE_WRITECOPY, 0, 0, NULL);
+	if (handle == NULL) {
+		return NULL;
+	}
+	memory = MapViewOfFile(handle, FILE_MAP_COPY, 0, 0, 0);
+	if (memory == NULL) {
+		CloseHandle(handle);
+		return NULL;
+	}
+#else
+	memory = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+	if (memory == MAP_FAILED) {
+		return NULL;
+	}
+#endif
+
+	LIB_mmap_file *file = MEM_callocN(sizeof(LIB_mmap_file), "LIB_mmap_file");
+	file->memory = memory;
+	file->length = length;
+#if defined(WIN32)
+	file->handle = handle;
+#endif
+	return file;
+}
+
+void *LIB_mmap_get_pointer(LIB_mmap_file *file) {
+	return file->memory;
+}
+
+size_t LIB_mmap_get_length(const LIB_mmap_file *file) {
+	return file->length;
+}
+
+void LIB_mmap_free(LIB_mmap_file *file) {
+#if defined(WIN32)
+	UnmapViewOfFile(file->memory);
+	CloseHandle(file->handle);
+#else
+	munmap(file->memory, file->length);
+#endif
+	MEM_freeN(file);
+}
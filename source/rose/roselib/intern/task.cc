@@ -5,6 +5,11 @@
 #	include <tbb/enumerable_thread_specific.h>
 #	include <tbb/parallel_for.h>
 #	include <tbb/parallel_reduce.h>
+#else
+#	include <algorithm>
+#	include <atomic>
+
+#	include "task_scheduler_private.hh"
 #endif
 
 namespace rose::threading::detail {
@@ -13,6 +18,51 @@ namespace rose::threading::detail {
 static void parallel_for_impl_static_size(const IndexRange range, const size_t grain_size, const FunctionRef<void(IndexRange)> function) {
 	tbb::parallel_for(tbb::blocked_range<size_t>(range.first(), range.one_after_last(), grain_size), [function](const tbb::blocked_range<size_t> &subrange) { function(IndexRange(subrange.begin(), subrange.size())); });
 }
+#else
+int parallel_participants_num(const IndexRange range, const size_t grain_size) {
+	if (range.size() <= grain_size) {
+		return 1;
+	}
+	const size_t chunks_num = (range.size() + grain_size - 1) / grain_size;
+	return int(std::min<size_t>(chunks_num, scheduler::threads_num()));
+}
+
+void parallel_for_participants_impl(const IndexRange range, const size_t grain_size, const int participants_num, const FunctionRef<void(int participant, IndexRange range)> function) {
+	/* The sub-ranges are handed out dynamically, so that threads which are done early (or joined
+	 * late) take over more of the work. A thread waiting in a nested loop keeps taking sub-ranges of
+	 * the outer loop as well, which is what makes nested parallelism work. */
+	const size_t chunk_size = std::max<size_t>(grain_size, 1);
+	const size_t chunks_num = (range.size() + chunk_size - 1) / chunk_size;
+	std::atomic<size_t> next_chunk = 0;
+
+	scheduler::run_participants(participants_num, [&](const int participant) {
+		while (true) {
+			const size_t chunk = next_chunk.fetch_add(1, std::memory_order_relaxed);
+			if (chunk >= chunks_num) {
+				break;
+			}
+			const size_t start = chunk * chunk_size;
+			function(participant, range.slice(start, std::min(chunk_size, range.size() - start)));
+		}
+	});
+}
+
+void parallel_run_impl(const FunctionRef<void()> function) {
+	scheduler::run_participants(scheduler::threads_num(), [&](const int /*participant*/) { function(); });
+}
+
+void parallel_invoke_impl(const FunctionRef<void()> *functions, const int functions_num) {
+	std::atomic<int> next_function = 0;
+	scheduler::run_participants(functions_num, [&](const int /*participant*/) {
+		for (int i = next_function.fetch_add(1); i < functions_num; i = next_function.fetch_add(1)) {
+			functions[i]();
+		}
+	});
+}
+
+void isolate_task_impl(const FunctionRef<void()> function) {
+	scheduler::isolate(function);
+}
 #endif /* WITH_TBB */
 
 void parallel_for_impl(IndexRange range, size_t grain_size, FunctionRef<void(IndexRange)> function) {
@@ -20,8 +70,13 @@ void parallel_for_impl(IndexRange range, size_t grain_size, FunctionRef<void(Ind
 	lazy_threading::send_hint();
 	parallel_for_impl_static_size(range, grain_size, function);
 #else
-	UNUSED_VARS(grain_size);
-	function(range);
+	const int participants_num = parallel_participants_num(range, grain_size);
+	if (participants_num <= 1) {
+		function(range);
+		return;
+	}
+	lazy_threading::send_hint();
+	parallel_for_participants_impl(range, grain_size, participants_num, [&](const int /*participant*/, const IndexRange sub_range) { function(sub_range); });
 #endif
 }
 
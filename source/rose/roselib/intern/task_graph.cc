@@ -2,13 +2,19 @@
 
 #include "LIB_task.h"
 
+#include <atomic>
 #include <memory>
 #include <vector>
 
+#include "task_scheduler_private.hh"
+
 /* Task Graph */
 struct TaskGraph {
 	std::vector<std::unique_ptr<TaskNode>> nodes;
 
+	/* All the nodes of one execution are spawned in this group, so that they can be waited for. */
+	rose::threading::scheduler::TaskGroup task_group;
+
 #ifdef WITH_CXX_GUARDEDALLOC
 	MEM_CXX_CLASS_ALLOC_FUNCS("task_graph:TaskGraph")
 #endif
@@ -16,9 +22,16 @@ struct TaskGraph {
 
 /* TaskNode - a node in the task graph. */
 struct TaskNode {
-	/* Successors to execute after this task, for serial execution fallback. */
+	TaskGraph *task_graph;
+	/* Successors to execute after this task. */
 	std::vector<TaskNode *> successors;
 
+	/* Number of edges pointing to this node. */
+	int parents_num = 0;
+	/* Number of parents that did not finish yet in the current execution, the node is scheduled
+	 * once this reaches zero and is then reset for the next execution of the graph. */
+	std::atomic<int> parents_pending = 0;
+
 	/* User function to be executed with given task data. */
 	TaskGraphNodeRunFunction run_func;
 	void *task_data;
@@ -26,8 +39,7 @@ struct TaskNode {
 	 * is shared between nodes, only a single task node should free the data. */
 	TaskGraphNodeFreeFunction free_func;
 
-	TaskNode(TaskGraph *task_graph, TaskGraphNodeRunFunction run_func, void *task_data, TaskGraphNodeFreeFunction free_func) : run_func(run_func), task_data(task_data), free_func(free_func) {
-		EXPR_NOP(task_graph);
+	TaskNode(TaskGraph *task_graph, TaskGraphNodeRunFunction run_func, void *task_data, TaskGraphNodeFreeFunction free_func) : task_graph(task_graph), run_func(run_func), task_data(task_data), free_func(free_func) {
 	}
 
 	TaskNode(const TaskNode &other) = delete;
@@ -39,10 +51,21 @@ struct TaskNode {
 		}
 	}
 
-	void run_serial() {
-		run_func(task_data);
-		for (TaskNode *successor : successors) {
-			successor->run_serial();
+	void schedule() {
+		task_graph->task_group.spawn(run_task, this);
+	}
+
+	static void run_task(void *data) {
+		TaskNode *task_node = static_cast<TaskNode *>(data);
+		task_node->run_func(task_node->task_data);
+
+		for (TaskNode *successor : task_node->successors) {
+			/* Only the last parent to finish schedules the successor. */
+			if (successor->parents_pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+				/* No other parent can signal the successor anymore in this execution. */
+				successor->parents_pending.store(successor->parents_num, std::memory_order_relaxed);
+				successor->schedule();
+			}
 		}
 	}
 
@@ -56,11 +79,18 @@ TaskGraph *LIB_task_graph_create() {
 }
 
 void LIB_task_graph_free(TaskGraph *task_graph) {
+	task_graph->task_group.wait();
 	delete task_graph;
 }
 
 void LIB_task_graph_work_and_wait(TaskGraph *task_graph) {
-	EXPR_NOP(task_graph);
+	task_graph->task_group.wait();
+
+	/* Nodes of which not all parents ran (work entered below them) are reset as well, so that the
+	 * next execution starts from a clean state. */
+	for (const std::unique_ptr<TaskNode> &task_node : task_graph->nodes) {
+		task_node->parents_pending.store(task_node->parents_num, std::memory_order_relaxed);
+	}
 }
 
 struct TaskNode *LIB_task_graph_node_create(struct TaskGraph *task_graph, TaskGraphNodeRunFunction run, void *user_data, TaskGraphNodeFreeFunction free_func) {
@@ -70,10 +100,12 @@ struct TaskNode *LIB_task_graph_node_create(struct TaskGraph *task_graph, TaskGr
 }
 
 bool LIB_task_graph_node_push_work(struct TaskNode *task_node) {
-	task_node->run_serial();
+	task_node->schedule();
 	return true;
 }
 
 void LIB_task_graph_edge_create(struct TaskNode *from_node, struct TaskNode *to_node) {
 	from_node->successors.push_back(to_node);
+	to_node->parents_num++;
+	to_node->parents_pending.store(to_node->parents_num, std::memory_order_relaxed);
 }
@@ -1,3 +1,4 @@
+#include <atomic>
 #include <cstdlib>
 #include <memory>
 #include <utility>
@@ -13,6 +14,8 @@
 #include "LIB_task.h"
 #include "LIB_thread.h"
 
+#include "task_scheduler_private.hh"
+
 /* Task
  *
  * Unit of work to execute. This is a C++ class to work with TBB. */
@@ -76,6 +79,10 @@ struct TaskPool {
 	ThreadMutex user_mutex;
 	void *userdata;
 
+	/* Scheduler task group, for threaded pools. */
+	rose::threading::scheduler::TaskGroup *task_group;
+	std::atomic<bool> is_canceled;
+
 	volatile bool is_suspended;
 	MemPool *suspended_mempool;
 
@@ -92,13 +99,18 @@ void Task::operator()() const {
 
 /* TBB Task Pool.
  *
- * Task pool using the TBB scheduler for tasks. When building without TBB
- * support or running Blender with -t 1, this reverts to single threaded.
+ * Task pool using the task scheduler for tasks, that is TBB or the native
+ * work-stealing scheduler when building without TBB. When running with a
+ * single thread, this reverts to single threaded.
  *
  * Tasks may be suspended until in all are created, to make it possible to
  * initialize data structures and create tasks in a single pass. */
 
 static void tbb_task_pool_create(TaskPool *pool, eTaskPriority priority) {
+	if (pool->use_threads) {
+		pool->task_group = MEM_new<rose::threading::scheduler::TaskGroup>(__func__);
+	}
+
 	if (pool->type == TASK_POOL_TBB_SUSPENDED) {
 		pool->is_suspended = true;
 		pool->suspended_mempool = LIB_memory_pool_create(sizeof(Task), 512, 512, ROSE_MEMPOOL_ALLOW_ITER);
@@ -107,6 +119,15 @@ static void tbb_task_pool_create(TaskPool *pool, eTaskPriority priority) {
 	EXPR_NOP(priority);
 }
 
+static void tbb_task_pool_task_run(void *data) {
+	Task *task = static_cast<Task *>(data);
+	if (!task->pool->is_canceled.load(std::memory_order_relaxed)) {
+		(*task)();
+	}
+	task->~Task();
+	MEM_freeN(task);
+}
+
 static void tbb_task_pool_run(TaskPool *pool, Task &&task) {
 	if (pool->is_suspended) {
 		/* Suspended task that will be executed in work_and_wait(). */
@@ -120,6 +141,12 @@ static void tbb_task_pool_run(TaskPool *pool, Task &&task) {
 		std::atomic_thread_fence(std::memory_order_release);
 #endif
 	}
+	else if (pool->use_threads) {
+		/* Execute in the scheduler, the task is freed once it ran. */
+		Task *task_mem = (Task *)MEM_mallocN(sizeof(Task), __func__);
+		new (task_mem) Task(std::move(task));
+		pool->task_group->spawn(tbb_task_pool_task_run, task_mem);
+	}
 	else {
 		/* Execute immediately. */
 		task();
@@ -139,19 +166,32 @@ static void tbb_task_pool_work_and_wait(TaskPool *pool) {
 
 		LIB_memory_pool_clear(pool->suspended_mempool, 0);
 	}
+
+	/* Wait for all tasks, including the ones spawned by other tasks. */
+	if (pool->use_threads) {
+		pool->task_group->wait();
+	}
 }
 
 static void tbb_task_pool_cancel(TaskPool *pool) {
-	EXPR_NOP(pool);
+	if (pool->use_threads) {
+		/* Tasks that did not start yet are skipped, running tasks can poll
+		 * #LIB_task_pool_current_canceled to stop early. */
+		pool->is_canceled.store(true);
+		pool->task_group->wait();
+		pool->is_canceled.store(false);
+	}
 }
 
 static bool tbb_task_pool_canceled(TaskPool *pool) {
-	EXPR_NOP(pool);
-
-	return false;
+	return pool->is_canceled.load(std::memory_order_relaxed);
 }
 
 static void tbb_task_pool_free(TaskPool *pool) {
+	if (pool->use_threads) {
+		pool->task_group->wait();
+		MEM_delete(pool->task_group);
+	}
 	if (pool->suspended_mempool) {
 		LIB_memory_pool_destroy(pool->suspended_mempool);
 	}
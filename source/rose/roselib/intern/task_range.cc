@@ -1,4 +1,7 @@
+#include <algorithm>
+#include <atomic>
 #include <cstdlib>
+#include <cstring>
 
 #include "MEM_guardedalloc.h"
 
@@ -10,7 +13,88 @@
 
 #include "atomic_ops.h"
 
+#include "task_scheduler_private.hh"
+
+namespace rose::threading {
+
+/**
+ * Same heuristic as the iterator based loops use (see `task_iterator.c`), when the user did not
+ * provide #TaskParallelSettings.min_iter_per_thread.
+ */
+static int task_parallel_range_chunk_size(const TaskParallelSettings *settings, const int items_num, const int threads_num) {
+	if (settings->min_iter_per_thread > 0) {
+		return settings->min_iter_per_thread;
+	}
+	const int chunk_size = 32 * std::max(1, threads_num >> 3);
+	/* Avoid threading on low amount of items. */
+	if (items_num < std::max(256, chunk_size * 2)) {
+		return items_num;
+	}
+	return chunk_size;
+}
+
+static void task_parallel_range_threaded(const int start, const int stop, void *userdata, TaskParallelRangeFunc func, const TaskParallelSettings *settings, const int chunk_size, const int participants_num) {
+	const int chunks_num = (stop - start + chunk_size - 1) / chunk_size;
+	std::atomic<int> next_chunk = 0;
+
+	/* Each participating thread gets its own copy of the user chunk (similar to OpenMP's
+	 * `firstprivate`), they are reduced into the original chunk once the whole range is done. */
+	const size_t userdata_chunk_size = settings->userdata_chunk_size;
+	const bool use_userdata_chunk = (userdata_chunk_size != 0) && (settings->userdata_chunk != nullptr);
+	char *userdata_chunk_array = nullptr;
+	if (use_userdata_chunk) {
+		userdata_chunk_array = static_cast<char *>(MEM_mallocN(userdata_chunk_size * participants_num, __func__));
+		for (int i = 0; i < participants_num; i++) {
+			void *userdata_chunk_local = userdata_chunk_array + userdata_chunk_size * i;
+			memcpy(userdata_chunk_local, settings->userdata_chunk, userdata_chunk_size);
+			if (settings->func_init != nullptr) {
+				settings->func_init(userdata, userdata_chunk_local);
+			}
+		}
+	}
+
+	scheduler::run_participants(participants_num, [&](const int participant) {
+		TaskParallelTLS tls;
+		tls.userdata_chunk = use_userdata_chunk ? userdata_chunk_array + userdata_chunk_size * participant : nullptr;
+
+		for (int chunk = next_chunk.fetch_add(1); chunk < chunks_num; chunk = next_chunk.fetch_add(1)) {
+			const int chunk_start = start + chunk * chunk_size;
+			const int chunk_stop = std::min(stop, chunk_start + chunk_size);
+			for (int i = chunk_start; i < chunk_stop; i++) {
+				func(userdata, i, &tls);
+			}
+		}
+	});
+
+	if (use_userdata_chunk) {
+		for (int i = 0; i < participants_num; i++) {
+			void *userdata_chunk_local = userdata_chunk_array + userdata_chunk_size * i;
+			if (settings->func_reduce != nullptr) {
+				settings->func_reduce(userdata, settings->userdata_chunk, userdata_chunk_local);
+			}
+			if (settings->func_free != nullptr) {
+				settings->func_free(userdata, userdata_chunk_local);
+			}
+		}
+		MEM_freeN(userdata_chunk_array);
+	}
+}
+
+}  // namespace rose::threading
+
 void LIB_task_parallel_range(const int start, const int stop, void *userdata, TaskParallelRangeFunc func, const TaskParallelSettings *settings) {
+	const int items_num = stop - start;
+	const int threads_num = LIB_task_scheduler_num_threads();
+	if (settings->use_threading && threads_num > 1 && items_num > 0) {
+		const int chunk_size = rose::threading::task_parallel_range_chunk_size(settings, items_num, threads_num);
+		const int participants_num = std::min(threads_num, (items_num + chunk_size - 1) / chunk_size);
+		if (participants_num > 1) {
+			rose::lazy_threading::send_hint();
+			rose::threading::task_parallel_range_threaded(start, stop, userdata, func, settings, chunk_size, participants_num);
+			return;
+		}
+	}
+
 	/* Single threaded. Nothing to reduce as everything is accumulated into the
 	 * main userdata chunk directly. */
 	TaskParallelTLS tls;
@@ -24,5 +108,5 @@ void LIB_task_parallel_range(const int start, const int stop, void *userdata, Ta
 }
 
 int LIB_task_parallel_thread_id(const TaskParallelTLS * /*tls*/) {
-	return 0;
+	return rose::threading::scheduler::thread_index();
 }
@@ -1,24 +1,405 @@
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
 #include "MEM_guardedalloc.h"
 
 #include "LIB_lazy_threading.hh"
 #include "LIB_task.h"
+#include "LIB_task.hh"
 #include "LIB_thread.h"
 
-/* Task Scheduler */
+#ifdef WITH_TBB
+#	include <tbb/global_control.h>
+#	include <tbb/task_arena.h>
+#endif
+
+#include "task_scheduler_private.hh"
+
+namespace rose::threading::scheduler {
+
+/**
+ * The index of the threads that are not owned by the scheduler, assigned the first time they ask
+ * for it so that the main thread and the job threads do not share an index. The thread that
+ * initializes the scheduler is zero, the others come after the workers.
+ */
+static thread_local int external_thread_index = -1;
+static std::atomic<int> external_thread_index_next = 1;
+
+static int external_thread_index_ensure() {
+	if (external_thread_index == -1) {
+		external_thread_index = external_thread_index_next.fetch_add(1);
+	}
+	return external_thread_index;
+}
+
+static void external_thread_index_init(const int num_threads) {
+	external_thread_index = 0;
+	external_thread_index_next.store(std::max(num_threads, 1));
+}
 
+#ifdef WITH_TBB
+
+/* -------------------------------------------------------------------- */
+/** \name TBB Scheduler
+ * \{ */
+
+static tbb::global_control *task_scheduler_global_control = nullptr;
 static int task_scheduler_num_threads = 1;
 
+static void scheduler_init(const int num_threads) {
+	external_thread_index_init(num_threads);
+	task_scheduler_num_threads = num_threads;
+	task_scheduler_global_control = MEM_new<tbb::global_control>(__func__, tbb::global_control::max_allowed_parallelism, num_threads);
+}
+
+static void scheduler_exit() {
+	MEM_delete(task_scheduler_global_control);
+	task_scheduler_global_control = nullptr;
+}
+
+void TaskGroup::spawn(TaskFunc func, void *data) {
+	tbb_group_.run([func, data]() { func(data); });
+}
+
+void TaskGroup::wait() {
+	tbb_group_.wait();
+}
+
+int threads_num() {
+	return task_scheduler_num_threads;
+}
+
+int thread_index() {
+	const int index = tbb::this_task_arena::current_thread_index();
+	return (index == tbb::task_arena::not_initialized) ? external_thread_index_ensure() : index;
+}
+
+void isolate(const FunctionRef<void()> function) {
+	tbb::this_task_arena::isolate(function);
+}
+
+/** \} */
+
+#else /* WITH_TBB */
+
+/* -------------------------------------------------------------------- */
+/** \name Native Scheduler
+ * \{ */
+
+struct TaskItem {
+	TaskFunc func;
+	void *data;
+	TaskGroup *group;
+	/** The isolation region the task was spawned in, zero when it was not spawned in one. */
+	int isolation;
+
+	void execute();
+};
+
+struct TaskQueue {
+	std::mutex mutex;
+	std::deque<TaskItem> tasks;
+};
+
+struct Scheduler {
+	int threads_num;
+
+	/** One queue per thread, the first one is shared by all threads not owned by the scheduler. */
+	std::vector<std::unique_ptr<TaskQueue>> queues;
+	std::vector<std::thread> threads;
+
+	std::atomic<bool> is_exiting = false;
+	/** Number of tasks in all the queues, this is only a hint for sleeping threads. */
+	std::atomic<int64_t> tasks_queued = 0;
+
+	/** Idle workers sleep here until new tasks are pushed. */
+	std::mutex idle_mutex;
+	std::condition_variable idle_cond;
+	std::atomic<int> idle_num = 0;
+
+	/** Threads waiting for a #TaskGroup sleep here until a group is done or new tasks are pushed. */
+	std::mutex wait_mutex;
+	std::condition_variable wait_cond;
+	std::atomic<int> wait_num = 0;
+};
+
+/**
+ * Only modified by #LIB_task_scheduler_init and #LIB_task_scheduler_exit which are called from the
+ * main thread while no tasks are running.
+ */
+static Scheduler *scheduler = nullptr;
+
+static thread_local int current_thread_index = 0;
+static thread_local int current_isolation = 0;
+static std::atomic<int> isolation_counter = 0;
+
+void TaskItem::execute() {
+	const int isolation_prev = current_isolation;
+	current_isolation = isolation;
+	func(data);
+	current_isolation = isolation_prev;
+
+	/* The group may be freed by its waiting thread as soon as the counter reaches zero. Sequentially
+	 * consistent, so that either the waiting thread sees the counter reach zero when evaluating its
+	 * wake-up condition or this thread sees the waiting thread. */
+	if (group->pending_.fetch_sub(1) == 1) {
+		if (scheduler->wait_num.load() > 0) {
+			std::lock_guard<std::mutex> lock(scheduler->wait_mutex);
+			scheduler->wait_cond.notify_all();
+		}
+	}
+}
+
+static void scheduler_push(const TaskItem &item) {
+	TaskQueue &queue = *scheduler->queues[current_thread_index];
+	{
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		queue.tasks.push_back(item);
+	}
+	/* Sequentially consistent, so that either the sleeping thread sees the new task when evaluating
+	 * its wake-up condition or the pushing thread sees the sleeping thread. */
+	scheduler->tasks_queued.fetch_add(1);
+
+	if (scheduler->idle_num.load() > 0) {
+		std::lock_guard<std::mutex> lock(scheduler->idle_mutex);
+		scheduler->idle_cond.notify_one();
+	}
+	else if (scheduler->wait_num.load() > 0) {
+		/* All of them, the waiting threads may only run the tasks of their own isolation region. */
+		std::lock_guard<std::mutex> lock(scheduler->wait_mutex);
+		scheduler->wait_cond.notify_all();
+	}
+}
+
+ROSE_INLINE bool task_matches_isolation(const TaskItem &item, const int isolation) {
+	return isolation == 0 || item.isolation == isolation;
+}
+
+static bool scheduler_pop_from(TaskQueue &queue, const bool from_back, const int isolation, TaskItem *r_item) {
+	std::lock_guard<std::mutex> lock(queue.mutex);
+	if (from_back) {
+		for (auto it = queue.tasks.rbegin(); it != queue.tasks.rend(); ++it) {
+			if (task_matches_isolation(*it, isolation)) {
+				*r_item = *it;
+				queue.tasks.erase(std::next(it).base());
+				return true;
+			}
+		}
+	}
+	else {
+		for (auto it = queue.tasks.begin(); it != queue.tasks.end(); ++it) {
+			if (task_matches_isolation(*it, isolation)) {
+				*r_item = *it;
+				queue.tasks.erase(it);
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+/** Whether any queue holds a task that a thread in the given isolation region may run. */
+static bool scheduler_has_task(const int isolation) {
+	if (isolation == 0) {
+		return scheduler->tasks_queued.load() > 0;
+	}
+	for (const std::unique_ptr<TaskQueue> &queue : scheduler->queues) {
+		std::lock_guard<std::mutex> lock(queue->mutex);
+		for (const TaskItem &item : queue->tasks) {
+			if (task_matches_isolation(item, isolation)) {
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+/**
+ * Pop a task from the queue of the calling thread, or steal one from another queue, and run it.
+ * Only tasks spawned in the given isolation region are considered, any task when zero.
+ */
+static bool scheduler_run_one(const int isolation) {
+	const int index = current_thread_index;
+	const int queues_num = int(scheduler->queues.size());
+
+	TaskItem item;
+	bool found = scheduler_pop_from(*scheduler->queues[index], true, isolation, &item);
+	for (int i = 1; !found && i < queues_num; i++) {
+		found = scheduler_pop_from(*scheduler->queues[(index + i) % queues_num], false, isolation, &item);
+	}
+	if (!found) {
+		return false;
+	}
+	scheduler->tasks_queued.fetch_sub(1);
+
+	item.execute();
+	return true;
+}
+
+static void scheduler_worker_main(const int index) {
+	current_thread_index = index;
+
+	while (!scheduler->is_exiting.load()) {
+		if (scheduler_run_one(0)) {
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(scheduler->idle_mutex);
+		scheduler->idle_num.fetch_add(1);
+		scheduler->idle_cond.wait(lock, []() { return scheduler->is_exiting.load() || scheduler->tasks_queued.load() > 0; });
+		scheduler->idle_num.fetch_sub(1);
+	}
+}
+
+static void scheduler_init(const int num_threads) {
+	external_thread_index_init(num_threads);
+	if (num_threads <= 1) {
+		return;
+	}
+
+	scheduler = new Scheduler();
+	scheduler->threads_num = num_threads;
+	for (int i = 0; i < num_threads; i++) {
+		scheduler->queues.push_back(std::make_unique<TaskQueue>());
+	}
+	/* The calling thread participates as well, so one worker less is needed. */
+	for (int i = 1; i < num_threads; i++) {
+		scheduler->threads.emplace_back(scheduler_worker_main, i);
+	}
+}
+
+static void scheduler_exit() {
+	if (scheduler == nullptr) {
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(scheduler->idle_mutex);
+		scheduler->is_exiting.store(true);
+		scheduler->idle_cond.notify_all();
+	}
+	for (std::thread &thread : scheduler->threads) {
+		thread.join();
+	}
+
+	delete scheduler;
+	scheduler = nullptr;
+}
+
+void TaskGroup::spawn(TaskFunc func, void *data) {
+	if (scheduler == nullptr) {
+		func(data);
+		return;
+	}
+
+	pending_.fetch_add(1, std::memory_order_relaxed);
+	scheduler_push(TaskItem{func, data, this, current_isolation});
+}
+
+void TaskGroup::wait() {
+	if (scheduler == nullptr) {
+		return;
+	}
+
+	const int isolation = current_isolation;
+
+	int spin = 0;
+	while (pending_.load(std::memory_order_acquire) > 0) {
+		if (scheduler_run_one(isolation)) {
+			spin = 0;
+			continue;
+		}
+		/* Tasks of this group are running on other threads, spin for a little while since they are
+		 * often about to finish before going to sleep. */
+		if (spin++ < 64) {
+			std::this_thread::yield();
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(scheduler->wait_mutex);
+		scheduler->wait_num.fetch_add(1);
+		/* Tasks of other isolation regions can not be run here, waking up for them would only spin. */
+		scheduler->wait_cond.wait(lock, [&]() { return pending_.load() == 0 || scheduler_has_task(isolation); });
+		scheduler->wait_num.fetch_sub(1);
+		spin = 0;
+	}
+}
+
+int threads_num() {
+	return scheduler ? scheduler->threads_num : 1;
+}
+
+int thread_index() {
+	/* Slot zero of the queues is shared by the external threads, their index is their own. */
+	return (current_thread_index != 0) ? current_thread_index : external_thread_index_ensure();
+}
+
+void isolate(const FunctionRef<void()> function) {
+	const int isolation_prev = current_isolation;
+	current_isolation = isolation_counter.fetch_add(1) + 1;
+	function();
+	current_isolation = isolation_prev;
+}
+
+/** \} */
+
+#endif /* WITH_TBB */
+
+/* -------------------------------------------------------------------- */
+/** \name Shared Utilities
+ * \{ */
+
+struct ParticipantData {
+	FunctionRef<void(int)> function;
+	std::atomic<int> next_participant;
+};
+
+static void run_participant_func(void *data) {
+	ParticipantData *participants = static_cast<ParticipantData *>(data);
+	participants->function(participants->next_participant.fetch_add(1, std::memory_order_relaxed));
+}
+
+void run_participants(const int max_participants, const FunctionRef<void(int participant)> function) {
+	const int participants_num = std::min(max_participants, threads_num());
+	if (participants_num <= 1) {
+		function(0);
+		return;
+	}
+
+	ParticipantData participants{function, 1};
+
+	TaskGroup task_group;
+	for (int i = 1; i < participants_num; i++) {
+		task_group.spawn(run_participant_func, &participants);
+	}
+	function(0);
+	task_group.wait();
+}
+
+/** \} */
+
+}  // namespace rose::threading::scheduler
+
+/* Task Scheduler */
+
 void LIB_task_scheduler_init() {
-	task_scheduler_num_threads = LIB_system_thread_count();
+	const int num_threads = LIB_system_thread_count();
+	rose::threading::scheduler::scheduler_init(num_threads);
 }
 
 void LIB_task_scheduler_exit() {
+	rose::threading::scheduler::scheduler_exit();
 }
 
 int LIB_task_scheduler_num_threads() {
-	return task_scheduler_num_threads;
+	return rose::threading::scheduler::threads_num();
 }
 
 void LIB_task_isolate(void (*func)(void *userdata), void *userdata) {
-	func(userdata);
+	rose::threading::isolate_task([&]() { func(userdata); });
 }
@@ -0,0 +1,79 @@
+#ifndef TASK_SCHEDULER_PRIVATE_HH
+#define TASK_SCHEDULER_PRIVATE_HH
+
+#include <atomic>
+#include <cstdint>
+
+#ifdef WITH_TBB
+#	include <tbb/task_group.h>
+#endif
+
+#include "LIB_function_ref.hh"
+#include "LIB_utildefines.h"
+#include "LIB_utility_mixins.hh"
+
+/**
+ * Scheduler used by the task pools, task graphs, parallel ranges and the threading templates in
+ * `LIB_task.hh`. When building with TBB this forwards to TBB, otherwise it is a native
+ * work-stealing scheduler.
+ *
+ * Every worker thread owns a deque of tasks. New tasks are pushed to the back of the deque of the
+ * spawning thread and popped from the back by its owner (LIFO, the data is likely still in cache),
+ * idle threads steal from the front of the other deques (FIFO, the oldest and usually largest
+ * tasks first). Threads that are not owned by the scheduler (e.g. the main thread) share slot zero.
+ *
+ * Until #LIB_task_scheduler_init has been called, or when only a single thread is available,
+ * tasks are executed immediately on the spawning thread.
+ */
+namespace rose::threading::scheduler {
+
+typedef void (*TaskFunc)(void *data);
+
+struct TaskItem;
+
+class TaskGroup : NonCopyable, NonMovable {
+#ifdef WITH_TBB
+	tbb::task_group tbb_group_;
+#else
+	std::atomic<int64_t> pending_ = 0;
+
+	friend struct TaskItem;
+#endif
+
+public:
+	/**
+	 * Schedule \a func to run with \a data on any thread, \a data has to stay alive until the group
+	 * has been waited for. Tasks are allowed to spawn more tasks into the same group.
+	 */
+	void spawn(TaskFunc func, void *data);
+
+	/**
+	 * Returns when all tasks spawned into this group are done. The calling thread executes other
+	 * tasks in the meantime, respecting the isolation region it is in.
+	 */
+	void wait();
+};
+
+/** Number of threads that may execute tasks at the same time, including the calling thread. */
+int threads_num();
+
+/**
+ * Index of the calling thread, unique among the threads alive at the same time. The thread that
+ * initialized the scheduler is zero, the other threads that are not owned by the scheduler get an
+ * index past the ones of the workers.
+ */
+int thread_index();
+
+/**
+ * Invoke \a function on the calling thread and on up to `max_participants - 1` other threads at
+ * the same time, the index of the invocation is passed to \a function. Returns once all
+ * invocations are done. Used for loops where the participants grab work from a shared counter.
+ */
+void run_participants(int max_participants, FunctionRef<void(int participant)> function);
+
+/** See #LIB_task_isolate. */
+void isolate(FunctionRef<void()> function);
+
+}  // namespace rose::threading::scheduler
+
+#endif	// TASK_SCHEDULER_PRIVATE_HH
@@ -445,13 +445,26 @@ void LIB_thread_queue_wait_finish(ThreadQueue *queue) {
  * \{ */
 
 size_t LIB_system_thread_count() {
+	if (threads_override_num > 0) {
+		return threads_override_num;
+	}
+
 #ifdef WIN32
 	SYSTEM_INFO info;
 	GetSystemInfo(&info);
-	return ROSE_MIN(1, info.dwNumberOfProcessors);
+	const size_t count = ROSE_MAX(1, info.dwNumberOfProcessors);
 #else
-	return ROSE_MIN(1, sysconf(_SC_NPROCESSORS_ONLN));
+	const size_t count = ROSE_MAX(1, sysconf(_SC_NPROCESSORS_ONLN));
 #endif
+	return ROSE_MIN(count, RE_MAX_THREAD);
+}
+
+void LIB_system_num_threads_override_set(int num) {
+	threads_override_num = num;
+}
+
+int LIB_system_num_threads_override_get(void) {
+	return threads_override_num;
 }
 
 /** \} */
@@ -0,0 +1,149 @@
+#include "LIB_bvhtree.hh"
+#include "LIB_math_vector.hh"
+#include "LIB_utildefines.h"
+
+#include <random>
+
+#include "gtest/gtest.h"
+
+namespace rose {
+
+/** Small cubes scattered in a box, enough of them to build the subtrees in parallel. */
+static Array<Bounds<float3>> random_cubes(const int num, const unsigned int seed) {
+	std::mt19937 rng(seed);
+	std::uniform_real_distribution<float> dist(-10.0f, 10.0f);
+	Array<Bounds<float3>> cubes(num);
+	for (const int index : cubes.index_range()) {
+		const float3 center(dist(rng), dist(rng), dist(rng));
+		cubes[index] = Bounds<float3>(center - float3(0.05f), center + float3(0.05f));
+	}
+	return cubes;
+}
+
+static bool isect_ray_cube(const Bounds<float3> &cube, const float3 &origin, const float3 &direction, float *r_dist) {
+	const float3 t0 = (cube.min - origin) / direction;
+	const float3 t1 = (cube.max - origin) / direction;
+	const float tmin = math::reduce_max(math::min(t0, t1));
+	const float tmax = math::reduce_min(math::max(t0, t1));
+	*r_dist = tmin;
+	return tmin >= 0.0f && tmin <= tmax;
+}
+
+TEST(BVHTree, Empty) {
+	const BVHTree tree(Span<Bounds<float3>>{});
+	EXPECT_TRUE(tree.is_empty());
+
+	BVHTreeRayHit hit;
+	EXPECT_FALSE(tree.ray_cast(float3(0.0f), float3(1.0f, 0.0f, 0.0f), hit, [](int, const float3 &, const float3 &, BVHTreeRayHit &) {}));
+}
+
+TEST(BVHTree, Structure) {
+	const Array<Bounds<float3>> cubes = random_cubes(20000, 1);
+	const BVHTree tree(cubes, 4);
+
+	/* Every primitive is referenced once and the leaves are small. */
+	Array<int> uses(cubes.size(), 0);
+	for (const BVHTree::Node &node : tree.nodes()) {
+		if (node.children == -1) {
+			EXPECT_LE(node.prim_num, 4);
+			for (const int prim : tree.prim_indices().slice(node.prim_start, node.prim_num)) {
+				uses[prim]++;
+			}
+		}
+	}
+	for (const int num : uses) {
+		EXPECT_EQ(num, 1);
+	}
+}
+
+TEST(BVHTree, RayCast) {
+	const Array<Bounds<float3>> cubes = random_cubes(20000, 2);
+	const BVHTree tree(cubes);
+
+	const auto ray_cast_cube = [&](const int index, const float3 &origin, const float3 &direction, BVHTreeRayHit &hit) {
+		float dist;
+		if (isect_ray_cube(cubes[index], origin, direction, &dist) && dist < hit.dist) {
+			hit.index = index;
+			hit.dist = dist;
+		}
+	};
+
+	std::mt19937 rng(3);
+	std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+	for ([[maybe_unused]] const int i : IndexRange(100)) {
+		/* Aim at a cube so that most rays hit something. */
+		const float3 origin(dist(rng) * 20.0f, dist(rng) * 20.0f, 20.0f);
+		const float3 direction = math::normalize(cubes[i].center() - origin);
+
+		BVHTreeRayHit hit;
+		tree.ray_cast(origin, direction, hit, ray_cast_cube);
+
+		BVHTreeRayHit hit_expected;
+		for (const int index : cubes.index_range()) {
+			ray_cast_cube(index, origin, direction, hit_expected);
+		}
+		EXPECT_EQ(hit.index, hit_expected.index);
+		EXPECT_FLOAT_EQ(hit.dist, hit_expected.dist);
+	}
+}
+
+TEST(BVHTree, FindNearestAfterRefit) {
+	Array<Bounds<float3>> cubes = random_cubes(20000, 4);
+	BVHTree tree(cubes);
+
+	/* Squash all the cubes towards the origin, the hierarchy is kept but the bounds are updated. */
+	for (Bounds<float3> &cube : cubes) {
+		cube = Bounds<float3>(cube.min * 0.5f, cube.max * 0.5f);
+	}
+	tree.refit(cubes);
+
+	const auto nearest_cube = [&](const int index, const float3 &co, BVHTreeNearest &nearest) {
+		const float3 closest = math::clamp(co, cubes[index].min, cubes[index].max);
+		const float dist_sq = math::distance_squared(co, closest);
+		if (dist_sq < nearest.dist_sq) {
+			nearest.index = index;
+			nearest.dist_sq = dist_sq;
+			nearest.co = closest;
+		}
+	};
+
+	Array<float3> cos(64);
+	std::mt19937 rng(5);
+	std::uniform_real_distribution<float> dist(-8.0f, 8.0f);
+	for (float3 &co : cos) {
+		co = float3(dist(rng), dist(rng), dist(rng));
+	}
+
+	Array<BVHTreeNearest> nearest(cos.size());
+	tree.find_nearest_batch(cos, nearest, nearest_cube);
+
+	for (const int i : cos.index_range()) {
+		BVHTreeNearest nearest_expected;
+		for (const int index : cubes.index_range()) {
+			nearest_cube(index, cos[i], nearest_expected);
+		}
+		EXPECT_EQ(nearest[i].dist_sq, nearest_expected.dist_sq);
+	}
+}
+
+TEST(BVHTree, Overlap) {
+	const Array<Bounds<float3>> cubes = random_cubes(5000, 6);
+	const BVHTree tree(cubes);
+
+	const Bounds<float3> query(float3(-2.0f), float3(3.0f));
+	const auto overlaps = [&](const Bounds<float3> &cube) {
+		return math::reduce_max(math::max(query.min - cube.max, cube.min - query.max)) <= 0.0f;
+	};
+
+	int num = 0;
+	tree.overlap(query, [&](const int index) { num += overlaps(cubes[index]); });
+
+	int num_expected = 0;
+	for (const Bounds<float3> &cube : cubes) {
+		num_expected += overlaps(cube);
+	}
+	EXPECT_EQ(num, num_expected);
+	EXPECT_GT(num, 0);
+}
+
+}  // namespace rose
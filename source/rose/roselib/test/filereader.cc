@@ -0,0 +1,137 @@
+#include "MEM_guardedalloc.h"
+
+#include "LIB_fileops.h"
+#include "LIB_filereader.h"
+#include "LIB_utildefines.h"
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#ifdef WITH_ZLIB
+#	include <zlib.h>
+#endif
+
+#include "gtest/gtest.h"
+
+namespace {
+
+std::vector<char> test_data() {
+	std::vector<char> data(100000);
+	for (size_t i = 0; i < data.size(); i++) {
+		data[i] = char((i * 7) ^ (i >> 5));
+	}
+	return data;
+}
+
+/** Read the whole file in small uneven steps, like the loader does with block headers. */
+std::vector<char> read_all(FileReader *reader) {
+	std::vector<char> result;
+	char buffer[37];
+	while (true) {
+		const uint64_t readsize = reader->read(reader, buffer, sizeof(buffer));
+		result.insert(result.end(), buffer, buffer + readsize);
+		if (readsize < sizeof(buffer)) {
+			break;
+		}
+	}
+	return result;
+}
+
+TEST(FileReader, Raw) {
+	const std::vector<char> data = test_data();
+	const std::string filepath = testing::TempDir() + "filereader_raw.bin";
+
+	FILE *file = fopen(filepath.c_str(), "wb");
+	ASSERT_NE(file, nullptr);
+	fwrite(data.data(), 1, data.size(), file);
+	fclose(file);
+
+	FileReader *reader = LIB_filereader_new_file(LIB_open(filepath.c_str(), O_BINARY | O_RDONLY, 0));
+	EXPECT_EQ(read_all(reader), data);
+	EXPECT_EQ(reader->offset, data.size());
+	reader->close(reader);
+
+	remove(filepath.c_str());
+}
+
+TEST(FileReader, Mmap) {
+	const std::vector<char> data = test_data();
+	const std::string filepath = testing::TempDir() + "filereader_mmap.bin";
+
+	FILE *file = fopen(filepath.c_str(), "wb");
+	ASSERT_NE(file, nullptr);
+	fwrite(data.data(), 1, data.size(), file);
+	fclose(file);
+
+	/* The mapping outlives the file descriptor. */
+	const int descr = LIB_open(filepath.c_str(), O_BINARY | O_RDONLY, 0);
+	FileReader *reader = LIB_filereader_new_mmap(descr);
+	close(descr);
+	ASSERT_NE(reader, nullptr);
+
+	size_t length = 0;
+	const char *memory = static_cast<const char *>(LIB_filereader_mmap_data(reader, &length));
+	ASSERT_NE(memory, nullptr);
+	EXPECT_EQ(std::vector<char>(memory, memory + length), data);
+
+	EXPECT_EQ(read_all(reader), data);
+	reader->seek(reader, 100, SEEK_SET);
+	char value;
+	EXPECT_EQ(reader->read(reader, &value, 1), 1);
+	EXPECT_EQ(value, data[100]);
+	reader->close(reader);
+
+	remove(filepath.c_str());
+}
+
+TEST(FileReader, MmapFallback) {
+	const std::vector<char> data = test_data();
+	const std::string filepath = testing::TempDir() + "filereader_mmap_fallback.bin";
+
+	FILE *file = fopen(filepath.c_str(), "wb");
+	ASSERT_NE(file, nullptr);
+	fwrite(data.data(), 1, data.size(), file);
+	fclose(file);
+
+	/* Write only descriptors can not be mapped, trying to must not move the descriptor. */
+	int descr = LIB_open(filepath.c_str(), O_BINARY | O_WRONLY, 0);
+	EXPECT_EQ(LIB_filereader_new_mmap(descr), nullptr);
+	EXPECT_EQ(LIB_seek(descr, 0, SEEK_CUR), 0);
+	close(descr);
+
+	/* The raw reader that takes over after a mapping reads the file from the start. */
+	descr = LIB_open(filepath.c_str(), O_BINARY | O_RDONLY, 0);
+	FileReader *mmap = LIB_filereader_new_mmap(descr);
+	ASSERT_NE(mmap, nullptr);
+	mmap->close(mmap);
+	FileReader *reader = LIB_filereader_new_file(descr);
+	ASSERT_NE(reader, nullptr);
+	EXPECT_EQ(read_all(reader), data);
+	reader->close(reader);
+
+	remove(filepath.c_str());
+}
+
+#ifdef WITH_ZLIB
+TEST(FileReader, Gzip) {
+	const std::vector<char> data = test_data();
+	const std::string filepath = testing::TempDir() + "filereader_gzip.bin.gz";
+
+	gzFile file = gzopen(filepath.c_str(), "wb1");
+	ASSERT_NE(file, nullptr);
+	gzwrite(file, data.data(), unsigned(data.size()));
+	gzclose(file);
+
+	FileReader *rawfile = LIB_filereader_new_file(LIB_open(filepath.c_str(), O_BINARY | O_RDONLY, 0));
+	FileReader *reader = LIB_filereader_new_gzip(rawfile);
+	ASSERT_NE(reader, nullptr);
+	EXPECT_EQ(read_all(reader), data);
+	EXPECT_EQ(reader->offset, data.size());
+	reader->close(reader);
+
+	remove(filepath.c_str());
+}
+#endif
+
+}  // namespace
@@ -0,0 +1,116 @@
+#include "LIB_kdtree.hh"
+#include "LIB_utildefines.h"
+
+#include <random>
+
+#include "gtest/gtest.h"
+
+namespace rose {
+
+template<int DimsNum> static Array<VecBase<float, DimsNum>> random_points(const int num, const unsigned int seed) {
+	std::mt19937 rng(seed);
+	std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+	Array<VecBase<float, DimsNum>> points(num);
+	for (VecBase<float, DimsNum> &point : points) {
+		for (int i = 0; i < DimsNum; i++) {
+			point[i] = dist(rng);
+		}
+	}
+	return points;
+}
+
+TEST(KDTree, FindNearest) {
+	const Array<float3> points = random_points<3>(10000, 1);
+	const KDTree_3d tree(points);
+	EXPECT_EQ(tree.size(), 10000);
+
+	for (const float3 &co : random_points<3>(100, 2)) {
+		KDTree_3d::Nearest nearest;
+		EXPECT_TRUE(tree.find_nearest(co, nearest));
+
+		float dist_sq_expected = FLT_MAX;
+		for (const float3 &point : points) {
+			dist_sq_expected = std::min(dist_sq_expected, math::distance_squared(co, point));
+		}
+		EXPECT_EQ(nearest.dist_sq, dist_sq_expected);
+		EXPECT_EQ(nearest.co, points[nearest.index]);
+	}
+}
+
+TEST(KDTree, FindNearestN) {
+	const Array<float2> points = random_points<2>(1000, 3);
+	const KDTree_2d tree(points);
+
+	const float2 co(0.25f, -0.5f);
+	KDTree_2d::Nearest nearest[8];
+	EXPECT_EQ(tree.find_nearest_n(co, MutableSpan<KDTree_2d::Nearest>(nearest, ARRAY_SIZE(nearest))), 8);
+
+	Array<float> dists(points.size());
+	for (const int i : points.index_range()) {
+		dists[i] = math::distance_squared(co, points[i]);
+	}
+	std::sort(dists.begin(), dists.end());
+	for (const int i : IndexRange(8)) {
+		EXPECT_EQ(nearest[i].dist_sq, dists[i]);
+	}
+
+	/* Asking for more points than the tree has. */
+	const KDTree_2d small_tree(points.as_span().take_front(3));
+	EXPECT_EQ(small_tree.find_nearest_n(co, MutableSpan<KDTree_2d::Nearest>(nearest, ARRAY_SIZE(nearest))), 3);
+}
+
+TEST(KDTree, FindRange) {
+	const Array<float4> points = random_points<4>(5000, 4);
+	const KDTree_4d tree(points);
+
+	const float4 co(0.1f, 0.2f, -0.3f, 0.0f);
+	Vector<int> indices;
+	tree.find_range(co, 0.5f, indices);
+	std::sort(indices.begin(), indices.end());
+
+	Vector<int> indices_expected;
+	for (const int i : points.index_range()) {
+		if (math::distance_squared(co, points[i]) <= 0.25f) {
+			indices_expected.append(i);
+		}
+	}
+	EXPECT_EQ(indices.as_span(), indices_expected.as_span());
+}
+
+TEST(KDTree, FindDuplicates) {
+	/* The points 1 and 3 are close to the point 0, the points 2 and 4 to each other. The point 5
+	 * is in range of the point 3 only, which is merged, so it is kept. */
+	const float points_data[] = {0.0f, 0.05f, 5.0f, -0.05f, 5.01f, -0.12f, 9.0f};
+	const Span<float> values(points_data, ARRAY_SIZE(points_data));
+	Array<VecBase<float, 1>> points(values.size());
+	for (const int i : values.index_range()) {
+		points[i][0] = values[i];
+	}
+	const KDTree_1d tree(points);
+
+	Array<int> duplicates(points.size());
+	EXPECT_EQ(tree.find_duplicates(0.1f, duplicates), 3);
+
+	const int duplicates_expected[] = {-1, 0, -1, 0, 2, -1, -1};
+	EXPECT_EQ(duplicates.as_span(), Span<int>(duplicates_expected, ARRAY_SIZE(duplicates_expected)));
+}
+
+TEST(KDTree, FindDuplicatesParallel) {
+	/* Every point is repeated with a small offset, large enough to build and query in parallel. */
+	const Array<float3> unique_points = random_points<3>(10000, 5);
+	Array<float3> points(unique_points.size() * 2);
+	for (const int i : unique_points.index_range()) {
+		points[i] = unique_points[i];
+		points[unique_points.size() + i] = unique_points[i] + float3(1e-5f);
+	}
+	const KDTree_3d tree(points);
+
+	Array<int> duplicates(points.size());
+	EXPECT_EQ(tree.find_duplicates(1e-4f, duplicates), int(unique_points.size()));
+	for (const int i : unique_points.index_range()) {
+		EXPECT_EQ(duplicates[i], -1);
+		EXPECT_EQ(duplicates[unique_points.size() + i], i);
+	}
+}
+
+}  // namespace rose
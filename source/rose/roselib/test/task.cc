@@ -0,0 +1,197 @@
+#include "MEM_guardedalloc.h"
+
+#include "LIB_task.h"
+#include "LIB_task.hh"
+#include "LIB_thread.h"
+#include "LIB_utildefines.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace {
+
+/** Force multiple threads, even on a single core machine. */
+class TaskScheduler : public testing::Test {
+protected:
+	void SetUp() override {
+		LIB_system_num_threads_override_set(4);
+		LIB_task_scheduler_init();
+	}
+	void TearDown() override {
+		LIB_task_scheduler_exit();
+		LIB_system_num_threads_override_set(0);
+	}
+};
+
+constexpr int ITEMS_NUM = 10000;
+
+struct RangeData {
+	int *values;
+	std::atomic<int> max_thread_id;
+};
+
+static void range_func(void *__restrict userdata, const int iter, const TaskParallelTLS *__restrict tls) {
+	RangeData *data = static_cast<RangeData *>(userdata);
+	data->values[iter] = iter;
+	*static_cast<int *>(tls->userdata_chunk) += iter;
+
+	const int thread_id = LIB_task_parallel_thread_id(tls);
+	int max_thread_id = data->max_thread_id.load();
+	while (thread_id > max_thread_id && !data->max_thread_id.compare_exchange_weak(max_thread_id, thread_id)) {
+	}
+}
+
+static void range_reduce(const void *__restrict /*userdata*/, void *__restrict chunk_join, void *__restrict chunk) {
+	*static_cast<int *>(chunk_join) += *static_cast<int *>(chunk);
+}
+
+TEST_F(TaskScheduler, NumThreads) {
+	ASSERT_EQ(LIB_task_scheduler_num_threads(), 4);
+}
+
+TEST_F(TaskScheduler, ParallelRangeReduce) {
+	std::vector<int> values(ITEMS_NUM, -1);
+	RangeData data;
+	data.values = values.data();
+	data.max_thread_id = 0;
+
+	int sum = 0;
+	TaskParallelSettings settings;
+	LIB_parallel_range_settings_defaults(&settings);
+	settings.min_iter_per_thread = 1;
+	settings.userdata_chunk = &sum;
+	settings.userdata_chunk_size = sizeof(sum);
+	settings.func_reduce = range_reduce;
+
+	LIB_task_parallel_range(0, ITEMS_NUM, &data, range_func, &settings);
+
+	for (int i = 0; i < ITEMS_NUM; i++) {
+		ASSERT_EQ(values[i], i);
+	}
+	ASSERT_EQ(sum, ITEMS_NUM * (ITEMS_NUM - 1) / 2);
+	ASSERT_LT(data.max_thread_id.load(), LIB_task_scheduler_num_threads());
+}
+
+TEST_F(TaskScheduler, ParallelFor) {
+	std::vector<std::atomic<int>> values(ITEMS_NUM);
+	rose::threading::parallel_for(rose::IndexRange(ITEMS_NUM), 64, [&](const rose::IndexRange range) {
+		for (const size_t i : range) {
+			values[i].fetch_add(1);
+		}
+	});
+	for (int i = 0; i < ITEMS_NUM; i++) {
+		ASSERT_EQ(values[i].load(), 1);
+	}
+}
+
+TEST_F(TaskScheduler, ParallelForNested) {
+	std::atomic<int> count = 0;
+	rose::threading::parallel_for(rose::IndexRange(64), 1, [&](const rose::IndexRange range) {
+		for ([[maybe_unused]] const size_t i : range) {
+			rose::threading::parallel_for(rose::IndexRange(64), 1, [&](const rose::IndexRange sub_range) { count.fetch_add(int(sub_range.size())); });
+		}
+	});
+	ASSERT_EQ(count.load(), 64 * 64);
+}
+
+TEST_F(TaskScheduler, ParallelReduce) {
+	const int sum = rose::threading::parallel_reduce(
+		rose::IndexRange(ITEMS_NUM),
+		128,
+		0,
+		[](const rose::IndexRange range, const int init) {
+			int result = init;
+			for (const size_t i : range) {
+				result += int(i);
+			}
+			return result;
+		},
+		[](const int a, const int b) { return a + b; });
+	ASSERT_EQ(sum, ITEMS_NUM * (ITEMS_NUM - 1) / 2);
+}
+
+TEST_F(TaskScheduler, ParallelInvoke) {
+	std::atomic<int> count = 0;
+	rose::threading::parallel_invoke([&]() { count.fetch_add(1); }, [&]() { count.fetch_add(2); }, [&]() { count.fetch_add(4); });
+	ASSERT_EQ(count.load(), 7);
+}
+
+TEST_F(TaskScheduler, ExternalThreadIndex) {
+	ASSERT_EQ(LIB_task_parallel_thread_id(nullptr), 0);
+
+	/* Threads that are not owned by the scheduler do not share an index with it or with each other. */
+	int thread_ids[2] = {-1, -1};
+	std::thread thread_a([&]() { thread_ids[0] = LIB_task_parallel_thread_id(nullptr); });
+	std::thread thread_b([&]() { thread_ids[1] = LIB_task_parallel_thread_id(nullptr); });
+	thread_a.join();
+	thread_b.join();
+	ASSERT_GE(thread_ids[0], LIB_task_scheduler_num_threads());
+	ASSERT_GE(thread_ids[1], LIB_task_scheduler_num_threads());
+	ASSERT_NE(thread_ids[0], thread_ids[1]);
+}
+
+static void pool_task_func(TaskPool *__restrict pool, void *taskdata) {
+	std::atomic<int> *count = static_cast<std::atomic<int> *>(LIB_task_pool_user_data(pool));
+	const intptr_t depth = intptr_t(taskdata);
+	count->fetch_add(1);
+	if (depth > 0) {
+		/* Tasks pushed from running tasks are waited for as well. */
+		LIB_task_pool_push(pool, pool_task_func, POINTER_FROM_INT(depth - 1), false, nullptr);
+		LIB_task_pool_push(pool, pool_task_func, POINTER_FROM_INT(depth - 1), false, nullptr);
+	}
+}
+
+TEST_F(TaskScheduler, TaskPool) {
+	std::atomic<int> count = 0;
+	TaskPool *pool = LIB_task_pool_create(&count, TASK_PRIORITY_HIGH);
+	LIB_task_pool_push(pool, pool_task_func, POINTER_FROM_INT(8), false, nullptr);
+	LIB_task_pool_work_and_wait(pool);
+	LIB_task_pool_free(pool);
+	ASSERT_EQ(count.load(), (1 << 9) - 1);
+}
+
+TEST_F(TaskScheduler, TaskPoolSuspended) {
+	std::atomic<int> count = 0;
+	TaskPool *pool = LIB_task_pool_create_suspended(&count, TASK_PRIORITY_HIGH);
+	for (int i = 0; i < 16; i++) {
+		LIB_task_pool_push(pool, pool_task_func, POINTER_FROM_INT(0), false, nullptr);
+	}
+	ASSERT_EQ(count.load(), 0);
+	LIB_task_pool_work_and_wait(pool);
+	LIB_task_pool_free(pool);
+	ASSERT_EQ(count.load(), 16);
+}
+
+static void graph_node_func(void *__restrict task_data) {
+	static_cast<std::atomic<int> *>(task_data)->fetch_add(1);
+}
+
+TEST_F(TaskScheduler, TaskGraphDiamond) {
+	std::atomic<int> counters[4] = {};
+
+	TaskGraph *graph = LIB_task_graph_create();
+	TaskNode *root = LIB_task_graph_node_create(graph, graph_node_func, &counters[0], nullptr);
+	TaskNode *left = LIB_task_graph_node_create(graph, graph_node_func, &counters[1], nullptr);
+	TaskNode *right = LIB_task_graph_node_create(graph, graph_node_func, &counters[2], nullptr);
+	TaskNode *join = LIB_task_graph_node_create(graph, graph_node_func, &counters[3], nullptr);
+	LIB_task_graph_edge_create(root, left);
+	LIB_task_graph_edge_create(root, right);
+	LIB_task_graph_edge_create(left, join);
+	LIB_task_graph_edge_create(right, join);
+
+	/* The graph can be executed multiple times, the join node runs once per execution. */
+	for (int execution = 1; execution <= 8; execution++) {
+		LIB_task_graph_node_push_work(root);
+		LIB_task_graph_work_and_wait(graph);
+		for (const std::atomic<int> &counter : counters) {
+			ASSERT_EQ(counter.load(), execution);
+		}
+	}
+
+	LIB_task_graph_free(graph);
+}
+
+}  // namespace
@@ -36,13 +36,22 @@ enum {
 /** \name Rose Write API
  * \{ */
 
+typedef struct RoseWriter RoseWriter;
+
 void RLO_write_struct_by_name(struct RoseWriter *writer, const char *name, const void *ptr);
+/** Write \a data as if it was stored at \a address, used to write modified copies of structs. */
+void RLO_write_struct_at_address_by_name(struct RoseWriter *writer, const char *name, const void *address, const void *data);
+/** Write the whole array as a single block, instead of one block per element. */
+void RLO_write_struct_array_by_name(struct RoseWriter *writer, const char *name, int length, const void *ptr);
+void RLO_write_struct_array_at_address_by_name(struct RoseWriter *writer, const char *name, int length, const void *address, const void *data);
+void RLO_write_struct_list_by_name(struct RoseWriter *writer, const char *name, const ListBase *list);
 
 void RLO_write_raw(struct RoseWriter *writer, size_t size, const void *ptr);
 
 void RLO_write_char_array(struct RoseWriter *writer, size_t length, const char *ptr);
 void RLO_write_int8_array(struct RoseWriter *writer, size_t length, const int8_t *ptr);
 void RLO_write_uint8_array(struct RoseWriter *writer, size_t length, const uint8_t *ptr);
+void RLO_write_int16_array(struct RoseWriter *writer, size_t length, const int16_t *ptr);
 void RLO_write_int32_array(struct RoseWriter *writer, size_t length, const int32_t *ptr);
 void RLO_write_uint32_array(struct RoseWriter *writer, size_t length, const uint32_t *ptr);
 void RLO_write_float_array(struct RoseWriter *writer, size_t length, const float *ptr);
@@ -56,6 +65,26 @@ void RLO_write_string(struct RoseWriter *writer, const char *ptr);
 		RLO_write_struct_by_name(writer, #_struct, (const _struct *)data); \
 	} while (false)
 
+#define RLO_write_struct_at_address(writer, _struct, address, data)                            \
+	do {                                                                                      \
+		RLO_write_struct_at_address_by_name(writer, #_struct, address, (const _struct *)data); \
+	} while (false)
+
+#define RLO_write_struct_array(writer, _struct, length, data)                            \
+	do {                                                                                 \
+		RLO_write_struct_array_by_name(writer, #_struct, length, (const _struct *)data); \
+	} while (false)
+
+#define RLO_write_struct_array_at_address(writer, _struct, length, address, data)                            \
+	do {                                                                                                     \
+		RLO_write_struct_array_at_address_by_name(writer, #_struct, length, address, (const _struct *)data); \
+	} while (false)
+
+#define RLO_write_struct_list(writer, _struct, list)             \
+	do {                                                         \
+		RLO_write_struct_list_by_name(writer, #_struct, (list)); \
+	} while (false)
+
 void rlo_write_id_struct(struct RoseWriter *writer, const char *name, const void *id_address, const struct ID *id);
 
 #define RLO_write_id_struct(writer, _struct, id_address, id)   \
@@ -88,12 +117,19 @@ void RLO_read_struct_list_with_size(struct RoseDataReader *reader, size_t esize,
 void RLO_read_char_array(RoseDataReader *reader, int array_size, char **ptr_p);
 void RLO_read_int8_array(RoseDataReader *reader, int array_size, int8_t **ptr_p);
 void RLO_read_uint8_array(RoseDataReader *reader, int array_size, uint8_t **ptr_p);
+void RLO_read_int16_array(RoseDataReader *reader, int array_size, int16_t **ptr_p);
 void RLO_read_int32_array(RoseDataReader *reader, int array_size, int32_t **ptr_p);
 void RLO_read_uint32_array(RoseDataReader *reader, int array_size, uint32_t **ptr_p);
 void RLO_read_float_array(RoseDataReader *reader, int array_size, float **ptr_p);
 void RLO_read_double_array(RoseDataReader *reader, int array_size, double **ptr_p);
 void RLO_read_pointer_array(RoseDataReader *reader, int array_size, void **ptr_p);
 
+/**
+ * Reset the runtime fields and read the data of an ID that is owned by another one
+ * (e.g. #Scene::master_collection), the struct itself should already be read.
+ */
+void RLO_read_embedded_id(RoseDataReader *reader, struct ID *id);
+
 /** \} */
 
 /* -------------------------------------------------------------------- */
@@ -10,7 +10,10 @@
 extern "C" {
 #endif
 
+struct DNA_ReconstructInfo;
 struct Main;
+struct MemFile;
+struct MemFileUndoData;
 struct OldNewMap;
 struct UserDef;
 
@@ -18,6 +21,9 @@ typedef struct FileData {
 	ListBase headlist;
 
 	struct FileReader *file;
+	/** Memory of the whole file when it is memory mapped, see #LIB_filereader_mmap_data. */
+	void *mmap_data;
+	size_t mmap_length;
 
 	struct OldNewMap *map_data;
 	struct OldNewMap *map_glob;
@@ -26,7 +32,12 @@ typedef struct FileData {
 	char relabase[FILE_MAX];
 
 	struct SDNA *f_dna;
-	struct SDNA *m_dna;
+	const struct SDNA *m_dna;
+	/** The steps to convert the structs of #f_dna into #m_dna, NULL when the DNA is current. */
+	struct DNA_ReconstructInfo *reconstruct_info;
+
+	/** Only set when restoring an undo step, see #RLO_read_from_memfile. */
+	struct MemFileUndoData *undo_data;
 
 	int flag;
 } FileData;
@@ -38,9 +49,26 @@ enum {
 	FD_FLAG_POINTSIZE_DIFFERS = 1 << 2,
 	FD_FLAG_FILE_OK = 1 << 3,
 	FD_FLAG_IS_MEMFILE = 1 << 4,
+	/** The file DNA is identical to the current one, structs do not need to be reconstructed. */
+	FD_FLAG_DNA_IS_CURRENT = 1 << 5,
+};
+
+/** #RLO_read_file flag */
+enum {
+	/** Decode all the blocks on the calling thread, the result is identical. */
+	RLO_READ_SINGLE_THREADED = 1 << 0,
 };
 
 bool RLO_read_file(struct Main *main, const char *filepath, int flag);
+/**
+ * Restore \a main to the state stored in \a memfile, where \a current is the memory file written
+ * from the current state of \a main.
+ *
+ * IDs whose chunks are shared by both memory files did not change and are kept as they are, along
+ * with all their runtime data. The other IDs are read from \a memfile at the address of their
+ * current version, so that the pointers of the kept IDs remain valid.
+ */
+bool RLO_read_from_memfile(struct Main *main, struct MemFile *memfile, const struct MemFile *current);
 
 #ifdef __cplusplus
 }
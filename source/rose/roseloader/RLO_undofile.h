@@ -0,0 +1,99 @@
+#ifndef RLO_UNDOFILE_H
+#define RLO_UNDOFILE_H
+
+#include "LIB_listbase.h"
+#include "LIB_utildefines.h"
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct FileReader;
+
+/* -------------------------------------------------------------------- */
+/** \name Memory File
+ *
+ * A memory file is a rose file written in memory, split into chunks. Chunks that are identical to
+ * the ones of the previous undo step share their memory with it, so that a step only costs the
+ * memory of what changed since then.
+ * \{ */
+
+typedef struct MemFileChunk {
+	struct MemFileChunk *prev, *next;
+
+	const char *buf;
+	size_t size;
+	/** Hash of the content, see #RLO_memfile_chunk_add. */
+	uint32_t hash;
+
+	/** The session UUID of the ID this chunk belongs to, zero when written outside of any ID. */
+	unsigned int id_session_uuid;
+
+	/** The buffer is shared with the previous step, which owns it. */
+	bool is_identical;
+	/** The buffer is shared with the next step. */
+	bool is_identical_future;
+} MemFileChunk;
+
+typedef struct MemFile {
+	ListBase chunks;
+
+	/** The memory owned by this memory file, shared chunks are not counted. */
+	size_t size;
+} MemFile;
+
+/**
+ * Free the chunks of the memory file, buffers that are shared with the previous step are owned by
+ * that step and are not freed.
+ */
+void RLO_memfile_free(MemFile *memfile);
+/**
+ * Transfer the ownership of the buffers \a second shares with \a first, so that \a first can be
+ * freed without invalidating \a second, which has to be the step written right after \a first.
+ */
+void RLO_memfile_merge(MemFile *first, MemFile *second);
+
+/**
+ * Read the content of the memory file as if it was a regular file.
+ */
+struct FileReader *RLO_memfile_new_filereader(MemFile *memfile);
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Memory File Writing
+ * \{ */
+
+typedef struct MemFileWriteData MemFileWriteData;
+
+/**
+ * Start writing chunks into \a written_memfile, when \a reference_memfile is not NULL chunks that
+ * are identical to the ones of the reference share its memory.
+ */
+MemFileWriteData *RLO_memfile_write_init(MemFile *written_memfile, MemFile *reference_memfile);
+void RLO_memfile_write_finalize(MemFileWriteData *mem_data);
+
+/**
+ * Mark the following chunks as belonging to the ID with the given session UUID, they are only
+ * compared against the chunks of the same ID in the reference, since IDs can be added, removed or
+ * reordered between the steps.
+ */
+void RLO_memfile_write_id_begin(MemFileWriteData *mem_data, unsigned int id_session_uuid);
+void RLO_memfile_write_id_end(MemFileWriteData *mem_data);
+
+/**
+ * Add a chunk with a copy of \a buf, or with the memory of the matching chunk of the reference when
+ * the content is identical. Chunks are matched by their position within the ID and their size, then
+ * by a hash of their content, the content itself is only compared when everything else matches.
+ */
+void RLO_memfile_chunk_add(MemFileWriteData *mem_data, const void *buf, size_t size);
+
+/** \} */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif	// RLO_UNDOFILE_H
@@ -6,8 +6,23 @@ extern "C" {
 #endif
 
 struct Main;
+struct MemFile;
+
+/** Flags for #RLO_write_file. */
+enum {
+	/**
+	 * Compress the file with zlib (ignored when not built with zlib). Reading detects compressed
+	 * files from their header, no flag is needed there.
+	 */
+	RLO_WRITE_COMPRESS = 1 << 0,
+};
 
 bool RLO_write_file(struct Main *main, const char *filepath, int flag);
+/**
+ * Write the database into \a current for undo, chunks that are identical to the ones of \a compare
+ * (the previous undo step, may be NULL) share its memory instead of being copied.
+ */
+bool RLO_write_file_mem(struct Main *main, struct MemFile *compare, struct MemFile *current, int flag);
 
 #ifdef __cplusplus
 }
@@ -9,18 +9,30 @@
 #include "LIB_filereader.h"
 #include "LIB_listbase.h"
 #include "LIB_map.hh"
+#include "LIB_set.hh"
 #include "LIB_string.h"
+#include "LIB_task.hh"
 #include "LIB_utildefines.h"
+#include "LIB_vector.hh"
 
+#include "KER_collection.h"
 #include "KER_global.h"
 #include "KER_idtype.h"
 #include "KER_lib_id.h"
+#include "KER_layer.h"
+#include "KER_lib_query.h"
 #include "KER_main.h"
+#include "KER_main_id_name_map.h"
+#include "KER_main_name_map.h"
 #include "KER_rosefile.h"
 #include "KER_userdef.h"
 
 #include "RLO_read_write.h"
 #include "RLO_readfile.h"
+#include "RLO_undofile.h"
+
+#include "DEG_depsgraph.h"
+#include "DEG_depsgraph_build.h"
 
 #include "RT_parser.h"
 
@@ -101,6 +113,13 @@ typedef struct RHeadN {
 
 	uint64_t offset;
 	bool has_data;
+	/** The data points into the memory mapped file instead of being owned by the node. */
+	bool is_mapped;
+
+	/** Data of the block, can be adopted by the caller (see #rlo_rhead_data_adopt). */
+	void *data;
+	/** The struct decoded ahead of time by #rlo_decode_blocks, owned until #read_struct adopts it. */
+	void *decoded;
 
 	RHead head;
 } RHeadN;
@@ -140,16 +159,38 @@ ROSE_STATIC RHeadN *get_rhead(FileData *fd) {
 			return NULL;
 		}
 
-		/** For now we read everything immediately! */
-		nheadn = static_cast<RHeadN *>(MEM_mallocN(sizeof(RHeadN) + head.size, "RHeadN"));
+		nheadn = static_cast<RHeadN *>(MEM_mallocN(sizeof(RHeadN), "RHeadN"));
 		memcpy(&nheadn->head, &head, sizeof(RHead));
 		nheadn->offset = fd->file->offset;
-
-		readsize = fd->file->read(fd->file, nheadn + 1, head.size);
-		if (readsize == head.size) {
-			nheadn->has_data = true;
+		nheadn->has_data = false;
+		nheadn->is_mapped = false;
+		nheadn->data = NULL;
+		nheadn->decoded = NULL;
+
+		if (fd->mmap_data) {
+			/* Point straight into the mapping, the data is only paged in once it is accessed. */
+			if (nheadn->offset + head.size <= fd->mmap_length) {
+				nheadn->data = POINTER_OFFSET(fd->mmap_data, nheadn->offset);
+				nheadn->has_data = true;
+				nheadn->is_mapped = true;
+				fd->file->seek(fd->file, head.size, SEEK_CUR);
+			}
+		}
+		else if ((fd->flag & FD_FLAG_IS_MEMFILE) != 0) {
+			/* Read on demand (see #rlo_rhead_read_data), the data of unchanged IDs is never read on undo. */
+			fd->file->seek(fd->file, head.size, SEEK_CUR);
 		}
 		else {
+			/* Read into a separate allocation, so that the data can be adopted by #read_struct. */
+			nheadn->data = MEM_mallocN(ROSE_MAX(head.size, 1), "RHeadN::data");
+			readsize = fd->file->read(fd->file, nheadn->data, head.size);
+			nheadn->has_data = (readsize == head.size);
+		}
+
+		if (!nheadn->has_data && (fd->flag & FD_FLAG_IS_MEMFILE) == 0) {
+			if (!nheadn->is_mapped) {
+				MEM_SAFE_FREE(nheadn->data);
+			}
 			MEM_SAFE_FREE(nheadn);
 		}
 	}
@@ -161,6 +202,54 @@ ROSE_STATIC RHeadN *get_rhead(FileData *fd) {
 	return nheadn;
 }
 
+/**
+ * Make sure the data of the block is available, only blocks of memory files are read on demand.
+ */
+ROSE_STATIC void rlo_rhead_read_data(FileData *fd, RHead *head) {
+	RHeadN *nheadn = RHEADN_FROM_RHEAD(head);
+	if (nheadn->has_data || (fd->flag & FD_FLAG_IS_MEMFILE) == 0) {
+		return;
+	}
+
+	const uint64_t offset = fd->file->offset;
+	nheadn->data = MEM_mallocN(ROSE_MAX(head->size, 1), "RHeadN::data");
+	fd->file->seek(fd->file, nheadn->offset, SEEK_SET);
+	nheadn->has_data = (fd->file->read(fd->file, nheadn->data, head->size) == head->size);
+	fd->file->seek(fd->file, offset, SEEK_SET);
+}
+
+ROSE_STATIC void *rlo_rhead_data(RHead *head) {
+	RHeadN *nheadn = RHEADN_FROM_RHEAD(head);
+	ROSE_assert_msg(nheadn->has_data, "Block data was already adopted");
+	return nheadn->data;
+}
+
+/**
+ * Take ownership of the data of the block, which avoids a copy when the data does not need to be
+ * reconstructed. Only possible when the data is not memory mapped, returns NULL otherwise.
+ */
+ROSE_STATIC void *rlo_rhead_data_adopt(RHead *head) {
+	RHeadN *nheadn = RHEADN_FROM_RHEAD(head);
+	if (nheadn->is_mapped || !nheadn->has_data) {
+		return NULL;
+	}
+	void *data = nheadn->data;
+	nheadn->data = NULL;
+	nheadn->has_data = false;
+	return data;
+}
+
+ROSE_STATIC void rlo_rhead_free_list(FileData *fd) {
+	LISTBASE_FOREACH_MUTABLE(RHeadN *, nheadn, &fd->headlist) {
+		if (!nheadn->is_mapped) {
+			MEM_SAFE_FREE(nheadn->data);
+		}
+		MEM_SAFE_FREE(nheadn->decoded);
+		MEM_freeN(nheadn);
+	}
+	LIB_listbase_clear(&fd->headlist);
+}
+
 RHead *rlo_rhead_first(FileData *fd) {
 	RHeadN *nheadn = reinterpret_cast<RHeadN *>(fd->headlist.first);
 	if (!nheadn) {
@@ -198,7 +287,8 @@ typedef struct RoseDataReader {
  * \{ */
 
 ROSE_STATIC void switch_endian_structs(const SDNA *sdna, RHead *head) {
-	void *data = head + 1;
+	/* Mapped memory is private, switching in place is fine. */
+	void *data = rlo_rhead_data(head);
 	size_t count = head->length, size = DNA_sdna_struct_size(sdna, head->dnatype);
 	while (count--) {
 		DNA_struct_switch_endian(sdna, head->dnatype, data);
@@ -207,20 +297,78 @@ ROSE_STATIC void switch_endian_structs(const SDNA *sdna, RHead *head) {
 	}
 }
 
-ROSE_STATIC void *read_struct(FileData *fd, RHead *head, const char *blockname) {
+ROSE_STATIC void *read_struct_decode(FileData *fd, RHead *head, const char *blockname) {
 	void *temp = NULL;
 
 	if (head->size) {
+		rlo_rhead_read_data(fd, head);
+
 		if (head->dnatype && (fd->flag & FD_FLAG_SWITCH_ENDIAN) != 0) {
 			switch_endian_structs(fd->f_dna, head);
 		}
 
-		temp = DNA_sdna_struct_reconstruct(fd->f_dna, fd->m_dna, head->dnatype, head + 1, blockname);
+		if (head->dnatype == 0 || (fd->flag & FD_FLAG_DNA_IS_CURRENT) != 0) {
+			/* Nothing to reconstruct, use the data as is (raw data has no DNA type at all). */
+			temp = rlo_rhead_data_adopt(head);
+			if (temp == NULL) {
+				temp = MEM_mallocN(head->size, blockname);
+				memcpy(temp, rlo_rhead_data(head), head->size);
+			}
+		}
+		else {
+			temp = DNA_sdna_struct_reconstruct(fd->reconstruct_info, head->dnatype, head->length, rlo_rhead_data(head), blockname);
+		}
 	}
 
 	return temp;
 }
 
+ROSE_STATIC void *read_struct(FileData *fd, RHead *head, const char *blockname) {
+	RHeadN *nheadn = RHEADN_FROM_RHEAD(head);
+	if (nheadn->decoded) {
+		void *temp = nheadn->decoded;
+		nheadn->decoded = NULL;
+		return temp;
+	}
+	return read_struct_decode(fd, head, blockname);
+}
+
+/**
+ * Index the headers of the whole file and decode the blocks of every data-block in parallel,
+ * endian switching and struct reconstruction only depend on the block itself. Restoring the
+ * pointers between the blocks remains serial, see #read_libblock and #lib_link_all.
+ */
+ROSE_STATIC void rlo_decode_blocks(FileData *fd, const int flag) {
+	rose::Vector<RHead *> blocks;
+	rose::Vector<const char *> blocknames;
+
+	const IDTypeInfo *id_type = NULL;
+	for (RHead *head = rlo_rhead_first(fd); head; head = rlo_rhead_next(fd, head)) {
+		if (head->filecode != RLO_CODE_DATA) {
+			id_type = KER_idtype_get_info_from_idcode(head->filecode);
+		}
+		/** The other blocks (user preferences, DNA) are read as they are. */
+		if (id_type != NULL && head->size) {
+			blocks.append(head);
+			blocknames.append(id_type->name);
+		}
+	}
+
+	auto decode_range = [&](const rose::IndexRange range) {
+		for (const int64_t index : range) {
+			RHead *head = blocks[index];
+			RHEADN_FROM_RHEAD(head)->decoded = read_struct_decode(fd, head, blocknames[index]);
+		}
+	};
+
+	if ((flag & RLO_READ_SINGLE_THREADED) != 0) {
+		decode_range(blocks.index_range());
+		return;
+	}
+	/** Blocks vary a lot in size, keep the tasks small so that a few large arrays do not stall a thread. */
+	rose::threading::parallel_for(blocks.index_range(), 8, decode_range);
+}
+
 /** \} */
 
 /* -------------------------------------------------------------------- */
@@ -284,6 +432,299 @@ ROSE_STATIC RHead *read_userdef(RoseFileData *rfd, FileData *fd, RHead *head) {
 
 /** \} */
 
+/* -------------------------------------------------------------------- */
+/** \name Read ID
+ * \{ */
+
+ROSE_STATIC void read_id_common(FileData *fd, ID *id, const int tag) {
+	id->prev = NULL;
+	id->next = NULL;
+	id->newid = NULL;
+	id->orig_id = NULL;
+	id->lib = NULL;
+	/** ID properties are not written yet. */
+	id->properties = NULL;
+
+	id->tag = tag;
+	id->recalc = 0;
+	/** Real users are counted again when the ID pointers are restored, see #lib_link_all. */
+	id->user = ID_FAKE_USERS(id);
+	/** Undo steps of the same ID are matched through their session UUID. */
+	if ((fd->flag & FD_FLAG_IS_MEMFILE) == 0) {
+		id->uuid = 0;
+	}
+	KER_lib_libblock_session_uuid_ensure(id);
+}
+
+ROSE_STATIC void read_id_data(FileData *fd, ID *id) {
+	const IDTypeInfo *id_type = KER_idtype_get_info_from_id(id);
+
+	if (id_type->read_data != NULL) {
+		RoseDataReader reader = {fd};
+		id_type->read_data(&reader, id);
+	}
+}
+
+ROSE_STATIC bool read_libblock_undo_reuse_unchanged(FileData *fd, RHead *head);
+ROSE_STATIC ID *read_libblock_undo_restore_at_old_address(FileData *fd, Main *main, ID *id);
+
+ROSE_STATIC RHead *read_libblock(FileData *fd, Main *main, RHead *head) {
+	const IDTypeInfo *id_type = KER_idtype_get_info_from_idcode(head->filecode);
+
+	if (fd->undo_data != NULL && read_libblock_undo_reuse_unchanged(fd, head)) {
+		/** Skip the data of the ID without reading it. */
+		do {
+			head = rlo_rhead_next(fd, head);
+		} while (head && head->filecode == RLO_CODE_DATA);
+		return head;
+	}
+
+	ID *id = static_cast<ID *>(read_struct(fd, head, id_type->name));
+	const uint64_t old_address = head->address;
+
+	head = read_data_into_datamap(fd, head, id_type->name);
+
+	if (id != NULL) {
+		read_id_common(fd, id, 0);
+		read_id_data(fd, id);
+
+		if (fd->undo_data != NULL) {
+			id = read_libblock_undo_restore_at_old_address(fd, main, id);
+		}
+		else {
+			ListBase *lb = which_libbase(main, GS(id->name));
+			KER_main_lock(main);
+			LIB_addtail(lb, id);
+			KER_id_new_name_validate(main, lb, id, NULL);
+			KER_main_unlock(main);
+		}
+
+		/** Other IDs store the old address of this one, restored by #lib_link_all. */
+		oldnewmap_insert(fd->map_glob, old_address, id, 1);
+	}
+
+	/** Blocks that were not claimed by the data-block are freed here. */
+	oldnewmap_clear(fd->map_data);
+
+	return head;
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Read Undo Step
+ *
+ * The current database is the state the last undo step was written from, IDs that did not change
+ * since the step that is restored are kept as they are. The other ones are restored at the address
+ * of their current version, other IDs may still point to them.
+ * \{ */
+
+typedef struct MemFileUndoData {
+	/** The IDs of the current database that are written to memory files, by session UUID. */
+	rose::Map<unsigned int, ID *> old_ids;
+	/** The IDs whose chunks are the same in the restored and the current memory file. */
+	rose::Set<unsigned int> unchanged_ids;
+	/** The IDs that are part of the restored step, the other ones are removed. */
+	rose::Set<unsigned int> restored_ids;
+} MemFileUndoData;
+
+ROSE_STATIC rose::Map<unsigned int, rose::Vector<const char *>> memfile_id_chunks(const MemFile *memfile) {
+	rose::Map<unsigned int, rose::Vector<const char *>> id_chunks;
+	LISTBASE_FOREACH(const MemFileChunk *, chunk, &memfile->chunks) {
+		if (chunk->id_session_uuid != 0) {
+			id_chunks.lookup_or_add_default(chunk->id_session_uuid).append(chunk->buf);
+		}
+	}
+	return id_chunks;
+}
+
+typedef struct UndoIDUsesChangedData {
+	const MemFileUndoData *undo_data;
+	bool uses_changed_id;
+} UndoIDUsesChangedData;
+
+ROSE_STATIC int undo_id_uses_changed_id_cb(LibraryIDLinkCallbackData *cb_data) {
+	UndoIDUsesChangedData *data = static_cast<UndoIDUsesChangedData *>(cb_data->user_data);
+	ID *id = *cb_data->self_ptr;
+
+	if (id == NULL || (cb_data->cb_flag & IDWALK_CB_EMBEDDED_NOT_OWNING) != 0) {
+		return IDWALK_RET_NOP;
+	}
+	if (cb_data->cb_flag & IDWALK_CB_EMBEDDED) {
+		/** Embedded IDs are written along their owner, only the IDs they use matter. */
+		KER_library_foreach_ID_link(cb_data->main, id, undo_id_uses_changed_id_cb, data, IDWALK_READONLY);
+		return data->uses_changed_id ? IDWALK_RET_STOP_ITER : IDWALK_RET_NOP;
+	}
+	if (!data->undo_data->unchanged_ids.contains(id->uuid)) {
+		data->uses_changed_id = true;
+		return IDWALK_RET_STOP_ITER;
+	}
+	return IDWALK_RET_NOP;
+}
+
+ROSE_STATIC void memfile_undo_data_init(MemFileUndoData *undo_data, Main *main, const MemFile *memfile, const MemFile *current) {
+	ID *id;
+	FOREACH_MAIN_ID_BEGIN(main, id) {
+		if (KER_idtype_get_info_from_id(id)->write != NULL) {
+			undo_data->old_ids.add(id->uuid, id);
+		}
+	}
+	FOREACH_MAIN_ID_END;
+
+	/**
+	 * Identical chunks share their memory with the previous step, so the chunks of an ID that did
+	 * not change between the two steps are the very same buffers.
+	 */
+	rose::Map<unsigned int, rose::Vector<const char *>> current_chunks = memfile_id_chunks(current);
+	for (const auto item : memfile_id_chunks(memfile).items()) {
+		const rose::Vector<const char *> *chunks = current_chunks.lookup_ptr(item.key);
+		if (chunks != NULL && *chunks == item.value && undo_data->old_ids.contains(item.key)) {
+			undo_data->unchanged_ids.add(item.key);
+		}
+	}
+
+	/**
+	 * Unchanged IDs may point to the data of changed ones (e.g. pose channels to the bones of the
+	 * armature), those are read again as well.
+	 */
+	rose::Vector<unsigned int> uses_changed_ids;
+	for (ID *old_id : undo_data->old_ids.values()) {
+		if (undo_data->unchanged_ids.contains(old_id->uuid)) {
+			UndoIDUsesChangedData data = {undo_data, false};
+			KER_library_foreach_ID_link(main, old_id, undo_id_uses_changed_id_cb, &data, IDWALK_READONLY);
+			if (data.uses_changed_id) {
+				uses_changed_ids.append(old_id->uuid);
+			}
+		}
+	}
+	for (const unsigned int uuid : uses_changed_ids) {
+		undo_data->unchanged_ids.remove(uuid);
+	}
+}
+
+/** Keep the current version of the ID if it did not change, returns false otherwise. */
+ROSE_STATIC bool read_libblock_undo_reuse_unchanged(FileData *fd, RHead *head) {
+	MemFileUndoData *undo_data = fd->undo_data;
+
+	/** Memory files are written with the current DNA, the ID can be used as is. */
+	rlo_rhead_read_data(fd, head);
+	const unsigned int uuid = static_cast<const ID *>(rlo_rhead_data(head))->uuid;
+	undo_data->restored_ids.add(uuid);
+
+	if (!undo_data->unchanged_ids.contains(uuid)) {
+		return false;
+	}
+
+	ID *id_old = undo_data->old_ids.lookup(uuid);
+	id_old->tag |= ID_TAG_UNDO_OLD_ID_REUSED_UNCHANGED;
+	oldnewmap_insert(fd->map_glob, head->address, id_old, 1);
+	return true;
+}
+
+/**
+ * Move the newly read ID to the address of its current version, or add it to the database when it
+ * did not exist. Returns the ID that remains.
+ */
+ROSE_STATIC ID *read_libblock_undo_restore_at_old_address(FileData *fd, Main *main, ID *id) {
+	ListBase *lb = which_libbase(main, GS(id->name));
+	ID *id_old = fd->undo_data->old_ids.lookup_default(id->uuid, NULL);
+
+	/**
+	 * Names are unique in the restored step, they are not validated (a renamed ID could clash with
+	 * the current name of an ID that is not restored yet), the name map is rebuilt afterwards.
+	 */
+	if (id_old == NULL) {
+		LIB_addtail(lb, id);
+		id_sort_by_name(lb, id, NULL);
+		return id;
+	}
+
+	/** User counts are recomputed once all the IDs are restored. */
+	KER_libblock_free_datablock(id_old, LIB_ID_FREE_NO_USER_REFCOUNT);
+	KER_libblock_free_data(id_old, false);
+
+	void *prev = id_old->prev, *next = id_old->next;
+	memcpy(id_old, id, KER_idtype_get_info_from_id(id)->size);
+	id_old->prev = prev;
+	id_old->next = next;
+	MEM_freeN(id);
+
+	id_sort_by_name(lb, id_old, NULL);
+	return id_old;
+}
+
+/** Free the IDs of the current database that do not exist in the restored step. */
+ROSE_STATIC void read_undo_remove_deleted_ids(FileData *fd, Main *main) {
+	for (ID *id_old : fd->undo_data->old_ids.values()) {
+		if (fd->undo_data->restored_ids.contains(id_old->uuid)) {
+			continue;
+		}
+		LIB_remlink(which_libbase(main, GS(id_old->name)), id_old);
+		/** Nothing that is kept uses the ID, otherwise it would have changed as well. */
+		KER_id_free_ex(main, id_old, LIB_ID_FREE_NO_MAIN | LIB_ID_FREE_NO_USER_REFCOUNT, false);
+	}
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Library Linking
+ *
+ * ID pointers still store the addresses the data-blocks had when the file was written, they are
+ * restored once all the data-blocks of the file are read.
+ * \{ */
+
+ROSE_STATIC int lib_link_cb(LibraryIDLinkCallbackData *cb_data) {
+	FileData *fd = static_cast<FileData *>(cb_data->user_data);
+	ID **id_p = cb_data->self_ptr;
+
+	if (*id_p == NULL) {
+		return IDWALK_RET_NOP;
+	}
+
+	if (cb_data->cb_flag & IDWALK_CB_EMBEDDED_NOT_OWNING) {
+		/** Already restored by the owner when its data was read. */
+		return IDWALK_RET_NOP;
+	}
+	if (cb_data->cb_flag & IDWALK_CB_EMBEDDED) {
+		/** Embedded data-blocks were already read along their owner, only their own pointers need linking. */
+		KER_library_foreach_ID_link(cb_data->main, *id_p, lib_link_cb, fd, IDWALK_NOP);
+		return IDWALK_RET_NOP;
+	}
+
+	/** Data-blocks that were not written (or are of an unknown type) are cleared. */
+	*id_p = static_cast<ID *>(oldnewmap_lookup_and_inc(fd->map_glob, (uint64_t)*id_p, true));
+	if (*id_p != NULL && (cb_data->cb_flag & IDWALK_CB_USER) != 0) {
+		id_us_add(*id_p);
+	}
+
+	return IDWALK_RET_NOP;
+}
+
+ROSE_STATIC void lib_link_all(FileData *fd, Main *main) {
+	for (NewAddress &new_addr : fd->map_glob->map.values()) {
+		ID *id = static_cast<ID *>(new_addr.newp);
+		if (id->tag & ID_TAG_UNDO_OLD_ID_REUSED_UNCHANGED) {
+			/** The pointers of the kept IDs are valid already. */
+			id->tag &= ~ID_TAG_UNDO_OLD_ID_REUSED_UNCHANGED;
+			continue;
+		}
+		KER_library_foreach_ID_link(main, id, lib_link_cb, fd, IDWALK_NOP);
+		if (fd->undo_data != NULL) {
+			DEG_id_tag_update_ex(main, id, ID_RECALC_ALL);
+		}
+	}
+
+	/** Runtime relations that are never written. */
+	KER_main_collections_parent_relations_rebuild(main);
+	KER_main_collection_sync(main);
+
+	/** The slot users are only cached at runtime. */
+	main->is_action_slot_to_id_map_dirty = true;
+}
+
+/** \} */
+
 /* -------------------------------------------------------------------- */
 /** \name Rose Read API
  * \{ */
@@ -346,6 +787,14 @@ void RLO_read_uint8_array(RoseDataReader *reader, int array_size, uint8_t **ptr_
 	*ptr_p = reinterpret_cast<uint8_t *>(RLO_read_struct_array_with_size(reader, *((void **)ptr_p), sizeof(uint8_t) * array_size));
 }
 
+void RLO_read_int16_array(RoseDataReader *reader, int array_size, int16_t **ptr_p) {
+	*ptr_p = reinterpret_cast<int16_t *>(RLO_read_struct_array_with_size(reader, *((void **)ptr_p), sizeof(int16_t) * array_size));
+
+	if (*ptr_p && RLO_read_requires_endian_switch(reader)) {
+		LIB_endian_switch_int16_array(*ptr_p, array_size);
+	}
+}
+
 void RLO_read_int32_array(RoseDataReader *reader, int array_size, int32_t **ptr_p) {
 	*ptr_p = reinterpret_cast<int32_t *>(RLO_read_struct_array_with_size(reader, *((void **)ptr_p), sizeof(int32_t) * array_size));
 
@@ -378,6 +827,66 @@ void RLO_read_double_array(RoseDataReader *reader, int array_size, double **ptr_
 	}
 }
 
+ROSE_STATIC void convert_pointer_array_64_to_32(RoseDataReader *reader, int array_size, const uint64_t *src, uint32_t *dst) {
+	/** Only the uniqueness of the old addresses matters, they are never dereferenced. */
+	const bool use_endian_swap = RLO_read_requires_endian_switch(reader);
+	for (int i = 0; i < array_size; i++) {
+		uint64_t ptr = src[i];
+		if (use_endian_swap) {
+			LIB_endian_switch_uint64(&ptr);
+		}
+		dst[i] = (uint32_t)(ptr >> 3);
+	}
+}
+
+ROSE_STATIC void convert_pointer_array_32_to_64(RoseDataReader *reader, int array_size, const uint32_t *src, uint64_t *dst) {
+	const bool use_endian_swap = RLO_read_requires_endian_switch(reader);
+	for (int i = 0; i < array_size; i++) {
+		uint32_t ptr = src[i];
+		if (use_endian_swap) {
+			LIB_endian_switch_uint32(&ptr);
+		}
+		dst[i] = ptr;
+	}
+}
+
+void RLO_read_pointer_array(RoseDataReader *reader, int array_size, void **ptr_p) {
+	FileData *fd = reader->fd;
+
+	const int64_t file_pointer_size = (fd->flag & FD_FLAG_FILE_POINTSIZE_IS_4) ? 4 : 8;
+	void *orig_array = RLO_read_struct_array_with_size(reader, *ptr_p, file_pointer_size * array_size);
+	if (orig_array == NULL) {
+		*ptr_p = NULL;
+		return;
+	}
+
+	const int64_t current_pointer_size = sizeof(void *);
+	if (file_pointer_size == current_pointer_size) {
+		/** No pointer conversion necessary, old pointers are only compared or looked up. */
+		*ptr_p = orig_array;
+		return;
+	}
+
+	void *final_array = MEM_mallocN(current_pointer_size * array_size, "new pointer array");
+	if (file_pointer_size == 8 && current_pointer_size == 4) {
+		convert_pointer_array_64_to_32(reader, array_size, static_cast<const uint64_t *>(orig_array), static_cast<uint32_t *>(final_array));
+	}
+	else {
+		convert_pointer_array_32_to_64(reader, array_size, static_cast<const uint32_t *>(orig_array), static_cast<uint64_t *>(final_array));
+	}
+	MEM_freeN(orig_array);
+
+	*ptr_p = final_array;
+}
+
+void RLO_read_embedded_id(RoseDataReader *reader, ID *id) {
+	if (id == NULL) {
+		return;
+	}
+	read_id_common(reader->fd, id, ID_TAG_NO_MAIN);
+	read_id_data(reader->fd, id);
+}
+
 /** \} */
 
 /* -------------------------------------------------------------------- */
@@ -389,8 +898,14 @@ ROSE_STATIC FileData *filedata_new(void) {
 
 	LIB_listbase_clear(&fd->headlist);
 
+	fd->file = NULL;
+	fd->mmap_data = NULL;
+	fd->mmap_length = 0;
+
 	fd->f_dna = NULL;
-	fd->m_dna = DNA_sdna_new_current();
+	fd->m_dna = DNA_sdna_current_get();
+	fd->reconstruct_info = NULL;
+	fd->undo_data = NULL;
 	fd->flag = 0;
 
 	fd->map_data = oldnewmap_new();
@@ -400,13 +915,13 @@ ROSE_STATIC FileData *filedata_new(void) {
 }
 
 ROSE_STATIC void filedata_free(FileData *fd) {
+	if (fd->reconstruct_info) {
+		DNA_sdna_reconstruct_info_free(fd->reconstruct_info);
+	}
 	if (fd->f_dna) {
 		DNA_sdna_free(fd->f_dna);
 	}
-	if (fd->m_dna) {
-		DNA_sdna_free(fd->m_dna);
-	}
-	LIB_freelistN(&fd->headlist);
+	rlo_rhead_free_list(fd);
 	if (fd->file) {
 		fd->file->close(fd->file);
 	}
@@ -449,11 +964,21 @@ ROSE_STATIC bool read_file_dna(FileData *fd) {
 
 	for (head = rlo_rhead_first(fd); head; head = rlo_rhead_next(fd, head)) {
 		if (head->filecode == RLO_CODE_DNA1) {
-			fd->f_dna = DNA_sdna_new_memory(&head[1], head->size);
+			rlo_rhead_read_data(fd, head);
+			fd->f_dna = DNA_sdna_new_memory(rlo_rhead_data(head), head->size);
 			if (!fd->f_dna || !DNA_sdna_build_struct_list(fd->f_dna)) {
 				fprintf(stderr, "Failed to read rose file '%s': %s\n", fd->relabase, "Invalid DNA");
 				return false;
 			}
+			/* A file written by this very version, every struct can be used as is. */
+			const SDNA *m_dna = fd->m_dna;
+			if ((fd->flag & FD_FLAG_SWITCH_ENDIAN) == 0 && head->size == m_dna->length && memcmp(rlo_rhead_data(head), m_dna->data, m_dna->length) == 0) {
+				fd->flag |= FD_FLAG_DNA_IS_CURRENT;
+			}
+			else {
+				/* Built ahead of decoding, the threads of #rlo_decode_blocks only read it. */
+				fd->reconstruct_info = DNA_sdna_reconstruct_info_new(fd->f_dna, m_dna);
+			}
 			return true;
 		}
 	}
@@ -492,8 +1017,22 @@ ROSE_STATIC FileData *rlo_filedata_from_file_descriptor(int descr) {
 	rawfile->seek(rawfile, 0, SEEK_SET);
 
 	if (memcmp(header, "ROSE", sizeof(header)) == 0) {
-		SWAP(FileReader *, file, rawfile);
+		/* Uncompressed files are memory mapped, blocks are then used without reading them. */
+		file = LIB_filereader_new_mmap(descr);
+		if (file == NULL) {
+			SWAP(FileReader *, file, rawfile);
+		}
+	}
+#ifdef WITH_ZLIB
+	/* Files written with #RLO_WRITE_COMPRESS are a plain gzip stream, see the gzip magic. */
+	else if ((unsigned char)header[0] == 0x1f && (unsigned char)header[1] == 0x8b) {
+		file = LIB_filereader_new_gzip(rawfile);
+		if (file != NULL) {
+			/* The decompressing reader owns the raw file now. */
+			rawfile = NULL;
+		}
 	}
+#endif
 
 	if (rawfile) {
 		rawfile->close(rawfile);
@@ -505,6 +1044,7 @@ ROSE_STATIC FileData *rlo_filedata_from_file_descriptor(int descr) {
 
 	FileData *fd = filedata_new();
 	fd->file = file;
+	fd->mmap_data = LIB_filereader_mmap_data(file, &fd->mmap_length);
 
 	return fd;
 }
@@ -527,6 +1067,15 @@ ROSE_STATIC FileData *rlo_filedata_from_file(const char *filepath) {
 	return NULL;
 }
 
+ROSE_STATIC FileData *rlo_filedata_from_memfile(MemFile *memfile) {
+	FileData *fd = filedata_new();
+	fd->file = RLO_memfile_new_filereader(memfile);
+	fd->flag |= FD_FLAG_IS_MEMFILE;
+	LIB_strcpy(fd->relabase, ARRAY_SIZE(fd->relabase), "<memory>");
+
+	return rlo_decode_and_check(fd);
+}
+
 /** \} */
 
 void RLO_rosefile_data_free(RoseFileData *rfd) {
@@ -548,6 +1097,8 @@ bool RLO_read_file(struct Main *main, const char *filepath, int flag) {
 
 	RoseFileData *rfd = static_cast<RoseFileData *>(MEM_callocN(sizeof(RoseFileData), "RoseFileData"));
 
+	rlo_decode_blocks(fd, flag);
+
 	RHead *head = rlo_rhead_first(fd);
 
 	while (head) {
@@ -556,11 +1107,18 @@ bool RLO_read_file(struct Main *main, const char *filepath, int flag) {
 				head = read_userdef(rfd, fd, head);
 			} break;
 			default: {
-				head = rlo_rhead_next(fd, head);
+				if (KER_idtype_get_info_from_idcode(head->filecode) != NULL) {
+					head = read_libblock(fd, main, head);
+				}
+				else {
+					head = rlo_rhead_next(fd, head);
+				}
 			} break;
 		}
 	}
 
+	lib_link_all(fd, main);
+
 	do_versions_userdef(fd, rfd);
 	KER_rosefile_read_setup(rfd);
 	RLO_rosefile_data_free(rfd);
@@ -568,3 +1126,39 @@ bool RLO_read_file(struct Main *main, const char *filepath, int flag) {
 	filedata_free(fd);
 	return true;
 }
+
+bool RLO_read_from_memfile(struct Main *main, struct MemFile *memfile, const struct MemFile *current) {
+	FileData *fd = rlo_filedata_from_memfile(memfile);
+
+	if (!fd) {
+		return false;
+	}
+
+	MemFileUndoData undo_data;
+	memfile_undo_data_init(&undo_data, main, memfile, current);
+	fd->undo_data = &undo_data;
+
+	for (RHead *head = rlo_rhead_first(fd); head;) {
+		if (KER_idtype_get_info_from_idcode(head->filecode) != NULL) {
+			head = read_libblock(fd, main, head);
+		}
+		else {
+			head = rlo_rhead_next(fd, head);
+		}
+	}
+
+	read_undo_remove_deleted_ids(fd, main);
+	lib_link_all(fd, main);
+
+	/** Both lookup maps are rebuilt on demand, IDs were added, removed and renamed. */
+	KER_main_name_map_clear(main);
+	if (main->id_map) {
+		KER_main_idmap_free(main->id_map);
+		main->id_map = NULL;
+	}
+	KER_main_id_refcount_recompute(main, false);
+	DEG_relations_tag_update(main);
+
+	filedata_free(fd);
+	return true;
+}
@@ -0,0 +1,233 @@
+#include "MEM_guardedalloc.h"
+
+#include "LIB_filereader.h"
+#include "LIB_hash_mm2a.h"
+#include "LIB_listbase.h"
+#include "LIB_map.hh"
+#include "LIB_utildefines.h"
+
+#include "RLO_undofile.h"
+
+#include <string.h>
+
+/* -------------------------------------------------------------------- */
+/** \name Memory File
+ * \{ */
+
+void RLO_memfile_free(MemFile *memfile) {
+	LISTBASE_FOREACH_MUTABLE(MemFileChunk *, chunk, &memfile->chunks) {
+		if (!chunk->is_identical && chunk->buf != nullptr) {
+			MEM_freeN(const_cast<char *>(chunk->buf));
+		}
+		MEM_freeN(chunk);
+	}
+	LIB_listbase_clear(&memfile->chunks);
+	memfile->size = 0;
+}
+
+void RLO_memfile_merge(MemFile *first, MemFile *second) {
+	rose::Map<const char *, MemFileChunk *> buffer_to_chunk;
+	LISTBASE_FOREACH(MemFileChunk *, chunk, &first->chunks) {
+		buffer_to_chunk.add(chunk->buf, chunk);
+	}
+
+	LISTBASE_FOREACH(MemFileChunk *, chunk, &second->chunks) {
+		if (!chunk->is_identical) {
+			continue;
+		}
+		MemFileChunk *first_chunk = buffer_to_chunk.lookup_default(chunk->buf, nullptr);
+		if (first_chunk == nullptr) {
+			continue;
+		}
+		/* The buffer is either owned by the first step, or shared with a step before that one. */
+		chunk->is_identical = first_chunk->is_identical;
+		if (!chunk->is_identical) {
+			second->size += chunk->size;
+			first_chunk->is_identical = true;
+		}
+	}
+
+	RLO_memfile_free(first);
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Memory File Reading
+ * \{ */
+
+typedef struct MemFileReader {
+	FileReader reader;
+
+	MemFile *memfile;
+
+	MemFileChunk *chunk;
+	/** Offset of the next byte to read within #chunk. */
+	size_t chunk_offset;
+} MemFileReader;
+
+ROSE_STATIC uint64_t memfile_read(FileReader *reader, void *buffer, size_t size) {
+	MemFileReader *mem = (MemFileReader *)reader;
+
+	uint64_t readsize = 0;
+	while (readsize < size && mem->chunk != nullptr) {
+		const size_t length = ROSE_MIN(size - readsize, mem->chunk->size - mem->chunk_offset);
+		memcpy(POINTER_OFFSET(buffer, readsize), mem->chunk->buf + mem->chunk_offset, length);
+		readsize += length;
+		mem->chunk_offset += length;
+		if (mem->chunk_offset == mem->chunk->size) {
+			mem->chunk = mem->chunk->next;
+			mem->chunk_offset = 0;
+		}
+	}
+
+	reader->offset += readsize;
+	return readsize;
+}
+
+ROSE_STATIC uint64_t memfile_seek(FileReader *reader, uint64_t offset, int whence) {
+	MemFileReader *mem = (MemFileReader *)reader;
+
+	uint64_t target;
+	switch (whence) {
+		case SEEK_SET: {
+			target = offset;
+		} break;
+		case SEEK_CUR: {
+			target = reader->offset + offset;
+		} break;
+		default: {
+			return (uint64_t)-1;
+		}
+	}
+
+	/* Walk the chunks from the current one, reading mostly seeks a short distance forward. */
+	MemFileChunk *chunk = mem->chunk;
+	uint64_t chunk_start = reader->offset - mem->chunk_offset;
+	if (chunk == nullptr) {
+		/* Past the end of the file, step back into the last chunk if needed. */
+		chunk = static_cast<MemFileChunk *>(mem->memfile->chunks.last);
+		chunk_start -= (chunk) ? chunk->size : 0;
+	}
+	while (chunk != nullptr && target < chunk_start) {
+		chunk = chunk->prev;
+		chunk_start -= (chunk) ? chunk->size : 0;
+	}
+	while (chunk != nullptr && chunk_start + chunk->size <= target) {
+		chunk_start += chunk->size;
+		chunk = chunk->next;
+	}
+
+	mem->chunk = chunk;
+	if (chunk != nullptr) {
+		mem->chunk_offset = target - chunk_start;
+		reader->offset = target;
+	}
+	else {
+		mem->chunk_offset = 0;
+		reader->offset = chunk_start;
+	}
+	return reader->offset;
+}
+
+ROSE_STATIC void memfile_close(FileReader *reader) {
+	MEM_freeN(reader);
+}
+
+FileReader *RLO_memfile_new_filereader(MemFile *memfile) {
+	MemFileReader *mem = static_cast<MemFileReader *>(MEM_callocN(sizeof(MemFileReader), "MemFileReader"));
+
+	mem->memfile = memfile;
+	mem->chunk = static_cast<MemFileChunk *>(memfile->chunks.first);
+
+	mem->reader.read = memfile_read;
+	mem->reader.seek = memfile_seek;
+	mem->reader.close = memfile_close;
+
+	return (FileReader *)mem;
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Memory File Writing
+ * \{ */
+
+typedef struct MemFileWriteData {
+	MemFile *written_memfile;
+	MemFile *reference_memfile;
+
+	/** The session UUID of the ID being written, zero outside of any ID. */
+	unsigned int current_id_session_uuid;
+	/** The chunk of the reference expected to match the next added chunk. */
+	MemFileChunk *reference_current_chunk;
+
+	/** The first chunk of every ID in the reference, IDs are not written in the same order. */
+	rose::Map<unsigned int, MemFileChunk *> id_session_uuid_mapping;
+} MemFileWriteData;
+
+MemFileWriteData *RLO_memfile_write_init(MemFile *written_memfile, MemFile *reference_memfile) {
+	MemFileWriteData *mem_data = MEM_new<MemFileWriteData>("MemFileWriteData");
+	mem_data->written_memfile = written_memfile;
+	mem_data->reference_memfile = reference_memfile;
+
+	if (reference_memfile != nullptr) {
+		mem_data->reference_current_chunk = static_cast<MemFileChunk *>(reference_memfile->chunks.first);
+
+		LISTBASE_FOREACH(MemFileChunk *, chunk, &reference_memfile->chunks) {
+			if (chunk->id_session_uuid != 0) {
+				mem_data->id_session_uuid_mapping.add(chunk->id_session_uuid, chunk);
+			}
+		}
+	}
+	return mem_data;
+}
+
+void RLO_memfile_write_finalize(MemFileWriteData *mem_data) {
+	MEM_delete(mem_data);
+}
+
+void RLO_memfile_write_id_begin(MemFileWriteData *mem_data, unsigned int id_session_uuid) {
+	mem_data->current_id_session_uuid = id_session_uuid;
+	mem_data->reference_current_chunk = mem_data->id_session_uuid_mapping.lookup_default(id_session_uuid, nullptr);
+}
+
+void RLO_memfile_write_id_end(MemFileWriteData *mem_data) {
+	mem_data->current_id_session_uuid = 0;
+	mem_data->reference_current_chunk = nullptr;
+}
+
+void RLO_memfile_chunk_add(MemFileWriteData *mem_data, const void *buf, size_t size) {
+	MemFile *memfile = mem_data->written_memfile;
+
+	MemFileChunk *chunk = static_cast<MemFileChunk *>(MEM_mallocN(sizeof(MemFileChunk), "MemFileChunk"));
+	chunk->buf = nullptr;
+	chunk->size = size;
+	chunk->hash = LIB_hash_mm2(static_cast<const unsigned char *>(buf), size, 0);
+	chunk->id_session_uuid = mem_data->current_id_session_uuid;
+	chunk->is_identical = false;
+	chunk->is_identical_future = false;
+	LIB_addtail(&memfile->chunks, chunk);
+
+	MemFileChunk *reference = mem_data->reference_current_chunk;
+	if (reference != nullptr) {
+		/* Chunks of the reference are consumed in order, even when they do not match. */
+		mem_data->reference_current_chunk = reference->next;
+
+		if (reference->id_session_uuid == chunk->id_session_uuid && reference->size == size && reference->hash == chunk->hash) {
+			if (memcmp(reference->buf, buf, size) == 0) {
+				chunk->buf = reference->buf;
+				chunk->is_identical = true;
+				reference->is_identical_future = true;
+				return;
+			}
+		}
+	}
+
+	char *copy = static_cast<char *>(MEM_mallocN(size, "MemFileChunk::buf"));
+	memcpy(copy, buf, size);
+	chunk->buf = copy;
+	memfile->size += size;
+}
+
+/** \} */
@@ -16,6 +16,7 @@
 #include "KER_main.h"
 
 #include "RLO_read_write.h"
+#include "RLO_undofile.h"
 #include "RLO_writefile.h"
 
 #include "RT_parser.h"
@@ -24,6 +25,10 @@
 
 #include <limits.h>
 
+#ifdef WITH_ZLIB
+#	include <zlib.h>
+#endif
+
 /* -------------------------------------------------------------------- */
 /** \name Internal Write Wrapper's (Abstracts Compression)
  * \{ */
@@ -58,25 +63,105 @@ bool RawWriteWrap::close() {
 }
 
 bool RawWriteWrap::write(const void *buffer, size_t length) {
-	return ::write(this->fd, buffer, length) == length;
+	const char *data = static_cast<const char *>(buffer);
+	while (length > 0) {
+		/* The system is allowed to write less than requested. */
+		const int64_t written = ::write(this->fd, data, length);
+		if (written <= 0) {
+			return false;
+		}
+		data += written;
+		length -= size_t(written);
+	}
+	return true;
+}
+
+#ifdef WITH_ZLIB
+
+class ZlibWriteWrap : public WriteWrap {
+public:
+	bool open(const char *filepath) override;
+	bool close() override;
+	bool write(const void *buffer, size_t length) override;
+
+private:
+	gzFile file = nullptr;
+};
+
+bool ZlibWriteWrap::open(const char *filepath) {
+	int handle = LIB_open(filepath, O_BINARY | O_WRONLY | O_CREAT | O_TRUNC, 0666);
+	if (handle < 0) {
+		return false;
+	}
+	/* Favor speed over ratio, most of the size reduction comes from the runs of zeroes in DNA
+	 * structs which every level handles well. */
+	this->file = gzdopen(handle, "wb1");
+	if (this->file == nullptr) {
+		::close(handle);
+		return false;
+	}
+	return true;
 }
 
+bool ZlibWriteWrap::close() {
+	return gzclose(this->file) == Z_OK;
+}
+
+bool ZlibWriteWrap::write(const void *buffer, size_t length) {
+	const char *data = static_cast<const char *>(buffer);
+	while (length > 0) {
+		/* The length and the result of #gzwrite are integers, large arrays are written in parts. */
+		const unsigned int chunk = (unsigned int)ROSE_MIN(length, size_t(INT_MAX));
+		if (gzwrite(this->file, data, chunk) != int(chunk)) {
+			return false;
+		}
+		data += chunk;
+		length -= chunk;
+	}
+	return true;
+}
+
+#endif
+
 /** \} */
 
 /* -------------------------------------------------------------------- */
 /** \name Write Data Type & Functions
  * \{ */
 
+/**
+ * Most blocks written are small structs, collect them in a large buffer so that writing costs
+ * one call to the #WriteWrap per buffer instead of two per block.
+ */
+#define WRITE_BUFFER_SIZE (1 << 20)
+/**
+ * Every flush of the buffer is a chunk of the #MemFile, which is shared with the previous undo
+ * step only when nothing in it changed. Smaller chunks keep large arrays in chunks of their own.
+ */
+#define MEMFILE_WRITE_BUFFER_SIZE (1 << 16)
+
 typedef struct WriteData {
-	struct SDNA *dna;
+	/** The shared DNA of this executable, see #DNA_sdna_current_get. */
+	const struct SDNA *dna;
+
+	struct {
+		/** Data waiting to be passed on to the #WriteWrap. */
+		char *buf;
+		size_t used_len;
+		size_t max_size;
+	} buffer;
 
 	struct {
 		/** Set on unlikely case of an error (ignores further file writing). */
 		bool error;
 	} validation;
 
-	/** Wrap writing, so we can use zstd or other compression types later! */
+	/** Wrap writing, abstracts compression. */
 	WriteWrap *ww;
+
+	/** Write into a #MemFile instead of the #WriteWrap, for undo. */
+	MemFileWriteData *mem_data;
+	bool use_memfile;
 } WriteData;
 
 typedef struct RoseWriter {
@@ -85,11 +170,32 @@ typedef struct RoseWriter {
 
 ROSE_INLINE WriteData *writedata_new(WriteWrap *ww) {
 	WriteData *wd = MEM_cnew<WriteData>("WriteData");
-	wd->dna = DNA_sdna_new_current();
+	wd->dna = DNA_sdna_current_get();
 	wd->ww = ww;
+	wd->buffer.max_size = (ww == nullptr) ? MEMFILE_WRITE_BUFFER_SIZE : WRITE_BUFFER_SIZE;
+	wd->buffer.buf = static_cast<char *>(MEM_mallocN(wd->buffer.max_size, "wd->buffer.buf"));
 	return wd;
 }
 
+ROSE_INLINE void writedata_do_write_direct(WriteData *wd, const void *mem, size_t length) {
+	if (wd->use_memfile) {
+		RLO_memfile_chunk_add(wd->mem_data, mem, length);
+	}
+	else if (wd->ww) {
+		if (!wd->ww->write(mem, length)) {
+			wd->validation.error = true;
+		}
+	}
+}
+
+/** Pass on all the buffered data to the #WriteWrap. */
+ROSE_INLINE void writedata_flush(WriteData *wd) {
+	if (wd->buffer.used_len != 0 && wd->validation.error == false) {
+		writedata_do_write_direct(wd, wd->buffer.buf, wd->buffer.used_len);
+	}
+	wd->buffer.used_len = 0;
+}
+
 ROSE_INLINE void writedata_do_write(WriteData *wd, const void *mem, size_t length) {
 	if ((wd == NULL) || (wd->validation.error != false)) {
 		return;
@@ -100,21 +206,44 @@ ROSE_INLINE void writedata_do_write(WriteData *wd, const void *mem, size_t lengt
 		return;
 	}
 
-	if (wd->ww) {
-		if (!wd->ww->write(mem, length)) {
-			wd->validation.error = true;
-		}
+	if (wd->buffer.used_len + length > wd->buffer.max_size) {
+		writedata_flush(wd);
+	}
+
+	if (length >= wd->buffer.max_size) {
+		/* Large data-blocks (e.g. mesh arrays) are not worth copying into the buffer. */
+		writedata_do_write_direct(wd, mem, length);
+		return;
 	}
+
+	memcpy(wd->buffer.buf + wd->buffer.used_len, mem, length);
+	wd->buffer.used_len += length;
 }
 
 ROSE_INLINE void writedata_free(WriteData *wd) {
-	if (wd->dna) {
-		DNA_sdna_free(wd->dna);
-	}
+	MEM_SAFE_FREE(wd->buffer.buf);
 
 	MEM_freeN(wd);
 }
 
+/**
+ * The data of every ID is put into chunks of its own, so that the chunks of unchanged IDs can be
+ * shared between undo steps. Does nothing when writing a file.
+ */
+ROSE_INLINE void writedata_id_begin(WriteData *wd, const ID *id) {
+	if (wd->use_memfile) {
+		writedata_flush(wd);
+		RLO_memfile_write_id_begin(wd->mem_data, id->uuid);
+	}
+}
+
+ROSE_INLINE void writedata_id_end(WriteData *wd) {
+	if (wd->use_memfile) {
+		writedata_flush(wd);
+		RLO_memfile_write_id_end(wd->mem_data);
+	}
+}
+
 /** \} */
 
 /* -------------------------------------------------------------------- */
@@ -153,21 +282,26 @@ ROSE_STATIC void writedata(WriteData *wd, int fildecode, size_t length, const vo
 		return;
 	}
 
-	length = (length + 3) & ~(size_t)(3);
+	const size_t length_aligned = (length + 3) & ~(size_t)(3);
 
-	if (length > INT_MAX) {
+	if (length_aligned > INT_MAX) {
 		ROSE_assert_msg(0, "Cannot write chunks bigger than INT_MAX!");
 		return;
 	}
 
 	head.filecode = fildecode;
-	head.size = length;
+	head.size = length_aligned;
 	head.length = 1;
 	head.address = (uint64_t)address;
 	head.dnatype = 0;
 
 	writedata_do_write(wd, &head, sizeof(RHead));
-	writedata_do_write(wd, address, head.size);
+	writedata_do_write(wd, address, length);
+	/* Do not read past the end of the data, the padding would not be the same every time. */
+	if (length_aligned != length) {
+		const char padding[4] = {0};
+		writedata_do_write(wd, padding, length_aligned - length);
+	}
 }
 
 ROSE_STATIC void writelist_nr(WriteData *wd, int filecode, uint64_t struct_nr, const ListBase *lb) {
@@ -198,6 +332,34 @@ void RLO_write_struct_by_name(RoseWriter *writer, const char *struct_name, const
 	writestruct_nr(writer->wd, RLO_CODE_DATA, struct_nr, 1, data);
 }
 
+void RLO_write_struct_at_address_by_name(RoseWriter *writer, const char *struct_name, const void *address, const void *data) {
+	RLO_write_struct_array_at_address_by_name(writer, struct_name, 1, address, data);
+}
+
+void RLO_write_struct_array_by_name(RoseWriter *writer, const char *struct_name, int length, const void *data) {
+	RLO_write_struct_array_at_address_by_name(writer, struct_name, length, data, data);
+}
+
+void RLO_write_struct_array_at_address_by_name(RoseWriter *writer, const char *struct_name, int length, const void *address, const void *data) {
+	uint64_t struct_nr = DNA_sdna_struct_id(writer->wd->dna, struct_name);
+	if (struct_nr == 0) {
+		ROSE_assert_msg(0, "Cannot write unknown struct!");
+		return;
+	}
+
+	writestruct_at_address_nr(writer->wd, RLO_CODE_DATA, struct_nr, length, address, data);
+}
+
+void RLO_write_struct_list_by_name(RoseWriter *writer, const char *struct_name, const ListBase *list) {
+	uint64_t struct_nr = DNA_sdna_struct_id(writer->wd->dna, struct_name);
+	if (struct_nr == 0) {
+		ROSE_assert_msg(0, "Cannot write unknown struct!");
+		return;
+	}
+
+	writelist_nr(writer->wd, RLO_CODE_DATA, struct_nr, list);
+}
+
 void RLO_write_raw(RoseWriter *writer, size_t size, const void *ptr) {
 	writedata(writer->wd, RLO_CODE_DATA, size, ptr);
 }
@@ -214,6 +376,10 @@ void RLO_write_uint8_array(RoseWriter *writer, size_t length, const uint8_t *ptr
 	RLO_write_raw(writer, length * sizeof(ptr[0]), ptr);
 }
 
+void RLO_write_int16_array(RoseWriter *writer, size_t length, const int16_t *ptr) {
+	RLO_write_raw(writer, length * sizeof(ptr[0]), ptr);
+}
+
 void RLO_write_int32_array(RoseWriter *writer, size_t length, const int32_t *ptr) {
 	RLO_write_raw(writer, length * sizeof(ptr[0]), ptr);
 }
@@ -296,6 +462,7 @@ RLO_Write_IDBuffer::RLO_Write_IDBuffer(ID &id, const bool is_placeholder) : buff
 	/* Clear runtime data to reduce false detection of changed data in undo/redo context. */
 	temp_id->tag = 0;
 	temp_id->user = 0;
+	temp_id->recalc = 0;
 	/**
 	 * Those listbase data change every time we add/remove an ID, and also often when
 	 * renaming one (due to re-sorting). This avoids generating a lot of false 'is changed'
@@ -309,6 +476,8 @@ RLO_Write_IDBuffer::RLO_Write_IDBuffer(ID &id, const bool is_placeholder) : buff
 	 */
 	temp_id->orig_id = nullptr;
 	temp_id->newid = nullptr;
+	/** ID properties are not written yet. */
+	temp_id->properties = nullptr;
 }
 
 RLO_Write_IDBuffer::RLO_Write_IDBuffer(ID &id, RoseWriter *writer) : RLO_Write_IDBuffer(id, false) {
@@ -318,8 +487,10 @@ ROSE_STATIC void write_id(RoseWriter *writer, ID *id) {
 	const IDTypeInfo *id_type = KER_idtype_get_info_from_id(id);
 
 	if (id_type->write != nullptr) {
+		writedata_id_begin(writer->wd, id);
 		RLO_Write_IDBuffer id_buffer{*id, false};
 		id_type->write(writer, id_buffer.get(), id);
+		writedata_id_end(writer->wd);
 	}
 }
 
@@ -356,11 +527,16 @@ ROSE_STATIC void write_end(RoseWriter *writer) {
 	writedata_do_write(writer->wd, &head, sizeof(RHead));
 }
 
-ROSE_STATIC bool write_file_handle(Main *main, WriteWrap *ww, int flag) {
+ROSE_STATIC bool write_file_handle(Main *main, WriteWrap *ww, MemFile *compare, MemFile *current, int flag) {
 	bool status;
 	WriteData *wd = writedata_new(ww);
 	RoseWriter writer = {wd};
 
+	if (current != nullptr) {
+		wd->mem_data = RLO_memfile_write_init(current, compare);
+		wd->use_memfile = true;
+	}
+
 	char header[8];
 #ifdef __BIG_ENDIAN__
 	LIB_strnformat(header, sizeof(header), "ROSEBG%c", '0' + sizeof(void *));
@@ -370,11 +546,18 @@ ROSE_STATIC bool write_file_handle(Main *main, WriteWrap *ww, int flag) {
 	writedata_do_write(wd, header, sizeof(header));
 
 	write_dna(&writer, wd->dna);
-	write_userdef(&writer, &U);
+	/* The preferences are not part of the undo history. */
+	if (!wd->use_memfile) {
+		write_userdef(&writer, &U);
+	}
 	write_libraries(&writer, main);
 	write_end(&writer);
+	writedata_flush(wd);
 
 	status = !wd->validation.error;
+	if (wd->use_memfile) {
+		RLO_memfile_write_finalize(wd->mem_data);
+	}
 	writedata_free(wd);
 	return status;
 }
@@ -382,11 +565,19 @@ ROSE_STATIC bool write_file_handle(Main *main, WriteWrap *ww, int flag) {
 /** \} */
 
 bool RLO_write_file(Main *main, const char *filepath, int flag) {
-	RawWriteWrap ww;
+	RawWriteWrap raw_wrap;
+#ifdef WITH_ZLIB
+	ZlibWriteWrap zlib_wrap;
+	WriteWrap &ww = (flag & RLO_WRITE_COMPRESS) ? static_cast<WriteWrap &>(zlib_wrap) : static_cast<WriteWrap &>(raw_wrap);
+#else
+	/* Compression is not available, write an uncompressed file, which is read the same way. */
+	WriteWrap &ww = raw_wrap;
+#endif
+
 	if (!ww.open(filepath)) {
 		return false;
 	}
-	if (!write_file_handle(main, &ww, flag)) {
+	if (!write_file_handle(main, &ww, nullptr, nullptr, flag)) {
 		ww.close();
 		return false;
 	}
@@ -395,3 +586,7 @@ bool RLO_write_file(Main *main, const char *filepath, int flag) {
 	}
 	return true;
 }
+
+bool RLO_write_file_mem(Main *main, MemFile *compare, MemFile *current, int flag) {
+	return write_file_handle(main, nullptr, compare, current, flag);
+}
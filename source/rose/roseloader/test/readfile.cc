@@ -0,0 +1,562 @@
+#include "MEM_guardedalloc.h"
+
+#include "DNA_action_types.h"
+#include "DNA_anim_types.h"
+#include "DNA_armature_types.h"
+#include "DNA_camera_types.h"
+#include "DNA_collection_types.h"
+#include "DNA_layer_types.h"
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+#include "DNA_object_types.h"
+#include "DNA_scene_types.h"
+
+#include "KER_action.h"
+#include "KER_anim_data.h"
+#include "KER_anim_sys.h"
+#include "KER_armature.h"
+#include "KER_camera.h"
+#include "KER_collection.h"
+#include "KER_deform.h"
+#include "KER_fcurve.h"
+#include "KER_idtype.h"
+#include "KER_lib_id.h"
+#include "KER_main.h"
+#include "KER_mesh.h"
+#include "KER_object.h"
+#include "KER_scene.h"
+
+#include "LIB_listbase.h"
+#include "LIB_math_matrix.h"
+#include "LIB_math_vector.h"
+#include "LIB_string.h"
+#include "LIB_utildefines.h"
+
+#include "RLO_readfile.h"
+#include "RLO_writefile.h"
+
+#include <cstdio>
+#include <string>
+
+#include "gtest/gtest.h"
+
+namespace {
+
+Scene *add_scene_with_objects(Main *main, const int objects_num) {
+	Scene *scene = KER_scene_new(main, "Scene");
+	for (int index = 0; index < objects_num; index++) {
+		char name[64];
+		LIB_strnformat(name, ARRAY_SIZE(name), "Empty%d", index);
+		Object *object = KER_object_add(main, scene, OB_EMPTY, name);
+		copy_v3_fl3(object->loc, float(index), -1.0f, 2.0f);
+		KER_collection_object_add(main, scene->master_collection, object);
+	}
+	return scene;
+}
+
+/** Save #main to a temporary file and load it into a new #Main, the file is removed afterwards. */
+Main *write_and_read(Main *main, const char *filename) {
+	const std::string filepath = testing::TempDir() + filename;
+	EXPECT_TRUE(RLO_write_file(main, filepath.c_str(), 0));
+
+	Main *main_read = KER_main_new();
+	EXPECT_TRUE(RLO_read_file(main_read, filepath.c_str(), 0));
+	remove(filepath.c_str());
+	return main_read;
+}
+
+template<typename T> T *lookup(Main *main, const short idcode, const char *name) {
+	return reinterpret_cast<T *>(KER_main_id_lookup(main, idcode, name));
+}
+
+Bone *add_bone(Armature *armature, Bone *parent, const char *name, const float head[3], const float tail[3]) {
+	Bone *bone = static_cast<Bone *>(MEM_callocN(sizeof(Bone), "Bone"));
+	LIB_strcpy(bone->name, ARRAY_SIZE(bone->name), name);
+	copy_v3_v3(bone->head, head);
+	copy_v3_v3(bone->tail, tail);
+	bone->parent = parent;
+	LIB_addtail((parent) ? &parent->childbase : &armature->bonebase, bone);
+	return bone;
+}
+
+TEST(ReadFile, Compressed) {
+	KER_idtype_init();
+
+	Main *main = KER_main_new();
+	add_scene_with_objects(main, 16);
+
+	const std::string filepath = testing::TempDir() + "readfile_compressed.rose";
+	ASSERT_TRUE(RLO_write_file(main, filepath.c_str(), RLO_WRITE_COMPRESS));
+#ifdef WITH_ZLIB
+	/* The file is a plain gzip stream. */
+	unsigned char header[2] = {0, 0};
+	FILE *file = fopen(filepath.c_str(), "rb");
+	ASSERT_NE(file, nullptr);
+	EXPECT_EQ(fread(header, 1, sizeof(header), file), sizeof(header));
+	fclose(file);
+	EXPECT_EQ(header[0], 0x1f);
+	EXPECT_EQ(header[1], 0x8b);
+#endif
+
+	Main *main_read = KER_main_new();
+	EXPECT_TRUE(RLO_read_file(main_read, filepath.c_str(), 0));
+	remove(filepath.c_str());
+
+	EXPECT_EQ(LIB_listbase_count(&main_read->scenes), 1);
+	ASSERT_EQ(LIB_listbase_count(&main_read->objects), 16);
+	LISTBASE_FOREACH(Object *, object, &main_read->objects) {
+		const Object *object_orig = reinterpret_cast<const Object *>(KER_main_id_lookup(main, ID_OB, object->id.name + 2));
+		ASSERT_NE(object_orig, nullptr);
+		EXPECT_EQ(object->type, OB_EMPTY);
+		EXPECT_TRUE(equals_v3_v3(object->loc, object_orig->loc));
+	}
+
+	KER_main_free(main_read);
+	KER_main_free(main);
+}
+
+TEST(ReadFile, Mesh) {
+	KER_idtype_init();
+
+	Main *main = KER_main_new();
+	do {
+		/* A quad and a triangle sharing the edge between the second and the third vertex. */
+		const float positions[5][3] = {{0, 0, 0}, {1, 0, 0}, {1, 1, 0}, {0, 1, 0}, {2, 0.5f, 1}};
+		const int edges[6][2] = {{0, 1}, {1, 2}, {2, 3}, {3, 0}, {1, 4}, {4, 2}};
+		const int corner_verts[7] = {0, 1, 2, 3, 1, 4, 2};
+		const int corner_edges[7] = {0, 1, 2, 3, 4, 5, 1};
+		const int poly_offsets[3] = {0, 4, 7};
+
+		Scene *scene = KER_scene_new(main, "Scene");
+		Mesh *mesh = KER_mesh_add(main, "Mesh");
+		mesh->totvert = 5;
+		mesh->totedge = 6;
+		mesh->totpoly = 2;
+		mesh->totloop = 7;
+		KER_mesh_ensure_required_data_layers(mesh);
+		KER_mesh_poly_offsets_ensure_alloc(mesh);
+		memcpy(KER_mesh_vert_positions_for_write(mesh), positions, sizeof(positions));
+		memcpy(KER_mesh_edges_for_write(mesh), edges, sizeof(edges));
+		memcpy(KER_mesh_corner_verts_for_write(mesh), corner_verts, sizeof(corner_verts));
+		memcpy(KER_mesh_corner_edges_for_write(mesh), corner_edges, sizeof(corner_edges));
+		memcpy(KER_mesh_poly_offsets_for_write(mesh), poly_offsets, sizeof(poly_offsets));
+
+		Object *object = KER_object_add_for_data(main, scene, OB_MESH, "Mesh", &mesh->id, true);
+		KER_object_defgroup_new(object, "Group");
+		MDeformVert *dverts = KER_mesh_deform_verts_for_write(mesh);
+		KER_defvert_ensure_index(&dverts[1], 0)->weight = 0.5f;
+		KER_defvert_ensure_index(&dverts[4], 0)->weight = 1.0f;
+
+		Main *main_read = write_and_read(main, "readfile_mesh.rose");
+
+		const Mesh *mesh_read = lookup<Mesh>(main_read, ID_ME, "Mesh");
+		ASSERT_NE(mesh_read, nullptr);
+		EXPECT_EQ(mesh_read->totvert, 5);
+		EXPECT_EQ(mesh_read->totedge, 6);
+		EXPECT_EQ(mesh_read->totpoly, 2);
+		EXPECT_EQ(mesh_read->totloop, 7);
+		EXPECT_EQ(memcmp(KER_mesh_vert_positions(mesh_read), positions, sizeof(positions)), 0);
+		EXPECT_EQ(memcmp(KER_mesh_edges(mesh_read), edges, sizeof(edges)), 0);
+		EXPECT_EQ(memcmp(KER_mesh_corner_verts(mesh_read), corner_verts, sizeof(corner_verts)), 0);
+		EXPECT_EQ(memcmp(KER_mesh_corner_edges(mesh_read), corner_edges, sizeof(corner_edges)), 0);
+		EXPECT_EQ(memcmp(KER_mesh_poly_offsets(mesh_read), poly_offsets, sizeof(poly_offsets)), 0);
+
+		EXPECT_EQ(LIB_listbase_count(&mesh_read->vertex_group_names), 1);
+		const MDeformVert *dverts_read = KER_mesh_deform_verts(mesh_read);
+		ASSERT_NE(dverts_read, nullptr);
+		EXPECT_EQ(dverts_read[0].totweight, 0);
+		ASSERT_EQ(dverts_read[1].totweight, 1);
+		EXPECT_EQ(dverts_read[1].dw[0].weight, 0.5f);
+		ASSERT_EQ(dverts_read[4].totweight, 1);
+		EXPECT_EQ(dverts_read[4].dw[0].weight, 1.0f);
+
+		KER_main_free(main_read);
+	} while (false);
+	KER_main_free(main);
+}
+
+TEST(ReadFile, Object) {
+	KER_idtype_init();
+
+	Main *main = KER_main_new();
+	do {
+		Scene *scene = KER_scene_new(main, "Scene");
+		Camera *camera = KER_camera_add(main, "Camera");
+		Object *parent = KER_object_add(main, scene, OB_EMPTY, "Parent");
+		Object *child = KER_object_add_for_data(main, scene, OB_CAMERA, "Child", &camera->id, true);
+		child->parent = parent;
+
+		copy_v3_fl3(parent->loc, 1.0f, 2.0f, 3.0f);
+		copy_v3_fl3(parent->scale, 2.0f, 2.0f, 2.0f);
+		parent->rotmode = ROT_MODE_XYZ;
+		copy_v3_fl3(parent->rot, 0.1f, 0.2f, 0.3f);
+		copy_v3_fl3(child->loc, -1.0f, 0.0f, 0.5f);
+		child->rotmode = ROT_MODE_QUAT;
+		copy_v4_fl4(child->quat, 0.5f, 0.5f, 0.5f, 0.5f);
+		unit_m4(child->parentinv);
+		child->parentinv[3][2] = -4.0f;
+
+		Main *main_read = write_and_read(main, "readfile_object.rose");
+
+		const Object *parent_read = lookup<Object>(main_read, ID_OB, "Parent");
+		const Object *child_read = lookup<Object>(main_read, ID_OB, "Child");
+		ASSERT_NE(parent_read, nullptr);
+		ASSERT_NE(child_read, nullptr);
+		EXPECT_EQ(child_read->parent, parent_read);
+		EXPECT_EQ(child_read->data, lookup<Camera>(main_read, ID_CA, "Camera"));
+
+		EXPECT_TRUE(equals_v3_v3(parent_read->loc, parent->loc));
+		EXPECT_TRUE(equals_v3_v3(parent_read->scale, parent->scale));
+		EXPECT_TRUE(equals_v3_v3(parent_read->rot, parent->rot));
+		EXPECT_EQ(parent_read->rotmode, ROT_MODE_XYZ);
+		EXPECT_TRUE(equals_v3_v3(child_read->loc, child->loc));
+		EXPECT_TRUE(equals_v4_v4(child_read->quat, child->quat));
+		EXPECT_EQ(child_read->rotmode, ROT_MODE_QUAT);
+		EXPECT_TRUE(equals_m4_m4(child_read->parentinv, child->parentinv));
+
+		KER_main_free(main_read);
+	} while (false);
+	KER_main_free(main);
+}
+
+TEST(ReadFile, Armature) {
+	KER_idtype_init();
+
+	Main *main = KER_main_new();
+	do {
+		Armature *armature = KER_armature_add(main, "Armature");
+		const float origin[3] = {0.0f, 0.0f, 0.0f};
+		const float up[3] = {0.0f, 0.0f, 1.0f};
+		const float top[3] = {0.0f, 0.0f, 2.0f};
+		const float side[3] = {1.0f, 0.0f, 0.0f};
+		Bone *root = add_bone(armature, nullptr, "Root", origin, up);
+		Bone *spine = add_bone(armature, root, "Spine", up, top);
+		add_bone(armature, spine, "Head", top, up);
+		add_bone(armature, root, "Arm", up, side);
+		add_bone(armature, nullptr, "Other", origin, side);
+
+		Main *main_read = write_and_read(main, "readfile_armature.rose");
+
+		Armature *armature_read = lookup<Armature>(main_read, ID_AR, "Armature");
+		ASSERT_NE(armature_read, nullptr);
+		EXPECT_EQ(LIB_listbase_count(&armature_read->bonebase), 2);
+		EXPECT_EQ(KER_armature_bonelist_count(&armature_read->bonebase), 5);
+
+		const Bone *root_read = KER_armature_find_bone_name(armature_read, "Root");
+		const Bone *spine_read = KER_armature_find_bone_name(armature_read, "Spine");
+		const Bone *head_read = KER_armature_find_bone_name(armature_read, "Head");
+		const Bone *arm_read = KER_armature_find_bone_name(armature_read, "Arm");
+		const Bone *other_read = KER_armature_find_bone_name(armature_read, "Other");
+		ASSERT_TRUE(root_read && spine_read && head_read && arm_read && other_read);
+
+		EXPECT_EQ(root_read->parent, nullptr);
+		EXPECT_EQ(other_read->parent, nullptr);
+		EXPECT_EQ(spine_read->parent, root_read);
+		EXPECT_EQ(arm_read->parent, root_read);
+		EXPECT_EQ(head_read->parent, spine_read);
+		EXPECT_EQ(LIB_listbase_count(&root_read->childbase), 2);
+		EXPECT_EQ(root_read->childbase.first, spine_read);
+		EXPECT_EQ(root_read->childbase.last, arm_read);
+		EXPECT_EQ(spine_read->childbase.first, head_read);
+
+		EXPECT_TRUE(equals_v3_v3(spine_read->head, up));
+		EXPECT_TRUE(equals_v3_v3(spine_read->tail, top));
+		EXPECT_TRUE(equals_v3_v3(arm_read->tail, side));
+
+		KER_main_free(main_read);
+	} while (false);
+	KER_main_free(main);
+}
+
+TEST(ReadFile, Action) {
+	KER_idtype_init();
+
+	Main *main = KER_main_new();
+	do {
+		Scene *scene = KER_scene_new(main, "Scene");
+		Object *object = KER_object_add(main, scene, OB_EMPTY, "Empty");
+
+		Action *action = static_cast<Action *>(KER_id_new(main, ID_AC, "Action"));
+		KER_action_keystrip_ensure(action);
+		action->frame_start = 0;
+		action->frame_end = 10;
+
+		ActionSlot *slot = KER_action_slot_add_for_idtype(action, ID_OB);
+		KER_action_slot_identifier_define(action, slot, object->id.name + 2);
+		KER_animdata_ensure_id(&object->id);
+		ASSERT_TRUE(KER_action_assign(action, &object->id));
+		ASSERT_TRUE(KER_action_slot_assign(slot, &object->id));
+
+		const FCurveDescriptor descriptors[] = {
+			{"location", 0, -1, -1, NULL},
+			{"location", 2, -1, -1, NULL},
+		};
+		FCurve *fcurves[ARRAY_SIZE(descriptors)];
+		ActionStripKeyframeData *strip_data = KER_action_strip_data(action, action->layers[0]->strips[0]);
+		ActionChannelBag *channelbag = KER_action_strip_keyframe_data_ensure_channelbag_for_slot(strip_data, slot);
+		KER_action_channelbag_fcurve_create_many(NULL, channelbag, descriptors, ARRAY_SIZE(descriptors), fcurves);
+		for (int curve = 0; curve < 2; curve++) {
+			KER_fcurve_bezt_resize(fcurves[curve], 2);
+			for (int index = 0; index < 2; index++) {
+				BezTriple &bezt = fcurves[curve]->bezt[index];
+				bezt.vec[1][0] = 10.0f * float(index);
+				bezt.vec[1][1] = float(curve + 1) * float(index) * 10.0f;
+				bezt.ipo = BEZT_IPO_LINEAR;
+				bezt.h1 = bezt.h2 = HD_AUTO_ANIM;
+			}
+			KER_fcurve_handles_recalc(fcurves[curve]);
+		}
+
+		Main *main_read = write_and_read(main, "readfile_action.rose");
+
+		Action *action_read = lookup<Action>(main_read, ID_AC, "Action");
+		Object *object_read = lookup<Object>(main_read, ID_OB, "Empty");
+		ASSERT_NE(action_read, nullptr);
+		ASSERT_NE(object_read, nullptr);
+		EXPECT_EQ(action_read->frame_end, 10);
+
+		AnimData *adt = KER_animdata_from_id(&object_read->id);
+		ASSERT_NE(adt, nullptr);
+		EXPECT_EQ(adt->action, action_read);
+		ActionSlot *slot_read = KER_action_slot_for_handle(action_read, adt->handle);
+		ASSERT_NE(slot_read, nullptr);
+
+		ActionChannelBag *channelbag_read = KER_action_channelbag_for_action_slot(action_read, slot_read);
+		ASSERT_NE(channelbag_read, nullptr);
+		ASSERT_EQ(channelbag_read->totcurve, 2);
+		for (int curve = 0; curve < 2; curve++) {
+			const FCurve *fcurve = channelbag_read->fcurves[curve];
+			EXPECT_STREQ(fcurve->path, "location");
+			EXPECT_EQ(fcurve->index, descriptors[curve].index);
+			ASSERT_EQ(fcurve->totvert, 2);
+			EXPECT_EQ(memcmp(fcurve->bezt, fcurves[curve]->bezt, sizeof(BezTriple) * 2), 0);
+		}
+
+		KER_animsys_evaluate_animdata(&object_read->id, adt, 5.0f, ADT_RECALC_ANIM);
+		EXPECT_FLOAT_EQ(object_read->loc[0], 5.0f);
+		EXPECT_FLOAT_EQ(object_read->loc[2], 10.0f);
+
+		KER_main_free(main_read);
+	} while (false);
+	KER_main_free(main);
+}
+
+TEST(ReadFile, Scene) {
+	KER_idtype_init();
+
+	Main *main = KER_main_new();
+	do {
+		add_scene_with_objects(main, 3);
+
+		Main *main_read = write_and_read(main, "readfile_scene.rose");
+
+		Scene *scene_read = lookup<Scene>(main_read, ID_SCE, "Scene");
+		ASSERT_NE(scene_read, nullptr);
+		ASSERT_NE(scene_read->master_collection, nullptr);
+		EXPECT_TRUE(scene_read->master_collection->flag & COLLECTION_IS_MASTER);
+		EXPECT_EQ(LIB_listbase_count(&scene_read->master_collection->objects), 3);
+		LISTBASE_FOREACH(CollectionObject *, cob, &scene_read->master_collection->objects) {
+			EXPECT_TRUE(LIB_haslink(&main_read->objects, cob->object));
+		}
+
+		/* The bases are runtime data, rebuilt from the collections. */
+		ASSERT_EQ(LIB_listbase_count(&scene_read->view_layers), 1);
+		const ViewLayer *view_layer = static_cast<const ViewLayer *>(scene_read->view_layers.first);
+		EXPECT_EQ(LIB_listbase_count(&view_layer->bases), 3);
+		LISTBASE_FOREACH(Base *, base, &view_layer->bases) {
+			EXPECT_TRUE(LIB_haslink(&main_read->objects, base->object));
+		}
+
+		KER_main_free(main_read);
+	} while (false);
+	KER_main_free(main);
+}
+
+TEST(ReadFile, Collection) {
+	KER_idtype_init();
+
+	Main *main = KER_main_new();
+	do {
+		Scene *scene = KER_scene_new(main, "Scene");
+		Collection *parent = KER_collection_add(main, scene->master_collection, "Parent");
+		Collection *child = KER_collection_add(main, parent, "Child");
+		Object *object = KER_object_add(main, scene, OB_EMPTY, "Empty");
+		KER_collection_object_add(main, child, object);
+
+		Main *main_read = write_and_read(main, "readfile_collection.rose");
+
+		Scene *scene_read = lookup<Scene>(main_read, ID_SCE, "Scene");
+		Collection *parent_read = lookup<Collection>(main_read, ID_GR, "Parent");
+		Collection *child_read = lookup<Collection>(main_read, ID_GR, "Child");
+		ASSERT_TRUE(scene_read && parent_read && child_read);
+
+		ASSERT_EQ(LIB_listbase_count(&scene_read->master_collection->children), 1);
+		EXPECT_EQ(static_cast<CollectionChild *>(scene_read->master_collection->children.first)->collection, parent_read);
+		ASSERT_EQ(LIB_listbase_count(&parent_read->children), 1);
+		EXPECT_EQ(static_cast<CollectionChild *>(parent_read->children.first)->collection, child_read);
+		ASSERT_EQ(LIB_listbase_count(&child_read->objects), 1);
+		EXPECT_EQ(static_cast<CollectionObject *>(child_read->objects.first)->object, lookup<Object>(main_read, ID_OB, "Empty"));
+
+		/* The parents are runtime data, rebuilt from the children. */
+		ASSERT_EQ(LIB_listbase_count(&child_read->parents), 1);
+		EXPECT_EQ(static_cast<CollectionParent *>(child_read->parents.first)->collection, parent_read);
+		ASSERT_EQ(LIB_listbase_count(&parent_read->parents), 1);
+		EXPECT_EQ(static_cast<CollectionParent *>(parent_read->parents.first)->collection, scene_read->master_collection);
+
+		KER_main_free(main_read);
+	} while (false);
+	KER_main_free(main);
+}
+
+TEST(ReadFile, Camera) {
+	KER_idtype_init();
+
+	Main *main = KER_main_new();
+	do {
+		Camera *persp = KER_camera_add(main, "Perspective");
+		Camera *ortho = KER_camera_add(main, "Orthographic");
+		persp->type = CAM_PERSP;
+		ortho->type = CAM_ORTHO;
+
+		Main *main_read = write_and_read(main, "readfile_camera.rose");
+
+		const Camera *persp_read = lookup<Camera>(main_read, ID_CA, "Perspective");
+		const Camera *ortho_read = lookup<Camera>(main_read, ID_CA, "Orthographic");
+		ASSERT_NE(persp_read, nullptr);
+		ASSERT_NE(ortho_read, nullptr);
+		EXPECT_EQ(persp_read->type, CAM_PERSP);
+		EXPECT_EQ(ortho_read->type, CAM_ORTHO);
+		EXPECT_EQ(persp_read->adt, nullptr);
+
+		KER_main_free(main_read);
+	} while (false);
+	KER_main_free(main);
+}
+
+/** Compare the data-blocks that #ReadFile.ParallelDecode creates, matching them by name. */
+void expect_mains_equal(Main *main_a, Main *main_b) {
+	ASSERT_EQ(LIB_listbase_count(&main_a->objects), LIB_listbase_count(&main_b->objects));
+	LISTBASE_FOREACH(Object *, object_a, &main_a->objects) {
+		const Object *object_b = lookup<Object>(main_b, ID_OB, object_a->id.name + 2);
+		ASSERT_NE(object_b, nullptr);
+		EXPECT_TRUE(equals_v3_v3(object_a->loc, object_b->loc));
+		EXPECT_TRUE(equals_v3_v3(object_a->scale, object_b->scale));
+		EXPECT_TRUE(equals_v4_v4(object_a->quat, object_b->quat));
+		EXPECT_STREQ((object_a->parent) ? object_a->parent->id.name : "", (object_b->parent) ? object_b->parent->id.name : "");
+		EXPECT_STREQ((object_a->data) ? static_cast<ID *>(object_a->data)->name : "", (object_b->data) ? static_cast<ID *>(object_b->data)->name : "");
+	}
+
+	ASSERT_EQ(LIB_listbase_count(&main_a->meshes), LIB_listbase_count(&main_b->meshes));
+	LISTBASE_FOREACH(Mesh *, mesh_a, &main_a->meshes) {
+		const Mesh *mesh_b = lookup<Mesh>(main_b, ID_ME, mesh_a->id.name + 2);
+		ASSERT_NE(mesh_b, nullptr);
+		ASSERT_EQ(mesh_a->totvert, mesh_b->totvert);
+		ASSERT_EQ(mesh_a->totpoly, mesh_b->totpoly);
+		ASSERT_EQ(mesh_a->totloop, mesh_b->totloop);
+		EXPECT_EQ(memcmp(KER_mesh_vert_positions(mesh_a), KER_mesh_vert_positions(mesh_b), sizeof(float[3]) * mesh_a->totvert), 0);
+		EXPECT_EQ(memcmp(KER_mesh_corner_verts(mesh_a), KER_mesh_corner_verts(mesh_b), sizeof(int) * mesh_a->totloop), 0);
+		EXPECT_EQ(memcmp(KER_mesh_poly_offsets(mesh_a), KER_mesh_poly_offsets(mesh_b), sizeof(int) * (mesh_a->totpoly + 1)), 0);
+	}
+
+	ASSERT_EQ(LIB_listbase_count(&main_a->actions), LIB_listbase_count(&main_b->actions));
+	LISTBASE_FOREACH(Action *, action_a, &main_a->actions) {
+		Action *action_b = lookup<Action>(main_b, ID_AC, action_a->id.name + 2);
+		ASSERT_NE(action_b, nullptr);
+		ASSERT_EQ(action_a->totslot, 1);
+		ASSERT_EQ(action_b->totslot, 1);
+		const ActionChannelBag *channelbag_a = KER_action_channelbag_for_action_slot(action_a, action_a->slots[0]);
+		const ActionChannelBag *channelbag_b = KER_action_channelbag_for_action_slot(action_b, action_b->slots[0]);
+		ASSERT_TRUE(channelbag_a && channelbag_b);
+		ASSERT_EQ(channelbag_a->totcurve, channelbag_b->totcurve);
+		for (int index = 0; index < channelbag_a->totcurve; index++) {
+			const FCurve *fcurve_a = channelbag_a->fcurves[index];
+			const FCurve *fcurve_b = channelbag_b->fcurves[index];
+			EXPECT_STREQ(fcurve_a->path, fcurve_b->path);
+			ASSERT_EQ(fcurve_a->totvert, fcurve_b->totvert);
+			EXPECT_EQ(memcmp(fcurve_a->bezt, fcurve_b->bezt, sizeof(BezTriple) * fcurve_a->totvert), 0);
+		}
+	}
+}
+
+TEST(ReadFile, ParallelDecode) {
+	KER_idtype_init();
+
+	Main *main = KER_main_new();
+	do {
+		/* Many small blocks of different structs (objects, meshes, layers, actions and curves). */
+		Scene *scene = KER_scene_new(main, "Scene");
+		Object *parent = nullptr;
+		for (int index = 0; index < 64; index++) {
+			char name[64];
+			LIB_strnformat(name, ARRAY_SIZE(name), "Mesh%d", index);
+
+			/* A fan of triangles around the first vertex, the size differs per mesh. */
+			Mesh *mesh = KER_mesh_add(main, name);
+			mesh->totvert = 3 + index;
+			mesh->totpoly = 1 + index;
+			mesh->totloop = 3 * mesh->totpoly;
+			KER_mesh_ensure_required_data_layers(mesh);
+			KER_mesh_poly_offsets_ensure_alloc(mesh);
+			float(*positions)[3] = KER_mesh_vert_positions_for_write(mesh);
+			for (int vert = 0; vert < mesh->totvert; vert++) {
+				copy_v3_fl3(positions[vert], float(vert), float(index), float(vert * index) * 0.25f);
+			}
+			int *poly_offsets = KER_mesh_poly_offsets_for_write(mesh);
+			int *corner_verts = KER_mesh_corner_verts_for_write(mesh);
+			for (int poly = 0; poly < mesh->totpoly; poly++) {
+				poly_offsets[poly] = poly * 3;
+				corner_verts[poly * 3 + 0] = 0;
+				corner_verts[poly * 3 + 1] = poly + 1;
+				corner_verts[poly * 3 + 2] = poly + 2;
+			}
+			poly_offsets[mesh->totpoly] = mesh->totloop;
+
+			Object *object = KER_object_add_for_data(main, scene, OB_MESH, name, &mesh->id, true);
+			copy_v3_fl3(object->loc, float(index), 0.5f, -float(index));
+			copy_v3_fl(object->scale, 1.0f + float(index) * 0.125f);
+			object->parent = parent;
+			parent = (index % 8 == 7) ? nullptr : object;
+
+			if (index % 4 == 0) {
+				Action *action = static_cast<Action *>(KER_id_new(main, ID_AC, name));
+				KER_action_keystrip_ensure(action);
+				ActionSlot *slot = KER_action_slot_add_for_idtype(action, ID_OB);
+				const FCurveDescriptor descriptors[] = {
+					{"location", 0, -1, -1, NULL},
+					{"scale", 1, -1, -1, NULL},
+				};
+				FCurve *fcurves[ARRAY_SIZE(descriptors)];
+				ActionStripKeyframeData *strip_data = KER_action_strip_data(action, action->layers[0]->strips[0]);
+				ActionChannelBag *channelbag = KER_action_strip_keyframe_data_ensure_channelbag_for_slot(strip_data, slot);
+				KER_action_channelbag_fcurve_create_many(NULL, channelbag, descriptors, ARRAY_SIZE(descriptors), fcurves);
+				for (FCurve *fcurve : fcurves) {
+					KER_fcurve_bezt_resize(fcurve, 2 + index / 4);
+					for (int key = 0; key < fcurve->totvert; key++) {
+						fcurve->bezt[key].vec[1][0] = float(key);
+						fcurve->bezt[key].vec[1][1] = float(key * index);
+						fcurve->bezt[key].ipo = BEZT_IPO_BEZ;
+					}
+					KER_fcurve_handles_recalc(fcurve);
+				}
+			}
+		}
+
+		const std::string filepath = testing::TempDir() + "readfile_parallel.rose";
+		ASSERT_TRUE(RLO_write_file(main, filepath.c_str(), 0));
+
+		Main *main_parallel = KER_main_new();
+		Main *main_serial = KER_main_new();
+		EXPECT_TRUE(RLO_read_file(main_parallel, filepath.c_str(), 0));
+		EXPECT_TRUE(RLO_read_file(main_serial, filepath.c_str(), RLO_READ_SINGLE_THREADED));
+		remove(filepath.c_str());
+
+		expect_mains_equal(main_parallel, main_serial);
+		expect_mains_equal(main, main_parallel);
+
+		KER_main_free(main_serial);
+		KER_main_free(main_parallel);
+	} while (false);
+	KER_main_free(main);
+}
+
+}  // namespace
@@ -0,0 +1,66 @@
+#include "MEM_guardedalloc.h"
+
+#include "LIB_filereader.h"
+#include "LIB_utildefines.h"
+
+#include "RLO_undofile.h"
+
+#include <cstdio>
+#include <numeric>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace {
+
+TEST(UndoFile, ReaderSeek) {
+	/* The bytes count up over chunks of uneven size. */
+	std::vector<unsigned char> data(1000);
+	std::iota(data.begin(), data.end(), 0);
+
+	MemFile memfile = {};
+	MemFileWriteData *mem_data = RLO_memfile_write_init(&memfile, nullptr);
+	size_t offset = 0;
+	for (size_t size = 1; offset < data.size(); size = size * 2 + 1) {
+		size = ROSE_MIN(size, data.size() - offset);
+		RLO_memfile_chunk_add(mem_data, &data[offset], size);
+		offset += size;
+	}
+	RLO_memfile_write_finalize(mem_data);
+
+	FileReader *reader = RLO_memfile_new_filereader(&memfile);
+
+	auto read_at = [&](const uint64_t position, const size_t size) {
+		std::vector<unsigned char> buffer(size);
+		EXPECT_EQ(reader->seek(reader, position, SEEK_SET), position);
+		EXPECT_EQ(reader->read(reader, buffer.data(), size), size);
+		EXPECT_EQ(reader->offset, position + size);
+		EXPECT_EQ(memcmp(buffer.data(), &data[position], size), 0);
+	};
+
+	/* Forward, backward, within the current chunk and across several chunks. */
+	read_at(0, 10);
+	read_at(500, 100);
+	read_at(3, 2);
+	read_at(700, 300);
+	read_at(640, 1);
+	read_at(641, 1);
+	read_at(0, 1000);
+
+	/* Relative seeks continue from the current offset. */
+	read_at(100, 4);
+	EXPECT_EQ(reader->seek(reader, 6, SEEK_CUR), 110);
+	unsigned char byte;
+	EXPECT_EQ(reader->read(reader, &byte, 1), 1);
+	EXPECT_EQ(byte, data[110]);
+
+	/* Seeking past the end stops at the end, the reader can still seek back. */
+	EXPECT_EQ(reader->seek(reader, 2000, SEEK_SET), data.size());
+	EXPECT_EQ(reader->read(reader, &byte, 1), 0);
+	read_at(999, 1);
+
+	reader->close(reader);
+	RLO_memfile_free(&memfile);
+}
+
+}  // namespace
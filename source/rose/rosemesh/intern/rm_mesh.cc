@@ -56,6 +56,20 @@ static void rm_mempool_init(RMesh *mesh, const bool use_toolflags) {
 	rm_mempool_init_ex(use_toolflags, &mesh->vpool, &mesh->epool, &mesh->lpool, &mesh->fpool);
 }
 
+void RM_mesh_elem_pools_reserve(RMesh *mesh, const int totvert, const int totedge, const int totloop, const int totface) {
+	ROSE_assert(mesh->totvert == 0 && mesh->totedge == 0 && mesh->totloop == 0 && mesh->totface == 0);
+
+	LIB_memory_pool_destroy(mesh->vpool);
+	LIB_memory_pool_destroy(mesh->epool);
+	LIB_memory_pool_destroy(mesh->lpool);
+	LIB_memory_pool_destroy(mesh->fpool);
+
+	mesh->vpool = LIB_memory_pool_create(sizeof(RMVert), rm_mesh_allocsize_default_verts, totvert, ROSE_MEMPOOL_ALLOW_ITER);
+	mesh->epool = LIB_memory_pool_create(sizeof(RMEdge), rm_mesh_allocsize_default_edges, totedge, ROSE_MEMPOOL_ALLOW_ITER);
+	mesh->lpool = LIB_memory_pool_create(sizeof(RMLoop), rm_mesh_allocsize_default_loops, totloop, ROSE_MEMPOOL_ALLOW_ITER);
+	mesh->fpool = LIB_memory_pool_create(sizeof(RMFace), rm_mesh_allocsize_default_faces, totface, ROSE_MEMPOOL_ALLOW_ITER);
+}
+
 RMesh *RM_mesh_create(void) {
 	/** Allocate the structure. */
 	RMesh *mesh = static_cast<RMesh *>(MEM_callocN(sizeof(RMesh), __func__));
@@ -25,6 +25,12 @@ void RM_mesh_free(struct RMesh *mesh);
  */
 void RM_mesh_clear(struct RMesh *mesh);
 
+/**
+ * Recreate the element pools of an empty \a mesh with room for the given number of elements,
+ * so that filling the mesh does not grow the pools one chunk at a time.
+ */
+void RM_mesh_elem_pools_reserve(struct RMesh *mesh, int totvert, int totedge, int totloop, int totface);
+
 void RM_mesh_elem_table_ensure(struct RMesh *mesh, char htype);
 /* use #RM_mesh_elem_table_ensure where possible to avoid full rebuild */
 void RM_mesh_elem_table_init(struct RMesh *mesh, const char htype);
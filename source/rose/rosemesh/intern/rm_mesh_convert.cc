@@ -11,6 +11,8 @@
 #include "LIB_math_matrix_types.hh"
 #include "LIB_math_vector_types.hh"
 #include "LIB_math_vector.h"
+#include "LIB_mempool.h"
+#include "LIB_offset_indices.hh"
 #include "LIB_span.hh"
 #include "LIB_string_ref.hh"
 #include "LIB_task.hh"
@@ -18,12 +20,17 @@
 
 #include "KER_customdata.h"
 #include "KER_mesh.h"
+#include "KER_mesh.hh"
 
 #include "RM_include.h"
 
 #include "rm_mesh_convert.h"
 #include "rm_private.h"
 
+#include "atomic_ops.h"
+
+#include <algorithm>
+
 ROSE_STATIC void assert_rmesh_has_no_mesh_only_attributes(const RMesh *rm) {
 	(void)rm;
 	ROSE_assert(!CustomData_has_layer_named(&rm->vdata, CD_PROP_FLOAT3, "position"));
@@ -233,3 +240,236 @@ void RM_mesh_rm_to_me(Main *main, RMesh *rm, Mesh *me, const struct RMeshToMeshP
 		}
 	);
 }
+
+/* -------------------------------------------------------------------- */
+/** \name Mesh to RMesh
+ * \{ */
+
+/**
+ * Gather the indices of \a indices that reference each group, the groups are sorted afterwards so
+ * that the result does not depend on the scheduling of the threads.
+ */
+ROSE_STATIC void reverse_indices_in_groups(const rose::Span<int> indices, const rose::OffsetIndices<int> offsets, rose::MutableSpan<int> results) {
+	rose::Array<int> counts(offsets.size(), 0);
+	rose::threading::parallel_for(indices.index_range(), 4096, [&](const rose::IndexRange range) {
+		for (const int index : range) {
+			const int group = indices[index];
+			const int index_in_group = atomic_fetch_and_add_int32(&counts[group], 1);
+			results[offsets[group][index_in_group]] = index;
+		}
+	});
+	rose::threading::parallel_for(offsets.index_range(), 1024, [&](const rose::IndexRange range) {
+		for (const int group : range) {
+			rose::MutableSpan<int> group_indices = results.slice(offsets[group]);
+			std::sort(group_indices.begin(), group_indices.end());
+		}
+	});
+}
+
+/** Allocating from a #MemPool is not thread-safe, so only the elements are allocated serially. */
+template<typename T> ROSE_STATIC T **rm_elem_table_alloc(MemPool *pool, const int num, const char *name) {
+	T **table = static_cast<T **>(MEM_mallocN(sizeof(T *) * num, name));
+	for (const int index : rose::IndexRange(num)) {
+		table[index] = static_cast<T *>(LIB_memory_pool_malloc(pool));
+	}
+	return table;
+}
+
+ROSE_STATIC void mesh_to_rm_verts(RMesh *rm, const Mesh *me, const rose::Span<float3> normals) {
+	const rose::Span<float3> positions = KER_mesh_vert_positions_span(me);
+
+	rose::threading::parallel_for(positions.index_range(), 1024, [&](const rose::IndexRange range) {
+		for (const int index : range) {
+			RMVert *v = rm->vtable[index];
+
+			v->head.data = nullptr;
+			RM_elem_index_set(v, index);
+			v->head.htype = RM_VERT;
+			v->head.hflag = 0;
+			v->head.api_flag = 0;
+
+			copy_v3_v3(v->co, positions[index]);
+			if (normals.is_empty()) {
+				zero_v3(v->no);
+			}
+			else {
+				copy_v3_v3(v->no, normals[index]);
+			}
+			v->e = nullptr;
+		}
+	});
+}
+
+ROSE_STATIC void mesh_to_rm_edges(RMesh *rm, const Mesh *me) {
+	const rose::Span<int2> edges = KER_mesh_edges_span(me);
+
+	rose::threading::parallel_for(edges.index_range(), 1024, [&](const rose::IndexRange range) {
+		for (const int index : range) {
+			RMEdge *e = rm->etable[index];
+
+			e->head.data = nullptr;
+			RM_elem_index_set(e, index);
+			e->head.htype = RM_EDGE;
+			e->head.hflag = RM_ELEM_SMOOTH | RM_ELEM_DRAW;
+			e->head.api_flag = 0;
+
+			e->v1 = rm->vtable[edges[index][0]];
+			e->v2 = rm->vtable[edges[index][1]];
+			e->l = nullptr;
+		}
+	});
+}
+
+ROSE_STATIC void mesh_to_rm_polys_loops(RMesh *rm, const Mesh *me, const rose::Span<float3> normals, rose::Span<RMLoop *> loops) {
+	const rose::OffsetIndices<int> polys = KER_mesh_poly_offsets_span(me);
+	const rose::Span<int> corner_verts = KER_mesh_corner_verts_span(me);
+	const rose::Span<int> corner_edges = KER_mesh_corner_edges_span(me);
+
+	rose::threading::parallel_for(polys.index_range(), 1024, [&](const rose::IndexRange range) {
+		for (const int index : range) {
+			const rose::IndexRange poly = polys[index];
+			RMFace *f = rm->ftable[index];
+
+			f->head.data = nullptr;
+			RM_elem_index_set(f, index);
+			f->head.htype = RM_FACE;
+			f->head.hflag = 0;
+			f->head.api_flag = 0;
+
+			f->l_first = loops[poly.start()];
+			f->len = int(poly.size());
+			f->mat_nr = 0;
+			if (normals.is_empty()) {
+				zero_v3(f->no);
+			}
+			else {
+				copy_v3_v3(f->no, normals[index]);
+			}
+
+			for (const int corner : poly) {
+				RMLoop *l = loops[corner];
+
+				l->head.data = nullptr;
+				RM_elem_index_set(l, corner);
+				l->head.htype = RM_LOOP;
+				l->head.hflag = 0;
+				l->head.api_flag = 0;
+
+				l->v = rm->vtable[corner_verts[corner]];
+				l->e = rm->etable[corner_edges[corner]];
+				l->f = f;
+				l->prev = loops[rose::kernel::mesh::face_corner_prev(poly, corner)];
+				l->next = loops[rose::kernel::mesh::face_corner_next(poly, corner)];
+			}
+		}
+	});
+}
+
+/**
+ * Link the edges around every vertex, \a vert_edges stores twice the index of the edge plus the
+ * side of the edge the vertex is on, which selects the disk link to write.
+ */
+ROSE_STATIC void mesh_to_rm_disk_cycles(RMesh *rm, const rose::GroupedSpan<int> vert_edges) {
+	rose::threading::parallel_for(vert_edges.index_range(), 1024, [&](const rose::IndexRange range) {
+		for (const int index : range) {
+			const rose::Span<int> group = vert_edges[index];
+			if (group.is_empty()) {
+				continue;
+			}
+			const size_t num = group.size();
+			for (const size_t i : group.index_range()) {
+				RMEdge *e = rm->etable[group[i] >> 1];
+				RMDiskLink *link = &(&e->v1_disk_link)[group[i] & 1];
+
+				link->prev = rm->etable[group[(i + num - 1) % num] >> 1];
+				link->next = rm->etable[group[(i + 1) % num] >> 1];
+			}
+			rm->vtable[index]->e = rm->etable[group.first() >> 1];
+		}
+	});
+}
+
+ROSE_STATIC void mesh_to_rm_radial_cycles(RMesh *rm, const rose::GroupedSpan<int> edge_corners, rose::Span<RMLoop *> loops) {
+	rose::threading::parallel_for(edge_corners.index_range(), 1024, [&](const rose::IndexRange range) {
+		for (const int index : range) {
+			const rose::Span<int> group = edge_corners[index];
+			if (group.is_empty()) {
+				continue;
+			}
+			const size_t num = group.size();
+			for (const size_t i : group.index_range()) {
+				RMLoop *l = loops[group[i]];
+
+				l->radial_prev = loops[group[(i + num - 1) % num]];
+				l->radial_next = loops[group[(i + 1) % num]];
+			}
+			rm->etable[index]->l = loops[group.first()];
+		}
+	});
+}
+
+void RM_mesh_me_to_rm(RMesh *rm, const Mesh *me, const RMeshFromMeshParams *params) {
+	ROSE_assert(rm->totvert == 0 && rm->totedge == 0 && rm->totloop == 0 && rm->totface == 0);
+
+	RM_mesh_elem_pools_reserve(rm, me->totvert, me->totedge, me->totloop, me->totpoly);
+	RM_mesh_elem_table_free(rm, RM_ALL_NOLOOP);
+
+	rm->vtable = rm_elem_table_alloc<RMVert>(rm->vpool, me->totvert, "mesh->vtable");
+	rm->etable = rm_elem_table_alloc<RMEdge>(rm->epool, me->totedge, "mesh->etable");
+	rm->ftable = rm_elem_table_alloc<RMFace>(rm->fpool, me->totpoly, "mesh->ftable");
+	rm->vtable_tot = rm->totvert = me->totvert;
+	rm->etable_tot = rm->totedge = me->totedge;
+	rm->ftable_tot = rm->totface = me->totpoly;
+	rm->totloop = me->totloop;
+
+	rose::Array<RMLoop *> loops(me->totloop);
+	for (const int index : loops.index_range()) {
+		loops[index] = static_cast<RMLoop *>(LIB_memory_pool_malloc(rm->lpool));
+	}
+
+	/** Normals are cached on the mesh, make sure they are computed before the threads read them. */
+	const rose::Span<float3> vert_normals = (params->calc_vert_normal) ? KER_mesh_vert_normals_span(me) : rose::Span<float3>();
+	const rose::Span<float3> poly_normals = (params->calc_face_normal) ? KER_mesh_poly_normals_span(me) : rose::Span<float3>();
+
+	/** The offsets of the vertex to edge and edge to corner maps are prefix sums of the use counts. */
+	const rose::Span<int> edge_verts = KER_mesh_edges_span(me).cast<int>();
+	const rose::Span<int> corner_edges = KER_mesh_corner_edges_span(me);
+	rose::Array<int> vert_to_edge_offsets(me->totvert + 1, 0);
+	rose::Array<int> vert_to_edge_indices(edge_verts.size());
+	rose::Array<int> edge_to_corner_offsets(me->totedge + 1, 0);
+	rose::Array<int> edge_to_corner_indices(corner_edges.size());
+
+	rose::threading::parallel_invoke((me->totpoly + me->totedge) > 1024,
+		[&]() {
+			mesh_to_rm_verts(rm, me, vert_normals);
+		},
+		[&]() {
+			mesh_to_rm_edges(rm, me);
+		},
+		[&]() {
+			mesh_to_rm_polys_loops(rm, me, poly_normals, loops);
+		},
+		[&]() {
+			rose::offset_indices::build_reverse_offsets(edge_verts, vert_to_edge_offsets);
+			reverse_indices_in_groups(edge_verts, rose::OffsetIndices<int>(vert_to_edge_offsets), vert_to_edge_indices);
+		},
+		[&]() {
+			rose::offset_indices::build_reverse_offsets(corner_edges, edge_to_corner_offsets);
+			reverse_indices_in_groups(corner_edges, rose::OffsetIndices<int>(edge_to_corner_offsets), edge_to_corner_indices);
+		}
+	);
+
+	rose::threading::parallel_invoke((me->totpoly + me->totedge) > 1024,
+		[&]() {
+			mesh_to_rm_disk_cycles(rm, rose::GroupedSpan<int>(rose::OffsetIndices<int>(vert_to_edge_offsets), vert_to_edge_indices));
+		},
+		[&]() {
+			mesh_to_rm_radial_cycles(rm, rose::GroupedSpan<int>(rose::OffsetIndices<int>(edge_to_corner_offsets), edge_to_corner_indices), loops);
+		}
+	);
+
+	rm->elem_index_dirty &= ~(RM_VERT | RM_EDGE | RM_FACE | RM_LOOP);
+	rm->elem_table_dirty &= ~RM_ALL_NOLOOP;
+}
+
+/** \} */
@@ -20,6 +20,22 @@ typedef struct RMeshToMeshParams {
     struct CustomData_MeshMasks cd_mask_extra;
 } RMeshToMeshParams;
 
+typedef struct RMeshFromMeshParams {
+    /** Copy the face normals of the mesh to #RMFace.no. */
+    bool calc_face_normal;
+    /** Copy the vertex normals of the mesh to #RMVert.no. */
+    bool calc_vert_normal;
+} RMeshFromMeshParams;
+
+/**
+ * Fill the empty \a rm with the vertices, edges, faces and face corners of \a me.
+ *
+ * The element pools are reserved up-front and the elements are filled in parallel, the disk and
+ * radial cycles are built from the vertex to edge and edge to corner maps of the mesh.
+ * The element indices and lookup tables of \a rm are valid afterwards.
+ */
+void RM_mesh_me_to_rm(struct RMesh *rm, const struct Mesh *me, const struct RMeshFromMeshParams *params);
+
 void RM_mesh_rm_to_me(struct Main *main, struct RMesh *rm, struct Mesh *me, const struct RMeshToMeshParams *params);
 
 #ifdef __cplusplus
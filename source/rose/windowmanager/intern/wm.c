@@ -3,6 +3,8 @@
 #include "DNA_mesh_types.h"
 #include "DNA_space_types.h"
 
+#include "intern/genfile.h"
+
 #include "RNA_access.h"
 
 #include "DRW_engine.h"
@@ -40,6 +42,7 @@
 #include "LIB_math_matrix.h"
 #include "LIB_listbase.h"
 #include "LIB_string.h"
+#include "LIB_task.h"
 #include "LIB_utildefines.h"
 
 #include "IO_fbx.h"
@@ -246,7 +249,7 @@ ROSE_INLINE void wm_init_scene(rContext *C, struct Main *main, struct wmWindow *
 	Scene *scene = KER_scene_new(main, "Scene");
 
 	ED_screen_scene_change(C, window, scene);
-	// FBX_import_memory(C, datatoc_sarah_fbx, datatoc_sarah_fbx_size, 1.0f);
+	// FBX_import_memory(C, datatoc_sarah_fbx, datatoc_sarah_fbx_size, 1.0f, NULL);
 }
 
 void WM_keyconfig_init(rContext *C) {
@@ -341,11 +344,14 @@ void WM_exit(rContext *C) {
 	RFT_exit();
 
 	RNA_exit();
+	DNA_sdna_current_free();
 
 	ED_spacetypes_exit();
 	WM_operatortype_clear();
 
 	CTX_free(C);
+
+	LIB_task_scheduler_exit();
 	exit(0);
 }
 